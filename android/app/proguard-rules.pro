@@ -12,3 +12,12 @@
 -keep class com.facebook.react.turbomodule.** { *; }
 
 # Add any project specific keep options here:
+
+# QEMU JNI: natives are bound by name with RegisterNatives, and
+# onNative* callbacks are looked up by name from JNI_OnLoad
+-keepclasseswithmembernames class com.dockerandroid.app.qemu.** {
+    native <methods>;
+}
+-keepclassmembers class com.dockerandroid.app.qemu.QemuModule {
+    void onNative*(...);
+}
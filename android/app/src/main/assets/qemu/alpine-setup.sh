@@ -55,9 +55,150 @@ apk add \
     iptables \
     ip6tables \
     ca-certificates \
-    bash
+    bash \
+    criu
 
-# Configure Docker daemon
+# Container storage on its own virtio disk (serial docker-data), formatted
+# for layer extraction: ext4 with lazy inode/journal init so formatting is
+# quick under TCG, a 128 MiB journal for bursts of small-file metadata,
+# more inodes than the default, no reserved blocks, and noatime. Runs
+# before containerd and dockerd; appliance-init mounts it directly and
+# only calls this to format a blank disk.
+echo "Setting up data disk..."
+apk add e2fsprogs
+mkdir -p /usr/local/sbin
+cat > /usr/local/sbin/docker-data << 'EOF'
+#!/bin/sh
+ROOT=/var/lib/docker
+OPTS=noatime,commit=30,discard
+DEV=
+for s in /sys/block/vd*/serial; do
+    [ "$(cat "$s" 2> /dev/null)" = docker-data ] && DEV=/dev/$(basename "$(dirname "$s")")
+done
+[ -n "$DEV" ] || exit 0
+mountpoint -q $ROOT && exit 0
+mkdir -p $ROOT
+if ! blkid "$DEV" | grep -q 'TYPE="ext4"'; then
+    echo "Formatting $DEV for $ROOT"
+    mkfs.ext4 -q -F -L docker-data -m 0 -i 8192 -J size=128 \
+        -E lazy_itable_init=1,lazy_journal_init=1,nodiscard "$DEV" || exit 1
+    # Move Docker data the OS disk already holds onto the new disk
+    if [ -n "$(ls -A $ROOT)" ]; then
+        mkdir -p /mnt/docker-data
+        mount -t ext4 -o $OPTS "$DEV" /mnt/docker-data || exit 1
+        cp -a $ROOT/. /mnt/docker-data/ && find $ROOT -mindepth 1 -maxdepth 1 -exec rm -rf {} +
+        umount /mnt/docker-data
+    fi
+fi
+mount -t ext4 -o $OPTS "$DEV" $ROOT || exit 1
+# containerd and the stargz snapshotter (lite runtime) keep their state there too
+for d in containerd containerd-stargz-grpc; do
+    mkdir -p $ROOT/.$d /var/lib/$d
+    mount --bind $ROOT/.$d /var/lib/$d
+done
+EOF
+chmod 755 /usr/local/sbin/docker-data
+cat > /etc/init.d/docker-data << 'EOF'
+#!/sbin/openrc-run
+description="Mount the container storage disk on /var/lib/docker"
+
+depend() {
+    need localmount
+    before containerd docker
+}
+
+start() {
+    ebegin "Mounting docker data disk"
+    /usr/local/sbin/docker-data
+    eend $?
+}
+EOF
+chmod 755 /etc/init.d/docker-data
+rc-update add docker-data boot
+/etc/init.d/docker-data start || true
+
+# Optional scratch disk (virtio serial scratch): the host hands over a
+# blank, unsafe-cached file every boot, so it is formatted without a
+# journal each time and holds only what may be lost: /tmp, dockerd's
+# BuildKit cache and bind volumes under /scratch/volumes.
+cat > /usr/local/sbin/scratch-disk << 'EOF'
+#!/bin/sh
+S=/scratch
+if [ "${1:-}" = watch ]; then
+    # dockerd doesn't create a bind volume's directory; do it on creation.
+    # Runs for as long as the VM does (appliance-init's scratch-volumes
+    # service, or the OpenRC service below)
+    backing() {
+        dir=$(docker volume inspect -f '{{index .Options "device"}}' "$1" 2> /dev/null)
+        case "$dir" in $S/volumes/*) mkdir -p "$dir" ;; esac
+    }
+    while :; do
+        # Catch up on volumes created while dockerd was starting or
+        # before a restart, then follow new ones
+        if names=$(docker volume ls -q 2> /dev/null); then
+            for name in $names; do backing "$name"; done
+            docker events --filter type=volume --filter event=create --format '{{.Actor.ID}}' |
+            while read -r name; do backing "$name"; done
+        fi
+        sleep 2
+    done
+fi
+DEV=
+for s in /sys/block/vd*/serial; do
+    [ "$(cat "$s" 2> /dev/null)" = scratch ] && DEV=/dev/$(basename "$(dirname "$s")")
+done
+[ -n "$DEV" ] || exit 0
+mountpoint -q $S && exit 0
+mkfs.ext4 -q -F -L scratch -O ^has_journal -m 0 -E lazy_itable_init=1,nodiscard "$DEV" || exit 1
+mkdir -p $S
+mount -t ext4 -o noatime,nobarrier "$DEV" $S || exit 1
+mkdir -p $S/tmp $S/buildkit $S/volumes /var/lib/docker/buildkit
+chmod 1777 $S/tmp
+mount --bind $S/tmp /tmp
+mount --bind $S/buildkit /var/lib/docker/buildkit
+# Bind volumes from earlier boots: dockerd keeps their options in
+# opts.json, docker-shim symlinks their data directory
+for f in /var/lib/docker/volumes/*/opts.json; do
+    [ -f "$f" ] || continue
+    dir=$(sed -n 's/.*"MountDevice":"\([^"]*\)".*/\1/p' "$f")
+    case "$dir" in $S/volumes/*) mkdir -p "$dir" ;; esac
+done
+find /var/lib/nerdctl -path '*/volumes/*/_data' -type l 2> /dev/null | while read -r l; do
+    dir=$(readlink "$l")
+    case "$dir" in $S/volumes/*) mkdir -p "$dir" ;; esac
+done
+EOF
+chmod 755 /usr/local/sbin/scratch-disk
+cat > /etc/init.d/scratch-disk << 'EOF'
+#!/sbin/openrc-run
+description="Format and mount the scratch disk"
+pidfile=/run/scratch-volumes.pid
+
+depend() {
+    need localmount
+    after docker-data
+    before containerd docker
+}
+
+start() {
+    ebegin "Setting up scratch disk"
+    /usr/local/sbin/scratch-disk
+    eend $? || return 1
+    if mountpoint -q /scratch && ! grep -qw appliance.runtime=lite /proc/cmdline; then
+        start-stop-daemon -S -b -m -p $pidfile -x /usr/local/sbin/scratch-disk -- watch
+    fi
+}
+
+stop() {
+    [ -f $pidfile ] && start-stop-daemon -K -p $pidfile
+    return 0
+}
+EOF
+chmod 755 /etc/init.d/scratch-disk
+rc-update add scratch-disk boot
+
+# Configure Docker daemon. "experimental" enables `docker checkpoint`,
+# which uses the criu package installed above.
 echo "Configuring Docker daemon..."
 mkdir -p /etc/docker
 
@@ -70,6 +211,8 @@ cat > /etc/docker/daemon.json << 'EOF'
         "max-size": "10m",
         "max-file": "3"
     },
+    "registry-mirrors": ["http://10.0.2.2:5080"],
+    "experimental": true,
     "max-concurrent-downloads": 3,
     "max-concurrent-uploads": 2,
     "default-ulimits": {
@@ -125,6 +268,174 @@ else
     exit 1
 fi
 
+# Appliance init: a static PID 1 that starts containerd/dockerd directly,
+# used instead of OpenRC when enabled in the app. The host serves it over
+# slirp's TFTP server.
+echo "Installing appliance init..."
+if tftp -g -r appliance-init -l /sbin/appliance-init 10.0.2.2; then
+    chmod 755 /sbin/appliance-init
+else
+    rm -f /sbin/appliance-init
+fi
+
+# Stats for all containers in one stream, read from cgroup v2 and sent
+# over the org.dockerandroid.stats virtio-serial port. It only samples
+# while the app is reading. appliance-init starts it; under OpenRC a
+# local.d script does.
+echo "Installing container stats collector..."
+if tftp -g -r cgroup-stats -l /usr/local/bin/cgroup-stats 10.0.2.2; then
+    chmod 755 /usr/local/bin/cgroup-stats
+    mkdir -p /etc/local.d
+    cat > /etc/local.d/cgroup-stats.start << 'EOF'
+#!/bin/sh
+[ -x /usr/local/bin/cgroup-stats ] || exit 0
+start-stop-daemon -S -b -x /usr/local/bin/cgroup-stats
+EOF
+    chmod +x /etc/local.d/cgroup-stats.start
+else
+    rm -f /usr/local/bin/cgroup-stats /etc/local.d/cgroup-stats.start
+fi
+
+# Optional eBPF latency tracer; cgroup-stats runs it only while the app's
+# Trace tab is open. Needs a kernel with BTF (Alpine's has it).
+if tftp -g -r bpf-latency -l /usr/local/bin/bpf-latency 10.0.2.2; then
+    chmod 755 /usr/local/bin/bpf-latency
+else
+    rm -f /usr/local/bin/bpf-latency
+fi
+
+# Lite runtime for low-RAM devices: containerd with docker-shim serving
+# the Docker API instead of dockerd. The host selects it per boot with
+# appliance.runtime=lite on the kernel command line; appliance-init reads
+# it directly, under OpenRC the docker service swaps its binary.
+echo "Installing lite runtime..."
+apk add containerd nerdctl cni-plugins
+mkdir -p /etc/nerdctl
+cat > /etc/nerdctl/nerdctl.toml << 'EOF'
+cni_path = "/usr/libexec/cni"
+EOF
+
+# The host's registry cache (BlobCacheProxy) mirrors every registry;
+# containerd falls back to the registry itself when it doesn't answer
+mkdir -p /etc/containerd/certs.d/_default
+cat > /etc/containerd/certs.d/_default/hosts.toml << 'EOF'
+[host."http://10.0.2.2:5080"]
+  capabilities = ["pull", "resolve"]
+EOF
+if tftp -g -r docker-shim -l /usr/local/bin/docker-shim 10.0.2.2; then
+    chmod 755 /usr/local/bin/docker-shim
+    cat > /usr/local/bin/docker-lite << 'EOF'
+#!/bin/sh
+# Started by the docker service in place of dockerd
+rc-service -q containerd start
+STARGZ=/usr/local/bin/containerd-stargz-grpc
+if grep -qw appliance.snapshotter=stargz /proc/cmdline && [ -x $STARGZ ]; then
+    start-stop-daemon -S -b -x $STARGZ \
+        --stdout /var/log/containerd-stargz-grpc.log \
+        --stderr /var/log/containerd-stargz-grpc.log -- --log-level=info
+    exec /usr/local/bin/docker-shim -snapshotter stargz "$@"
+fi
+exec /usr/local/bin/docker-shim "$@"
+EOF
+    chmod 755 /usr/local/bin/docker-lite
+    cat >> /etc/conf.d/docker << 'EOF'
+if grep -qw appliance.runtime=lite /proc/cmdline && [ -x /usr/local/bin/docker-lite ]; then
+    DOCKERD_BINARY=/usr/local/bin/docker-lite
+    DOCKER_OPTS=
+fi
+EOF
+else
+    rm -f /usr/local/bin/docker-shim
+fi
+
+# Lazy pulling for the lite runtime (appliance.snapshotter=stargz): the
+# stargz snapshotter mounts eStargz layers over FUSE and fetches the files
+# a container reads on demand, through the host's registry cache.
+# Ordinary layers still work, they are just pulled in full.
+echo "Installing stargz snapshotter..."
+if tftp -g -r containerd-stargz-grpc -l /usr/local/bin/containerd-stargz-grpc 10.0.2.2; then
+    chmod 755 /usr/local/bin/containerd-stargz-grpc
+    cat > /etc/containerd/config.toml << 'EOF'
+version = 2
+
+[proxy_plugins.stargz]
+  type = "snapshot"
+  address = "/run/containerd-stargz-grpc/containerd-stargz-grpc.sock"
+EOF
+    mkdir -p /etc/containerd-stargz-grpc
+    cat > /etc/containerd-stargz-grpc/config.toml << 'EOF'
+# Prefetch the files an image lists as its startup set, then the rest
+noprefetch = false
+no_background_fetch = false
+
+[[resolver.host."docker.io".mirrors]]
+  host = "10.0.2.2:5080"
+  insecure = true
+
+# Local registry stand-in used by measure-ttfr.sh
+[[resolver.host."127.0.0.1:5000".mirrors]]
+  host = "127.0.0.1:5000"
+  insecure = true
+EOF
+else
+    rm -f /usr/local/bin/containerd-stargz-grpc
+fi
+
+# Heartbeat for the host watchdog over virtio-serial. The watchdog only
+# checks it once the first beat has arrived. The one-off ready line
+# times the boot; it also tells the host appliance-init is installed.
+echo "Installing watchdog heartbeat..."
+mkdir -p /etc/local.d
+cat > /etc/local.d/heartbeat.start << 'EOF'
+#!/bin/sh
+PORT=/dev/virtio-ports/org.dockerandroid.heartbeat
+[ -e "$PORT" ] || exit 0
+(
+    until docker info >/dev/null 2>&1; do
+        sleep 1
+    done
+    FLAGS=
+    [ -x /sbin/appliance-init ] && FLAGS=appliance-init
+    # Whether `docker checkpoint` can work on this kernel
+    if criu check > /dev/null 2>&1; then
+        FLAGS="$FLAGS criu"
+    else
+        FLAGS="$FLAGS no-criu"
+    fi
+    echo "ready $(cut -d' ' -f1 /proc/uptime) openrc $FLAGS" > "$PORT"
+) &
+(
+    exec 3> "$PORT"
+    while true; do
+        echo "$(cut -d' ' -f1 /proc/uptime) $(cut -d' ' -f1-3 /proc/loadavg)" >&3 || exit 0
+        sleep 5
+    done
+) &
+EOF
+chmod +x /etc/local.d/heartbeat.start
+rc-update add local default
+/etc/local.d/heartbeat.start
+
+# Live resize support: memory added through virtio-mem is onlined as
+# movable so it can be unplugged again, and hotplugged vCPUs, which
+# arrive offline, are brought up
+echo "Installing hotplug helper..."
+cat > /etc/local.d/hotplug.start << 'EOF'
+#!/bin/sh
+modprobe virtio_mem 2>/dev/null
+echo online_movable > /sys/devices/system/memory/auto_online_blocks 2>/dev/null
+(
+    while true; do
+        for cpu in /sys/devices/system/cpu/cpu[1-9]*/online; do
+            [ "$(cat "$cpu" 2>/dev/null)" = 0 ] && echo 1 > "$cpu"
+        done
+        sleep 2
+    done
+) &
+EOF
+chmod +x /etc/local.d/hotplug.start
+/etc/local.d/hotplug.start
+
 # Configure SSH for remote access
 echo "Configuring SSH..."
 sed -i 's/#PermitRootLogin.*/PermitRootLogin yes/' /etc/ssh/sshd_config
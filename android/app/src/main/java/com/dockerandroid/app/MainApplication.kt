@@ -2,6 +2,8 @@ package com.dockerandroid.app
 
 import android.app.Application
 import android.content.res.Configuration
+import android.os.Build
+import java.io.File
 
 import com.facebook.react.PackageList
 import com.facebook.react.ReactApplication
@@ -42,6 +44,8 @@ class MainApplication : Application(), ReactApplication {
 
   override fun onCreate() {
     super.onCreate()
+    // The :vm process only hosts the VM supervisor; it never runs JS
+    if (vmProcess) return
     DefaultNewArchitectureEntryPoint.releaseLevel = try {
       ReleaseLevel.valueOf(BuildConfig.REACT_NATIVE_RELEASE_LEVEL.uppercase())
     } catch (e: IllegalArgumentException) {
@@ -53,6 +57,16 @@ class MainApplication : Application(), ReactApplication {
 
   override fun onConfigurationChanged(newConfig: Configuration) {
     super.onConfigurationChanged(newConfig)
+    if (vmProcess) return
     ApplicationLifecycleDispatcher.onConfigurationChanged(this, newConfig)
   }
+
+  private val vmProcess: Boolean by lazy {
+    val name = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.P) {
+      Application.getProcessName()
+    } else {
+      File("/proc/self/cmdline").readText().substringBefore('\u0000')
+    }
+    name.endsWith(":vm")
+  }
 }
@@ -0,0 +1,838 @@
+package com.dockerandroid.app.qemu
+
+import android.util.Log
+import kotlinx.coroutines.*
+import org.json.JSONArray
+import org.json.JSONObject
+import java.io.BufferedInputStream
+import java.io.BufferedOutputStream
+import java.io.File
+import java.io.FileOutputStream
+import java.io.IOException
+import java.io.InputStream
+import java.io.OutputStream
+import java.io.RandomAccessFile
+import java.net.HttpURLConnection
+import java.net.InetAddress
+import java.net.ServerSocket
+import java.net.Socket
+import java.net.URL
+import java.net.URLDecoder
+import java.net.URLEncoder
+import java.security.MessageDigest
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * Pull-through registry cache for the guest, with byte-range support.
+ *
+ * containerd, dockerd and the stargz snapshotter in the guest use it as a
+ * registry mirror at http://10.0.2.2:5080 (slirp maps the gateway to the
+ * host's loopback). Lazy pulling reads eStargz layers with Range requests
+ * for just the files a container touches: an uncached range is fetched
+ * from the upstream registry straight away and queues a background
+ * download of the whole blob, so later ranges, restarts and re-pulls are
+ * served from flash instead of the network.
+ *
+ * Blobs and digest-addressed manifests are immutable and verified against
+ * their digest before entering the cache, which is trimmed least recently
+ * used first. Tags always go upstream and fall back to the last digest
+ * seen when the registry is unreachable. Only anonymous pulls are
+ * supported (Bearer tokens from the registry's auth challenge).
+ *
+ * warm() fills the cache ahead of time without the server, for
+ * ImagePrefetchWorker.
+ */
+class BlobCacheProxy(
+    private val cacheDir: File,
+    private val maxBytes: Long = DEFAULT_MAX_BYTES
+) {
+
+    companion object {
+        private const val TAG = "BlobCacheProxy"
+        const val PORT = 5080
+        const val CACHE_DIR = "blob-cache"
+        private const val DEFAULT_MAX_BYTES = 4L * 1024 * 1024 * 1024
+        private const val BACKLOG = 16
+        private const val IDLE_TIMEOUT_MS = 30_000
+        private const val CONNECT_TIMEOUT_MS = 15_000
+        private const val READ_TIMEOUT_MS = 60_000
+        private const val MAX_HEADER_LINE = 8 * 1024
+        private const val MAX_MANIFEST_BYTES = 4 * 1024 * 1024
+        private const val BUFFER_BYTES = 64 * 1024
+        private const val MAX_REDIRECTS = 5
+        private const val DOCKER_HUB = "docker.io"
+        private const val DOCKER_HUB_API = "registry-1.docker.io"
+
+        private val DIGEST = Regex("sha256:[0-9a-f]{64}")
+        private val ROUTE = Regex("^/v2/(.+)/(manifests|blobs)/([^/]+)$")
+        private val REPO = Regex("^[a-z0-9]+(?:[._-][a-z0-9]+)*(?:/[a-z0-9]+(?:[._-][a-z0-9]+)*)*$")
+        private val TAG_NAME = Regex("^\\w[\\w.-]{0,127}$")
+        private val REGISTRY = Regex("^[A-Za-z0-9.-]+(?::[0-9]+)?$")
+        private val CHALLENGE_PARAM = Regex("(\\w+)=\"([^\"]*)\"")
+        // The guest is x86_64 whatever the phone is
+        private const val GUEST_ARCH = "amd64"
+        private const val HTTP_RANGE_NOT_SATISFIABLE = 416
+        // Lists first: what a pull by tag resolves to
+        private val MANIFEST_TYPES = listOf(
+            "application/vnd.oci.image.index.v1+json",
+            "application/vnd.docker.distribution.manifest.list.v2+json",
+            "application/vnd.oci.image.manifest.v1+json",
+            "application/vnd.docker.distribution.manifest.v2+json"
+        ).joinToString(", ")
+        // Upstream response headers the guest cares about
+        private val RELAYED_HEADERS = listOf(
+            "Content-Type", "Content-Range", "Docker-Content-Digest", "Accept-Ranges", "ETag"
+        )
+    }
+
+    private class Request(
+        val method: String,
+        val path: String,
+        val query: Map<String, String>,
+        // Lower-case names
+        val headers: Map<String, String>
+    )
+
+    private val blobsDir = File(cacheDir, "blobs")
+    private val manifestsDir = File(cacheDir, "manifests")
+    private val tagsDir = File(cacheDir, "tags")
+    // warm() downloads, kept across runs so they resume; start() leaves them alone
+    private val partialDir = File(cacheDir, "partial")
+
+    // Bearer tokens per registry/repository
+    private val tokens = ConcurrentHashMap<String, String>()
+    // Whole-blob downloads in progress, by digest
+    private val inFlight = ConcurrentHashMap<String, Job>()
+
+    private var scope: CoroutineScope? = null
+    private var server: ServerSocket? = null
+    @Volatile private var running = false
+
+    @Synchronized
+    fun start() {
+        if (server != null) return
+        blobsDir.mkdirs()
+        manifestsDir.mkdirs()
+        // Downloads interrupted by the last stop
+        blobsDir.listFiles { f -> f.name.endsWith(".part") }?.forEach { it.delete() }
+
+        val socket = try {
+            ServerSocket(PORT, BACKLOG, InetAddress.getLoopbackAddress())
+        } catch (e: IOException) {
+            // The guest falls back to the registries themselves
+            Log.w(TAG, "Registry cache unavailable: ${e.message}")
+            return
+        }
+        server = socket
+        running = true
+        val serverScope = CoroutineScope(Dispatchers.IO + SupervisorJob()).also { scope = it }
+        serverScope.launch {
+            while (isActive) {
+                val client = try {
+                    socket.accept()
+                } catch (e: IOException) {
+                    break
+                }
+                launch { serve(client) }
+            }
+        }
+        Log.i(TAG, "Registry cache listening on 127.0.0.1:$PORT")
+    }
+
+    @Synchronized
+    fun stop() {
+        running = false
+        server?.close()
+        server = null
+        scope?.cancel()
+        scope = null
+        inFlight.clear()
+    }
+
+    // ============== HTTP server ==============
+
+    private fun serve(socket: Socket) {
+        socket.use { s ->
+            s.soTimeout = IDLE_TIMEOUT_MS
+            val input = BufferedInputStream(s.getInputStream())
+            val output = BufferedOutputStream(s.getOutputStream(), BUFFER_BYTES)
+            try {
+                while (running) {
+                    val request = readRequest(input) ?: break
+                    val keepAlive = handle(request, output)
+                    output.flush()
+                    if (!keepAlive || request.headers["connection"].equals("close", ignoreCase = true)) break
+                }
+            } catch (e: IOException) {
+                // Guest closed the connection or timed out idle
+            } catch (e: Exception) {
+                Log.e(TAG, "Request failed", e)
+            }
+        }
+    }
+
+    private fun readLine(input: InputStream): String? {
+        val line = StringBuilder()
+        while (true) {
+            val c = input.read()
+            if (c < 0) return if (line.isEmpty()) null else line.toString()
+            if (c == '\n'.code) break
+            if (line.length >= MAX_HEADER_LINE) throw IOException("Header line too long")
+            line.append(c.toChar())
+        }
+        return line.trimEnd('\r').toString()
+    }
+
+    private fun readRequest(input: InputStream): Request? {
+        val requestLine = readLine(input) ?: return null
+        val parts = requestLine.split(' ')
+        if (parts.size < 3) throw IOException("Malformed request line")
+        val headers = mutableMapOf<String, String>()
+        while (true) {
+            val line = readLine(input) ?: throw IOException("Truncated headers")
+            if (line.isEmpty()) break
+            val colon = line.indexOf(':')
+            if (colon > 0) {
+                headers[line.substring(0, colon).trim().lowercase()] = line.substring(colon + 1).trim()
+            }
+        }
+        val target = parts[1]
+        val path = target.substringBefore('?')
+        val query = target.substringAfter('?', "").split('&').filter { it.contains('=') }.associate {
+            URLDecoder.decode(it.substringBefore('='), "UTF-8") to URLDecoder.decode(it.substringAfter('='), "UTF-8")
+        }
+        return Request(parts[0], path, query, headers)
+    }
+
+    private fun writeHead(out: OutputStream, status: Int, headers: Map<String, String>) {
+        val head = StringBuilder("HTTP/1.1 $status ${reason(status)}\r\n")
+        head.append("Docker-Distribution-API-Version: registry/2.0\r\n")
+        for ((name, value) in headers) {
+            head.append(name).append(": ").append(value).append("\r\n")
+        }
+        head.append("\r\n")
+        out.write(head.toString().toByteArray(Charsets.ISO_8859_1))
+    }
+
+    private fun reason(status: Int): String = when (status) {
+        200 -> "OK"
+        206 -> "Partial Content"
+        307 -> "Temporary Redirect"
+        400 -> "Bad Request"
+        401 -> "Unauthorized"
+        404 -> "Not Found"
+        405 -> "Method Not Allowed"
+        416 -> "Range Not Satisfiable"
+        429 -> "Too Many Requests"
+        502 -> "Bad Gateway"
+        else -> "Status"
+    }
+
+    private fun respond(out: OutputStream, request: Request, status: Int, body: ByteArray, headers: Map<String, String>): Boolean {
+        writeHead(out, status, headers + ("Content-Length" to body.size.toString()))
+        if (request.method != "HEAD") out.write(body)
+        return true
+    }
+
+    /** Registry-style error body */
+    private fun error(out: OutputStream, request: Request, status: Int, code: String, message: String): Boolean {
+        val body = JSONObject().put("errors", JSONArray().put(
+            JSONObject().put("code", code).put("message", message)
+        )).toString().toByteArray()
+        return respond(out, request, status, body, mapOf("Content-Type" to "application/json"))
+    }
+
+    // ============== Routing ==============
+
+    private fun handle(request: Request, out: OutputStream): Boolean {
+        if (request.method != "GET" && request.method != "HEAD") {
+            return error(out, request, 405, "UNSUPPORTED", "Read-only registry cache")
+        }
+        if (request.path == "/v2/" || request.path == "/v2") {
+            return respond(out, request, 200, "{}".toByteArray(), mapOf("Content-Type" to "application/json"))
+        }
+        val match = ROUTE.matchEntire(request.path)
+            ?: return error(out, request, 404, "NOT_FOUND", "Unknown path ${request.path}")
+        val (repo, kind, ref) = match.destructured
+        // containerd names the upstream in ?ns=; dockerd only mirrors Docker Hub
+        val registry = request.query["ns"] ?: DOCKER_HUB
+        if (!REPO.matches(repo) || !REGISTRY.matches(registry)) {
+            return error(out, request, 400, "NAME_INVALID", "Invalid repository $registry/$repo")
+        }
+
+        return try {
+            if (kind == "blobs") {
+                serveBlob(request, out, registry, repo, ref)
+            } else {
+                serveManifest(request, out, registry, repo, ref)
+            }
+        } catch (e: IOException) {
+            Log.w(TAG, "${request.method} $registry/$repo $kind/$ref: ${e.message}")
+            // Headers may already be out: the connection can't be reused
+            false
+        }
+    }
+
+    // ============== Blobs ==============
+
+    private fun blobFile(digest: String) = File(blobsDir, digest.removePrefix("sha256:"))
+
+    private fun serveBlob(request: Request, out: OutputStream, registry: String, repo: String, digest: String): Boolean {
+        if (!DIGEST.matches(digest)) {
+            return error(out, request, 400, "DIGEST_INVALID", "Unsupported digest $digest")
+        }
+        val file = blobFile(digest)
+        if (file.exists()) {
+            file.setLastModified(System.currentTimeMillis())
+            return serveFile(request, out, file, mapOf(
+                "Content-Type" to "application/octet-stream",
+                "Docker-Content-Digest" to digest
+            ))
+        }
+
+        val range = request.headers["range"]
+        if (range != null) {
+            // Lazy pulling: answer this range now, fetch the rest for next time
+            prefetch(registry, repo, digest)
+        }
+        val cacheWhileStreaming = range == null && request.method == "GET" && !inFlight.containsKey(digest)
+        return relay(request, out, registry, repo, "blobs/$digest", if (cacheWhileStreaming) digest else null)
+    }
+
+    /** Download a whole blob into the cache in the background */
+    fun prefetch(registry: String, repo: String, digest: String) {
+        val serverScope = scope ?: return
+        if (!DIGEST.matches(digest) || blobFile(digest).exists()) return
+        val job = serverScope.launch(start = CoroutineStart.LAZY) {
+            try {
+                download(registry, repo, digest)
+            } catch (e: Exception) {
+                Log.w(TAG, "Prefetch of $digest failed: ${e.message}")
+            } finally {
+                inFlight.remove(digest)
+            }
+        }
+        if (inFlight.putIfAbsent(digest, job) == null) job.start() else job.cancel()
+    }
+
+    private fun download(registry: String, repo: String, digest: String) {
+        val connection = openUpstream(registry, repo, "blobs/$digest", "GET", emptyMap())
+        try {
+            if (connection.responseCode != HttpURLConnection.HTTP_OK) {
+                throw IOException("upstream answered ${connection.responseCode}")
+            }
+            val writer = CacheWriter(digest)
+            try {
+                connection.inputStream.use { input ->
+                    val buffer = ByteArray(BUFFER_BYTES)
+                    while (running) {
+                        val n = input.read(buffer)
+                        if (n < 0) break
+                        writer.write(buffer, n)
+                    }
+                }
+                if (running) writer.commit() else writer.abort()
+            } catch (e: IOException) {
+                writer.abort()
+                throw e
+            }
+        } finally {
+            connection.disconnect()
+        }
+    }
+
+    /** Temp file plus running digest; renamed into place only if it matches */
+    private inner class CacheWriter(private val digest: String) {
+        private val temp = File.createTempFile(digest.removePrefix("sha256:"), ".part", blobsDir)
+        private val stream = temp.outputStream().buffered(BUFFER_BYTES)
+        private val hash = MessageDigest.getInstance("SHA-256")
+
+        fun write(buffer: ByteArray, n: Int) {
+            stream.write(buffer, 0, n)
+            hash.update(buffer, 0, n)
+        }
+
+        fun commit() {
+            stream.close()
+            val actual = "sha256:" + hash.digest().joinToString("") { "%02x".format(it) }
+            if (actual != digest) {
+                temp.delete()
+                throw IOException("digest mismatch: got $actual")
+            }
+            if (!temp.renameTo(blobFile(digest))) {
+                temp.delete()
+                return
+            }
+            Log.d(TAG, "Cached $digest (${blobFile(digest).length() / 1024} KiB)")
+            evict()
+        }
+
+        fun abort() {
+            try {
+                stream.close()
+            } catch (e: IOException) {
+                // Deleting anyway
+            }
+            temp.delete()
+        }
+    }
+
+    @Synchronized
+    private fun evict() {
+        val blobs = blobsDir.listFiles { f -> f.isFile && !f.name.endsWith(".part") } ?: return
+        var total = blobs.sumOf { it.length() }
+        if (total <= maxBytes) return
+        for (blob in blobs.sortedBy { it.lastModified() }) {
+            if (total <= maxBytes) break
+            total -= blob.length()
+            blob.delete()
+            Log.d(TAG, "Evicted sha256:${blob.name}")
+        }
+    }
+
+    // ============== Warming ==============
+
+    /** What warm() left in the cache for one image */
+    data class WarmResult(
+        val digest: String,
+        val blobs: Int,
+        val totalBytes: Long,
+        val fetchedBytes: Long,
+        val complete: Boolean
+    )
+
+    /**
+     * Resolve an image reference and download its manifests and blobs as
+     * a guest pull through this cache would, so the pull later finds them
+     * here. Needs no running server. A download cut short (isStopped, or a
+     * dropped connection) resumes from where it stopped on the next call.
+     */
+    fun warm(reference: String, isStopped: () -> Boolean = { false }): WarmResult {
+        val (registry, repo, ref) = parseReference(reference)
+        blobsDir.mkdirs()
+        manifestsDir.mkdirs()
+        partialDir.mkdirs()
+
+        val (digest, top) = fetchManifest(registry, repo, ref)
+        if (!DIGEST.matches(ref)) writeTag(registry, repo, ref, digest)
+        // A multi-platform index: the guest only ever pulls one of them
+        val manifest = top.optJSONArray("manifests")?.let { list ->
+            val entry = (0 until list.length()).map { list.getJSONObject(it) }.firstOrNull {
+                val platform = it.optJSONObject("platform")
+                platform != null && platform.optString("os") == "linux" && platform.optString("architecture") == GUEST_ARCH
+            } ?: throw IOException("$reference has no linux/$GUEST_ARCH image")
+            fetchManifest(registry, repo, entry.getString("digest")).second
+        } ?: top
+
+        val blobs = listOfNotNull(manifest.optJSONObject("config")) +
+            (manifest.optJSONArray("layers")?.let { layers -> (0 until layers.length()).map { layers.getJSONObject(it) } } ?: emptyList())
+        var fetched = 0L
+        for (blob in blobs) {
+            if (isStopped()) break
+            val blobDigest = blob.getString("digest")
+            val file = blobFile(blobDigest)
+            if (file.exists()) {
+                // Counts as a use, so eviction keeps warmed images
+                file.setLastModified(System.currentTimeMillis())
+            } else {
+                fetched += downloadResumable(registry, repo, blobDigest, isStopped)
+            }
+        }
+        evict()
+        return WarmResult(
+            digest = digest,
+            blobs = blobs.size,
+            totalBytes = blobs.sumOf { it.optLong("size") },
+            fetchedBytes = fetched,
+            complete = blobs.all { blobFile(it.getString("digest")).exists() }
+        )
+    }
+
+    /** [registry/]repo[:tag|@digest] as dockerd names it to a mirror */
+    private fun parseReference(reference: String): Triple<String, String, String> {
+        var rest = reference.trim()
+        val first = rest.substringBefore('/')
+        val registry = if (rest.contains('/') && (first.contains('.') || first.contains(':') || first == "localhost")) {
+            rest = rest.substringAfter('/')
+            first
+        } else {
+            DOCKER_HUB
+        }
+        val ref = when {
+            rest.contains('@') -> rest.substringAfter('@').also { rest = rest.substringBefore('@') }
+            rest.substringAfterLast('/').contains(':') -> rest.substringAfterLast(':').also { rest = rest.substringBeforeLast(':') }
+            else -> "latest"
+        }
+        val repo = if (registry == DOCKER_HUB && !rest.contains('/')) "library/$rest" else rest
+        if (!REPO.matches(repo) || !REGISTRY.matches(registry) || !(DIGEST.matches(ref) || TAG_NAME.matches(ref))) {
+            throw IOException("Invalid image reference $reference")
+        }
+        return Triple(registry, repo, ref)
+    }
+
+    /** Digest and body of a manifest, from the cache when addressed by digest */
+    private fun fetchManifest(registry: String, repo: String, ref: String): Pair<String, JSONObject> {
+        if (DIGEST.matches(ref)) {
+            val file = manifestFile(ref)
+            if (file.exists()) return ref to JSONObject(file.readText())
+        }
+        val connection = openUpstream(registry, repo, "manifests/$ref", "GET", mapOf("Accept" to MANIFEST_TYPES))
+        try {
+            if (connection.responseCode != HttpURLConnection.HTTP_OK) {
+                throw IOException("$registry/$repo:$ref: upstream answered ${connection.responseCode}")
+            }
+            val body = connection.inputStream.use { readLimited(it, MAX_MANIFEST_BYTES) }
+            val type = connection.contentType ?: "application/vnd.oci.image.manifest.v1+json"
+            val digest = "sha256:" + MessageDigest.getInstance("SHA-256").digest(body).joinToString("") { "%02x".format(it) }
+            if (DIGEST.matches(ref) && digest != ref) {
+                throw IOException("Upstream manifest does not match $ref")
+            }
+            storeManifest(digest, type, body)
+            return digest to JSONObject(String(body))
+        } finally {
+            connection.disconnect()
+        }
+    }
+
+    /** Continue or start a blob download; returns the bytes fetched this time */
+    private fun downloadResumable(registry: String, repo: String, digest: String, isStopped: () -> Boolean): Long {
+        val partial = File(partialDir, digest.removePrefix("sha256:"))
+        val offset = partial.length()
+        val headers = if (offset > 0) mapOf("Range" to "bytes=$offset-") else emptyMap()
+        val connection = openUpstream(registry, repo, "blobs/$digest", "GET", headers)
+        var fetched = 0L
+        try {
+            val append = when (connection.responseCode) {
+                HttpURLConnection.HTTP_PARTIAL -> true
+                // The server ignored the range: start over
+                HttpURLConnection.HTTP_OK -> false
+                // Everything was already there
+                HTTP_RANGE_NOT_SATISFIABLE -> null
+                else -> throw IOException("$digest: upstream answered ${connection.responseCode}")
+            }
+            if (append != null) {
+                FileOutputStream(partial, append).use { out ->
+                    connection.inputStream.use { input ->
+                        val buffer = ByteArray(BUFFER_BYTES)
+                        while (!isStopped()) {
+                            val n = input.read(buffer)
+                            if (n < 0) break
+                            out.write(buffer, 0, n)
+                            fetched += n
+                        }
+                    }
+                }
+                if (isStopped()) return fetched
+            }
+        } finally {
+            connection.disconnect()
+        }
+
+        val hash = MessageDigest.getInstance("SHA-256")
+        partial.inputStream().use { input ->
+            val buffer = ByteArray(BUFFER_BYTES)
+            while (true) {
+                val n = input.read(buffer)
+                if (n < 0) break
+                hash.update(buffer, 0, n)
+            }
+        }
+        val actual = "sha256:" + hash.digest().joinToString("") { "%02x".format(it) }
+        if (actual != digest) {
+            partial.delete()
+            throw IOException("$digest: digest mismatch, got $actual")
+        }
+        if (!partial.renameTo(blobFile(digest))) {
+            partial.delete()
+            throw IOException("$digest: could not move into the cache")
+        }
+        Log.d(TAG, "Warmed $digest (${blobFile(digest).length() / 1024} KiB, ${fetched / 1024} KiB fetched)")
+        return fetched
+    }
+
+    // ============== Ranges ==============
+
+    /** Byte ranges of a "bytes=" header, clamped to size; null if malformed */
+    private fun parseRanges(header: String, size: Long): List<LongRange>? {
+        if (!header.startsWith("bytes=")) return null
+        val ranges = mutableListOf<LongRange>()
+        for (spec in header.removePrefix("bytes=").split(',')) {
+            val first = spec.substringBefore('-').trim()
+            val last = spec.substringAfter('-', "").trim()
+            val range = if (first.isEmpty()) {
+                // Suffix: the last N bytes
+                val n = last.toLongOrNull() ?: return null
+                maxOf(0L, size - n) until size
+            } else {
+                val start = first.toLongOrNull() ?: return null
+                val end = if (last.isEmpty()) size - 1 else minOf(last.toLongOrNull() ?: return null, size - 1)
+                start..end
+            }
+            if (!range.isEmpty() && range.first < size) ranges.add(range)
+        }
+        return ranges
+    }
+
+    private fun serveFile(request: Request, out: OutputStream, file: File, headers: Map<String, String>): Boolean {
+        val size = file.length()
+        val rangeHeader = request.headers["range"]
+        val ranges = rangeHeader?.let { parseRanges(it, size) }
+
+        if (rangeHeader == null || ranges == null) {
+            writeHead(out, 200, headers + mapOf("Content-Length" to size.toString(), "Accept-Ranges" to "bytes"))
+            if (request.method != "HEAD") file.inputStream().use { it.copyTo(out, BUFFER_BYTES) }
+            return true
+        }
+        if (ranges.isEmpty()) {
+            return respond(out, request, 416, ByteArray(0), mapOf("Content-Range" to "bytes */$size"))
+        }
+
+        RandomAccessFile(file, "r").use { raf ->
+            if (ranges.size == 1) {
+                val range = ranges[0]
+                writeHead(out, 206, headers + mapOf(
+                    "Content-Length" to (range.last - range.first + 1).toString(),
+                    "Content-Range" to "bytes ${range.first}-${range.last}/$size"
+                ))
+                if (request.method != "HEAD") copyRange(raf, range, out)
+                return true
+            }
+
+            // Several ranges in one request, as the stargz fetcher batches them
+            val boundary = "blobcache${System.nanoTime()}"
+            val partHeaders = ranges.map { range ->
+                ("\r\n--$boundary\r\nContent-Type: application/octet-stream\r\n" +
+                    "Content-Range: bytes ${range.first}-${range.last}/$size\r\n\r\n").toByteArray(Charsets.ISO_8859_1)
+            }
+            val trailer = "\r\n--$boundary--\r\n".toByteArray(Charsets.ISO_8859_1)
+            val length = partHeaders.sumOf { it.size.toLong() } +
+                ranges.sumOf { it.last - it.first + 1 } + trailer.size
+            writeHead(out, 206, headers.filterKeys { it != "Content-Type" } + mapOf(
+                "Content-Type" to "multipart/byteranges; boundary=$boundary",
+                "Content-Length" to length.toString()
+            ))
+            if (request.method != "HEAD") {
+                ranges.forEachIndexed { i, range ->
+                    out.write(partHeaders[i])
+                    copyRange(raf, range, out)
+                }
+                out.write(trailer)
+            }
+        }
+        return true
+    }
+
+    private fun copyRange(raf: RandomAccessFile, range: LongRange, out: OutputStream) {
+        val buffer = ByteArray(BUFFER_BYTES)
+        raf.seek(range.first)
+        var remaining = range.last - range.first + 1
+        while (remaining > 0) {
+            val n = raf.read(buffer, 0, minOf(buffer.size.toLong(), remaining).toInt())
+            if (n < 0) throw IOException("Cached blob shrank")
+            out.write(buffer, 0, n)
+            remaining -= n
+        }
+    }
+
+    // ============== Manifests ==============
+
+    private fun manifestFile(digest: String) = File(manifestsDir, digest.removePrefix("sha256:"))
+
+    private fun tagFile(registry: String, repo: String, tag: String) =
+        File(File(File(tagsDir, registry.replace(':', '_')), repo), tag)
+
+    private fun serveManifest(request: Request, out: OutputStream, registry: String, repo: String, ref: String): Boolean {
+        val byDigest = DIGEST.matches(ref)
+        if (!byDigest && !TAG_NAME.matches(ref)) {
+            return error(out, request, 400, "TAG_INVALID", "Invalid reference $ref")
+        }
+        if (byDigest) {
+            serveCachedManifest(request, out, ref)?.let { return it }
+        }
+
+        val forwarded = request.headers["accept"]?.let { mapOf("Accept" to it) } ?: emptyMap()
+        val connection = try {
+            openUpstream(registry, repo, "manifests/$ref", request.method, forwarded).also { it.responseCode }
+        } catch (e: IOException) {
+            // Offline: the last manifest this tag resolved to
+            val digest = if (byDigest) ref else readTag(registry, repo, ref)
+            digest?.let { serveCachedManifest(request, out, it) }?.let { return it }
+            return error(out, request, 502, "UNAVAILABLE", "Registry $registry unreachable: ${e.message}")
+        }
+
+        try {
+            if (connection.responseCode != HttpURLConnection.HTTP_OK || request.method == "HEAD") {
+                return relayResponse(request, out, connection, null)
+            }
+            val body = connection.inputStream.use { readLimited(it, MAX_MANIFEST_BYTES) }
+            val type = connection.contentType ?: "application/vnd.oci.image.manifest.v1+json"
+            val digest = "sha256:" + MessageDigest.getInstance("SHA-256").digest(body).joinToString("") { "%02x".format(it) }
+            if (byDigest && digest != ref) {
+                return error(out, request, 502, "DIGEST_INVALID", "Upstream manifest does not match $ref")
+            }
+            storeManifest(digest, type, body)
+            if (!byDigest) writeTag(registry, repo, ref, digest)
+            return respond(out, request, 200, body, mapOf("Content-Type" to type, "Docker-Content-Digest" to digest))
+        } finally {
+            connection.disconnect()
+        }
+    }
+
+    private fun serveCachedManifest(request: Request, out: OutputStream, digest: String): Boolean? {
+        val file = manifestFile(digest)
+        val typeFile = File(file.path + ".type")
+        if (!file.exists() || !typeFile.exists()) return null
+        return respond(out, request, 200, file.readBytes(), mapOf(
+            "Content-Type" to typeFile.readText(),
+            "Docker-Content-Digest" to digest
+        ))
+    }
+
+    private fun storeManifest(digest: String, type: String, body: ByteArray) {
+        val file = manifestFile(digest)
+        if (file.exists()) return
+        File(file.path + ".type").writeText(type)
+        val tmp = File(file.path + ".tmp")
+        tmp.writeBytes(body)
+        tmp.renameTo(file)
+    }
+
+    private fun readTag(registry: String, repo: String, tag: String): String? =
+        tagFile(registry, repo, tag).takeIf { it.exists() }?.readText()?.trim()
+
+    private fun writeTag(registry: String, repo: String, tag: String, digest: String) {
+        val file = tagFile(registry, repo, tag)
+        file.parentFile?.mkdirs()
+        file.writeText(digest)
+    }
+
+    private fun readLimited(input: InputStream, limit: Int): ByteArray {
+        val bytes = input.readBytes()
+        if (bytes.size > limit) throw IOException("Manifest larger than $limit bytes")
+        return bytes
+    }
+
+    // ============== Upstream ==============
+
+    private fun upstreamBase(registry: String): String {
+        val host = if (registry == DOCKER_HUB) DOCKER_HUB_API else registry
+        // Registry stand-ins on the device itself speak plain HTTP
+        val plain = host.startsWith("localhost") || host.startsWith("127.")
+        return (if (plain) "http://" else "https://") + host
+    }
+
+    private fun connect(url: URL, method: String, headers: Map<String, String>, token: String?): HttpURLConnection {
+        return (url.openConnection() as HttpURLConnection).apply {
+            requestMethod = method
+            connectTimeout = CONNECT_TIMEOUT_MS
+            readTimeout = READ_TIMEOUT_MS
+            // Followed by hand: the registry token must not reach blob storage
+            instanceFollowRedirects = false
+            // Otherwise the body arrives decompressed and no longer matches its digest
+            setRequestProperty("Accept-Encoding", "identity")
+            for ((name, value) in headers) setRequestProperty(name, value)
+            token?.let { setRequestProperty("Authorization", "Bearer $it") }
+        }
+    }
+
+    private fun openUpstream(
+        registry: String,
+        repo: String,
+        path: String,
+        method: String,
+        headers: Map<String, String>
+    ): HttpURLConnection {
+        val url = URL("${upstreamBase(registry)}/v2/$repo/$path")
+        val key = "$registry/$repo"
+        var connection = connect(url, method, headers, tokens[key])
+        if (connection.responseCode == HttpURLConnection.HTTP_UNAUTHORIZED) {
+            val token = fetchToken(connection.getHeaderField("WWW-Authenticate"), repo)
+            if (token != null) {
+                connection.disconnect()
+                tokens[key] = token
+                connection = connect(url, method, headers, token)
+            }
+        }
+
+        // Blobs usually live behind a redirect to a CDN or object storage
+        var redirects = 0
+        while (connection.responseCode in 301..308 && redirects++ < MAX_REDIRECTS) {
+            val location = connection.getHeaderField("Location") ?: break
+            val target = URL(connection.url, location)
+            connection.disconnect()
+            connection = connect(target, method, headers, null)
+        }
+        return connection
+    }
+
+    /** Anonymous token for a Bearer challenge, or null for other schemes */
+    private fun fetchToken(challenge: String?, repo: String): String? {
+        if (challenge == null || !challenge.startsWith("Bearer ", ignoreCase = true)) return null
+        val params = CHALLENGE_PARAM.findAll(challenge).associate { it.groupValues[1] to it.groupValues[2] }
+        val realm = params["realm"] ?: return null
+        val query = listOfNotNull(
+            params["service"]?.let { "service=" + URLEncoder.encode(it, "UTF-8") },
+            "scope=" + URLEncoder.encode(params["scope"] ?: "repository:$repo:pull", "UTF-8")
+        ).joinToString("&")
+        val connection = connect(URL("$realm?$query"), "GET", emptyMap(), null)
+        return try {
+            if (connection.responseCode != HttpURLConnection.HTTP_OK) return null
+            val json = JSONObject(connection.inputStream.bufferedReader().readText())
+            json.optString("token").ifEmpty { json.optString("access_token") }.ifEmpty { null }
+        } finally {
+            connection.disconnect()
+        }
+    }
+
+    /** Forward a request upstream and stream the answer back */
+    private fun relay(request: Request, out: OutputStream, registry: String, repo: String, path: String, cacheDigest: String?): Boolean {
+        val forwarded = listOf("range", "accept").mapNotNull { name ->
+            request.headers[name]?.let { name.replaceFirstChar { c -> c.uppercase() } to it }
+        }.toMap()
+        val connection = try {
+            openUpstream(registry, repo, path, request.method, forwarded).also { it.responseCode }
+        } catch (e: IOException) {
+            return error(out, request, 502, "UNAVAILABLE", "Registry $registry unreachable: ${e.message}")
+        }
+        try {
+            val cache = cacheDigest?.takeIf { connection.responseCode == HttpURLConnection.HTTP_OK }
+            return relayResponse(request, out, connection, cache)
+        } finally {
+            connection.disconnect()
+        }
+    }
+
+    private fun relayResponse(request: Request, out: OutputStream, connection: HttpURLConnection, cacheDigest: String?): Boolean {
+        val status = connection.responseCode
+        val length = connection.contentLengthLong
+        val headers = linkedMapOf<String, String>()
+        for (name in RELAYED_HEADERS) {
+            connection.getHeaderField(name)?.let { headers[name] = it }
+        }
+        // Without a length the body ends with the connection
+        val keepAlive = length >= 0 || request.method == "HEAD"
+        if (length >= 0) headers["Content-Length"] = length.toString() else headers["Connection"] = "close"
+        writeHead(out, status, headers)
+        if (request.method == "HEAD") return true
+
+        // An announced body that never comes would leave the guest waiting
+        val body = (if (status < 400) connection.inputStream else connection.errorStream) ?: return false
+        val writer = cacheDigest?.let { CacheWriter(it) }
+        try {
+            body.use { input ->
+                val buffer = ByteArray(BUFFER_BYTES)
+                while (true) {
+                    val n = input.read(buffer)
+                    if (n < 0) break
+                    writer?.write(buffer, n)
+                    out.write(buffer, 0, n)
+                }
+            }
+            writer?.commit()
+        } catch (e: IOException) {
+            writer?.abort()
+            throw e
+        }
+        return keepAlive
+    }
+}
@@ -0,0 +1,72 @@
+package com.dockerandroid.app.qemu
+
+import android.util.Log
+import org.json.JSONObject
+import java.io.File
+
+/**
+ * Boot-to-ready times per guest init mode, persisted in boot-times.json.
+ *
+ * The guest writes "ready <uptime> <mode> [appliance-init] [criu|no-criu]" to the
+ * heartbeat port once the Docker API answers: heartbeat.start under
+ * OpenRC, appliance-init itself in appliance mode. The host time runs from
+ * QEMU launch so it includes firmware and kernel boot; the guest uptime
+ * is what the guest saw. Keeping both modes side by side gives the time
+ * appliance init saves per boot.
+ */
+object BootTimes {
+    private const val TAG = "BootTimes"
+    private const val FILE = "boot-times.json"
+    // Weight of the newest boot in the running average
+    private const val ALPHA = 0.3
+
+    const val MODE_OPENRC = "openrc"
+    const val MODE_APPLIANCE = "appliance"
+    // Flag on the OpenRC ready line: /sbin/appliance-init is installed
+    const val FLAG_APPLIANCE_INSTALLED = "appliance-init"
+    // `criu check` passed or failed in the guest; absent from older guests
+    const val FLAG_CRIU = "criu"
+    const val FLAG_NO_CRIU = "no-criu"
+
+    fun load(qemuDir: File): JSONObject {
+        val file = File(qemuDir, FILE)
+        return try {
+            if (file.exists()) JSONObject(file.readText()) else JSONObject()
+        } catch (e: Exception) {
+            Log.w(TAG, "Ignoring unreadable boot times: ${e.message}")
+            JSONObject()
+        }
+    }
+
+    /** Whether the guest reported appliance-init installed on its last OpenRC boot */
+    fun applianceInstalled(qemuDir: File): Boolean = load(qemuDir).optBoolean("applianceInstalled")
+
+    fun record(qemuDir: File, mode: String, hostMs: Long, guestUptimeMs: Long, flags: List<String>) {
+        val times = load(qemuDir)
+        val modes = times.optJSONObject("modes") ?: JSONObject()
+        val previous = modes.optJSONObject(mode)
+        val count = (previous?.optInt("count") ?: 0) + 1
+        val average = previous?.optDouble("averageMs")?.takeIf { !it.isNaN() }
+            ?.let { it + ALPHA * (hostMs - it) } ?: hostMs.toDouble()
+
+        modes.put(mode, JSONObject()
+            .put("lastMs", hostMs)
+            .put("lastGuestMs", guestUptimeMs)
+            .put("averageMs", average)
+            .put("count", count)
+            .put("at", System.currentTimeMillis()))
+        times.put("modes", modes)
+        if (mode == MODE_OPENRC) {
+            times.put("applianceInstalled", FLAG_APPLIANCE_INSTALLED in flags)
+        }
+        when {
+            FLAG_CRIU in flags -> times.put("checkpointSupported", true)
+            FLAG_NO_CRIU in flags -> times.put("checkpointSupported", false)
+        }
+
+        val tmp = File(qemuDir, "$FILE.tmp")
+        tmp.writeText(times.toString())
+        tmp.renameTo(File(qemuDir, FILE))
+        Log.i(TAG, "Guest ready in ${hostMs}ms ($mode, guest uptime ${guestUptimeMs}ms)")
+    }
+}
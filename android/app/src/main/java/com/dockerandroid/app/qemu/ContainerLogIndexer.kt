@@ -0,0 +1,172 @@
+package com.dockerandroid.app.qemu
+
+import android.util.Log
+import kotlinx.coroutines.*
+import org.json.JSONArray
+import org.json.JSONObject
+import java.io.File
+import java.io.IOException
+import java.net.HttpURLConnection
+import java.net.URL
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * Follows every running container's logs into the native log index
+ * (qj_logindex.h) so they can be searched across containers, including
+ * containers that have since been removed.
+ *
+ * One follower per container streams GET /containers/{id}/logs?follow=1
+ * straight into the index, resuming after the last sealed line so
+ * nothing is lost or indexed twice across VM and app restarts. The index
+ * outlives the VM: it is opened on first use and searchable while the VM
+ * is stopped.
+ */
+class ContainerLogIndexer(private val qemuDir: File) {
+
+    companion object {
+        private const val TAG = "ContainerLogIndexer"
+        const val INDEX_DIR = "logindex"
+        private const val MAX_BYTES = 64L * 1024 * 1024
+        private const val MAX_AGE_MS = 7L * 24 * 60 * 60 * 1000
+        private const val POLL_MS = 5000L
+        private const val FLUSH_MS = 60_000L
+        private const val READ_BYTES = 64 * 1024
+        private const val API = "http://localhost:${VmSupervisor.DOCKER_API_PORT}"
+    }
+
+    private var job: Job? = null
+    private var opened = false
+    private val followers = ConcurrentHashMap<String, HttpURLConnection>()
+
+    val isSupported: Boolean get() = NativeTransfer.isAvailable
+
+    @Synchronized
+    private fun ensureOpen(): Boolean {
+        if (!opened && isSupported) {
+            opened = NativeTransfer.nativeLogIndexOpen(File(qemuDir, INDEX_DIR).absolutePath, MAX_BYTES, MAX_AGE_MS)
+        }
+        return opened
+    }
+
+    fun start(scope: CoroutineScope) {
+        stop()
+        if (!ensureOpen()) return
+        job = scope.launch(Dispatchers.IO) { poll(this) }
+    }
+
+    /** Stops following and seals what was indexed so far */
+    fun stop() {
+        job?.cancel()
+        job = null
+        for (connection in followers.values) {
+            connection.disconnect()
+        }
+        followers.clear()
+        if (opened) {
+            NativeTransfer.nativeLogIndexFlush()
+        }
+    }
+
+    @Synchronized
+    fun close() {
+        stop()
+        if (opened) {
+            NativeTransfer.nativeLogIndexClose()
+            opened = false
+        }
+    }
+
+    /**
+     * Newest matches first; see qj_logindex.h for the result. containerId
+     * is a short id prefix or null for all; times are epoch ms, 0 for
+     * unbounded.
+     */
+    fun search(query: String, containerId: String?, sinceMs: Long, untilMs: Long, stream: Int, limit: Int): JSONObject {
+        if (!ensureOpen()) {
+            throw IllegalStateException("Log index is not available")
+        }
+        val json = NativeTransfer.nativeLogIndexSearch(query, containerId, sinceMs, untilMs, stream, limit)
+            ?: throw IOException("Log search failed")
+        return JSONObject(json)
+    }
+
+    fun stats(): JSONObject {
+        if (!ensureOpen()) return JSONObject().put("supported", false)
+        return (NativeTransfer.nativeLogIndexStats()?.let { JSONObject(it) } ?: JSONObject())
+            .put("supported", true)
+    }
+
+    private suspend fun poll(scope: CoroutineScope) {
+        var lastFlush = System.currentTimeMillis()
+        while (currentCoroutineContext().isActive) {
+            try {
+                val running = JSONArray(get("/containers/json"))
+                for (i in 0 until running.length()) {
+                    val id = running.getJSONObject(i).getString("Id")
+                    if (!followers.containsKey(id)) {
+                        follow(scope, id)
+                    }
+                }
+            } catch (e: IOException) {
+                // Docker not up yet, or restarting with the VM
+            }
+            if (System.currentTimeMillis() - lastFlush >= FLUSH_MS) {
+                NativeTransfer.nativeLogIndexFlush()
+                lastFlush = System.currentTimeMillis()
+            }
+            delay(POLL_MS)
+        }
+    }
+
+    private fun follow(scope: CoroutineScope, id: String) {
+        val inspect = try {
+            JSONObject(get("/containers/$id/json"))
+        } catch (e: IOException) {
+            return
+        }
+        val tty = inspect.optJSONObject("Config")?.optBoolean("Tty") ?: false
+        NativeTransfer.nativeLogIndexSetName(id, inspect.optString("Name"))
+
+        val lastNs = NativeTransfer.nativeLogIndexLastTimestamp(id)
+        val since = if (lastNs > 0) "&since=${lastNs / 1_000_000_000}.${"%09d".format(lastNs % 1_000_000_000)}" else ""
+        val connection = URL("$API/containers/$id/logs?follow=1&stdout=1&stderr=1&timestamps=1$since")
+            .openConnection() as HttpURLConnection
+        connection.connectTimeout = 2000
+        // Followers idle for as long as the container is quiet
+        connection.readTimeout = 0
+        followers[id] = connection
+
+        scope.launch(Dispatchers.IO) {
+            try {
+                connection.inputStream.use { input ->
+                    val buffer = ByteArray(READ_BYTES)
+                    while (isActive) {
+                        val n = input.read(buffer)
+                        if (n < 0) break
+                        NativeTransfer.nativeLogIndexFeed(id, tty, buffer, n)
+                    }
+                }
+            } catch (e: IOException) {
+                if (isActive) Log.d(TAG, "Log follower for ${id.take(12)} ended: ${e.message}")
+            } finally {
+                connection.disconnect()
+                // Exited; picked up again by the next poll if it restarts
+                followers.remove(id, connection)
+            }
+        }
+    }
+
+    private fun get(path: String): String {
+        val connection = URL("$API$path").openConnection() as HttpURLConnection
+        connection.connectTimeout = 2000
+        connection.readTimeout = 5000
+        try {
+            if (connection.responseCode != HttpURLConnection.HTTP_OK) {
+                throw IOException("GET $path: HTTP ${connection.responseCode}")
+            }
+            return connection.inputStream.bufferedReader().use { it.readText() }
+        } finally {
+            connection.disconnect()
+        }
+    }
+}
@@ -0,0 +1,264 @@
+package com.dockerandroid.app.qemu
+
+import android.net.LocalSocket
+import android.net.LocalSocketAddress
+import kotlinx.coroutines.*
+import java.io.File
+import java.io.IOException
+
+/** One container's usage, as of the latest frame */
+data class ContainerUsage(
+    val id: String,
+    val cpuPercent: Double,
+    // memory.current minus inactive page cache, like `docker stats`
+    val memoryBytes: Long,
+    // 0 when the container has no limit
+    val memoryLimit: Long,
+    val pids: Long,
+    val blockRead: Long,
+    val blockWrite: Long,
+    val netRx: Long,
+    val netTx: Long
+)
+
+/**
+ * One container's eBPF latency report from guest/bpf-latency, cumulative
+ * since tracing started. Histograms are log2 buckets of microseconds:
+ * bucket n counts [2^n, 2^(n+1)) us.
+ */
+data class ContainerLatency(
+    val id: String,
+    val runqueue: LongArray,
+    val blockIo: LongArray,
+    val tcpRetransmits: Long,
+    val syscalls: Long,
+    // (x86_64 syscall number, count), most frequent first
+    val topSyscalls: List<Pair<Int, Long>>
+)
+
+/**
+ * Follows the org.dockerandroid.stats virtio-serial port, where the
+ * guest's cgroup-stats writes usage for every container in one frame per
+ * interval (see guest/cgroup-stats/cgroup-stats.c for the format).
+ *
+ * The collector only samples while someone reads the port, so the stream
+ * is connected only between [start] and [stop]. [setTracing] asks it to
+ * run the eBPF tracer as well, whose reports arrive through [onLatency]
+ * and its state ("on", "off" with an exit status, "unavailable") through
+ * [onTraceState].
+ */
+class ContainerStatsStream(
+    private val qemuDir: File,
+    private val onFrame: (List<ContainerUsage>) -> Unit,
+    private val onLatency: (ContainerLatency) -> Unit = {},
+    private val onTraceState: (String, Int?) -> Unit = { _, _ -> }
+) {
+
+    companion object {
+        const val STATS_SOCKET = "stats.sock"
+        const val STATS_PORT_NAME = "org.dockerandroid.stats"
+        private const val RECONNECT_MS = 2000L
+        private const val NUM_VALUES = 9
+        private const val CPU_USEC = 0
+        private const val MEMORY = 1
+        private const val INACTIVE_FILE = 2
+        private const val MEMORY_MAX = 3
+        private const val IO_READ = 4
+        private const val IO_WRITE = 5
+        private const val PIDS = 6
+        private const val NET_RX = 7
+        private const val NET_TX = 8
+    }
+
+    private var job: Job? = null
+    @Volatile private var socket: LocalSocket? = null
+    @Volatile private var tracing = false
+
+    // Decoder state: the last key frame's containers, in slot order, with
+    // their values as of the last frame applied
+    private var ids: List<String> = emptyList()
+    private var values: List<LongArray> = emptyList()
+    private var lastSeq = -1L
+    private var lastTime = 0L
+    private var synced = false
+
+    fun start(scope: CoroutineScope, intervalMs: Int) {
+        stop()
+        job = scope.launch(Dispatchers.IO) { follow(intervalMs) }
+    }
+
+    fun stop() {
+        job?.cancel()
+        job = null
+        try { socket?.close() } catch (_: IOException) { }
+        socket = null
+    }
+
+    /** Takes effect now if connected, and again on every reconnect */
+    fun setTracing(enabled: Boolean) {
+        tracing = enabled
+        val s = socket ?: return
+        try {
+            send(s, if (enabled) "trace on" else "trace off")
+        } catch (_: IOException) {
+            // Not connected yet; follow() sends it once it is
+        }
+    }
+
+    private fun send(s: LocalSocket, command: String) {
+        synchronized(s) {
+            s.outputStream.write("$command\n".toByteArray())
+        }
+    }
+
+    private suspend fun follow(intervalMs: Int) {
+        val socketFile = File(qemuDir, STATS_SOCKET)
+        while (currentCoroutineContext().isActive) {
+            val s = LocalSocket()
+            socket = s
+            synced = false
+            try {
+                s.connect(LocalSocketAddress(socketFile.absolutePath, LocalSocketAddress.Namespace.FILESYSTEM))
+                send(s, "interval $intervalMs")
+                if (tracing) send(s, "trace on")
+                val reader = s.inputStream.bufferedReader()
+                while (currentCoroutineContext().isActive) {
+                    val line = reader.readLine() ?: break
+                    decode(line)
+                }
+            } catch (e: IOException) {
+                // QEMU not up yet, restarted, or stop() closed the socket
+            } finally {
+                try { s.close() } catch (_: IOException) { }
+            }
+            delay(RECONNECT_MS)
+        }
+    }
+
+    /** Applies one frame; anything unexpected drops sync until the next key frame */
+    private fun decode(line: String) {
+        // Tracer lines sit between frames without taking part in the sequence
+        when {
+            line.startsWith("H ") -> return decodeLatency(line)
+            line.startsWith("T ") -> return decodeTraceState(line)
+        }
+        val fields = line.split(' ')
+        if (fields.size < 3) {
+            synced = false
+            return
+        }
+        val seq = fields[1].toLongOrNull()
+        val time = fields[2].toLongOrNull()
+        if (seq == null || time == null) {
+            synced = false
+            return
+        }
+        try {
+            when (fields[0]) {
+                "K" -> applyKeyFrame(fields.drop(3), time)
+                "D" -> {
+                    if (!synced || seq != lastSeq + 1) {
+                        synced = false
+                        return
+                    }
+                    applyDeltaFrame(fields.drop(3), time)
+                }
+                else -> {
+                    synced = false
+                    return
+                }
+            }
+        } catch (e: NumberFormatException) {
+            synced = false
+            return
+        } catch (e: IndexOutOfBoundsException) {
+            synced = false
+            return
+        }
+        lastSeq = seq
+        synced = true
+    }
+
+    private fun applyKeyFrame(entries: List<String>, time: Long) {
+        val previous = if (synced) ids.zip(values).toMap() else emptyMap()
+        val elapsed = time - lastTime
+        val newIds = ArrayList<String>(entries.size)
+        val newValues = ArrayList<LongArray>(entries.size)
+        for (entry in entries) {
+            val (id, list) = entry.split('=', limit = 2)
+            val parts = list.split(',')
+            newIds.add(id)
+            newValues.add(LongArray(NUM_VALUES) { parts[it].toLong() })
+        }
+        // CPU needs a previous sample of the same container
+        val usage = newIds.indices.map { i ->
+            val before = previous[newIds[i]]
+            usage(newIds[i], newValues[i], before?.let { newValues[i][CPU_USEC] - it[CPU_USEC] } ?: 0L, elapsed)
+        }
+        ids = newIds
+        values = newValues
+        lastTime = time
+        onFrame(usage)
+    }
+
+    private fun applyDeltaFrame(entries: List<String>, time: Long) {
+        val elapsed = time - lastTime
+        val cpuDelta = LongArray(ids.size)
+        for (entry in entries) {
+            val (slot, list) = entry.split('=', limit = 2)
+            val current = values[slot.toInt()]
+            list.split(',').forEachIndexed { v, delta ->
+                if (delta.isNotEmpty()) {
+                    current[v] += delta.toLong()
+                    if (v == CPU_USEC) cpuDelta[slot.toInt()] = delta.toLong()
+                }
+            }
+        }
+        lastTime = time
+        onFrame(ids.indices.map { usage(ids[it], values[it], cpuDelta[it], elapsed) })
+    }
+
+    /** H <id> rq=<buckets> io=<buckets> retrans=<n> sys=<n> top=<nr>:<n>,... */
+    private fun decodeLatency(line: String) {
+        val fields = line.split(' ')
+        if (fields.size < 2) return
+        val values = fields.drop(2).associate { it.substringBefore('=') to it.substringAfter('=', "") }
+        fun buckets(key: String) = values[key].orEmpty().split(',')
+            .filter { it.isNotEmpty() }
+            .map { it.toLongOrNull() ?: 0L }
+            .toLongArray()
+        onLatency(ContainerLatency(
+            id = fields[1],
+            runqueue = buckets("rq"),
+            blockIo = buckets("io"),
+            tcpRetransmits = values["retrans"]?.toLongOrNull() ?: 0L,
+            syscalls = values["sys"]?.toLongOrNull() ?: 0L,
+            topSyscalls = values["top"].orEmpty().split(',').mapNotNull { entry ->
+                val nr = entry.substringBefore(':').toIntOrNull()
+                val count = entry.substringAfter(':', "").toLongOrNull()
+                if (nr != null && count != null) nr to count else null
+            }.sortedByDescending { it.second }
+        ))
+    }
+
+    /** T on | T off <status> | T unavailable */
+    private fun decodeTraceState(line: String) {
+        val fields = line.split(' ')
+        if (fields.size < 2) return
+        if (fields[1] != "on") tracing = false
+        onTraceState(fields[1], fields.getOrNull(2)?.toIntOrNull())
+    }
+
+    private fun usage(id: String, v: LongArray, cpuUsecDelta: Long, elapsedMs: Long) = ContainerUsage(
+        id = id,
+        // 100% is one fully used CPU, as in `docker stats`
+        cpuPercent = if (elapsedMs > 0) cpuUsecDelta / (elapsedMs * 10.0) else 0.0,
+        memoryBytes = (v[MEMORY] - v[INACTIVE_FILE]).coerceAtLeast(0),
+        memoryLimit = v[MEMORY_MAX],
+        pids = v[PIDS],
+        blockRead = v[IO_READ],
+        blockWrite = v[IO_WRITE],
+        netRx = v[NET_RX],
+        netTx = v[NET_TX]
+    )
+}
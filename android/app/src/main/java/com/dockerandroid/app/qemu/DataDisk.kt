@@ -0,0 +1,59 @@
+package com.dockerandroid.app.qemu
+
+import android.util.Log
+import java.io.File
+
+/**
+ * Second virtio disk holding the guest's /var/lib/docker.
+ *
+ * Image layers and container writes get their own qcow2 and QEMU cache
+ * settings instead of sharing alpine-disk.qcow2 with the OS, which then
+ * stays read-mostly. The guest finds the disk by its virtio serial and
+ * formats it on first boot with options suited to layer extraction (see
+ * docker-data in alpine-setup.sh and appliance-init); existing Docker data
+ * on the OS disk is moved over at that point.
+ */
+object DataDisk {
+    private const val TAG = "DataDisk"
+    const val FILE = "docker-data.qcow2"
+    // Read by the guest from /sys/block/vd*/serial
+    const val SERIAL = "docker-data"
+    private const val DRIVE_ID = "docker-data"
+    private const val IOTHREAD_ID = "iothread-data"
+    // Sparse: only what the guest writes takes space on the device
+    private const val SIZE_MB = 32 * 1024L
+    // 2 MiB clusters: layers are written as large sequential files, and one
+    // L2 table then maps 512 GiB, so lookups never miss the metadata cache
+    private const val CLUSTER_BITS = 21
+
+    /** The image, created blank if it doesn't exist yet */
+    fun ensure(qemuDir: File): File {
+        val file = File(qemuDir, FILE)
+        if (!file.exists()) {
+            Qcow2.create(file, SIZE_MB * 1024 * 1024, CLUSTER_BITS)
+            Log.i(TAG, "Created ${file.absolutePath} (${SIZE_MB / 1024} GiB, ${(1 shl CLUSTER_BITS) / 1024} KiB clusters)")
+        }
+        return file
+    }
+
+    fun launchArgs(file: File): List<String> = listOf(
+        // Disk emulation off the main loop, which TCG also needs
+        "-object", "iothread,id=$IOTHREAD_ID",
+        "-drive", listOf(
+            "file=${file.absolutePath}",
+            "if=none",
+            "id=$DRIVE_ID",
+            "format=qcow2",
+            "cache=writeback",
+            "aio=threads",
+            // Deleted layers give their space back to the device
+            "discard=unmap",
+            "detect-zeroes=unmap",
+            // Load L2 metadata in 64 KiB slices rather than whole 2 MiB tables
+            "l2-cache-entry-size=65536",
+            // Drop metadata cache the guest hasn't touched for a minute
+            "cache-clean-interval=60"
+        ).joinToString(","),
+        "-device", "virtio-blk-pci,drive=$DRIVE_ID,serial=$SERIAL,iothread=$IOTHREAD_ID"
+    )
+}
@@ -0,0 +1,135 @@
+package com.dockerandroid.app.qemu
+
+import android.content.Context
+import android.util.Log
+import androidx.work.Constraints
+import androidx.work.CoroutineWorker
+import androidx.work.ExistingPeriodicWorkPolicy
+import androidx.work.ExistingWorkPolicy
+import androidx.work.NetworkType
+import androidx.work.OneTimeWorkRequestBuilder
+import androidx.work.PeriodicWorkRequestBuilder
+import androidx.work.WorkManager
+import androidx.work.WorkerParameters
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.withContext
+import org.json.JSONArray
+import org.json.JSONObject
+import java.io.File
+import java.util.concurrent.TimeUnit
+
+/**
+ * Pulls docker.defaultImages from qemu-config.json into the host blob
+ * cache while the phone is charging, idle and on an unmetered network.
+ *
+ * The guest pulls through BlobCacheProxy, so a later `docker run` of one
+ * of these images only resolves its tag upstream and reads the layers
+ * from flash. Each run re-resolves the tags, which picks up new versions.
+ * Runs stopped by a constraint lapsing leave partial blobs that the next
+ * run resumes.
+ */
+class ImagePrefetchWorker(context: Context, params: WorkerParameters) : CoroutineWorker(context, params) {
+
+    companion object {
+        private const val TAG = "ImagePrefetch"
+        private const val PERIODIC_WORK = "image-prefetch"
+        private const val ONE_TIME_WORK = "image-prefetch-now"
+        private const val STATUS_FILE = "image-prefetch.json"
+        private const val INTERVAL_HOURS = 12L
+        private const val MAX_ATTEMPTS = 3
+
+        fun schedule(context: Context, enabled: Boolean) {
+            val workManager = WorkManager.getInstance(context)
+            if (!enabled) {
+                workManager.cancelUniqueWork(PERIODIC_WORK)
+                return
+            }
+            val constraints = Constraints.Builder()
+                .setRequiredNetworkType(NetworkType.UNMETERED)
+                .setRequiresCharging(true)
+                .setRequiresDeviceIdle(true)
+                .setRequiresStorageNotLow(true)
+                .build()
+            val request = PeriodicWorkRequestBuilder<ImagePrefetchWorker>(INTERVAL_HOURS, TimeUnit.HOURS)
+                .setConstraints(constraints)
+                .build()
+            // KEEP: calling this on every app start doesn't reset the period
+            workManager.enqueueUniquePeriodicWork(PERIODIC_WORK, ExistingPeriodicWorkPolicy.KEEP, request)
+        }
+
+        /** Run once as soon as there is a network, ignoring the other gates */
+        fun runNow(context: Context) {
+            val request = OneTimeWorkRequestBuilder<ImagePrefetchWorker>()
+                .setConstraints(Constraints.Builder().setRequiredNetworkType(NetworkType.CONNECTED).build())
+                .build()
+            WorkManager.getInstance(context).enqueueUniqueWork(ONE_TIME_WORK, ExistingWorkPolicy.KEEP, request)
+        }
+
+        fun isScheduled(context: Context): Boolean =
+            WorkManager.getInstance(context).getWorkInfosForUniqueWork(PERIODIC_WORK).get().any { !it.state.isFinished }
+
+        /** The last run's report, or an empty object before the first */
+        fun readStatus(context: Context): JSONObject {
+            val file = File(VmSupervisor.qemuDir(context), STATUS_FILE)
+            return try {
+                if (file.exists()) JSONObject(file.readText()) else JSONObject()
+            } catch (e: Exception) {
+                JSONObject()
+            }
+        }
+
+        private fun configuredImages(qemuDir: File): List<String> {
+            val config = File(qemuDir, "qemu-config.json")
+            if (!config.exists()) return emptyList()
+            val images = JSONObject(config.readText()).optJSONObject("docker")?.optJSONArray("defaultImages")
+                ?: return emptyList()
+            return (0 until images.length()).map { images.getString(it) }
+        }
+    }
+
+    override suspend fun doWork(): Result = withContext(Dispatchers.IO) {
+        val qemuDir = VmSupervisor.qemuDir(applicationContext)
+        val cache = BlobCacheProxy(File(qemuDir, BlobCacheProxy.CACHE_DIR))
+        val images = configuredImages(qemuDir)
+        val startedAt = System.currentTimeMillis()
+        val results = JSONArray()
+        var failed = false
+
+        for (image in images) {
+            if (isStopped) break
+            val entry = JSONObject().put("image", image)
+            try {
+                val result = cache.warm(image) { isStopped }
+                entry.put("digest", result.digest)
+                    .put("blobs", result.blobs)
+                    .put("totalBytes", result.totalBytes)
+                    .put("fetchedBytes", result.fetchedBytes)
+                    .put("complete", result.complete)
+                Log.i(TAG, "$image: ${result.fetchedBytes / 1024} KiB fetched, complete=${result.complete}")
+            } catch (e: Exception) {
+                failed = true
+                entry.put("error", e.message ?: e.javaClass.simpleName)
+                Log.w(TAG, "$image: ${e.message}")
+            }
+            results.put(entry)
+        }
+
+        writeStatus(qemuDir, JSONObject()
+            .put("startedAt", startedAt)
+            .put("finishedAt", System.currentTimeMillis())
+            .put("stopped", isStopped)
+            .put("images", results))
+
+        when {
+            isStopped -> Result.retry()
+            failed && runAttemptCount + 1 < MAX_ATTEMPTS -> Result.retry()
+            else -> Result.success()
+        }
+    }
+
+    private fun writeStatus(qemuDir: File, status: JSONObject) {
+        val tmp = File(qemuDir, "$STATUS_FILE.tmp")
+        tmp.writeText(status.toString())
+        tmp.renameTo(File(qemuDir, STATUS_FILE))
+    }
+}
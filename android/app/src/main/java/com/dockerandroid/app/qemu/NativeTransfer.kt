@@ -0,0 +1,234 @@
+package com.dockerandroid.app.qemu
+
+import android.os.ParcelFileDescriptor
+import android.util.Log
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.CharBuffer
+import java.nio.charset.CharsetDecoder
+import java.nio.charset.CodingErrorAction
+
+/**
+ * Bulk data path between native code and Kotlin.
+ *
+ * Native producers (log pump, stats sampler) append records to rings that
+ * Kotlin reads in place through a direct ByteBuffer; see qj_ring.h for the
+ * record layout. Shared rings are memfd-backed and cross from the :vm
+ * host process to the UI as ParcelFileDescriptors. Batch process samples are copied into a caller-owned
+ * LongArray with GetPrimitiveArrayCritical. QEMU trace events are too many
+ * to cross one by one and are summarized natively instead (qj_trace.h).
+ * Container logs go the other way, into the native log index
+ * (qj_logindex.h), which answers searches as JSON.
+ */
+object NativeTransfer {
+    private const val TAG = "NativeTransfer"
+
+    // Record types - keep in sync with qj_ring.h
+    const val REC_PAD = 0
+    const val REC_LOG = 1
+    const val REC_STATS = 2
+    const val REC_BENCH = 3
+
+    // Log streams - keep in sync with qj_logindex.h
+    const val LOG_STDOUT = 1
+    const val LOG_STDERR = 2
+
+    // Fields per process sample - keep in sync with qj_proc.h
+    const val SAMPLE_PID = 0
+    const val SAMPLE_UTIME_TICKS = 1
+    const val SAMPLE_STIME_TICKS = 2
+    const val SAMPLE_VSIZE_BYTES = 3
+    const val SAMPLE_RSS_BYTES = 4
+    const val SAMPLE_THREADS = 5
+    const val SAMPLE_MINFLT = 6
+    const val SAMPLE_MAJFLT = 7
+    const val SAMPLE_FIELDS = 8
+
+    // Ring header offsets - keep in sync with QjRingHeader
+    private const val HDR_CAPACITY = 8
+    private const val HDR_HEADER_SIZE = 12
+    private const val HDR_TAIL = 128
+    private const val REC_HEADER_SIZE = 16
+
+    val isAvailable: Boolean = try {
+        System.loadLibrary("qemu_jni")
+        true
+    } catch (e: UnsatisfiedLinkError) {
+        Log.w(TAG, "Native library not available: ${e.message}")
+        false
+    }
+
+    @JvmStatic external fun nativeRingCreate(capacity: Int): Int
+    @JvmStatic external fun nativeRingCreateShared(capacity: Int): Int
+    @JvmStatic external fun nativeRingFd(id: Int): Int
+    @JvmStatic external fun nativeRingAttach(fd: Int): Int
+    @JvmStatic external fun nativeRingBuffer(id: Int): ByteBuffer?
+    @JvmStatic external fun nativeRingReadable(id: Int): Long
+    @JvmStatic external fun nativeRingCommit(id: Int, tail: Long)
+    @JvmStatic external fun nativeRingDropped(id: Int): Long
+    @JvmStatic external fun nativeRingDestroy(id: Int)
+    @JvmStatic external fun nativeLogPumpStart(ringId: Int, path: String, offset: Long): Boolean
+    @JvmStatic external fun nativeLogPumpStop(): Long
+    @JvmStatic external fun nativeStatsStart(ringId: Int, pid: Int, intervalMs: Int): Boolean
+    @JvmStatic external fun nativeStatsStop()
+    @JvmStatic external fun nativeSampleProcesses(pids: IntArray, out: LongArray): Int
+    @JvmStatic external fun nativeTracePumpStart(fifoPath: String): Boolean
+    @JvmStatic external fun nativeTracePumpStop()
+    @JvmStatic external fun nativeTraceReset()
+    @JvmStatic external fun nativeTraceSummary(): String?
+    @JvmStatic external fun nativeLogIndexOpen(dir: String, maxBytes: Long, maxAgeMs: Long): Boolean
+    @JvmStatic external fun nativeLogIndexClose()
+    @JvmStatic external fun nativeLogIndexFeed(containerId: String, tty: Boolean, data: ByteArray, length: Int): Boolean
+    @JvmStatic external fun nativeLogIndexSetName(containerId: String, name: String)
+    @JvmStatic external fun nativeLogIndexLastTimestamp(containerId: String): Long
+    @JvmStatic external fun nativeLogIndexFlush()
+    @JvmStatic external fun nativeLogIndexSearch(
+        query: String,
+        containerId: String?,
+        sinceMs: Long,
+        untilMs: Long,
+        stream: Int,
+        limit: Int
+    ): String?
+    @JvmStatic external fun nativeLogIndexStats(): String?
+    @JvmStatic external fun nativeBenchmarkProduce(ringId: Int, count: Int, payloadBytes: Int): Boolean
+    @JvmStatic external fun nativeBenchmarkJoin()
+    @JvmStatic external fun nativeBenchmarkString(seq: Int): String
+
+    /**
+     * Receives records in place. payload is only valid for the duration of
+     * the call - positions [offset, offset + length) in a shared buffer.
+     */
+    fun interface RecordVisitor {
+        fun onRecord(type: Int, flags: Int, timestampNs: Long, payload: ByteBuffer, offset: Int, length: Int)
+    }
+
+    /**
+     * Consumer side of one native ring. Drain from a single coroutine or
+     * thread. [close] is safe from any thread: [buffer] maps memory that
+     * nativeRingDestroy unmaps, so it waits for a drain in progress and
+     * later drains return nothing.
+     */
+    class Ring private constructor(val id: Int) {
+        companion object {
+            /** Process-local ring */
+            fun create(capacityBytes: Int) = Ring(nativeRingCreate(capacityBytes))
+
+            /** memfd-backed ring that can be handed to another process */
+            fun createShared(capacityBytes: Int) = Ring(nativeRingCreateShared(capacityBytes))
+
+            /** Map a shared ring received over Binder; consumes pfd */
+            fun attach(pfd: ParcelFileDescriptor) = Ring(nativeRingAttach(pfd.detachFd()))
+        }
+
+        private val buffer: ByteBuffer
+        private val dataOffset: Int
+        private val mask: Long
+        private var readPos: Long
+        private val lock = Any()
+        private var closed = false
+
+        init {
+            require(id >= 0) { "Failed to allocate native ring" }
+            buffer = nativeRingBuffer(id)!!.order(ByteOrder.LITTLE_ENDIAN)
+            dataOffset = buffer.getInt(HDR_HEADER_SIZE)
+            mask = buffer.getInt(HDR_CAPACITY).toLong() - 1
+            readPos = buffer.getLong(HDR_TAIL)
+        }
+
+        // The id may belong to a new ring once this one is closed
+        val dropped: Long get() = synchronized(lock) { if (closed) 0L else nativeRingDropped(id) }
+
+        /** A dup of the backing fd for sending to another process (shared rings only) */
+        fun share(): ParcelFileDescriptor {
+            val fd = nativeRingFd(id)
+            check(fd >= 0) { "Ring $id is not shared" }
+            return ParcelFileDescriptor.fromFd(fd)
+        }
+
+        /**
+         * Visit every published record, then release them in one commit.
+         * Returns the number of records visited.
+         */
+        fun drain(visitor: RecordVisitor): Int = synchronized(lock) {
+            if (closed) return 0
+            val start = readPos
+            val end = readPos + nativeRingReadable(id)
+            var count = 0
+
+            while (readPos < end) {
+                val at = dataOffset + (readPos and mask).toInt()
+                val length = buffer.getInt(at)
+                val type = buffer.getShort(at + 4).toInt() and 0xFFFF
+
+                if (type == REC_PAD) {
+                    readPos += length
+                    continue
+                }
+
+                val flags = buffer.getShort(at + 6).toInt() and 0xFFFF
+                val timestamp = buffer.getLong(at + 8)
+                visitor.onRecord(type, flags, timestamp, buffer, at + REC_HEADER_SIZE, length - REC_HEADER_SIZE)
+                readPos += (length + 7).toLong() and 7L.inv()
+                count++
+            }
+
+            if (readPos != start) {
+                nativeRingCommit(id, readPos)
+            }
+            count
+        }
+
+        fun close() {
+            synchronized(lock) {
+                if (closed) return
+                closed = true
+                nativeRingDestroy(id)
+            }
+        }
+    }
+
+    /**
+     * Decodes UTF-8 LOG payloads straight from the ring into one reusable
+     * StringBuilder, without a String or ByteArray per line.
+     */
+    class LineCollector(initialCapacity: Int = 16 * 1024) : RecordVisitor {
+        private val decoder: CharsetDecoder = Charsets.UTF_8.newDecoder()
+            .onMalformedInput(CodingErrorAction.REPLACE)
+            .onUnmappableCharacter(CodingErrorAction.REPLACE)
+        private var chars: CharBuffer = CharBuffer.allocate(4096)
+        private var source: ByteBuffer? = null
+        private var view: ByteBuffer? = null
+        val text = StringBuilder(initialCapacity)
+        var lines = 0
+            private set
+
+        override fun onRecord(type: Int, flags: Int, timestampNs: Long, payload: ByteBuffer, offset: Int, length: Int) {
+            if (type != REC_LOG) return
+
+            if (chars.capacity() < length) {
+                chars = CharBuffer.allocate(length)
+            }
+            // One view per ring buffer, repositioned for each record
+            if (source !== payload) {
+                source = payload
+                view = payload.duplicate()
+            }
+            val view = view!!
+            view.limit(offset + length).position(offset)
+            chars.clear()
+            decoder.reset()
+            decoder.decode(view, chars, true)
+            decoder.flush(chars)
+            chars.flip()
+
+            text.append(chars).append('\n')
+            lines++
+        }
+
+        fun reset() {
+            text.setLength(0)
+            lines = 0
+        }
+    }
+}
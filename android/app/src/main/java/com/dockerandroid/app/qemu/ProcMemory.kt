@@ -0,0 +1,50 @@
+package com.dockerandroid.app.qemu
+
+import android.os.Debug
+import java.io.File
+
+/**
+ * Memory accounting for the app process, the :vm host process and its
+ * QEMU child.
+ *
+ * smaps_rollup (Linux 4.14+) gives PSS without walking every mapping;
+ * older kernels fall back to Debug.MemoryInfo for self and VmRSS for QEMU.
+ */
+object ProcMemory {
+
+    /** Values in kB keyed by smaps field name (Rss, Pss, Pss_Anon, ...) */
+    fun readRollup(pid: Int?): Map<String, Long>? {
+        val path = if (pid == null) "/proc/self/smaps_rollup" else "/proc/$pid/smaps_rollup"
+        return readKbFields(File(path))
+    }
+
+    /** VmRSS/VmSwap etc. from /proc/<pid>/status, in kB */
+    fun readStatus(pid: Int): Map<String, Long>? {
+        return readKbFields(File("/proc/$pid/status"))
+    }
+
+    /** Self PSS in kB when smaps_rollup is unavailable - costs a full smaps walk */
+    fun selfPssFallbackKb(): Long {
+        val info = Debug.MemoryInfo()
+        Debug.getMemoryInfo(info)
+        return info.totalPss.toLong()
+    }
+
+    private fun readKbFields(file: File): Map<String, Long>? {
+        return try {
+            val fields = HashMap<String, Long>()
+            file.forEachLine { line ->
+                if (!line.endsWith(" kB")) return@forEachLine
+                val colon = line.indexOf(':')
+                if (colon <= 0) return@forEachLine
+                val value = line.substring(colon + 1, line.length - 3).trim().toLongOrNull()
+                if (value != null) {
+                    fields[line.substring(0, colon)] = value
+                }
+            }
+            fields.takeIf { it.isNotEmpty() }
+        } catch (e: Exception) {
+            null
+        }
+    }
+}
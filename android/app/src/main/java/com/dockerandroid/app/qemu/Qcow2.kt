@@ -0,0 +1,76 @@
+package com.dockerandroid.app.qemu
+
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+
+/**
+ * Creates empty qcow2 images without qemu-img, which the app doesn't ship.
+ *
+ * The layout is what `qemu-img create -f qcow2 -o cluster_size=...` makes
+ * for a new image: header, a one-cluster refcount table, one refcount
+ * block and the L1 table, each cluster-aligned, with 16-bit refcounts.
+ * QEMU allocates L2 tables, data clusters and further refcount blocks as
+ * the guest writes, so the file stays a few clusters until then.
+ */
+object Qcow2 {
+    private const val MAGIC = 0x514649fb
+    private const val VERSION = 3
+    // Version 3 header without the optional compression type field
+    private const val HEADER_LENGTH = 104
+    // log2 of the refcount width in bits
+    private const val REFCOUNT_ORDER = 4
+
+    /** Write a blank image of sizeBytes with 2^clusterBits byte clusters */
+    fun create(file: File, sizeBytes: Long, clusterBits: Int) {
+        require(clusterBits in 9..21) { "qcow2 cluster size must be 512 B to 2 MiB" }
+        val clusterSize = 1L shl clusterBits
+        // One L2 table maps clusterSize / 8 data clusters
+        val l2Coverage = clusterSize * (clusterSize / 8)
+        val l1Entries = (sizeBytes + l2Coverage - 1) / l2Coverage
+        val l1Clusters = maxOf(1L, (l1Entries * 8 + clusterSize - 1) / clusterSize)
+
+        val refcountTableOffset = clusterSize
+        val refcountBlockOffset = 2 * clusterSize
+        val l1Offset = 3 * clusterSize
+        val usedClusters = 3 + l1Clusters
+
+        val header = ByteBuffer.allocate(HEADER_LENGTH)
+            .putInt(MAGIC)
+            .putInt(VERSION)
+            .putLong(0) // backing file offset
+            .putInt(0) // backing file name length
+            .putInt(clusterBits)
+            .putLong(sizeBytes)
+            .putInt(0) // no encryption
+            .putInt(l1Entries.toInt())
+            .putLong(l1Offset)
+            .putLong(refcountTableOffset)
+            .putInt(1) // refcount table clusters
+            .putInt(0) // snapshots
+            .putLong(0) // snapshots offset
+            .putLong(0) // incompatible features
+            .putLong(0) // compatible features
+            .putLong(0) // autoclear features
+            .putInt(REFCOUNT_ORDER)
+            .putInt(HEADER_LENGTH)
+
+        val tmp = File(file.path + ".tmp")
+        RandomAccessFile(tmp, "rw").use { raf ->
+            raf.setLength(0)
+            // Zeros after the header end the (empty) extension list
+            raf.write(header.array())
+            raf.seek(refcountTableOffset)
+            raf.writeLong(refcountBlockOffset)
+            raf.seek(refcountBlockOffset)
+            repeat(usedClusters.toInt()) { raf.writeShort(1) }
+            // An all-zero L1 table: nothing allocated yet
+            raf.setLength(l1Offset + l1Clusters * clusterSize)
+        }
+        if (!tmp.renameTo(file)) {
+            tmp.delete()
+            throw IOException("Could not create ${file.absolutePath}")
+        }
+    }
+}
@@ -4,12 +4,24 @@ import android.app.*
 import android.content.Context
 import android.content.Intent
 import android.os.Build
+import android.os.Bundle
 import android.os.IBinder
+import android.os.ParcelFileDescriptor
 import android.os.PowerManager
+import android.os.Process
+import android.os.RemoteCallbackList
+import android.util.Log
 import androidx.core.app.NotificationCompat
+import kotlinx.coroutines.*
+import org.json.JSONObject
 
 /**
- * Foreground service to keep QEMU VM running in background
+ * VM host service, running in the :vm process.
+ *
+ * Owns the VmSupervisor (QEMU, QMP, log pump, stats) and exposes it to the
+ * UI process through IVmHost. It is bound by QemuModule and promoted to a
+ * foreground service while a VM runs, so the VM keeps running when the UI
+ * process is killed.
  */
 class QemuForegroundService : Service() {
 
@@ -44,20 +56,214 @@ class QemuForegroundService : Service() {
     private var wakeLock: PowerManager.WakeLock? = null
     private var isRunning = false
 
+    private val scope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+    private val callbacks = RemoteCallbackList<IVmHostCallback>()
+    private lateinit var supervisor: VmSupervisor
+
     override fun onCreate() {
         super.onCreate()
         createNotificationChannel()
+        supervisor = VmSupervisor(this, object : VmSupervisor.Listener {
+            override fun onStateChanged(state: String) {
+                broadcastState(state)
+                if (state == QemuModule.VM_STATE_STOPPED || state == QemuModule.VM_STATE_ERROR) {
+                    scope.launch(Dispatchers.Main) { stopForegroundService() }
+                }
+            }
+
+            override fun onWatchdogIncident(incident: String) {
+                broadcast { it.onWatchdogIncident(incident) }
+            }
+        })
     }
 
     override fun onStartCommand(intent: Intent?, flags: Int, startId: Int): Int {
         when (intent?.action) {
             ACTION_START -> startForegroundService()
-            ACTION_STOP -> stopForegroundService()
+            ACTION_STOP -> {
+                // "Stop VM" from the notification
+                scope.launch {
+                    supervisor.stop()
+                    withContext(Dispatchers.Main) { stopForegroundService() }
+                }
+            }
+            null -> {
+                // Sticky restart after the :vm process was killed
+                startForegroundService()
+                scope.launch {
+                    if (!supervisor.reattach()) {
+                        withContext(Dispatchers.Main) { stopForegroundService() }
+                    }
+                }
+            }
         }
         return START_STICKY
     }
 
-    override fun onBind(intent: Intent?): IBinder? = null
+    override fun onBind(intent: Intent?): IBinder = binder
+
+    private val binder = object : IVmHost.Stub() {
+        override fun start(ramMb: Int, cpuCores: Int, applianceInit: Boolean, runtime: String, scratchDisk: Boolean): Bundle = runBlocking {
+            try {
+                val launched = supervisor.start(ramMb, cpuCores, applianceInit, runtime, scratchDisk)
+                Bundle().apply {
+                    putBoolean("success", true)
+                    putString("state", supervisor.state)
+                    putBoolean("reattached", !launched)
+                    putInt("pid", supervisor.qemuPid)
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to start VM", e)
+                Bundle().apply {
+                    putBoolean("success", false)
+                    putString("state", supervisor.state)
+                    putString("error", e.message ?: e.toString())
+                }
+            }
+        }
+
+        override fun stop(): Bundle = runBlocking {
+            try {
+                supervisor.stop()
+                Bundle().apply {
+                    putBoolean("success", true)
+                    putString("state", supervisor.state)
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to stop VM", e)
+                Bundle().apply {
+                    putBoolean("success", false)
+                    putString("state", supervisor.state)
+                    putString("error", e.message ?: e.toString())
+                }
+            }
+        }
+
+        override fun resize(ramMb: Int, cpuCores: Int): Bundle = runBlocking {
+            try {
+                val result = supervisor.resize(ramMb, cpuCores)
+                Bundle().apply {
+                    putBoolean("success", true)
+                    putInt("cpuCores", result.cpuCores)
+                    putInt("ramMb", result.ramMb)
+                    putBoolean("restartRequired", result.restartReasons.isNotEmpty())
+                    putString("reason", result.restartReasons.joinToString("; "))
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to resize VM", e)
+                Bundle().apply {
+                    putBoolean("success", false)
+                    putString("error", e.message ?: e.toString())
+                }
+            }
+        }
+
+        override fun getStatus(): Bundle {
+            val alive = supervisor.isQemuAlive()
+            return Bundle().apply {
+                putString("state", supervisor.state)
+                putBoolean("isRunning", alive)
+                putInt("pid", supervisor.qemuPid)
+                putBoolean("dockerAvailable", alive && VmSupervisor.checkDockerApi())
+            }
+        }
+
+        override fun reattach(): Boolean = runBlocking { supervisor.reattach() }
+
+        override fun waitForDocker(timeoutSeconds: Int): Boolean = runBlocking {
+            supervisor.waitForDockerApi(timeoutSeconds.coerceIn(1, 600))
+        }
+
+        override fun getQemuPid(): Int = supervisor.qemuPid
+
+        override fun getHostPid(): Int = Process.myPid()
+
+        override fun openLogRing(): ParcelFileDescriptor? = supervisor.logRing?.share()
+
+        override fun openStatsRing(): ParcelFileDescriptor? = supervisor.statsRing?.share()
+
+        override fun getWatchdogConfig(): String = supervisor.watchdog.config.toJson().toString()
+
+        override fun setWatchdogConfig(configJson: String) {
+            supervisor.watchdog.updateConfig(VmWatchdog.WatchdogConfig.fromJson(JSONObject(configJson)))
+        }
+
+        override fun getWatchdogIncidents(limit: Int): String =
+            VmWatchdog.readIncidents(VmSupervisor.qemuDir(this@QemuForegroundService), limit.coerceIn(1, 200)).toString()
+
+        override fun getBootTimes(): String =
+            BootTimes.load(VmSupervisor.qemuDir(this@QemuForegroundService)).toString()
+
+        override fun setQemuTracing(enabled: Boolean): Bundle = runBlocking {
+            try {
+                val supported = supervisor.setQemuTracing(enabled)
+                Bundle().apply {
+                    putBoolean("success", supported)
+                    putBoolean("supported", supported)
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to switch QEMU tracing", e)
+                Bundle().apply {
+                    putBoolean("success", false)
+                    putBoolean("supported", true)
+                    putString("error", e.message ?: e.toString())
+                }
+            }
+        }
+
+        override fun getQemuTraceSummary(): String = supervisor.qemuTraceSummary().toString()
+
+        override fun searchContainerLogs(
+            query: String,
+            containerId: String?,
+            sinceMs: Long,
+            untilMs: Long,
+            stream: Int,
+            limit: Int
+        ): String = try {
+            supervisor.searchContainerLogs(query, containerId, sinceMs, untilMs, stream, limit).toString()
+        } catch (e: Exception) {
+            Log.e(TAG, "Log search failed", e)
+            JSONObject().put("error", e.message ?: e.toString()).toString()
+        }
+
+        override fun getLogIndexStats(): String = supervisor.logIndexStats().toString()
+
+        override fun registerCallback(callback: IVmHostCallback) {
+            callbacks.register(callback)
+            // Bring the new client up to date immediately
+            try {
+                callback.onStateChanged(supervisor.state)
+            } catch (e: Exception) {
+                Log.w(TAG, "Callback failed: ${e.message}")
+            }
+        }
+
+        override fun unregisterCallback(callback: IVmHostCallback) {
+            callbacks.unregister(callback)
+        }
+    }
+
+    private fun broadcastState(state: String) {
+        broadcast { it.onStateChanged(state) }
+    }
+
+    private fun broadcast(notify: (IVmHostCallback) -> Unit) {
+        synchronized(callbacks) {
+            val count = callbacks.beginBroadcast()
+            try {
+                for (i in 0 until count) {
+                    try {
+                        notify(callbacks.getBroadcastItem(i))
+                    } catch (e: Exception) {
+                        // Dead clients are pruned by RemoteCallbackList
+                    }
+                }
+            } finally {
+                callbacks.finishBroadcast()
+            }
+        }
+    }
 
     private fun startForegroundService() {
         if (isRunning) return
@@ -153,6 +359,9 @@ class QemuForegroundService : Service() {
 
     override fun onDestroy() {
         super.onDestroy()
+        callbacks.kill()
+        supervisor.destroy()
+        scope.cancel()
         wakeLock?.let {
             if (it.isHeld) {
                 it.release()
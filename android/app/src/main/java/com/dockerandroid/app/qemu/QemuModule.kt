@@ -1,12 +1,21 @@
 package com.dockerandroid.app.qemu
 
+import android.content.ComponentName
 import android.content.Context
 import android.content.Intent
+import android.content.ServiceConnection
 import android.os.Build
+import android.os.Debug
+import android.os.IBinder
+import android.os.SystemClock
+import android.system.Os
+import android.system.OsConstants
 import android.util.Log
 import com.facebook.react.bridge.*
 import com.facebook.react.modules.core.DeviceEventManagerModule
 import kotlinx.coroutines.*
+import org.json.JSONArray
+import org.json.JSONObject
 import java.io.*
 import java.net.HttpURLConnection
 import java.net.URL
@@ -28,20 +37,93 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
         private const val DEFAULT_RAM_MB = 2048
         private const val DEFAULT_CPU_CORES = 2
         private const val DEFAULT_DISK_SIZE_MB = 10240 // 10GB
+        // qemu-img's default; container data has its own disk (DataDisk)
+        private const val OS_DISK_CLUSTER_BITS = 16
         
-        // Port forwarding
-        private const val DOCKER_API_PORT = 2375
-        private const val SSH_PORT = 2222
-        private const val WEB_PORT_START = 8080
+        // Port forwarding - owned by the VM host
+        private const val DOCKER_API_PORT = VmSupervisor.DOCKER_API_PORT
+        private const val SSH_PORT = VmSupervisor.SSH_PORT
+        private const val WEB_PORT_START = VmSupervisor.WEB_PORT_START
+
+        // Native transfer rings
+        private const val BENCH_RING_BYTES = 256 * 1024
+        private const val RING_DRAIN_MS = 250L
+        private const val HOST_BIND_TIMEOUT_MS = 10_000L
     }
 
     private val scope = CoroutineScope(Dispatchers.IO + SupervisorJob())
-    private var qemuProcess: Process? = null
     private var vmState: String = VM_STATE_STOPPED
     private var qemuDir: File? = null
     private var logReader: Job? = null
+    private var containerStats: ContainerStatsStream? = null
 
-    // JNI Native methods - will be implemented in C
+    // Binder to the :vm host process that owns QEMU
+    @Volatile private var host: IVmHost? = null
+    private var hostReady = CompletableDeferred<IVmHost>()
+    private var hostBound = false
+    private var hostLost = false
+
+    private val hostCallback = object : IVmHostCallback.Stub() {
+        override fun onStateChanged(state: String) {
+            scope.launch { onHostState(state) }
+        }
+
+        override fun onWatchdogIncident(incidentJson: String) {
+            try {
+                sendEvent("qemu_watchdog_incident", jsonToMap(JSONObject(incidentJson)))
+            } catch (e: Exception) {
+                Log.w(TAG, "Bad watchdog incident: ${e.message}")
+            }
+        }
+    }
+
+    private val hostConnection = object : ServiceConnection {
+        override fun onServiceConnected(name: ComponentName, binder: IBinder) {
+            val connected = IVmHost.Stub.asInterface(binder)
+            host = connected
+            try {
+                connected.registerCallback(hostCallback)
+            } catch (e: Exception) {
+                Log.w(TAG, "Failed to register host callback: ${e.message}")
+            }
+            hostReady.complete(connected)
+            Log.d(TAG, "Connected to VM host")
+
+            // After a host crash the VM counts as stopped until the new host
+            // confirms it still has a live QEMU session
+            if (hostLost) {
+                hostLost = false
+                scope.launch {
+                    try {
+                        if (connected.reattach()) {
+                            onHostState(VM_STATE_RUNNING)
+                        }
+                    } catch (e: Exception) {
+                        Log.w(TAG, "Reattach after reconnect failed: ${e.message}")
+                    }
+                }
+            }
+        }
+
+        override fun onServiceDisconnected(name: ComponentName) {
+            // The :vm process died and QEMU may have gone with it. Binding
+            // reconnects automatically; onServiceConnected then reattaches.
+            Log.w(TAG, "VM host disconnected")
+            host = null
+            hostReady = CompletableDeferred()
+            hostLost = true
+            stopLogReader()
+            if (vmState != VM_STATE_STOPPED) {
+                updateVmState(VM_STATE_STOPPED)
+            }
+        }
+    }
+
+    // Set once System.loadLibrary succeeds; natives are unusable otherwise
+    private var nativeAvailable = false
+    private var nativeLoadNanos = 0L
+
+    // JNI Native methods - bound by RegisterNatives in qemu_jni.c
     private external fun nativeInit(dataDir: String): Boolean
     private external fun nativeCreateDisk(path: String, sizeMb: Int): Boolean
     private external fun nativeStart(
@@ -55,11 +137,16 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
     private external fun nativeStop(handle: Long): Boolean
     private external fun nativeGetStatus(handle: Long): Int
     private external fun nativeCleanup(handle: Long)
+    private external fun nativeNoop(): Int
+    private external fun nativeGetLoadTimeNanos(): Long
 
     init {
         try {
+            val start = SystemClock.elapsedRealtimeNanos()
             System.loadLibrary("qemu_jni")
-            Log.d(TAG, "Native library loaded successfully")
+            nativeLoadNanos = SystemClock.elapsedRealtimeNanos() - start
+            nativeAvailable = true
+            Log.d(TAG, "Native library loaded successfully in ${nativeLoadNanos / 1000}us")
         } catch (e: UnsatisfiedLinkError) {
             Log.w(TAG, "Native library not available, using Java fallback: ${e.message}")
         }
@@ -96,6 +183,11 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
                     if (!it.exists()) it.mkdirs() 
                 }
 
+                // Registers this instance as the target for native callbacks
+                if (nativeAvailable) {
+                    nativeInit(qemuDir!!.absolutePath)
+                }
+
                 // Copy Alpine ISO from assets if exists
                 val isoFile = File(qemuDir, "alpine-virt.iso")
                 if (!isoFile.exists()) {
@@ -107,10 +199,42 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
                     }
                 }
 
-                // Copy setup script
+                // Minimal guest kernel for direct boot; refreshed when the APK is
+                // updated so a new kernel isn't shadowed by the old copy
+                val apkUpdatedAt = context.packageManager.getPackageInfo(context.packageName, 0).lastUpdateTime
+                val qemuAssets = context.assets.list("qemu").orEmpty()
+                for (name in listOf(VmSupervisor.GUEST_KERNEL, VmSupervisor.GUEST_INITRD)) {
+                    if (name !in qemuAssets) continue
+                    val file = File(qemuDir, name)
+                    if (!file.exists() || file.lastModified() < apkUpdatedAt) {
+                        copyAssetToFile(context, "qemu/$name", file)
+                        Log.d(TAG, "Copied guest $name to ${file.absolutePath}")
+                    }
+                }
+
+                // Trace events a log-backend QEMU build ships with; a build
+                // without them can't take -trace file=, so drop a stale copy
+                val traceEvents = File(qemuDir, QemuTrace.EVENTS_FILE)
+                if (QemuTrace.EVENTS_FILE !in qemuAssets) {
+                    traceEvents.delete()
+                } else if (!traceEvents.exists() || traceEvents.lastModified() < apkUpdatedAt) {
+                    copyAssetToFile(context, "qemu/${QemuTrace.EVENTS_FILE}", traceEvents)
+                }
+
+                // BIOS blobs from the slim QEMU build, passed to QEMU with -L
+                copyAssetDir(context, "qemu/firmware", File(qemuDir, "firmware"), apkUpdatedAt)
+                // Files the guest fetches over TFTP (appliance-init, docker-shim,
+                // containerd-stargz-grpc)
+                copyAssetDir(context, "qemu/${VmSupervisor.GUEST_FILES_DIR}", File(qemuDir, VmSupervisor.GUEST_FILES_DIR), apkUpdatedAt)
+
+                // Guest setup script; refreshed with the APK like the kernel so
+                // guest-side changes (data disk migration, scratch disk watcher)
+                // reach existing installs
                 val setupScript = File(qemuDir, "alpine-setup.sh")
-                if (!setupScript.exists()) {
-                    createAlpineSetupScript(setupScript)
+                if (!setupScript.exists() || setupScript.lastModified() < apkUpdatedAt) {
+                    copyAssetToFile(context, "qemu/alpine-setup.sh", setupScript)
+                    setupScript.setExecutable(true)
+                    Log.d(TAG, "Copied Alpine setup script to ${setupScript.absolutePath}")
                 }
 
                 // Create disk image if not exists
@@ -126,8 +250,16 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
                     createQemuConfig(configFile)
                 }
 
+                // Pick up a VM that survived a JS reload or app restart
+                val reattached = awaitHost().reattach()
+                if (reattached) {
+                    onHostState(VM_STATE_RUNNING)
+                }
+
                 val result = Arguments.createMap().apply {
                     putBoolean("success", true)
+                    putString("state", vmState)
+                    putBoolean("reattached", reattached)
                     putString("qemuDir", qemuDir?.absolutePath)
                     putString("isoPath", isoFile.absolutePath)
                     putString("diskPath", diskFile.absolutePath)
@@ -150,10 +282,14 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
     }
 
     /**
-     * Start the QEMU VM
+     * Start the QEMU VM. With applianceInit the guest boots straight into
+     * appliance-init instead of OpenRC, once it has been installed; runtime
+     * "lite" serves the Docker API from docker-shim on containerd, and
+     * "lazy" does the same with images pulled lazily by the stargz snapshotter.
+     * scratchDisk attaches a blank, unsafe-cached disk for /tmp and build caches.
      */
     @ReactMethod
-    fun startVM(ramMb: Int, cpuCores: Int, promise: Promise) {
+    fun startVM(ramMb: Int, cpuCores: Int, applianceInit: Boolean, runtime: String, scratchDisk: Boolean, promise: Promise) {
         scope.launch {
             try {
                 if (vmState == VM_STATE_RUNNING || vmState == VM_STATE_STARTING) {
@@ -163,44 +299,34 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
                     return@launch
                 }
 
-                updateVmState(VM_STATE_STARTING)
-                Log.d(TAG, "Starting VM with ${ramMb}MB RAM and $cpuCores CPU cores")
+                // Promote the host to a foreground service before QEMU starts
+                // so the VM outlives this process
+                QemuForegroundService.start(reactApplicationContext)
 
-                val qemuBinary = findQemuBinary()
-                if (qemuBinary == null) {
-                    throw Exception("QEMU binary not found. Please install QEMU binary.")
+                val vmHost = awaitHost()
+                val started = vmHost.start(ramMb, cpuCores, applianceInit, runtime, scratchDisk)
+                if (!started.getBoolean("success")) {
+                    throw Exception(started.getString("error") ?: "VM host failed to start QEMU")
                 }
 
-                val isoFile = File(qemuDir, "alpine-virt.iso")
-                val diskFile = File(qemuDir, "alpine-disk.qcow2")
-
-                if (!isoFile.exists()) {
-                    throw Exception("Alpine ISO not found at ${isoFile.absolutePath}")
+                if (started.getBoolean("reattached")) {
+                    onHostState(VM_STATE_RUNNING)
+                    withContext(Dispatchers.Main) {
+                        promise.resolve(Arguments.createMap().apply {
+                            putBoolean("success", true)
+                            putString("state", VM_STATE_RUNNING)
+                            putBoolean("reattached", true)
+                            putBoolean("dockerReady", vmHost.getStatus().getBoolean("dockerAvailable"))
+                            putInt("dockerPort", DOCKER_API_PORT)
+                            putInt("sshPort", SSH_PORT)
+                            putString("message", "Reattached to running VM (pid ${started.getInt("pid")})")
+                        })
+                    }
+                    return@launch
                 }
 
-                // Build QEMU command
-                val qemuArgs = buildQemuArgs(
-                    qemuBinary = qemuBinary.absolutePath,
-                    isoPath = isoFile.absolutePath,
-                    diskPath = diskFile.absolutePath,
-                    ramMb = ramMb,
-                    cpuCores = cpuCores
-                )
-
-                Log.d(TAG, "QEMU command: ${qemuArgs.joinToString(" ")}")
-
-                // Start QEMU process
-                val processBuilder = ProcessBuilder(qemuArgs)
-                    .directory(qemuDir)
-                    .redirectErrorStream(true)
-                
-                qemuProcess = processBuilder.start()
-
-                // Start log reader
-                startLogReader()
-
-                // Wait for Docker API to be available
-                val dockerReady = waitForDockerApi(60) // 60 seconds timeout
+                // Wait for Docker API to be available; the host does the probing
+                val dockerReady = vmHost.waitForDocker(60) // 60 seconds timeout
                 
                 if (dockerReady) {
                     updateVmState(VM_STATE_RUNNING)
@@ -262,26 +388,13 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
                 Log.d(TAG, "Stopping VM...")
 
                 // Stop log reader
-                logReader?.cancel()
-                logReader = null
+                stopLogReader()
 
-                // Try graceful shutdown first via QEMU monitor
-                try {
-                    sendQemuCommand("system_powerdown")
-                    delay(5000) // Wait 5 seconds for graceful shutdown
-                } catch (e: Exception) {
-                    Log.w(TAG, "Graceful shutdown failed: ${e.message}")
+                val stopped = awaitHost().stop()
+                if (!stopped.getBoolean("success")) {
+                    throw Exception(stopped.getString("error") ?: "VM host failed to stop QEMU")
                 }
 
-                // Force kill if still running
-                qemuProcess?.let { process ->
-                    if (process.isAlive) {
-                        process.destroyForcibly()
-                        process.waitFor()
-                    }
-                }
-                qemuProcess = null
-
                 updateVmState(VM_STATE_STOPPED)
 
                 val result = Arguments.createMap().apply {
@@ -302,6 +415,54 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
         }
     }
 
+    /**
+     * Apply new RAM/vCPU sizes to the running VM via hotplug. Whatever
+     * could not be applied live is reported with restartRequired and the
+     * reason; the new sizes then take effect on the next start.
+     */
+    @ReactMethod
+    fun resizeVM(ramMb: Int, cpuCores: Int, promise: Promise) {
+        scope.launch {
+            try {
+                if (vmState != VM_STATE_RUNNING) {
+                    withContext(Dispatchers.Main) {
+                        promise.resolve(Arguments.createMap().apply {
+                            putBoolean("success", true)
+                            putBoolean("restartRequired", false)
+                            putInt("cpuCores", cpuCores)
+                            putInt("ramMb", ramMb)
+                            putString("message", "VM not running; sizes apply on next start")
+                        })
+                    }
+                    return@launch
+                }
+
+                val resized = awaitHost().resize(ramMb, cpuCores)
+                if (!resized.getBoolean("success")) {
+                    throw Exception(resized.getString("error") ?: "VM host failed to resize")
+                }
+
+                val result = Arguments.createMap().apply {
+                    putBoolean("success", true)
+                    putInt("cpuCores", resized.getInt("cpuCores"))
+                    putInt("ramMb", resized.getInt("ramMb"))
+                    putBoolean("restartRequired", resized.getBoolean("restartRequired"))
+                    resized.getString("reason")?.takeIf { it.isNotEmpty() }?.let { putString("message", it) }
+                }
+
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to resize VM", e)
+                withContext(Dispatchers.Main) {
+                    promise.reject("RESIZE_ERROR", "Failed to resize VM: ${e.message}", e)
+                }
+            }
+        }
+    }
+
     /**
      * Get current VM status
      */
@@ -309,19 +470,13 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
     fun getStatus(promise: Promise) {
         scope.launch {
             try {
-                val isProcessAlive = qemuProcess?.isAlive ?: false
-                
-                // Check Docker API availability
-                val dockerAvailable = if (isProcessAlive) {
-                    checkDockerApi()
-                } else {
-                    false
-                }
+                // Liveness and the Docker probe are answered by the host
+                val status = awaitHost().getStatus()
 
                 val result = Arguments.createMap().apply {
                     putString("state", vmState)
-                    putBoolean("isRunning", isProcessAlive)
-                    putBoolean("dockerAvailable", dockerAvailable)
+                    putBoolean("isRunning", status.getBoolean("isRunning"))
+                    putBoolean("dockerAvailable", status.getBoolean("dockerAvailable"))
                     putInt("dockerPort", DOCKER_API_PORT)
                     putInt("sshPort", SSH_PORT)
                 }
@@ -422,7 +577,7 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
     fun checkRequirements(promise: Promise) {
         scope.launch {
             try {
-                val qemuBinary = findQemuBinary()
+                val qemuBinary = VmSupervisor.findQemuBinary(reactApplicationContext)
                 val isoFile = File(qemuDir, "alpine-virt.iso")
                 val diskFile = File(qemuDir, "alpine-disk.qcow2")
 
@@ -450,72 +605,522 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
         }
     }
 
-    // ============== Private Helper Methods ==============
+    /**
+     * Measure JNI cold-load time and per-call overhead
+     */
+    @ReactMethod
+    fun getNativeDiagnostics(iterations: Int, promise: Promise) {
+        scope.launch {
+            try {
+                if (!nativeAvailable) {
+                    throw Exception("Native library not loaded")
+                }
 
-    private fun buildQemuArgs(
-        qemuBinary: String,
-        isoPath: String,
-        diskPath: String,
-        ramMb: Int,
-        cpuCores: Int
-    ): List<String> {
-        return listOf(
-            qemuBinary,
-            "-machine", "q35",
-            "-cpu", "max",
-            "-smp", cpuCores.toString(),
-            "-m", "${ramMb}M",
-            "-cdrom", isoPath,
-            "-drive", "file=$diskPath,format=qcow2,if=virtio",
-            "-boot", "d",
-            "-netdev", "user,id=net0,hostfwd=tcp::$DOCKER_API_PORT-:2375,hostfwd=tcp::$SSH_PORT-:22,hostfwd=tcp::8080-:80,hostfwd=tcp::8081-:8080,hostfwd=tcp::3000-:3000",
-            "-device", "virtio-net-pci,netdev=net0",
-            "-display", "none",
-            "-daemonize",
-            "-pidfile", "${qemuDir?.absolutePath}/qemu.pid",
-            "-serial", "file:${qemuDir?.absolutePath}/qemu.log"
-        )
+                val calls = iterations.coerceIn(1, 10_000_000)
+
+                // Warm up so the first timed call isn't paying for resolution
+                repeat(1000) { nativeNoop() }
+
+                val start = SystemClock.elapsedRealtimeNanos()
+                repeat(calls) { nativeNoop() }
+                val elapsed = SystemClock.elapsedRealtimeNanos() - start
+
+                val result = Arguments.createMap().apply {
+                    putDouble("loadLibraryMs", nativeLoadNanos / 1_000_000.0)
+                    putDouble("onLoadMs", nativeGetLoadTimeNanos() / 1_000_000.0)
+                    putInt("iterations", calls)
+                    putDouble("nsPerCall", elapsed.toDouble() / calls)
+                }
+
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("DIAGNOSTICS_ERROR", "Failed to measure JNI: ${e.message}", e)
+                }
+            }
+        }
     }
 
-    private fun findQemuBinary(): File? {
-        val context = reactApplicationContext
-        
-        // Check in jniLibs
-        val libDir = File(context.applicationInfo.nativeLibraryDir)
-        val binaryNames = listOf(
-            "libqemu-system-x86_64.so",
-            "libqemu.so",
-            "qemu-system-x86_64"
-        )
-        
-        for (name in binaryNames) {
-            val binary = File(libDir, name)
-            if (binary.exists() && binary.canExecute()) {
-                return binary
+    /**
+     * Snapshot of app and QEMU memory for long-session leak tracking.
+     * All sizes are in kB.
+     */
+    @ReactMethod
+    fun getMemoryStats(promise: Promise) {
+        scope.launch {
+            try {
+                val runtime = Runtime.getRuntime()
+                val self = ProcMemory.readRollup(null)
+                val qemuPid = host?.qemuPid?.takeIf { it > 0 }
+                val qemu = qemuPid?.let { ProcMemory.readRollup(it) }
+                val qemuStatus = if (qemuPid != null && qemu == null) ProcMemory.readStatus(qemuPid) else null
+                // The :vm host holds the supervisor, rings and log index
+                val vmPid = host?.hostPid?.takeIf { it > 0 && it != android.os.Process.myPid() }
+                val vm = vmPid?.let { ProcMemory.readRollup(it) }
+                val vmStatus = if (vmPid != null && vm == null) ProcMemory.readStatus(vmPid) else null
+
+                val result = Arguments.createMap().apply {
+                    putDouble("timestamp", System.currentTimeMillis().toDouble())
+                    putDouble("javaHeapUsedKb", (runtime.totalMemory() - runtime.freeMemory()) / 1024.0)
+                    putDouble("javaHeapMaxKb", runtime.maxMemory() / 1024.0)
+                    putDouble("nativeHeapKb", Debug.getNativeHeapAllocatedSize() / 1024.0)
+                    putDouble("selfRssKb", (self?.get("Rss") ?: 0L).toDouble())
+                    putDouble("selfPssKb", (self?.get("Pss") ?: ProcMemory.selfPssFallbackKb()).toDouble())
+                    putDouble("selfSwapKb", (self?.get("Swap") ?: 0L).toDouble())
+                    putBoolean("smapsRollup", self != null)
+                    if (qemuPid != null) {
+                        putInt("qemuPid", qemuPid)
+                        putDouble("qemuRssKb", (qemu?.get("Rss") ?: qemuStatus?.get("VmRSS") ?: 0L).toDouble())
+                        // Without smaps_rollup RSS is the best available stand-in for PSS
+                        putDouble("qemuPssKb", (qemu?.get("Pss") ?: qemuStatus?.get("VmRSS") ?: 0L).toDouble())
+                    }
+                    if (vmPid != null) {
+                        putInt("vmPid", vmPid)
+                        putDouble("vmRssKb", (vm?.get("Rss") ?: vmStatus?.get("VmRSS") ?: 0L).toDouble())
+                        putDouble("vmPssKb", (vm?.get("Pss") ?: vmStatus?.get("VmRSS") ?: 0L).toDouble())
+                        putDouble("vmSwapKb", (vm?.get("Swap") ?: vmStatus?.get("VmSwap") ?: 0L).toDouble())
+                    }
+                }
+
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("DIAGNOSTICS_ERROR", "Failed to read memory stats: ${e.message}", e)
+                }
             }
         }
+    }
 
-        // Check in assets extracted location
-        val extractedBinary = File(qemuDir, "qemu-system-x86_64")
-        if (extractedBinary.exists() && extractedBinary.canExecute()) {
-            return extractedBinary
+    /**
+     * Current hung-guest watchdog settings (see VmWatchdog.WatchdogConfig)
+     */
+    @ReactMethod
+    fun getWatchdogConfig(promise: Promise) {
+        scope.launch {
+            try {
+                val config = JSONObject(awaitHost().watchdogConfig)
+                withContext(Dispatchers.Main) {
+                    promise.resolve(jsonToMap(config))
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("WATCHDOG_ERROR", "Failed to read watchdog config: ${e.message}", e)
+                }
+            }
         }
+    }
 
-        // Check system PATH (for development)
-        val systemPaths = listOf(
-            "/usr/bin/qemu-system-x86_64",
-            "/usr/local/bin/qemu-system-x86_64"
-        )
-        for (path in systemPaths) {
-            val binary = File(path)
-            if (binary.exists() && binary.canExecute()) {
-                return binary
+    /**
+     * Merge the given fields into the watchdog settings; the host validates
+     * and persists them
+     */
+    @ReactMethod
+    fun setWatchdogConfig(config: ReadableMap, promise: Promise) {
+        scope.launch {
+            try {
+                val vmHost = awaitHost()
+                val merged = JSONObject(vmHost.watchdogConfig)
+                for ((key, value) in config.toHashMap()) {
+                    merged.put(key, JSONObject.wrap(value))
+                }
+                vmHost.setWatchdogConfig(merged.toString())
+                val saved = JSONObject(vmHost.watchdogConfig)
+                withContext(Dispatchers.Main) {
+                    promise.resolve(jsonToMap(saved))
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("WATCHDOG_ERROR", "Failed to update watchdog config: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Recorded watchdog incidents, newest first
+     */
+    @ReactMethod
+    fun getWatchdogIncidents(limit: Int, promise: Promise) {
+        scope.launch {
+            try {
+                val incidents = JSONArray(awaitHost().getWatchdogIncidents(limit))
+                val result = Arguments.createMap().apply {
+                    putArray("incidents", jsonToArray(incidents))
+                }
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("WATCHDOG_ERROR", "Failed to read watchdog incidents: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Free space on the volume holding the VM's disks, and the bytes each
+     * disk image actually occupies (sparse and discarded ranges excluded)
+     */
+    @ReactMethod
+    fun getStorageStats(promise: Promise) {
+        scope.launch {
+            try {
+                val dir = qemuDir ?: throw Exception("QEMU is not initialized")
+                val fs = Os.statvfs(dir.absolutePath)
+                // st_blocks counts 512-byte units whatever the block size
+                fun allocated(name: String): Double {
+                    val file = File(dir, name)
+                    return if (file.exists()) Os.stat(file.absolutePath).st_blocks * 512.0 else 0.0
+                }
+
+                val result = Arguments.createMap().apply {
+                    putDouble("freeBytes", fs.f_bavail.toDouble() * fs.f_frsize)
+                    putDouble("totalBytes", fs.f_blocks.toDouble() * fs.f_frsize)
+                    putDouble("osDiskBytes", allocated("alpine-disk.qcow2"))
+                    putDouble("dataDiskBytes", allocated(DataDisk.FILE))
+                }
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("STORAGE_ERROR", "Failed to read storage stats: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Schedule or cancel the background pre-fetch of docker.defaultImages
+     * into the host registry cache (see ImagePrefetchWorker)
+     */
+    @ReactMethod
+    fun setImagePrefetch(enabled: Boolean, promise: Promise) {
+        scope.launch {
+            try {
+                ImagePrefetchWorker.schedule(reactApplicationContext, enabled)
+                withContext(Dispatchers.Main) {
+                    promise.resolve(enabled)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("PREFETCH_ERROR", "Failed to schedule image pre-fetch: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Pre-fetch now on any network, e.g. against a local registry stand-in
+     */
+    @ReactMethod
+    fun prefetchImagesNow(promise: Promise) {
+        scope.launch {
+            try {
+                ImagePrefetchWorker.runNow(reactApplicationContext)
+                withContext(Dispatchers.Main) {
+                    promise.resolve(true)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("PREFETCH_ERROR", "Failed to start image pre-fetch: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Whether the pre-fetch is scheduled, and what its last run did
+     */
+    @ReactMethod
+    fun getImagePrefetchStatus(promise: Promise) {
+        scope.launch {
+            try {
+                val status = ImagePrefetchWorker.readStatus(reactApplicationContext)
+                    .put("scheduled", ImagePrefetchWorker.isScheduled(reactApplicationContext))
+                val result = jsonToMap(status)
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("PREFETCH_ERROR", "Failed to read image pre-fetch status: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Stream usage of every container from the guest's cgroup-stats as
+     * qemu_container_stats events, one per interval
+     */
+    @ReactMethod
+    fun startContainerStats(intervalMs: Int, promise: Promise) {
+        try {
+            val dir = qemuDir ?: VmSupervisor.qemuDir(reactApplicationContext)
+            val stream = containerStats ?: ContainerStatsStream(dir, onFrame = { containers ->
+                sendEvent("qemu_container_stats", Arguments.createMap().apply {
+                    putDouble("timestamp", System.currentTimeMillis().toDouble())
+                    putArray("containers", Arguments.createArray().apply {
+                        for (c in containers) {
+                            pushMap(Arguments.createMap().apply {
+                                putString("id", c.id)
+                                putDouble("cpuPercent", c.cpuPercent)
+                                putDouble("memoryBytes", c.memoryBytes.toDouble())
+                                putDouble("memoryLimit", c.memoryLimit.toDouble())
+                                putDouble("pids", c.pids.toDouble())
+                                putDouble("blockRead", c.blockRead.toDouble())
+                                putDouble("blockWrite", c.blockWrite.toDouble())
+                                putDouble("netRx", c.netRx.toDouble())
+                                putDouble("netTx", c.netTx.toDouble())
+                            })
+                        }
+                    })
+                })
+            }, onLatency = { c ->
+                sendEvent("qemu_container_latency", Arguments.createMap().apply {
+                    putDouble("timestamp", System.currentTimeMillis().toDouble())
+                    putString("id", c.id)
+                    putArray("runqueue", Arguments.createArray().apply { c.runqueue.forEach { pushDouble(it.toDouble()) } })
+                    putArray("blockIo", Arguments.createArray().apply { c.blockIo.forEach { pushDouble(it.toDouble()) } })
+                    putDouble("tcpRetransmits", c.tcpRetransmits.toDouble())
+                    putDouble("syscalls", c.syscalls.toDouble())
+                    putArray("topSyscalls", Arguments.createArray().apply {
+                        for ((nr, count) in c.topSyscalls) {
+                            pushMap(Arguments.createMap().apply {
+                                putInt("nr", nr)
+                                putDouble("count", count.toDouble())
+                            })
+                        }
+                    })
+                })
+            }, onTraceState = { state, status ->
+                sendEvent("qemu_container_trace", Arguments.createMap().apply {
+                    putString("state", state)
+                    if (status != null) putInt("exitStatus", status) else putNull("exitStatus")
+                })
+            })
+            containerStats = stream
+            stream.start(scope, intervalMs)
+            promise.resolve(true)
+        } catch (e: Exception) {
+            promise.reject("STATS_ERROR", "Failed to start container stats: ${e.message}", e)
+        }
+    }
+
+    @ReactMethod
+    fun stopContainerStats(promise: Promise) {
+        containerStats?.stop()
+        promise.resolve(true)
+    }
+
+    /**
+     * Run the guest's eBPF latency tracer alongside the stats stream;
+     * reports arrive as qemu_container_latency events, its state as
+     * qemu_container_trace
+     */
+    @ReactMethod
+    fun setContainerTracing(enabled: Boolean, promise: Promise) {
+        val stream = containerStats
+        if (stream == null) {
+            promise.reject("STATS_ERROR", "Container stats are not running")
+            return
+        }
+        scope.launch(Dispatchers.IO) { stream.setTracing(enabled) }
+        promise.resolve(true)
+    }
+
+    /**
+     * Boot-to-ready times per init mode, recorded from the guest's ready
+     * report on the heartbeat port
+     */
+    @ReactMethod
+    fun getBootTimes(promise: Promise) {
+        scope.launch {
+            try {
+                val times = jsonToMap(JSONObject(awaitHost().getBootTimes()))
+                withContext(Dispatchers.Main) {
+                    promise.resolve(times)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("BOOT_TIMES_ERROR", "Failed to read boot times: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Switch QEMU's block/virtio/TCG trace events on (starting a new summary
+     * window) or off. Resolves false if this QEMU build can't trace.
+     */
+    @ReactMethod
+    fun setQemuTracing(enabled: Boolean, promise: Promise) {
+        scope.launch {
+            try {
+                val result = awaitHost().setQemuTracing(enabled)
+                if (result.getBoolean("supported") && !result.getBoolean("success")) {
+                    throw Exception(result.getString("error") ?: "VM host failed to switch tracing")
+                }
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result.getBoolean("supported"))
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("QEMU_TRACE_ERROR", "Failed to switch QEMU tracing: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /** Trace event summary since tracing was switched on */
+    @ReactMethod
+    fun getQemuTraceSummary(promise: Promise) {
+        scope.launch {
+            try {
+                val summary = jsonToMap(JSONObject(awaitHost().getQemuTraceSummary()))
+                withContext(Dispatchers.Main) {
+                    promise.resolve(summary)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("QEMU_TRACE_ERROR", "Failed to read QEMU trace summary: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Full-text search across every container's logs, newest first. options:
+     * container (id prefix), since/until (epoch ms), stream ("stdout" or
+     * "stderr"), limit
+     */
+    @ReactMethod
+    fun searchContainerLogs(query: String, options: ReadableMap, promise: Promise) {
+        scope.launch {
+            try {
+                val stream = when (if (options.hasKey("stream")) options.getString("stream") else null) {
+                    "stdout" -> NativeTransfer.LOG_STDOUT
+                    "stderr" -> NativeTransfer.LOG_STDERR
+                    else -> 0
+                }
+                val json = JSONObject(awaitHost().searchContainerLogs(
+                    query,
+                    if (options.hasKey("container")) options.getString("container") else null,
+                    if (options.hasKey("since")) options.getDouble("since").toLong() else 0L,
+                    if (options.hasKey("until")) options.getDouble("until").toLong() else 0L,
+                    stream,
+                    if (options.hasKey("limit")) options.getInt("limit") else 100
+                ))
+                if (json.has("error")) {
+                    throw Exception(json.getString("error"))
+                }
+                val result = jsonToMap(json)
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("LOG_SEARCH_ERROR", "Failed to search container logs: ${e.message}", e)
+                }
             }
         }
+    }
+
+    /** Log index size per container and its retention limits */
+    @ReactMethod
+    fun getLogIndexStats(promise: Promise) {
+        scope.launch {
+            try {
+                val stats = jsonToMap(JSONObject(awaitHost().getLogIndexStats()))
+                withContext(Dispatchers.Main) {
+                    promise.resolve(stats)
+                }
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("LOG_SEARCH_ERROR", "Failed to read log index stats: ${e.message}", e)
+                }
+            }
+        }
+    }
+
+    /**
+     * Measure events/second across the JNI boundary for each transfer path:
+     * ring records decoded in place, critical-array batch samples, and a
+     * one-String-per-call baseline
+     */
+    @ReactMethod
+    fun benchmarkTransfer(events: Int, payloadBytes: Int, promise: Promise) {
+        scope.launch {
+            try {
+                if (!NativeTransfer.isAvailable) {
+                    throw Exception("Native library not loaded")
+                }
+
+                val count = events.coerceIn(1, 10_000_000)
+
+                // Ring: native thread produces, this thread drains in place
+                val ring = NativeTransfer.Ring.create(BENCH_RING_BYTES)
+                var received = 0
+                var bytes = 0L
+                val visitor = NativeTransfer.RecordVisitor { _, _, _, _, _, length ->
+                    received++
+                    bytes += length
+                }
+                val ringStart = SystemClock.elapsedRealtimeNanos()
+                NativeTransfer.nativeBenchmarkProduce(ring.id, count, payloadBytes)
+                while (received < count) {
+                    if (ring.drain(visitor) == 0) Thread.yield()
+                }
+                val ringNanos = SystemClock.elapsedRealtimeNanos() - ringStart
+                NativeTransfer.nativeBenchmarkJoin()
+                ring.close()
+
+                // Critical arrays: batches of self samples per JNI call
+                val batch = 64
+                val pids = IntArray(batch)
+                val samples = LongArray(batch * NativeTransfer.SAMPLE_FIELDS)
+                val batchCalls = (count / batch).coerceIn(1, 2000)
+                val batchStart = SystemClock.elapsedRealtimeNanos()
+                repeat(batchCalls) { NativeTransfer.nativeSampleProcesses(pids, samples) }
+                val batchNanos = SystemClock.elapsedRealtimeNanos() - batchStart
+
+                // Baseline: one JNI call + one String per event
+                val stringStart = SystemClock.elapsedRealtimeNanos()
+                var chars = 0
+                repeat(count) { chars += NativeTransfer.nativeBenchmarkString(it).length }
+                val stringNanos = SystemClock.elapsedRealtimeNanos() - stringStart
 
-        return null
+                val result = Arguments.createMap().apply {
+                    putInt("events", count)
+                    putDouble("ringEventsPerSec", count * 1e9 / ringNanos)
+                    putDouble("ringMBPerSec", bytes * 1e3 / ringNanos)
+                    putDouble("batchSamplesPerSec", batchCalls * batch * 1e9 / batchNanos)
+                    putDouble("stringEventsPerSec", count * 1e9 / stringNanos)
+                    putInt("stringChars", chars)
+                }
+
+                withContext(Dispatchers.Main) {
+                    promise.resolve(result)
+                }
+
+            } catch (e: Exception) {
+                withContext(Dispatchers.Main) {
+                    promise.reject("DIAGNOSTICS_ERROR", "Transfer benchmark failed: ${e.message}", e)
+                }
+            }
+        }
     }
 
+    // ============== Private Helper Methods ==============
+
     private fun copyAssetToFile(context: Context, assetPath: String, outFile: File) {
         context.assets.open(assetPath).use { input ->
             FileOutputStream(outFile).use { output ->
@@ -524,106 +1129,22 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
         }
     }
 
-    private fun createDiskImage(diskFile: File, sizeMb: Int) {
-        // Create a sparse QCOW2-like file (simplified)
-        // In production, use qemu-img or native JNI call
-        diskFile.createNewFile()
-        
-        // Write minimal QCOW2 header
-        RandomAccessFile(diskFile, "rw").use { raf ->
-            // QCOW2 magic number
-            raf.write(byteArrayOf(0x51, 0x46, 0x49, 0xFB.toByte())) // "QFI\xfb"
-            // Version 3
-            raf.writeInt(3)
-            // Backing file offset (0 = no backing file)
-            raf.writeLong(0)
-            // Backing file size
-            raf.writeInt(0)
-            // Cluster bits (16 = 64KB clusters)
-            raf.writeInt(16)
-            // Size in bytes
-            raf.writeLong(sizeMb.toLong() * 1024 * 1024)
-            // Encryption method (0 = none)
-            raf.writeInt(0)
-            // L1 size
-            raf.writeInt(0)
-            // L1 table offset
-            raf.writeLong(0)
-            // Refcount table offset
-            raf.writeLong(0)
-            // Refcount table clusters
-            raf.writeInt(0)
-            // Snapshots
-            raf.writeInt(0)
-            // Snapshot offset
-            raf.writeLong(0)
+    /** Copy every file under an asset directory, refreshing copies older than the APK */
+    private fun copyAssetDir(context: Context, assetDir: String, outDir: File, apkUpdatedAt: Long) {
+        val names = context.assets.list(assetDir).orEmpty()
+        if (names.isEmpty()) return
+        outDir.mkdirs()
+        for (name in names) {
+            val file = File(outDir, name)
+            if (!file.exists() || file.lastModified() < apkUpdatedAt) {
+                copyAssetToFile(context, "$assetDir/$name", file)
+            }
         }
-        
-        Log.d(TAG, "Created disk image at ${diskFile.absolutePath}")
     }
 
-    private fun createAlpineSetupScript(scriptFile: File) {
-        val script = """
-            #!/bin/sh
-            # Alpine Linux auto-setup script for Docker
-            
-            echo "Starting Alpine Docker setup..."
-            
-            # Setup networking
-            setup-interfaces -a
-            rc-service networking start
-            
-            # Update package repository
-            apk update
-            apk upgrade
-            
-            # Install Docker
-            apk add docker docker-compose openrc
-            
-            # Enable and start Docker
-            rc-update add docker boot
-            rc-service docker start
-            
-            # Configure Docker to listen on TCP
-            mkdir -p /etc/docker
-            cat > /etc/docker/daemon.json << 'EOF'
-            {
-                "hosts": ["unix:///var/run/docker.sock", "tcp://0.0.0.0:2375"],
-                "storage-driver": "overlay2",
-                "log-driver": "json-file",
-                "log-opts": {
-                    "max-size": "10m",
-                    "max-file": "3"
-                }
-            }
-            EOF
-            
-            # Restart Docker with new config
-            rc-service docker restart
-            
-            # Install commonly used tools
-            apk add curl wget vim htop
-            
-            # Enable SSH
-            apk add openssh
-            rc-update add sshd
-            rc-service sshd start
-            
-            # Set root password (for development)
-            echo "root:docker" | chpasswd
-            
-            # Pull base images
-            docker pull alpine:latest
-            docker pull nginx:alpine
-            
-            echo "Alpine Docker setup complete!"
-            echo "Docker API: http://localhost:2375"
-            echo "SSH: port 22 (user: root, pass: docker)"
-        """.trimIndent()
-
-        scriptFile.writeText(script)
-        scriptFile.setExecutable(true)
-        Log.d(TAG, "Created Alpine setup script at ${scriptFile.absolutePath}")
+    private fun createDiskImage(diskFile: File, sizeMb: Int) {
+        Qcow2.create(diskFile, sizeMb.toLong() * 1024 * 1024, OS_DISK_CLUSTER_BITS)
+        Log.d(TAG, "Created disk image at ${diskFile.absolutePath}")
     }
 
     private fun createQemuConfig(configFile: File) {
@@ -650,49 +1171,65 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
         Log.d(TAG, "Created QEMU config at ${configFile.absolutePath}")
     }
 
-    private suspend fun waitForDockerApi(timeoutSeconds: Int): Boolean {
-        val startTime = System.currentTimeMillis()
-        val timeoutMs = timeoutSeconds * 1000L
+    /**
+     * Follow logs and stats while the VM is up. The host's native producers
+     * write into shared rings; without them (no native library on either
+     * side) this falls back to tailing qemu.log directly.
+     */
+    private fun startLogReader(vmHost: IVmHost) {
+        if (logReader?.isActive == true) return
 
-        while (System.currentTimeMillis() - startTime < timeoutMs) {
-            if (checkDockerApi()) {
-                return true
+        val rings = if (NativeTransfer.isAvailable) attachRings(vmHost) else null
+        if (rings == null) {
+            startFileLogReader(File(qemuDir, "qemu.log").length())
+            return
+        }
+
+        val (logs, stats) = rings
+        logReader = scope.launch {
+            val lines = NativeTransfer.LineCollector()
+            val statsVisitor = QemuStatsVisitor()
+            try {
+                while (isActive) {
+                    lines.reset()
+                    logs.drain(lines)
+                    if (lines.lines > 0) {
+                        sendEvent("qemu_log", Arguments.createMap().apply {
+                            putString("log", lines.text.toString())
+                        })
+                    }
+
+                    stats.drain(statsVisitor)
+                    delay(RING_DRAIN_MS)
+                }
+            } finally {
+                logs.close()
+                stats.close()
             }
-            delay(2000) // Check every 2 seconds
         }
-        return false
     }
 
-    private fun checkDockerApi(): Boolean {
+    private fun attachRings(vmHost: IVmHost): Pair<NativeTransfer.Ring, NativeTransfer.Ring>? {
         return try {
-            val url = URL("http://localhost:$DOCKER_API_PORT/_ping")
-            val connection = url.openConnection() as HttpURLConnection
-            connection.requestMethod = "GET"
-            connection.connectTimeout = 2000
-            connection.readTimeout = 2000
-            
-            val responseCode = connection.responseCode
-            connection.disconnect()
-            
-            responseCode == 200
+            val logFd = vmHost.openLogRing() ?: return null
+            val statsFd = vmHost.openStatsRing()
+            if (statsFd == null) {
+                logFd.close()
+                return null
+            }
+            NativeTransfer.Ring.attach(logFd) to NativeTransfer.Ring.attach(statsFd)
         } catch (e: Exception) {
-            false
+            Log.w(TAG, "Shared rings unavailable, tailing qemu.log: ${e.message}")
+            null
         }
     }
 
-    private fun sendQemuCommand(command: String) {
-        // Send command to QEMU monitor (via socket or other mechanism)
-        // This is a placeholder - actual implementation depends on QEMU setup
-        Log.d(TAG, "Sending QEMU command: $command")
-    }
-
-    private fun startLogReader() {
-        logReader?.cancel()
+    private fun startFileLogReader(offset: Long) {
         logReader = scope.launch {
             val logFile = File(qemuDir, "qemu.log")
-            var lastPosition = 0L
+            var lastPosition = offset
 
-            while (isActive && vmState == VM_STATE_RUNNING) {
+            while (isActive && (vmState == VM_STATE_STARTING || vmState == VM_STATE_RUNNING)) {
                 try {
                     if (logFile.exists() && logFile.length() > lastPosition) {
                         RandomAccessFile(logFile, "r").use { raf ->
@@ -719,6 +1256,112 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
         }
     }
 
+    private fun stopLogReader() {
+        logReader?.cancel()
+        logReader = null
+    }
+
+    /**
+     * State pushed from the host (or observed after reattach). Drives the
+     * log/stats reader so it runs only while QEMU does.
+     */
+    private fun onHostState(state: String) {
+        if (state != vmState) {
+            updateVmState(state)
+        }
+        val vmHost = host
+        if (vmHost != null && (state == VM_STATE_STARTING || state == VM_STATE_RUNNING)) {
+            startLogReader(vmHost)
+        } else if (state == VM_STATE_STOPPED || state == VM_STATE_ERROR) {
+            stopLogReader()
+        }
+    }
+
+    /**
+     * Bind to the :vm host (starting its process if needed) and wait for the
+     * connection
+     */
+    private suspend fun awaitHost(): IVmHost {
+        host?.let { return it }
+        withContext(Dispatchers.Main) {
+            if (!hostBound) {
+                val intent = Intent(reactApplicationContext, QemuForegroundService::class.java)
+                hostBound = reactApplicationContext.bindService(intent, hostConnection, Context.BIND_AUTO_CREATE)
+            }
+        }
+        if (!hostBound) {
+            throw Exception("Unable to bind VM host service")
+        }
+        return withTimeoutOrNull(HOST_BIND_TIMEOUT_MS) { hostReady.await() }
+            ?: throw Exception("Timed out connecting to VM host")
+    }
+
+    /**
+     * Turns STATS records (cumulative /proc counters) into qemu_stats events
+     */
+    private inner class QemuStatsVisitor : NativeTransfer.RecordVisitor {
+        private val clockTicks = Os.sysconf(OsConstants._SC_CLK_TCK).toDouble()
+        private val hostCpus = Runtime.getRuntime().availableProcessors()
+        private var lastTicks = -1L
+        private var lastTimestamp = 0L
+
+        override fun onRecord(type: Int, flags: Int, timestampNs: Long, payload: java.nio.ByteBuffer, offset: Int, length: Int) {
+            if (type != NativeTransfer.REC_STATS) return
+
+            fun field(index: Int) = payload.getLong(offset + index * 8)
+
+            // The host notices the exit itself and reports the state change
+            if (flags and 1 != 0) {
+                return
+            }
+
+            val ticks = field(NativeTransfer.SAMPLE_UTIME_TICKS) + field(NativeTransfer.SAMPLE_STIME_TICKS)
+            if (lastTicks >= 0) {
+                val seconds = (timestampNs - lastTimestamp) / 1e9
+                val cpuPercent = ((ticks - lastTicks) / clockTicks) / seconds / hostCpus * 100
+                sendEvent("qemu_stats", Arguments.createMap().apply {
+                    putDouble("cpuPercent", cpuPercent.coerceIn(0.0, 100.0))
+                    putDouble("rssMb", field(NativeTransfer.SAMPLE_RSS_BYTES) / (1024.0 * 1024.0))
+                    putInt("threads", field(NativeTransfer.SAMPLE_THREADS).toInt())
+                })
+            }
+            lastTicks = ticks
+            lastTimestamp = timestampNs
+        }
+    }
+
+    private fun jsonToMap(json: JSONObject): WritableMap {
+        val map = Arguments.createMap()
+        for (key in json.keys()) {
+            when (val value = json.get(key)) {
+                is JSONObject -> map.putMap(key, jsonToMap(value))
+                is JSONArray -> map.putArray(key, jsonToArray(value))
+                is Boolean -> map.putBoolean(key, value)
+                is Int -> map.putInt(key, value)
+                is Number -> map.putDouble(key, value.toDouble())
+                is String -> map.putString(key, value)
+                else -> map.putNull(key)
+            }
+        }
+        return map
+    }
+
+    private fun jsonToArray(json: JSONArray): WritableArray {
+        val array = Arguments.createArray()
+        for (i in 0 until json.length()) {
+            when (val value = json.get(i)) {
+                is JSONObject -> array.pushMap(jsonToMap(value))
+                is JSONArray -> array.pushArray(jsonToArray(value))
+                is Boolean -> array.pushBoolean(value)
+                is Int -> array.pushInt(value)
+                is Number -> array.pushDouble(value.toDouble())
+                is String -> array.pushString(value)
+                else -> array.pushNull()
+            }
+        }
+        return array
+    }
+
     private fun updateVmState(newState: String) {
         vmState = newState
         sendEvent("qemu_state_change", Arguments.createMap().apply {
@@ -759,7 +1402,19 @@ class QemuModule(reactContext: ReactApplicationContext) : ReactContextBaseJavaMo
     override fun invalidate() {
         super.invalidate()
         scope.cancel()
-        logReader?.cancel()
-        qemuProcess?.destroyForcibly()
+        stopLogReader()
+        containerStats?.stop()
+        // The VM host and QEMU deliberately keep running; the next module
+        // instance binds again and reattaches
+        try {
+            host?.unregisterCallback(hostCallback)
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to unregister host callback: ${e.message}")
+        }
+        if (hostBound) {
+            reactApplicationContext.unbindService(hostConnection)
+            hostBound = false
+        }
+        host = null
     }
 }
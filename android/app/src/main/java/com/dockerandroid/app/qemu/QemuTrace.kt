@@ -0,0 +1,153 @@
+package com.dockerandroid.app.qemu
+
+import android.system.ErrnoException
+import android.system.Os
+import android.util.Log
+import org.json.JSONObject
+import java.io.File
+import java.io.IOException
+
+/**
+ * QEMU's own trace events (block, virtio, TCG), summarized on device.
+ *
+ * QEMU built with the "log" trace backend (scripts/qemu/build-qemu.sh)
+ * writes its trace output to a FIFO that the native trace pump folds into
+ * running aggregates (qj_trace.h). The curated events in [EVENTS_FILE] are
+ * off at launch and only switched on over QMP while someone is looking, so
+ * an untraced VM pays a predicted branch per trace point and nothing more.
+ *
+ * TB flushes have no trace event; they come from the TCG statistics in
+ * x-query-jit, counted from when tracing was switched on.
+ */
+class QemuTrace(private val qemuDir: File) {
+
+    companion object {
+        private const val TAG = "QemuTrace"
+        const val TRACE_FIFO = "trace.fifo"
+        // Installed with a log-backend QEMU; its presence means -trace file= works
+        const val EVENTS_FILE = "trace-events"
+        // x-query-jit lines worth a number in the summary
+        private val JIT_COUNTERS = mapOf(
+            "tbFlushes" to "TB flush count",
+            "tbInvalidations" to "TB invalidate count",
+            "tlbFlushes" to "TLB full flushes"
+        )
+    }
+
+    @Volatile
+    var isEnabled = false
+        private set
+
+    private var pumpRunning = false
+    private var jitBaseline: Map<String, Long> = emptyMap()
+
+    val isSupported: Boolean
+        get() = NativeTransfer.isAvailable && File(qemuDir, EVENTS_FILE).exists()
+
+    /**
+     * Open the FIFO for reading. Must run before QEMU is launched (it opens
+     * the trace file at startup) and again after a reattach, while QEMU
+     * still holds the write end.
+     */
+    fun startPump(): Boolean {
+        if (!isSupported) return false
+        val fifo = File(qemuDir, TRACE_FIFO)
+        try {
+            if (!fifo.exists()) {
+                Os.mkfifo(fifo.absolutePath, "600".toInt(8))
+            }
+        } catch (e: ErrnoException) {
+            Log.w(TAG, "Can't create trace FIFO: ${e.message}")
+            return false
+        }
+        pumpRunning = NativeTransfer.nativeTracePumpStart(fifo.absolutePath)
+        return pumpRunning
+    }
+
+    fun stopPump() {
+        if (NativeTransfer.isAvailable) {
+            NativeTransfer.nativeTracePumpStop()
+        }
+        pumpRunning = false
+        isEnabled = false
+    }
+
+    /** Trace output to the FIFO; nothing if the pump could not start */
+    fun launchArgs(): List<String> {
+        if (!pumpRunning) return emptyList()
+        return listOf(
+            "-msg", "timestamp=on",
+            "-trace", "file=${File(qemuDir, TRACE_FIFO).absolutePath}"
+        )
+    }
+
+    fun events(): List<String> {
+        val file = File(qemuDir, EVENTS_FILE)
+        if (!file.exists()) return emptyList()
+        return file.readLines().map { it.substringBefore('#').trim() }.filter { it.isNotEmpty() }
+    }
+
+    /**
+     * Switch the curated events on or off. Turning them on starts a new
+     * summary window. Events this QEMU doesn't have (kvm_* in a TCG-only
+     * build) are skipped.
+     */
+    fun setEnabled(qmp: QmpClient, enabled: Boolean) {
+        if (!pumpRunning) {
+            throw IllegalStateException("QEMU tracing needs a QEMU built with the log trace backend")
+        }
+        var applied = 0
+        for (name in events()) {
+            try {
+                qmp.execute("trace-event-set-state", JSONObject().put("name", name).put("enable", enabled))
+                applied++
+            } catch (e: IOException) {
+                Log.d(TAG, "Trace event $name not set: ${e.message}")
+            }
+        }
+        if (enabled && applied == 0) {
+            throw IOException("None of the trace events exist in this QEMU")
+        }
+        if (enabled) {
+            NativeTransfer.nativeTraceReset()
+            jitBaseline = jitCounters(qmp)
+        }
+        isEnabled = enabled
+    }
+
+    /** Native summary plus TCG counters since tracing was switched on */
+    fun summary(qmp: QmpClient?): JSONObject {
+        val json = NativeTransfer.nativeTraceSummary()?.let { JSONObject(it) } ?: JSONObject()
+        json.put("supported", isSupported)
+        json.put("enabled", isEnabled)
+        if (isEnabled && qmp != null) {
+            val counters = jitCounters(qmp)
+            if (counters.isNotEmpty()) {
+                val jit = JSONObject()
+                for ((key, value) in counters) {
+                    jit.put(key, value - (jitBaseline[key] ?: 0L))
+                }
+                json.put("jit", jit)
+            }
+        }
+        return json
+    }
+
+    /** Empty under KVM, or on a QEMU without x-query-jit */
+    private fun jitCounters(qmp: QmpClient): Map<String, Long> {
+        val text = try {
+            qmp.execute("x-query-jit").optString("human-readable-text")
+        } catch (e: IOException) {
+            return emptyMap()
+        }
+        val counters = mutableMapOf<String, Long>()
+        for (line in text.lineSequence()) {
+            for ((key, label) in JIT_COUNTERS) {
+                if (line.trimStart().startsWith(label)) {
+                    line.substring(line.indexOf(label) + label.length).trim().toLongOrNull()?.let { counters[key] = it }
+                }
+            }
+        }
+        return counters
+    }
+}
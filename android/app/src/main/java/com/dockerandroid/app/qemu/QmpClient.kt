@@ -0,0 +1,131 @@
+package com.dockerandroid.app.qemu
+
+import android.net.LocalSocket
+import android.net.LocalSocketAddress
+import android.util.Log
+import org.json.JSONArray
+import org.json.JSONObject
+import java.io.BufferedReader
+import java.io.File
+import java.io.IOException
+import java.io.InputStreamReader
+import java.io.OutputStream
+
+/**
+ * Minimal QMP (QEMU Machine Protocol) client over the unix socket created
+ * by `-qmp unix:<path>,server=on,wait=off`.
+ *
+ * QEMU accepts one QMP client per socket at a time, so a client must be
+ * closed before another one (e.g. after a reattach) can connect. Calls
+ * block and must not run on the main thread.
+ */
+class QmpClient private constructor(
+    private val socket: LocalSocket,
+    private val reader: BufferedReader,
+    private val output: OutputStream
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "QmpClient"
+        private const val DEFAULT_TIMEOUT_MS = 5000
+
+        /**
+         * Connect and negotiate capabilities. Throws IOException if QEMU is
+         * not listening or does not answer the greeting.
+         */
+        fun connect(socketFile: File, timeoutMs: Int = DEFAULT_TIMEOUT_MS): QmpClient {
+            val socket = LocalSocket()
+            try {
+                socket.connect(LocalSocketAddress(socketFile.absolutePath, LocalSocketAddress.Namespace.FILESYSTEM))
+                socket.soTimeout = timeoutMs
+                val reader = BufferedReader(InputStreamReader(socket.inputStream, Charsets.UTF_8))
+
+                val client = QmpClient(socket, reader, socket.outputStream)
+                val greeting = client.readMessage()
+                if (!greeting.has("QMP")) {
+                    throw IOException("Unexpected QMP greeting: $greeting")
+                }
+                client.execute("qmp_capabilities")
+                return client
+            } catch (e: Exception) {
+                try { socket.close() } catch (_: IOException) { }
+                throw if (e is IOException) e else IOException("QMP handshake failed: ${e.message}", e)
+            }
+        }
+    }
+
+    /** Asynchronous QMP events seen while waiting for command replies */
+    var onEvent: ((JSONObject) -> Unit)? = null
+
+    /**
+     * Run a command and return its "return" payload. QMP errors are raised
+     * as IOException with the error description; a reply slower than
+     * timeoutMs raises SocketTimeoutException and leaves the stream out of
+     * step, so the client must be reconnected after one.
+     */
+    fun execute(command: String, arguments: JSONObject? = null, timeoutMs: Int? = null): JSONObject {
+        return call(command, arguments, timeoutMs) as? JSONObject ?: JSONObject()
+    }
+
+    /** For commands whose "return" is a list (query-hotpluggable-cpus, query-cpus-fast) */
+    fun executeArray(command: String, arguments: JSONObject? = null): JSONArray {
+        return executeValue(command, arguments) as? JSONArray ?: JSONArray()
+    }
+
+    /** Untyped "return" payload, e.g. the bare number from qom-get */
+    fun executeValue(command: String, arguments: JSONObject? = null): Any? {
+        return call(command, arguments, null)
+    }
+
+    /** Human monitor passthrough for commands without a QMP equivalent (savevm, loadvm) */
+    fun humanMonitorCommand(commandLine: String, timeoutMs: Int? = null): String {
+        val arguments = JSONObject().put("command-line", commandLine)
+        return call("human-monitor-command", arguments, timeoutMs) as? String ?: ""
+    }
+
+    @Synchronized
+    private fun call(command: String, arguments: JSONObject?, timeoutMs: Int?): Any? {
+        val request = JSONObject().put("execute", command)
+        if (arguments != null) {
+            request.put("arguments", arguments)
+        }
+        val defaultTimeout = socket.soTimeout
+        if (timeoutMs != null) {
+            socket.soTimeout = timeoutMs
+        }
+        try {
+            output.write((request.toString() + "\n").toByteArray(Charsets.UTF_8))
+            output.flush()
+
+            while (true) {
+                val message = readMessage()
+                when {
+                    message.has("return") -> return message.get("return")
+                    message.has("error") -> {
+                        val error = message.getJSONObject("error")
+                        throw IOException("QMP $command failed: ${error.optString("desc", error.toString())}")
+                    }
+                    message.has("event") -> onEvent?.invoke(message)
+                    else -> Log.w(TAG, "Ignoring unexpected QMP message: $message")
+                }
+            }
+        } finally {
+            if (timeoutMs != null) {
+                socket.soTimeout = defaultTimeout
+            }
+        }
+    }
+
+    private fun readMessage(): JSONObject {
+        val line = reader.readLine() ?: throw IOException("QMP connection closed")
+        return JSONObject(line)
+    }
+
+    override fun close() {
+        try {
+            socket.close()
+        } catch (e: IOException) {
+            Log.w(TAG, "Error closing QMP socket: ${e.message}")
+        }
+    }
+}
@@ -0,0 +1,58 @@
+package com.dockerandroid.app.qemu
+
+import android.util.Log
+import java.io.File
+import java.io.RandomAccessFile
+
+/**
+ * Optional throwaway virtio disk for write-heavy data that need not
+ * survive: /tmp, BuildKit's cache and volumes created on it.
+ *
+ * A sparse raw file with cache=unsafe, so guest flushes never reach the
+ * device's flash and nothing pays qcow2 metadata updates. That is only
+ * safe because the contents are never reused: the file is recreated
+ * blank for every boot and deleted once QEMU exits, and the guest formats
+ * it without a journal each time (see scratch-disk in alpine-setup.sh).
+ *
+ * A writable raw drive rules out savevm, so while it is attached the
+ * watchdog takes no snapshots and skips its restore step.
+ */
+object ScratchDisk {
+    private const val TAG = "ScratchDisk"
+    const val FILE = "scratch.img"
+    // Read by the guest from /sys/block/vd*/serial
+    const val SERIAL = "scratch"
+    const val DRIVE_ID = "scratch"
+    private const val IOTHREAD_ID = "iothread-scratch"
+    private const val SIZE_MB = 8 * 1024L
+
+    /** A fresh blank image for the next boot */
+    fun recreate(qemuDir: File): File {
+        val file = File(qemuDir, FILE)
+        file.delete()
+        RandomAccessFile(file, "rw").use { it.setLength(SIZE_MB * 1024 * 1024) }
+        Log.d(TAG, "Created ${file.absolutePath} (${SIZE_MB / 1024} GiB sparse)")
+        return file
+    }
+
+    /** Give the space back once the VM that used it is gone */
+    fun delete(qemuDir: File) {
+        File(qemuDir, FILE).delete()
+    }
+
+    fun launchArgs(file: File): List<String> = listOf(
+        "-object", "iothread,id=$IOTHREAD_ID",
+        "-drive", listOf(
+            "file=${file.absolutePath}",
+            "if=none",
+            "id=$DRIVE_ID",
+            "format=raw",
+            // Flushes are dropped: a crash loses the disk, which is wiped anyway
+            "cache=unsafe",
+            "aio=threads",
+            "discard=unmap",
+            "detect-zeroes=unmap"
+        ).joinToString(","),
+        "-device", "virtio-blk-pci,drive=$DRIVE_ID,serial=$SERIAL,iothread=$IOTHREAD_ID"
+    )
+}
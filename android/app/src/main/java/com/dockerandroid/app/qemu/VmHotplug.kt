@@ -0,0 +1,190 @@
+package com.dockerandroid.app.qemu
+
+import android.os.SystemClock
+import android.util.Log
+import org.json.JSONObject
+import java.io.IOException
+
+/**
+ * Live vCPU and memory resizing over QMP.
+ *
+ * VMs are launched with headroom (see [launchArgs]): `-smp maxcpus` for
+ * vCPUs and a virtio-mem device covering maxmem - boot RAM. vCPUs are
+ * plugged with device_add from query-hotpluggable-cpus and unplugged with
+ * device_del; memory is resized by setting the virtio-mem requested-size.
+ * Both need guest cooperation (CPU onlining, virtio_mem driver, movable
+ * memory blocks), so every change is verified and anything that could not
+ * be applied live is reported as needing a restart instead of failing.
+ */
+class VmHotplug(private val qmp: QmpClient) {
+
+    companion object {
+        private const val TAG = "VmHotplug"
+        const val VIRTIO_MEM_ID = "vmem0"
+        private const val VIRTIO_MEM_BACKEND = "vmem-backend0"
+        // Upper bound on vCPU headroom; absent vCPUs only cost ACPI entries
+        private const val MAX_VCPUS = 8
+        private const val MAX_RAM_MB = 8192
+        // virtio-mem block size on x86_64
+        private const val MEM_BLOCK_MB = 2
+        private const val CPU_SETTLE_MS = 5000L
+        private const val MEM_SETTLE_MS = 15_000L
+        private const val POLL_MS = 250L
+
+        fun maxCpusFor(cpuCores: Int, hostCpus: Int): Int =
+            maxOf(cpuCores, minOf(hostCpus, MAX_VCPUS))
+
+        /** Leave a quarter of device RAM to Android; never below the boot size */
+        fun maxRamFor(ramMb: Int, deviceRamMb: Long): Int {
+            val cap = minOf(deviceRamMb * 3 / 4, MAX_RAM_MB.toLong()).toInt()
+            return maxOf(ramMb, cap / 128 * 128)
+        }
+
+        /** -smp/-m arguments with hotplug headroom */
+        fun launchArgs(cpuCores: Int, ramMb: Int, maxCpus: Int, maxRamMb: Int): List<String> {
+            val args = mutableListOf(
+                "-smp", "cpus=$cpuCores,maxcpus=$maxCpus",
+                "-m", if (maxRamMb > ramMb) "${ramMb}M,maxmem=${maxRamMb}M" else "${ramMb}M"
+            )
+            if (maxRamMb > ramMb) {
+                // Starts empty; host pages are only touched once plugged
+                args += listOf(
+                    "-object", "memory-backend-ram,id=$VIRTIO_MEM_BACKEND,size=${maxRamMb - ramMb}M",
+                    "-device", "virtio-mem-pci,id=$VIRTIO_MEM_ID,memdev=$VIRTIO_MEM_BACKEND,requested-size=0"
+                )
+            }
+            return args
+        }
+    }
+
+    data class Result(
+        val cpuCores: Int,
+        val ramMb: Int,
+        // Why part of the request was not applied; empty if it all was
+        val restartReasons: List<String>
+    )
+
+    fun resize(session: VmSession, cpuCores: Int, ramMb: Int): Result {
+        val reasons = mutableListOf<String>()
+        val cpus = try {
+            setCpus(session, cpuCores, reasons)
+        } catch (e: IOException) {
+            reasons.add("vCPU hotplug failed: ${e.message}")
+            onlineCpuCount()
+        }
+        val memory = try {
+            setMemory(session, ramMb, reasons)
+        } catch (e: IOException) {
+            reasons.add("memory hotplug failed: ${e.message}")
+            currentRamMb(session)
+        }
+        return Result(cpus, memory, reasons)
+    }
+
+    // ============== vCPUs ==============
+
+    private fun setCpus(session: VmSession, target: Int, reasons: MutableList<String>): Int {
+        val current = onlineCpuCount()
+        if (target == current) return current
+        if (target > session.maxCpus) {
+            reasons.add("$target vCPUs exceeds the ${session.maxCpus} this VM was started with")
+        }
+        val wanted = target.coerceIn(1, session.maxCpus)
+
+        // Slots in topology order; plugged ones carry a qom-path
+        val hotpluggable = qmp.executeArray("query-hotpluggable-cpus")
+        val slots = (0 until hotpluggable.length()).map { hotpluggable.getJSONObject(it) }
+            .sortedWith(compareBy({ it.topology("socket-id") }, { it.topology("core-id") }, { it.topology("thread-id") }))
+
+        if (wanted > current) {
+            for (slot in slots.filter { !it.has("qom-path") }.take(wanted - current)) {
+                val props = slot.getJSONObject("props")
+                val args = JSONObject()
+                    .put("driver", slot.getString("type"))
+                    .put("id", "vcpu-s${props.optInt("socket-id")}-c${props.optInt("core-id")}-t${props.optInt("thread-id")}")
+                for (key in props.keys()) {
+                    args.put(key, props.get(key))
+                }
+                qmp.execute("device_add", args)
+            }
+        } else if (wanted < current) {
+            // Never the boot processor
+            val plugged = slots.filter { it.has("qom-path") }.drop(1)
+            for (slot in plugged.takeLast(current - wanted).asReversed()) {
+                qmp.execute("device_del", JSONObject().put("id", slot.getString("qom-path")))
+            }
+        }
+
+        // Unplug completes asynchronously once the guest ejects the CPU
+        val deadline = SystemClock.elapsedRealtime() + CPU_SETTLE_MS
+        var count = onlineCpuCount()
+        while (count != wanted && SystemClock.elapsedRealtime() < deadline) {
+            Thread.sleep(POLL_MS)
+            count = onlineCpuCount()
+        }
+        if (count != wanted && wanted == target) {
+            reasons.add("guest kept $count of the requested $target vCPUs")
+        }
+        Log.d(TAG, "vCPUs $current -> $count (wanted $target)")
+        return count
+    }
+
+    private fun onlineCpuCount(): Int = qmp.executeArray("query-cpus-fast").length()
+
+    private fun JSONObject.topology(key: String): Int = getJSONObject("props").optInt(key)
+
+    // ============== Memory ==============
+
+    private fun setMemory(session: VmSession, target: Int, reasons: MutableList<String>): Int {
+        val current = currentRamMb(session)
+        if (target == current) return current
+
+        if (session.maxRamMb <= session.bootRamMb) {
+            reasons.add("this VM was started without memory hotplug headroom")
+            return current
+        }
+        if (target < session.bootRamMb) {
+            reasons.add("cannot shrink below the ${session.bootRamMb} MB boot memory")
+        }
+        if (target > session.maxRamMb) {
+            reasons.add("$target MB exceeds the ${session.maxRamMb} MB maximum")
+        }
+        val wanted = target.coerceIn(session.bootRamMb, session.maxRamMb)
+        val requestedMb = (wanted - session.bootRamMb + MEM_BLOCK_MB - 1) / MEM_BLOCK_MB * MEM_BLOCK_MB
+        val requestedBytes = requestedMb.toLong() * 1024 * 1024
+
+        qmp.execute("qom-set", JSONObject()
+            .put("path", "/machine/peripheral/$VIRTIO_MEM_ID")
+            .put("property", "requested-size")
+            .put("value", requestedBytes))
+
+        // The guest plugs/unplugs blocks at its own pace
+        val deadline = SystemClock.elapsedRealtime() + MEM_SETTLE_MS
+        var plugged = pluggedBytes()
+        while (plugged != requestedBytes && SystemClock.elapsedRealtime() < deadline) {
+            Thread.sleep(POLL_MS)
+            plugged = pluggedBytes()
+        }
+        val result = session.bootRamMb + (plugged / (1024 * 1024)).toInt()
+        if (plugged != requestedBytes && wanted == target) {
+            reasons.add(
+                if (plugged < requestedBytes) "guest only plugged ${result} MB (virtio_mem driver loaded?)"
+                else "guest could not release memory down to $target MB"
+            )
+        }
+        Log.d(TAG, "Memory $current -> $result MB (wanted $target)")
+        return result
+    }
+
+    private fun currentRamMb(session: VmSession): Int {
+        if (session.maxRamMb <= session.bootRamMb) return session.bootRamMb
+        return session.bootRamMb + (pluggedBytes() / (1024 * 1024)).toInt()
+    }
+
+    private fun pluggedBytes(): Long {
+        val size = qmp.executeValue("qom-get", JSONObject()
+            .put("path", "/machine/peripheral/$VIRTIO_MEM_ID")
+            .put("property", "size"))
+        return (size as? Number)?.toLong() ?: throw IOException("qom-get size returned $size")
+    }
+}
@@ -0,0 +1,251 @@
+package com.dockerandroid.app.qemu
+
+import android.system.Os
+import android.system.OsConstants
+import android.util.Log
+import org.json.JSONObject
+import java.io.File
+
+/**
+ * Persistent record of a daemonized QEMU instance.
+ *
+ * QEMU outlives the React context (and the app process, under the
+ * foreground service), so the pid alone is not enough to find it again:
+ * pids are recycled. The session stores the pid together with its kernel
+ * start time (field 22 of /proc/<pid>/stat), which is unique for the
+ * lifetime of the boot.
+ *
+ * ramMb/cpuCores are the current sizes and follow live resizes;
+ * bootRamMb and the max* fields describe the hotplug headroom the
+ * instance was launched with.
+ */
+data class VmSession(
+    val pid: Int,
+    val startTime: Long,
+    val ramMb: Int,
+    val cpuCores: Int,
+    val diskPath: String,
+    val launchedAt: Long,
+    val bootRamMb: Int = ramMb,
+    val maxCpus: Int = cpuCores,
+    val maxRamMb: Int = ramMb,
+    // Requested boot mode, container runtime and scratch disk; kept so a
+    // watchdog restart boots the same way
+    val applianceInit: Boolean = false,
+    val runtime: String = VmSupervisor.RUNTIME_DOCKER,
+    val scratchDisk: Boolean = false
+) {
+    companion object {
+        private const val TAG = "VmSession"
+        private const val SESSION_FILE = "vm-session.json"
+        const val PID_FILE = "qemu.pid"
+        const val QMP_SOCKET = "qmp.sock"
+
+        /** Kernel start time of pid in clock ticks since boot, or null if gone */
+        fun readStartTime(pid: Int): Long? {
+            return try {
+                val stat = File("/proc/$pid/stat").readText()
+                // comm may contain spaces - fields resume after the last ')'
+                val fields = stat.substring(stat.lastIndexOf(')') + 2).split(' ')
+                // fields[0] is field 3 (state), so starttime (22) is fields[19]
+                fields.getOrNull(19)?.toLongOrNull()
+            } catch (e: Exception) {
+                null
+            }
+        }
+
+        fun readPidFile(dir: File): Int? {
+            return try {
+                File(dir, PID_FILE).takeIf { it.exists() }?.readText()?.trim()?.toIntOrNull()
+            } catch (e: Exception) {
+                null
+            }
+        }
+
+        fun load(dir: File): VmSession? {
+            val file = File(dir, SESSION_FILE)
+            if (!file.exists()) return null
+            return try {
+                val json = JSONObject(file.readText())
+                val ramMb = json.optInt("ramMb")
+                val cpuCores = json.optInt("cpuCores")
+                VmSession(
+                    pid = json.getInt("pid"),
+                    startTime = json.getLong("startTime"),
+                    ramMb = ramMb,
+                    cpuCores = cpuCores,
+                    diskPath = json.optString("diskPath"),
+                    launchedAt = json.optLong("launchedAt"),
+                    // Sessions from before hotplug have no headroom
+                    bootRamMb = json.optInt("bootRamMb", ramMb),
+                    maxCpus = json.optInt("maxCpus", cpuCores),
+                    maxRamMb = json.optInt("maxRamMb", ramMb),
+                    applianceInit = json.optBoolean("applianceInit"),
+                    runtime = json.optString("runtime", VmSupervisor.RUNTIME_DOCKER),
+                    scratchDisk = json.optBoolean("scratchDisk")
+                )
+            } catch (e: Exception) {
+                Log.w(TAG, "Discarding unreadable session file: ${e.message}")
+                file.delete()
+                null
+            }
+        }
+
+        /**
+         * Find the live QEMU instance recorded in dir, if any.
+         *
+         * A QEMU named only by the pidfile (the host died between
+         * -daemonize and save()) is adopted from its command line if it
+         * runs diskPath, and stopped otherwise: it holds the image lock
+         * either way. Files are removed only once no QEMU of ours is left,
+         * so the next start is clean.
+         */
+        fun findLive(dir: File, diskPath: String): VmSession? {
+            val session = load(dir)
+            val pid = readPidFile(dir)
+
+            if (session != null && session.isAlive() && (pid == null || pid == session.pid)) {
+                return session
+            }
+
+            val args = pid?.let { readQemuArgs(dir, it) }
+            if (pid == null || args == null) {
+                // The pidfile is stale or its pid was recycled
+                if (session != null && session.isAlive()) return session
+                if (session != null || pid != null) {
+                    Log.d(TAG, "Clearing stale VM session (session pid=${session?.pid}, pidfile=$pid)")
+                }
+                clear(dir)
+                return null
+            }
+
+            // A newer QEMU took over the sockets; the session's can't be reached
+            if (session != null && session.isAlive()) {
+                Log.w(TAG, "Stopping unreachable QEMU pid ${session.pid}")
+                terminate(session.pid, session.startTime)
+            }
+            val adopted = fromArgs(pid, args, diskPath)
+            if (adopted != null) {
+                Log.i(TAG, "Adopting QEMU pid $pid from ${PID_FILE}; its session was never saved")
+                adopted.save(dir)
+                return adopted
+            }
+            Log.w(TAG, "QEMU pid $pid is not running $diskPath, stopping it")
+            val startTime = readStartTime(pid)
+            if (startTime != null && !terminate(pid, startTime)) {
+                throw IllegalStateException("QEMU pid $pid did not exit; not starting another")
+            }
+            clear(dir)
+            return null
+        }
+
+        /** argv of pid if it is a QEMU writing dir's pidfile, else null */
+        private fun readQemuArgs(dir: File, pid: Int): List<String>? {
+            val args = try {
+                File("/proc/$pid/cmdline").readText().split('\u0000').dropLastWhile { it.isEmpty() }
+            } catch (e: Exception) {
+                return null
+            }
+            val pidfile = args.indexOf("-pidfile")
+            val ours = args.firstOrNull()?.substringAfterLast('/')?.startsWith("qemu-system") == true &&
+                pidfile >= 0 && args.getOrNull(pidfile + 1) == File(dir, PID_FILE).absolutePath
+            return args.takeIf { ours }
+        }
+
+        /** Session for a QEMU launched by buildQemuArgs, or null if it isn't running diskPath */
+        private fun fromArgs(pid: Int, args: List<String>, diskPath: String): VmSession? {
+            fun valueOf(option: String) = args.indexOf(option).takeIf { it >= 0 }?.let { args.getOrNull(it + 1) }
+            val drives = args.indices.filter { args[it] == "-drive" }.mapNotNull { args.getOrNull(it + 1) }
+            if (drives.none { it.startsWith("file=$diskPath,") }) return null
+            val startTime = readStartTime(pid) ?: return null
+
+            // -smp cpus=N,maxcpus=M and -m NM[,maxmem=MM] (VmHotplug.launchArgs)
+            val smp = valueOf("-smp").orEmpty().split(',').associate { it.substringBefore('=') to it.substringAfter('=') }
+            val memory = valueOf("-m").orEmpty().split(',')
+            val cpuCores = smp["cpus"]?.toIntOrNull() ?: return null
+            val ramMb = memory[0].removeSuffix("M").toIntOrNull() ?: return null
+            val maxRamMb = memory.getOrNull(1)?.removePrefix("maxmem=")?.removeSuffix("M")?.toIntOrNull() ?: ramMb
+            val cmdline = valueOf("-append").orEmpty()
+            val runtime = when {
+                "${VmSupervisor.RUNTIME_CMDLINE_OPTION}=${VmSupervisor.RUNTIME_LITE}" !in cmdline -> VmSupervisor.RUNTIME_DOCKER
+                VmSupervisor.SNAPSHOTTER_CMDLINE_OPTION in cmdline -> VmSupervisor.RUNTIME_LAZY
+                else -> VmSupervisor.RUNTIME_LITE
+            }
+
+            // Never resized: that needs the session this QEMU never got
+            return VmSession(
+                pid = pid,
+                startTime = startTime,
+                ramMb = ramMb,
+                cpuCores = cpuCores,
+                diskPath = diskPath,
+                launchedAt = launchedAt(startTime),
+                bootRamMb = ramMb,
+                maxCpus = smp["maxcpus"]?.toIntOrNull() ?: cpuCores,
+                maxRamMb = maxRamMb,
+                applianceInit = "init=${VmSupervisor.APPLIANCE_INIT}" in cmdline,
+                runtime = runtime,
+                scratchDisk = drives.any { "id=${ScratchDisk.DRIVE_ID}," in it }
+            )
+        }
+
+        /** Wall-clock time a process started, from its start time in clock ticks */
+        private fun launchedAt(startTime: Long): Long {
+            return try {
+                val uptimeMs = (File("/proc/uptime").readText().substringBefore(' ').toDouble() * 1000).toLong()
+                val startedMs = startTime * 1000 / Os.sysconf(OsConstants._SC_CLK_TCK)
+                System.currentTimeMillis() - (uptimeMs - startedMs)
+            } catch (e: Exception) {
+                System.currentTimeMillis()
+            }
+        }
+
+        /** SIGTERM (QEMU flushes its images), then SIGKILL; true once it is gone */
+        private fun terminate(pid: Int, startTime: Long): Boolean {
+            for (signal in listOf(OsConstants.SIGTERM, OsConstants.SIGKILL)) {
+                try {
+                    Os.kill(pid, signal)
+                } catch (e: Exception) {
+                    Log.w(TAG, "kill($pid) failed: ${e.message}")
+                }
+                for (i in 0 until 30) {
+                    if (readStartTime(pid) != startTime) return true
+                    Thread.sleep(100)
+                }
+            }
+            return readStartTime(pid) != startTime
+        }
+
+        fun clear(dir: File) {
+            File(dir, SESSION_FILE).delete()
+            File(dir, PID_FILE).delete()
+            File(dir, QMP_SOCKET).delete()
+            File(dir, VmWatchdog.HEARTBEAT_SOCKET).delete()
+        }
+    }
+
+    /** True only if pid still refers to the process this session launched */
+    fun isAlive(): Boolean {
+        return readStartTime(pid) == startTime
+    }
+
+    fun save(dir: File) {
+        val json = JSONObject()
+            .put("pid", pid)
+            .put("startTime", startTime)
+            .put("ramMb", ramMb)
+            .put("cpuCores", cpuCores)
+            .put("diskPath", diskPath)
+            .put("launchedAt", launchedAt)
+            .put("bootRamMb", bootRamMb)
+            .put("maxCpus", maxCpus)
+            .put("maxRamMb", maxRamMb)
+            .put("applianceInit", applianceInit)
+            .put("runtime", runtime)
+            .put("scratchDisk", scratchDisk)
+        // Write-then-rename so a crash never leaves a truncated session
+        val tmp = File(dir, "$SESSION_FILE.tmp")
+        tmp.writeText(json.toString())
+        tmp.renameTo(File(dir, SESSION_FILE))
+    }
+}
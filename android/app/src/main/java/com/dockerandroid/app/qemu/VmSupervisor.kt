@@ -0,0 +1,660 @@
+package com.dockerandroid.app.qemu
+
+import android.app.ActivityManager
+import android.content.Context
+import android.system.Os
+import android.system.OsConstants
+import android.util.Log
+import kotlinx.coroutines.*
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import org.json.JSONObject
+import java.io.File
+import java.io.IOException
+import java.net.HttpURLConnection
+import java.net.URL
+
+/**
+ * Owns the QEMU daemon: launch, reattach, QMP, shutdown, liveness, the
+ * hung-guest watchdog, the native log and trace pumps, the stats sampler
+ * and the container log indexer.
+ *
+ * Lives in the :vm process (QemuForegroundService) so JS work in the UI
+ * process can't stall supervision and the VM outlives the UI. The UI reads
+ * logs and stats from the shared rings exposed here.
+ */
+class VmSupervisor(private val context: Context, private val listener: Listener) {
+
+    companion object {
+        private const val TAG = "VmSupervisor"
+
+        // Port forwarding
+        const val DOCKER_API_PORT = 2375
+        const val SSH_PORT = 2222
+        const val WEB_PORT_START = 8080
+
+        // Shared rings read by the UI process
+        private const val LOG_RING_BYTES = 256 * 1024
+        private const val STATS_RING_BYTES = 16 * 1024
+        private const val STATS_INTERVAL_MS = 2000
+        private const val LIVENESS_INTERVAL_MS = 2000L
+
+        // Minimal guest kernel from scripts/kernel, booted directly when present
+        const val GUEST_KERNEL = "vmlinuz"
+        const val GUEST_INITRD = "initramfs"
+        // Everything is built in, so no modules for the initramfs to load; lpj
+        // skips delay-loop calibration, which is slow under TCG.
+        // memhp_default_state onlines memory from a live resize as movable,
+        // whichever init runs, so it can be unplugged again
+        const val GUEST_KERNEL_CMDLINE = "console=ttyS0 quiet lpj=4000000 tsc=reliable no_timer_check mitigations=off memhp_default_state=online_movable modules="
+        // Static PID 1 from guest/appliance-init, installed by alpine-setup.sh
+        const val APPLIANCE_INIT = "/sbin/appliance-init"
+        // Served to the guest by slirp's TFTP server at 10.0.2.2
+        const val GUEST_FILES_DIR = "guest"
+        // Container runtimes: dockerd, or containerd behind guest/docker-shim
+        // for low-RAM devices, optionally pulling images lazily through the
+        // stargz snapshotter. The guest picks one from the kernel command line.
+        const val RUNTIME_DOCKER = "docker"
+        const val RUNTIME_LITE = "lite"
+        const val RUNTIME_LAZY = "lazy"
+        // Also read back from a running QEMU's command line (VmSession.findLive)
+        const val RUNTIME_CMDLINE_OPTION = "appliance.runtime"
+        const val SNAPSHOTTER_CMDLINE_OPTION = "appliance.snapshotter=stargz"
+        const val OS_DISK = "alpine-disk.qcow2"
+        private const val PRE_KERNEL_MAX_MS = 60_000L
+
+        fun qemuDir(context: Context): File {
+            return File(context.filesDir, "qemu").also {
+                if (!it.exists()) it.mkdirs()
+            }
+        }
+
+        fun findQemuBinary(context: Context): File? {
+            // Check in jniLibs
+            val libDir = File(context.applicationInfo.nativeLibraryDir)
+            val binaryNames = listOf(
+                "libqemu-system-x86_64.so",
+                "libqemu.so",
+                "qemu-system-x86_64"
+            )
+
+            for (name in binaryNames) {
+                val binary = File(libDir, name)
+                if (binary.exists() && binary.canExecute()) {
+                    return binary
+                }
+            }
+
+            // Check in assets extracted location
+            val extractedBinary = File(qemuDir(context), "qemu-system-x86_64")
+            if (extractedBinary.exists() && extractedBinary.canExecute()) {
+                return extractedBinary
+            }
+
+            // Check system PATH (for development)
+            val systemPaths = listOf(
+                "/usr/bin/qemu-system-x86_64",
+                "/usr/local/bin/qemu-system-x86_64"
+            )
+            for (path in systemPaths) {
+                val binary = File(path)
+                if (binary.exists() && binary.canExecute()) {
+                    return binary
+                }
+            }
+
+            return null
+        }
+
+        fun checkDockerApi(): Boolean {
+            return try {
+                val url = URL("http://localhost:$DOCKER_API_PORT/_ping")
+                val connection = url.openConnection() as HttpURLConnection
+                connection.requestMethod = "GET"
+                connection.connectTimeout = 2000
+                connection.readTimeout = 2000
+
+                val responseCode = connection.responseCode
+                connection.disconnect()
+
+                responseCode == 200
+            } catch (e: Exception) {
+                false
+            }
+        }
+    }
+
+    interface Listener {
+        fun onStateChanged(state: String)
+        fun onWatchdogIncident(incident: String)
+    }
+
+    private val scope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+    private val qemuDir = qemuDir(context)
+    private val lifecycleLock = Mutex()
+
+    var state: String = QemuModule.VM_STATE_STOPPED
+        private set
+
+    // Daemonized QEMU instance and its control channel; both survive
+    // independently of qemuProcess, which is only the -daemonize launcher
+    private var qemuProcess: Process? = null
+    private var session: VmSession? = null
+    private var qmp: QmpClient? = null
+    private var liveness: Job? = null
+
+    val logRing: NativeTransfer.Ring? = createSharedRing(LOG_RING_BYTES)
+    val statsRing: NativeTransfer.Ring? = createSharedRing(STATS_RING_BYTES)
+
+    val qemuPid: Int get() = session?.pid ?: -1
+
+    // Registry mirror for the guest, reached at 10.0.2.2 through slirp
+    private val blobCache = BlobCacheProxy(File(qemuDir, BlobCacheProxy.CACHE_DIR))
+
+    // QEMU's block/virtio/TCG trace events, off unless someone is looking
+    private val trace = QemuTrace(qemuDir)
+
+    // Every container's logs, searchable across containers
+    private val logIndexer = ContainerLogIndexer(qemuDir)
+
+    val watchdog = VmWatchdog(qemuDir, object : VmWatchdog.Host {
+        override val qmp: QmpClient? get() = this@VmSupervisor.qmp
+        override fun reconnectQmp() = connectQmp()
+        override fun isQemuAlive(): Boolean = this@VmSupervisor.isQemuAlive()
+        override suspend fun restartVm() = restart()
+        override fun onGuestReady(report: String) = recordGuestReady(report)
+        override fun hasScratchDisk(): Boolean = session?.scratchDisk ?: false
+    }) { incident ->
+        listener.onWatchdogIncident(incident.toString())
+    }
+
+    private fun createSharedRing(capacity: Int): NativeTransfer.Ring? {
+        if (!NativeTransfer.isAvailable) return null
+        return try {
+            NativeTransfer.Ring.createShared(capacity)
+        } catch (e: Exception) {
+            // UI falls back to tailing qemu.log itself
+            Log.w(TAG, "Shared ring unavailable: ${e.message}")
+            null
+        }
+    }
+
+    /**
+     * Start a VM, or adopt the one already running. Returns true if a new
+     * QEMU was launched, false if an existing one was reattached.
+     */
+    suspend fun start(
+        ramMb: Int,
+        cpuCores: Int,
+        applianceInit: Boolean,
+        runtime: String,
+        scratchDisk: Boolean
+    ): Boolean = lifecycleLock.withLock {
+        if (state == QemuModule.VM_STATE_RUNNING || state == QemuModule.VM_STATE_STARTING) {
+            throw IllegalStateException("VM is already running or starting")
+        }
+
+        // Never boot a second QEMU against the same disk
+        if (reattachLocked()) {
+            return@withLock false
+        }
+
+        try {
+            launchQemu(ramMb, cpuCores, applianceInit, runtime, scratchDisk)
+        } catch (e: Exception) {
+            updateState(QemuModule.VM_STATE_ERROR)
+            throw e
+        }
+        updateState(QemuModule.VM_STATE_RUNNING)
+        true
+    }
+
+    suspend fun stop() = lifecycleLock.withLock {
+        if (state == QemuModule.VM_STATE_STOPPED && session == null) {
+            return@withLock
+        }
+        watchdog.stop()
+        updateState(QemuModule.VM_STATE_STOPPING)
+        shutdownQemu()
+        updateState(QemuModule.VM_STATE_STOPPED)
+    }
+
+    /**
+     * Adopt a QEMU left running by a previous host process. Returns false
+     * (after clearing stale files) if there is none.
+     */
+    suspend fun reattach(): Boolean = lifecycleLock.withLock {
+        try {
+            state == QemuModule.VM_STATE_RUNNING || reattachLocked()
+        } catch (e: IllegalStateException) {
+            // A QEMU we can neither adopt nor stop; start() reports it
+            Log.e(TAG, "Reattach failed: ${e.message}")
+            false
+        }
+    }
+
+    fun isQemuAlive(): Boolean = session?.isAlive() ?: false
+
+    /**
+     * Resize the running VM through vCPU/virtio-mem hotplug. The session
+     * follows the sizes actually reached, so a later restart keeps them.
+     */
+    suspend fun resize(ramMb: Int, cpuCores: Int): VmHotplug.Result = lifecycleLock.withLock {
+        val current = session
+        val client = qmp
+        if (state != QemuModule.VM_STATE_RUNNING || current == null) {
+            throw IllegalStateException("VM is not running")
+        }
+        if (client == null) {
+            return@withLock VmHotplug.Result(current.cpuCores, current.ramMb, listOf("QMP is not connected"))
+        }
+
+        val result = VmHotplug(client).resize(current, cpuCores, ramMb)
+        session = current.copy(cpuCores = result.cpuCores, ramMb = result.ramMb).also { it.save(qemuDir) }
+        result
+    }
+
+    /**
+     * Switch QEMU's curated trace events on (starting a new summary window)
+     * or off. Returns false if this QEMU can't trace.
+     */
+    suspend fun setQemuTracing(enabled: Boolean): Boolean = lifecycleLock.withLock {
+        if (!trace.isSupported) return@withLock false
+        val client = qmp
+        if (state != QemuModule.VM_STATE_RUNNING || client == null) {
+            throw IllegalStateException("VM is not running")
+        }
+        trace.setEnabled(client, enabled)
+        true
+    }
+
+    /** What the trace events recorded since tracing was switched on */
+    fun qemuTraceSummary(): JSONObject = trace.summary(qmp)
+
+    /** Search the container log index; works while the VM is stopped too */
+    fun searchContainerLogs(query: String, containerId: String?, sinceMs: Long, untilMs: Long, stream: Int, limit: Int): JSONObject =
+        logIndexer.search(query, containerId, sinceMs, untilMs, stream, limit)
+
+    fun logIndexStats(): JSONObject = logIndexer.stats()
+
+    /**
+     * Watchdog's last resort: kill the hung QEMU and boot it again with the
+     * same session parameters
+     */
+    private suspend fun restart() = lifecycleLock.withLock {
+        val previous = session ?: throw IllegalStateException("No VM session to restart")
+        Log.w(TAG, "Restarting QEMU pid ${previous.pid}")
+        shutdownQemu()
+        try {
+            launchQemu(previous.ramMb, previous.cpuCores, previous.applianceInit, previous.runtime, previous.scratchDisk)
+        } catch (e: Exception) {
+            watchdog.stop()
+            updateState(QemuModule.VM_STATE_ERROR)
+            throw e
+        }
+        updateState(QemuModule.VM_STATE_RUNNING)
+    }
+
+    suspend fun waitForDockerApi(timeoutSeconds: Int): Boolean {
+        val startTime = System.currentTimeMillis()
+        val timeoutMs = timeoutSeconds * 1000L
+
+        while (System.currentTimeMillis() - startTime < timeoutMs) {
+            if (!isQemuAlive()) {
+                return false
+            }
+            if (checkDockerApi()) {
+                return true
+            }
+            delay(2000) // Check every 2 seconds
+        }
+        return false
+    }
+
+    fun destroy() {
+        scope.cancel()
+        watchdog.stop()
+        stopProducers()
+        logIndexer.close()
+        // QEMU is deliberately left running; the next host reattaches
+        qmp?.close()
+        qmp = null
+        logRing?.close()
+        statsRing?.close()
+    }
+
+    // ============== Lifecycle (caller holds lifecycleLock) ==============
+
+    /**
+     * Boot a new daemonized QEMU and record its session
+     */
+    private fun launchQemu(ramMb: Int, cpuCores: Int, applianceInit: Boolean, runtime: String, scratchDisk: Boolean) {
+        updateState(QemuModule.VM_STATE_STARTING)
+        Log.d(TAG, "Starting VM with ${ramMb}MB RAM and $cpuCores CPU cores")
+
+        val qemuBinary = findQemuBinary(context)
+        if (qemuBinary == null) {
+            throw Exception("QEMU binary not found. Please install QEMU binary.")
+        }
+
+        val isoFile = File(qemuDir, "alpine-virt.iso")
+        val diskFile = File(qemuDir, OS_DISK)
+
+        if (!isoFile.exists()) {
+            throw Exception("Alpine ISO not found at ${isoFile.absolutePath}")
+        }
+
+        // Headroom for live resizing without a reboot
+        val maxCpus = VmHotplug.maxCpusFor(cpuCores, Runtime.getRuntime().availableProcessors())
+        val maxRamMb = VmHotplug.maxRamFor(ramMb, deviceRamMb())
+
+        // Until the guest has reported appliance-init installed, booting with
+        // init= would leave it without a PID 1; OpenRC installs it first
+        val useAppliance = applianceInit && BootTimes.applianceInstalled(qemuDir)
+        if (applianceInit && !useAppliance) {
+            Log.i(TAG, "appliance-init not installed in the guest yet, booting OpenRC")
+        }
+        if (runtime !in listOf(RUNTIME_DOCKER, RUNTIME_LITE, RUNTIME_LAZY)) {
+            throw IllegalArgumentException("Unknown container runtime: $runtime")
+        }
+        val dataDisk = DataDisk.ensure(qemuDir)
+        // Wiped per boot: whatever the last VM left there is discarded
+        val scratch = if (scratchDisk) ScratchDisk.recreate(qemuDir) else null
+        // QEMU opens its trace file at startup, so the FIFO needs a reader first
+        trace.startPump()
+
+        // Build QEMU command
+        val qemuArgs = buildQemuArgs(
+            qemuBinary = qemuBinary.absolutePath,
+            isoPath = isoFile.absolutePath,
+            diskPath = diskFile.absolutePath,
+            dataDisk = dataDisk,
+            scratchDisk = scratch,
+            ramMb = ramMb,
+            cpuCores = cpuCores,
+            maxCpus = maxCpus,
+            maxRamMb = maxRamMb,
+            applianceInit = useAppliance,
+            runtime = runtime
+        )
+
+        Log.d(TAG, "QEMU command: ${qemuArgs.joinToString(" ")}")
+
+        // Start QEMU process; with -daemonize the launcher exits once the
+        // daemon has written its pidfile and opened the QMP socket
+        File(qemuDir, "qemu.log").delete()
+        val process = ProcessBuilder(qemuArgs)
+            .directory(qemuDir)
+            .redirectErrorStream(true)
+            .start()
+        qemuProcess = process
+
+        val launcherOutput = process.inputStream.bufferedReader().readText()
+        val exitCode = process.waitFor()
+        if (exitCode != 0) {
+            throw Exception("QEMU exited with code $exitCode: ${launcherOutput.trim().take(500)}")
+        }
+
+        val pid = VmSession.readPidFile(qemuDir)
+            ?: throw Exception("QEMU did not write ${VmSession.PID_FILE}")
+        val startTime = VmSession.readStartTime(pid)
+            ?: throw Exception("QEMU (pid $pid) exited during startup")
+
+        session = VmSession(
+            pid = pid,
+            startTime = startTime,
+            ramMb = ramMb,
+            cpuCores = cpuCores,
+            diskPath = diskFile.absolutePath,
+            launchedAt = System.currentTimeMillis(),
+            bootRamMb = ramMb,
+            maxCpus = maxCpus,
+            maxRamMb = maxRamMb,
+            applianceInit = applianceInit,
+            runtime = runtime,
+            scratchDisk = scratchDisk
+        ).also { it.save(qemuDir) }
+        Log.d(TAG, "QEMU daemon running as pid $pid")
+
+        connectQmp()
+        startProducers(pid, 0)
+    }
+
+    private fun reattachLocked(): Boolean {
+        val live = VmSession.findLive(qemuDir, File(qemuDir, OS_DISK).absolutePath) ?: return false
+
+        Log.i(TAG, "Reattaching to QEMU pid ${live.pid}")
+        session = live
+        connectQmp()
+        // A previous host may have left events on; nobody is looking now
+        val client = qmp
+        if (trace.startPump() && client != null) {
+            try {
+                trace.setEnabled(client, false)
+            } catch (e: Exception) {
+                Log.w(TAG, "Failed to reset QEMU trace events: ${e.message}")
+            }
+        }
+
+        // Continue the serial log from where it is now rather than replaying the boot
+        startProducers(live.pid, File(qemuDir, "qemu.log").length())
+        updateState(QemuModule.VM_STATE_RUNNING)
+        return true
+    }
+
+    @Synchronized
+    private fun connectQmp() {
+        qmp?.close()
+        qmp = null
+        val socketFile = File(qemuDir, VmSession.QMP_SOCKET)
+        try {
+            qmp = QmpClient.connect(socketFile).also { client ->
+                val status = client.execute("query-status")
+                Log.d(TAG, "QMP connected, guest status: ${status.optString("status")}")
+            }
+        } catch (e: IOException) {
+            // The VM is still usable without QMP; stop falls back to signals
+            Log.w(TAG, "QMP unavailable: ${e.message}")
+        }
+    }
+
+    /**
+     * ACPI powerdown via QMP, then quit, then SIGKILL as a last resort.
+     * Clears the session once the process is gone.
+     */
+    private suspend fun shutdownQemu() {
+        val current = session
+        val client = qmp
+
+        stopProducers()
+
+        if (client != null) {
+            try {
+                client.execute("system_powerdown")
+                // Wait up to 5 seconds for the guest to power off
+                for (i in 0 until 25) {
+                    if (!isQemuAlive()) break
+                    delay(200)
+                }
+                if (isQemuAlive()) {
+                    client.execute("quit")
+                }
+            } catch (e: IOException) {
+                // quit closes the socket before replying on some versions
+                Log.w(TAG, "Graceful shutdown failed: ${e.message}")
+            }
+        }
+
+        if (current != null) {
+            for (i in 0 until 10) {
+                if (!current.isAlive()) break
+                delay(100)
+            }
+            if (current.isAlive()) {
+                Log.w(TAG, "QEMU pid ${current.pid} did not exit, killing")
+                try {
+                    Os.kill(current.pid, OsConstants.SIGKILL)
+                } catch (e: Exception) {
+                    Log.w(TAG, "kill(${current.pid}) failed: ${e.message}")
+                }
+            }
+        }
+
+        clearSession()
+    }
+
+    private fun clearSession() {
+        qmp?.close()
+        qmp = null
+        qemuProcess = null
+        session = null
+        VmSession.clear(qemuDir)
+        ScratchDisk.delete(qemuDir)
+    }
+
+    // ============== Producers ==============
+
+    private fun startProducers(pid: Int, logOffset: Long) {
+        logRing?.let {
+            NativeTransfer.nativeLogPumpStart(it.id, File(qemuDir, "qemu.log").absolutePath, logOffset)
+        }
+        statsRing?.let {
+            NativeTransfer.nativeStatsStart(it.id, pid, STATS_INTERVAL_MS)
+        }
+
+        // Idempotent, so a watchdog-driven restart keeps the running watchdog
+        watchdog.start()
+        blobCache.start()
+        logIndexer.start(scope)
+
+        liveness?.cancel()
+        liveness = scope.launch {
+            while (isActive) {
+                delay(LIVENESS_INTERVAL_MS)
+                if (!isQemuAlive()) {
+                    onQemuGone()
+                    break
+                }
+            }
+        }
+    }
+
+    private fun stopProducers() {
+        liveness?.cancel()
+        liveness = null
+        blobCache.stop()
+        logIndexer.stop()
+        trace.stopPump()
+        if (NativeTransfer.isAvailable) {
+            NativeTransfer.nativeLogPumpStop()
+            NativeTransfer.nativeStatsStop()
+        }
+    }
+
+    /** QEMU exited without stop() (guest poweroff, crash, OOM kill) */
+    private suspend fun onQemuGone() {
+        lifecycleLock.withLock {
+            if (state != QemuModule.VM_STATE_RUNNING || isQemuAlive()) return
+            Log.w(TAG, "QEMU pid ${session?.pid} exited")
+            watchdog.stop()
+            stopProducers()
+            clearSession()
+            updateState(QemuModule.VM_STATE_STOPPED)
+        }
+    }
+
+    /** "<uptime s> <mode> [flags]" from the guest once Docker answers */
+    private fun recordGuestReady(report: String) {
+        val current = session ?: return
+        val parts = report.split(' ').filter { it.isNotEmpty() }
+        val guestUptimeMs = ((parts.getOrNull(0)?.toDoubleOrNull() ?: return) * 1000).toLong()
+        val mode = parts.getOrNull(1) ?: BootTimes.MODE_OPENRC
+        val hostMs = System.currentTimeMillis() - current.launchedAt
+        // Firmware and kernel decompression precede guest uptime by seconds;
+        // anything else is a guest reset or restore inside an older QEMU
+        if (hostMs - guestUptimeMs !in 0..PRE_KERNEL_MAX_MS) return
+        try {
+            BootTimes.record(qemuDir, mode, hostMs, guestUptimeMs, parts.drop(2))
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to record boot time: ${e.message}")
+        }
+    }
+
+    private fun deviceRamMb(): Long {
+        val memoryInfo = ActivityManager.MemoryInfo()
+        (context.getSystemService(Context.ACTIVITY_SERVICE) as ActivityManager).getMemoryInfo(memoryInfo)
+        return memoryInfo.totalMem / (1024 * 1024)
+    }
+
+    private fun updateState(newState: String) {
+        state = newState
+        listener.onStateChanged(newState)
+    }
+
+    private fun buildQemuArgs(
+        qemuBinary: String,
+        isoPath: String,
+        diskPath: String,
+        dataDisk: File,
+        scratchDisk: File?,
+        ramMb: Int,
+        cpuCores: Int,
+        maxCpus: Int,
+        maxRamMb: Int,
+        applianceInit: Boolean,
+        runtime: String
+    ): List<String> {
+        // Blobs shipped with the slim build (scripts/qemu); otherwise QEMU's own data dir
+        val firmwareDir = File(qemuDir, "firmware")
+        val firmwareArgs = if (firmwareDir.isDirectory) listOf("-L", firmwareDir.absolutePath) else emptyList()
+        // Direct boot skips the ISO bootloader and the stock kernel's probing;
+        // the initramfs still brings up the live system from the ISO
+        val kernel = File(qemuDir, GUEST_KERNEL)
+        val initrd = File(qemuDir, GUEST_INITRD)
+        val bootArgs = if (kernel.exists() && initrd.exists()) {
+            val cmdline = buildString {
+                append(GUEST_KERNEL_CMDLINE)
+                if (applianceInit) append(" init=$APPLIANCE_INIT")
+                if (runtime != RUNTIME_DOCKER) append(" $RUNTIME_CMDLINE_OPTION=$RUNTIME_LITE")
+                if (runtime == RUNTIME_LAZY) append(" $SNAPSHOTTER_CMDLINE_OPTION")
+            }
+            listOf(
+                "-kernel", kernel.absolutePath,
+                "-initrd", initrd.absolutePath,
+                "-append", cmdline
+            )
+        } else {
+            // The ISO's bootloader owns the command line: dockerd it is
+            if (runtime != RUNTIME_DOCKER) {
+                Log.w(TAG, "Lite runtime needs the direct-boot guest kernel, booting with dockerd")
+            }
+            listOf("-boot", "d")
+        }
+        return listOf(
+            qemuBinary,
+            "-machine", "q35",
+            "-cpu", "max"
+        ) + firmwareArgs + VmHotplug.launchArgs(cpuCores, ramMb, maxCpus, maxRamMb) + listOf(
+            "-cdrom", isoPath,
+            "-drive", "file=$diskPath,format=qcow2,if=virtio"
+        ) + DataDisk.launchArgs(dataDisk) + scratchDisk?.let { ScratchDisk.launchArgs(it) }.orEmpty() + bootArgs + listOf(
+            "-netdev", "user,id=net0,tftp=${File(qemuDir, GUEST_FILES_DIR).absolutePath},hostfwd=tcp::$DOCKER_API_PORT-:2375,hostfwd=tcp::$SSH_PORT-:22,hostfwd=tcp::8080-:80,hostfwd=tcp::8081-:8080,hostfwd=tcp::3000-:3000",
+            // No option ROM: only needed for PXE boot, and not shipped with the slim build
+            "-device", "virtio-net-pci,netdev=net0,romfile=",
+            // Guest panics surface as the guest-panicked run state
+            "-device", "pvpanic",
+            // Watchdog heartbeat: guest writes to /dev/virtio-ports/<name>
+            "-device", "virtio-serial-pci",
+            "-chardev", "socket,id=heartbeat,path=${qemuDir.absolutePath}/${VmWatchdog.HEARTBEAT_SOCKET},server=on,wait=off",
+            "-device", "virtserialport,chardev=heartbeat,name=${VmWatchdog.HEARTBEAT_PORT_NAME}",
+            // All-container stats from guest/cgroup-stats, read by the app process
+            "-chardev", "socket,id=stats,path=${qemuDir.absolutePath}/${ContainerStatsStream.STATS_SOCKET},server=on,wait=off",
+            "-device", "virtserialport,chardev=stats,name=${ContainerStatsStream.STATS_PORT_NAME}",
+            "-display", "none",
+            "-daemonize",
+            "-pidfile", "${qemuDir.absolutePath}/${VmSession.PID_FILE}",
+            "-qmp", "unix:${qemuDir.absolutePath}/${VmSession.QMP_SOCKET},server=on,wait=off",
+            "-serial", "file:${qemuDir.absolutePath}/qemu.log"
+        ) + trace.launchArgs()
+    }
+}
@@ -0,0 +1,518 @@
+package com.dockerandroid.app.qemu
+
+import android.net.LocalSocket
+import android.net.LocalSocketAddress
+import android.os.SystemClock
+import android.util.Log
+import kotlinx.coroutines.*
+import org.json.JSONArray
+import org.json.JSONObject
+import java.io.File
+import java.io.IOException
+import java.net.HttpURLConnection
+import java.net.URL
+
+/**
+ * Hung-guest watchdog.
+ *
+ * QEMU staying alive says nothing about the guest: a TCG livelock, a stuck
+ * virtio queue or a deadlocked dockerd all leave the process running. Each
+ * tick combines three probes:
+ *
+ *  - QMP query-status: round-trip latency and run state. A main loop that
+ *    holds the BQL (livelock) stops answering; pvpanic reports panics.
+ *  - Guest heartbeat: a line written to the org.dockerandroid.heartbeat
+ *    virtio-serial port every few seconds by the guest agent.
+ *  - Docker /_ping against a latency SLA.
+ *
+ * The heartbeat and Docker probes only arm once they have succeeded after a
+ * boot, so a guest without the agent or still booting is not "hung".
+ * After [WatchdogConfig.failureThreshold] bad ticks in a row the configured
+ * escalation steps run in order, each followed by a grace period, until the
+ * guest is healthy again. Every incident is appended to incidents.jsonl.
+ */
+class VmWatchdog(
+    private val qemuDir: File,
+    private val host: Host,
+    private val onIncident: (JSONObject) -> Unit
+) {
+
+    companion object {
+        private const val TAG = "VmWatchdog"
+        const val HEARTBEAT_SOCKET = "heartbeat.sock"
+        const val HEARTBEAT_PORT_NAME = "org.dockerandroid.heartbeat"
+        const val SNAPSHOT_TAG = "watchdog-good"
+        private const val CONFIG_FILE = "watchdog.json"
+        private const val STATE_FILE = "watchdog-state.json"
+        private const val INCIDENTS_FILE = "incidents.jsonl"
+        private const val MAX_INCIDENTS_BYTES = 256 * 1024
+        private const val KEEP_INCIDENTS = 200
+        private const val HEARTBEAT_RECONNECT_MS = 2000L
+        private const val SNAPSHOT_TIMEOUT_MS = 120_000
+
+        fun loadConfig(qemuDir: File): WatchdogConfig {
+            val file = File(qemuDir, CONFIG_FILE)
+            return try {
+                if (file.exists()) WatchdogConfig.fromJson(JSONObject(file.readText())) else WatchdogConfig()
+            } catch (e: Exception) {
+                Log.w(TAG, "Ignoring unreadable watchdog config: ${e.message}")
+                WatchdogConfig()
+            }
+        }
+
+        fun saveConfig(qemuDir: File, config: WatchdogConfig) {
+            val tmp = File(qemuDir, "$CONFIG_FILE.tmp")
+            tmp.writeText(config.toJson().toString())
+            tmp.renameTo(File(qemuDir, CONFIG_FILE))
+        }
+
+        /** Most recent incidents first */
+        fun readIncidents(qemuDir: File, limit: Int): JSONArray {
+            val result = JSONArray()
+            val file = File(qemuDir, INCIDENTS_FILE)
+            if (!file.exists()) return result
+            for (line in file.readLines().asReversed()) {
+                if (result.length() >= limit) break
+                try {
+                    result.put(JSONObject(line))
+                } catch (e: Exception) {
+                    // Torn last line after a crash mid-append
+                }
+            }
+            return result
+        }
+    }
+
+    /** Control hooks into the supervisor that owns QEMU */
+    interface Host {
+        val qmp: QmpClient?
+        fun reconnectQmp()
+        fun isQemuAlive(): Boolean
+        /** Kill QEMU and boot it again with the same session parameters */
+        suspend fun restartVm()
+        /** The guest's one-off "ready ..." line, without the keyword */
+        fun onGuestReady(report: String)
+        /**
+         * Whether this boot has the scratch disk: QEMU refuses savevm and
+         * loadvm while a writable raw drive is attached
+         */
+        fun hasScratchDisk(): Boolean
+    }
+
+    data class WatchdogConfig(
+        val enabled: Boolean = true,
+        val intervalMs: Long = 10_000,
+        // query-status slower than this counts as a failed probe
+        val qmpLatencyMs: Int = 3000,
+        val heartbeatTimeoutMs: Long = 30_000,
+        val dockerPingSlaMs: Int = 2000,
+        val failureThreshold: Int = 3,
+        // Time each step gets to bring the guest back, covering a reboot
+        val recoveryGraceMs: Long = 120_000,
+        // savevm pauses the guest while RAM is written; 0 disables snapshots
+        val snapshotIntervalMs: Long = 6 * 60 * 60 * 1000L,
+        // Restore is opt-in: loadvm reverts the data disk along with RAM, so
+        // container data written since the snapshot is lost
+        val escalation: List<String> = listOf(ACTION_NMI, ACTION_RESET, ACTION_RESTART)
+    ) {
+        companion object {
+            const val ACTION_NMI = "nmi"
+            const val ACTION_DUMP = "dump"
+            const val ACTION_RESET = "reset"
+            const val ACTION_RESTORE = "restore"
+            const val ACTION_RESTART = "restart"
+            val ACTIONS = setOf(ACTION_NMI, ACTION_DUMP, ACTION_RESET, ACTION_RESTORE, ACTION_RESTART)
+
+            fun fromJson(json: JSONObject): WatchdogConfig {
+                val defaults = WatchdogConfig()
+                val steps = json.optJSONArray("escalation")?.let { array ->
+                    (0 until array.length()).map { array.getString(it) }.filter { it in ACTIONS }
+                } ?: defaults.escalation
+                return WatchdogConfig(
+                    enabled = json.optBoolean("enabled", defaults.enabled),
+                    intervalMs = json.optLong("intervalMs", defaults.intervalMs).coerceAtLeast(2000),
+                    qmpLatencyMs = json.optInt("qmpLatencyMs", defaults.qmpLatencyMs).coerceIn(100, 30_000),
+                    heartbeatTimeoutMs = json.optLong("heartbeatTimeoutMs", defaults.heartbeatTimeoutMs).coerceAtLeast(5000),
+                    dockerPingSlaMs = json.optInt("dockerPingSlaMs", defaults.dockerPingSlaMs).coerceIn(100, 30_000),
+                    failureThreshold = json.optInt("failureThreshold", defaults.failureThreshold).coerceAtLeast(1),
+                    recoveryGraceMs = json.optLong("recoveryGraceMs", defaults.recoveryGraceMs).coerceAtLeast(10_000),
+                    snapshotIntervalMs = json.optLong("snapshotIntervalMs", defaults.snapshotIntervalMs).coerceAtLeast(0),
+                    escalation = steps
+                )
+            }
+        }
+
+        fun toJson(): JSONObject = JSONObject()
+            .put("enabled", enabled)
+            .put("intervalMs", intervalMs)
+            .put("qmpLatencyMs", qmpLatencyMs)
+            .put("heartbeatTimeoutMs", heartbeatTimeoutMs)
+            .put("dockerPingSlaMs", dockerPingSlaMs)
+            .put("failureThreshold", failureThreshold)
+            .put("recoveryGraceMs", recoveryGraceMs)
+            .put("snapshotIntervalMs", snapshotIntervalMs)
+            .put("escalation", JSONArray(escalation))
+    }
+
+    /** One tick's view of the guest */
+    private class Probe(
+        val qmpStatus: String?,
+        val qmpLatencyMs: Long?,
+        val heartbeatAgeMs: Long?,
+        val dockerPingMs: Long?,
+        val failures: List<String>
+    ) {
+        val healthy get() = failures.isEmpty()
+
+        fun toJson(): JSONObject = JSONObject()
+            .put("qmpStatus", qmpStatus ?: JSONObject.NULL)
+            .put("qmpLatencyMs", qmpLatencyMs ?: JSONObject.NULL)
+            .put("heartbeatAgeMs", heartbeatAgeMs ?: JSONObject.NULL)
+            .put("dockerPingMs", dockerPingMs ?: JSONObject.NULL)
+    }
+
+    @Volatile var config: WatchdogConfig = loadConfig(qemuDir)
+        private set
+
+    private var scope: CoroutineScope? = null
+    // Closed on stop() to unblock the reader
+    @Volatile private var heartbeatSocket: LocalSocket? = null
+
+    // Heartbeat state, written by the reader coroutine
+    @Volatile private var lastBeatAt = 0L
+    @Volatile private var lastBeat: String? = null
+
+    // Probes arm after their first success since boot
+    private var heartbeatArmed = false
+    private var dockerArmed = false
+    private var consecutiveFailures = 0
+    private var lastSnapshotAt = 0L
+
+    fun start() {
+        if (scope != null) return
+        val newScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+        scope = newScope
+        loadState()
+        resetArming()
+        newScope.launch { readHeartbeats() }
+        newScope.launch { monitor() }
+    }
+
+    fun stop() {
+        scope?.cancel()
+        scope = null
+        try { heartbeatSocket?.close() } catch (_: IOException) { }
+    }
+
+    fun updateConfig(newConfig: WatchdogConfig) {
+        config = newConfig
+        saveConfig(qemuDir, newConfig)
+        consecutiveFailures = 0
+    }
+
+    // ============== Monitor loop ==============
+
+    private suspend fun monitor() {
+        while (currentCoroutineContext().isActive) {
+            delay(config.intervalMs)
+            val current = config
+            if (!current.enabled || !host.isQemuAlive()) {
+                consecutiveFailures = 0
+                continue
+            }
+
+            val probe = probe(current)
+            if (probe.healthy) {
+                consecutiveFailures = 0
+                maybeSnapshot(current)
+                continue
+            }
+
+            consecutiveFailures++
+            Log.w(TAG, "Unhealthy ($consecutiveFailures/${current.failureThreshold}): ${probe.failures.joinToString()}")
+            if (consecutiveFailures >= current.failureThreshold) {
+                consecutiveFailures = 0
+                handleIncident(current, probe)
+            }
+        }
+    }
+
+    private fun probe(current: WatchdogConfig): Probe {
+        val failures = mutableListOf<String>()
+
+        // QMP: a timed-out reply leaves the stream out of step, so reconnect
+        var status: String? = null
+        var qmpLatency: Long? = null
+        val client = host.qmp
+        if (client == null) {
+            failures.add("qmp unavailable")
+            host.reconnectQmp()
+        } else {
+            val start = SystemClock.elapsedRealtime()
+            try {
+                status = client.execute("query-status", timeoutMs = current.qmpLatencyMs * 2).optString("status")
+                qmpLatency = SystemClock.elapsedRealtime() - start
+                if (qmpLatency > current.qmpLatencyMs) {
+                    failures.add("qmp latency ${qmpLatency}ms")
+                }
+                // Transient states (save-vm, restore-vm, paused by us) are not failures
+                if (status in setOf("internal-error", "io-error", "guest-panicked", "shutdown")) {
+                    failures.add("guest $status")
+                }
+            } catch (e: IOException) {
+                failures.add("qmp ${e.message}")
+                host.reconnectQmp()
+            }
+        }
+
+        // Heartbeat
+        val beatAt = lastBeatAt
+        val heartbeatAge = if (beatAt > 0) SystemClock.elapsedRealtime() - beatAt else null
+        if (heartbeatAge != null && heartbeatAge < current.heartbeatTimeoutMs) {
+            heartbeatArmed = true
+        } else if (heartbeatArmed) {
+            failures.add("heartbeat stale ${heartbeatAge ?: -1}ms")
+        }
+
+        // Docker ping SLA
+        val pingMs = pingDocker(current.dockerPingSlaMs * 2)
+        if (pingMs != null && pingMs <= current.dockerPingSlaMs) {
+            dockerArmed = true
+        } else if (dockerArmed) {
+            failures.add(if (pingMs == null) "docker ping failed" else "docker ping ${pingMs}ms")
+        }
+
+        return Probe(status, qmpLatency, heartbeatAge, pingMs, failures)
+    }
+
+    private fun pingDocker(timeoutMs: Int): Long? {
+        val start = SystemClock.elapsedRealtime()
+        return try {
+            val connection = URL("http://localhost:${VmSupervisor.DOCKER_API_PORT}/_ping").openConnection() as HttpURLConnection
+            connection.connectTimeout = timeoutMs
+            connection.readTimeout = timeoutMs
+            val ok = connection.responseCode == 200
+            connection.disconnect()
+            if (ok) SystemClock.elapsedRealtime() - start else null
+        } catch (e: Exception) {
+            null
+        }
+    }
+
+    // ============== Escalation ==============
+
+    private suspend fun handleIncident(current: WatchdogConfig, trigger: Probe) {
+        val detectedAt = System.currentTimeMillis()
+        val detectedMono = SystemClock.elapsedRealtime()
+        val steps = JSONArray()
+        var recoveredBy: String? = null
+        var outcome = "unrecovered"
+
+        Log.e(TAG, "Guest hung: ${trigger.failures.joinToString()}; escalating through ${current.escalation}")
+
+        for (action in current.escalation) {
+            if (!host.isQemuAlive() && action != WatchdogConfig.ACTION_RESTART) {
+                outcome = "vm-exited"
+                break
+            }
+
+            val stepStart = SystemClock.elapsedRealtime()
+            val step = JSONObject().put("action", action).put("at", System.currentTimeMillis())
+            try {
+                val skip = skipReason(action)
+                if (skip != null || !runAction(action)) {
+                    steps.put(step.put("skipped", true).put("reason", skip ?: JSONObject.NULL))
+                    continue
+                }
+                step.put("ok", true)
+                if (action == WatchdogConfig.ACTION_RESTORE) {
+                    step.put("revertedTo", lastSnapshotAt)
+                        .put("note", "Container data written after the snapshot was lost")
+                }
+            } catch (e: Exception) {
+                Log.w(TAG, "Watchdog action $action failed: ${e.message}")
+                step.put("ok", false).put("error", e.message ?: e.toString())
+            }
+
+            val recovered = awaitRecovery(current)
+            step.put("recovered", recovered).put("elapsedMs", SystemClock.elapsedRealtime() - stepStart)
+            steps.put(step)
+            if (recovered) {
+                recoveredBy = action
+                outcome = "recovered"
+                break
+            }
+        }
+
+        val incident = JSONObject()
+            .put("id", detectedAt.toString(36))
+            .put("detectedAt", detectedAt)
+            .put("reasons", JSONArray(trigger.failures))
+            .put("probe", trigger.toJson())
+            .put("lastHeartbeat", lastBeat ?: JSONObject.NULL)
+            .put("steps", steps)
+            .put("outcome", outcome)
+            .put("recoveredBy", recoveredBy ?: JSONObject.NULL)
+            .put("durationMs", SystemClock.elapsedRealtime() - detectedMono)
+        appendIncident(incident)
+        onIncident(incident)
+    }
+
+    /** Why a step can't run on this boot, or null if it can */
+    private fun skipReason(action: String): String? = when {
+        action != WatchdogConfig.ACTION_RESTORE -> null
+        host.hasScratchDisk() -> "Scratch disk attached; snapshots are unavailable"
+        lastSnapshotAt == 0L -> "No snapshot yet"
+        else -> null
+    }
+
+    /** Returns false if the step does not apply */
+    private suspend fun runAction(action: String): Boolean {
+        when (action) {
+            WatchdogConfig.ACTION_NMI -> requireQmp().execute("inject-nmi")
+            WatchdogConfig.ACTION_DUMP -> {
+                // Compressed kdump of guest memory in the background; only the latest is kept
+                val dump = File(qemuDir, "guest.kdump")
+                dump.delete()
+                requireQmp().execute("dump-guest-memory", JSONObject()
+                    .put("paging", false)
+                    .put("protocol", "file:${dump.absolutePath}")
+                    .put("detach", true)
+                    .put("format", "kdump-zlib"))
+            }
+            WatchdogConfig.ACTION_RESET -> {
+                requireQmp().execute("system_reset")
+                resetArming()
+            }
+            WatchdogConfig.ACTION_RESTORE -> {
+                // docker-data.qcow2 has the snapshot too and goes back with RAM;
+                // restoring RAM alone would leave the guest's ext4 out of step
+                val output = requireQmp().humanMonitorCommand("loadvm $SNAPSHOT_TAG", SNAPSHOT_TIMEOUT_MS)
+                if (output.isNotBlank()) throw IOException(output.trim())
+                // The restored guest was healthy, but its heartbeat resumes from scratch
+                resetArming()
+            }
+            WatchdogConfig.ACTION_RESTART -> {
+                host.restartVm()
+                resetArming()
+            }
+            else -> return false
+        }
+        return true
+    }
+
+    private fun requireQmp(): QmpClient {
+        host.qmp?.let { return it }
+        host.reconnectQmp()
+        return host.qmp ?: throw IOException("QMP unavailable")
+    }
+
+    /**
+     * Wait up to the grace period for a healthy tick. After reset/restart
+     * the probes are disarmed, so "healthy" there means QMP answering and
+     * the heartbeat or Docker coming back.
+     */
+    private suspend fun awaitRecovery(current: WatchdogConfig): Boolean {
+        val deadline = SystemClock.elapsedRealtime() + current.recoveryGraceMs
+        while (SystemClock.elapsedRealtime() < deadline) {
+            delay(current.intervalMs.coerceAtMost(5000))
+            if (!host.isQemuAlive()) return false
+            val probe = probe(current)
+            if (probe.healthy && (heartbeatArmed || dockerArmed)) return true
+        }
+        return false
+    }
+
+    private fun resetArming() {
+        heartbeatArmed = false
+        dockerArmed = false
+        lastBeatAt = 0L
+    }
+
+    // ============== Snapshots ==============
+
+    private fun maybeSnapshot(current: WatchdogConfig) {
+        if (current.snapshotIntervalMs <= 0 || WatchdogConfig.ACTION_RESTORE !in current.escalation) return
+        // Only snapshot a guest that has proven itself: Docker up since boot
+        if (!dockerArmed || host.hasScratchDisk()) return
+        val now = System.currentTimeMillis()
+        if (now - lastSnapshotAt < current.snapshotIntervalMs) return
+
+        val client = host.qmp ?: return
+        val start = SystemClock.elapsedRealtime()
+        try {
+            // Replaces the previous snapshot with the same tag
+            val output = client.humanMonitorCommand("savevm $SNAPSHOT_TAG", SNAPSHOT_TIMEOUT_MS)
+            if (output.isNotBlank()) throw IOException(output.trim())
+            lastSnapshotAt = now
+            saveState()
+            Log.i(TAG, "Saved snapshot $SNAPSHOT_TAG in ${SystemClock.elapsedRealtime() - start}ms")
+        } catch (e: IOException) {
+            Log.w(TAG, "savevm failed: ${e.message}")
+            host.reconnectQmp()
+            // Don't retry every tick
+            lastSnapshotAt = now - current.snapshotIntervalMs / 2
+        }
+    }
+
+    private fun loadState() {
+        lastSnapshotAt = try {
+            JSONObject(File(qemuDir, STATE_FILE).readText()).optLong("lastSnapshotAt")
+        } catch (e: Exception) {
+            0L
+        }
+    }
+
+    private fun saveState() {
+        File(qemuDir, STATE_FILE).writeText(JSONObject().put("lastSnapshotAt", lastSnapshotAt).toString())
+    }
+
+    // ============== Heartbeat ==============
+
+    /**
+     * Follow the heartbeat chardev. QEMU listens on the socket; the guest
+     * agent writes one line per beat to /dev/virtio-ports/<port name>.
+     */
+    private suspend fun readHeartbeats() {
+        val socketFile = File(qemuDir, HEARTBEAT_SOCKET)
+        while (currentCoroutineContext().isActive) {
+            val socket = LocalSocket()
+            heartbeatSocket = socket
+            try {
+                socket.connect(LocalSocketAddress(socketFile.absolutePath, LocalSocketAddress.Namespace.FILESYSTEM))
+                val reader = socket.inputStream.bufferedReader()
+                while (currentCoroutineContext().isActive) {
+                    val line = reader.readLine() ?: break
+                    lastBeatAt = SystemClock.elapsedRealtime()
+                    if (line.startsWith("ready ")) {
+                        host.onGuestReady(line.removePrefix("ready ").trim())
+                        continue
+                    }
+                    lastBeat = line.take(256)
+                }
+            } catch (e: IOException) {
+                // QEMU not up yet or restarted; keep retrying
+            } finally {
+                try { socket.close() } catch (_: IOException) { }
+            }
+            delay(HEARTBEAT_RECONNECT_MS)
+        }
+    }
+
+    // ============== Incident log ==============
+
+    private fun appendIncident(incident: JSONObject) {
+        val file = File(qemuDir, INCIDENTS_FILE)
+        try {
+            file.appendText(incident.toString() + "\n")
+            if (file.length() > MAX_INCIDENTS_BYTES) {
+                val kept = file.readLines().takeLast(KEEP_INCIDENTS)
+                val tmp = File(qemuDir, "$INCIDENTS_FILE.tmp")
+                tmp.writeText(kept.joinToString("\n", postfix = "\n"))
+                tmp.renameTo(file)
+            }
+        } catch (e: IOException) {
+            Log.w(TAG, "Failed to record incident: ${e.message}")
+        }
+    }
+}
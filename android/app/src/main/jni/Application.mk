@@ -1,6 +0,0 @@
-# Application.mk for QEMU JNI wrapper
-
-APP_ABI := arm64-v8a armeabi-v7a
-APP_PLATFORM := android-24
-APP_STL := c++_shared
-APP_OPTIM := release
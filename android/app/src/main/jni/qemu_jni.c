@@ -1,8 +1,11 @@
 /**
  * QEMU JNI Wrapper for Android
- * 
+ *
  * This provides native methods for controlling QEMU from Java/Kotlin.
  * The actual QEMU binary is loaded separately - this just manages the process.
+ *
+ * Natives are bound with RegisterNatives in JNI_OnLoad (see native_methods
+ * at the bottom of this file) rather than exported under mangled names.
  */
 
 #include <jni.h>
@@ -10,31 +13,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <fcntl.h>
 #include <errno.h>
-#include <android/log.h>
 
-#define LOG_TAG "QemuJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#include "qj_jvm.h"
+#include "qj_log.h"
+#include "qj_transfer.h"
+#include "simd/qj_simd.h"
 
 // QEMU process handle structure
 typedef struct {
     pid_t pid;
     int running;
+    int exit_status;
     char data_dir[512];
     char pid_file[512];
     char log_file[512];
+
+    // Exit watcher - the only thread that reaps pid
+    pthread_t watcher;
+    int watcher_started;
+    pthread_mutex_t lock;
+    pthread_cond_t exited;
 } QemuHandle;
 
 // Global handles storage (simple approach - max 4 concurrent VMs)
 #define MAX_HANDLES 4
 static QemuHandle* handles[MAX_HANDLES] = {NULL};
 
+// Load-time measurements, reported through nativeGetLoadTimeNanos
+static jlong onload_nanos = 0;
+
+static jlong monotonic_nanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jlong)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 static QemuHandle* get_handle(jlong handle_id) {
     if (handle_id >= 0 && handle_id < MAX_HANDLES) {
         return handles[handle_id];
@@ -47,6 +67,12 @@ static jlong allocate_handle() {
         if (handles[i] == NULL) {
             handles[i] = (QemuHandle*)calloc(1, sizeof(QemuHandle));
             if (handles[i]) {
+                pthread_condattr_t attr;
+                pthread_condattr_init(&attr);
+                pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+                pthread_cond_init(&handles[i]->exited, &attr);
+                pthread_condattr_destroy(&attr);
+                pthread_mutex_init(&handles[i]->lock, NULL);
                 return (jlong)i;
             }
         }
@@ -56,16 +82,87 @@ static jlong allocate_handle() {
 
 static void free_handle(jlong handle_id) {
     if (handle_id >= 0 && handle_id < MAX_HANDLES && handles[handle_id]) {
+        pthread_cond_destroy(&handles[handle_id]->exited);
+        pthread_mutex_destroy(&handles[handle_id]->lock);
         free(handles[handle_id]);
         handles[handle_id] = NULL;
     }
 }
 
+static int handle_is_running(QemuHandle *handle) {
+    pthread_mutex_lock(&handle->lock);
+    int running = handle->running;
+    pthread_mutex_unlock(&handle->lock);
+    return running;
+}
+
+/**
+ * Wait until the watcher has reaped the process, up to timeout_ms.
+ * Returns 1 if the process has exited.
+ */
+static int wait_for_exit(QemuHandle *handle, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&handle->lock);
+    while (handle->running) {
+        if (pthread_cond_timedwait(&handle->exited, &handle->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    int exited = !handle->running;
+    pthread_mutex_unlock(&handle->lock);
+    return exited;
+}
+
+/**
+ * Kill the process (if still running) and join its watcher
+ */
+static void terminate_handle(QemuHandle *handle) {
+    if (handle_is_running(handle)) {
+        kill(handle->pid, SIGKILL);
+    }
+    if (handle->watcher_started) {
+        pthread_join(handle->watcher, NULL);
+        handle->watcher_started = 0;
+    }
+}
+
+/**
+ * Blocks in waitpid for the QEMU child and records its exit status.
+ * Callers observe the exit through nativeGetStatus / wait_for_exit.
+ */
+static void *exit_watcher(void *arg) {
+    QemuHandle *handle = (QemuHandle *)arg;
+    int status = 0;
+
+    while (waitpid(handle->pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    int code = WIFEXITED(status) ? WEXITSTATUS(status)
+             : WIFSIGNALED(status) ? 128 + WTERMSIG(status)
+             : -1;
+
+    pthread_mutex_lock(&handle->lock);
+    handle->running = 0;
+    handle->exit_status = code;
+    pthread_cond_broadcast(&handle->exited);
+    pthread_mutex_unlock(&handle->lock);
+
+    LOGI("QEMU PID %d exited with status %d", handle->pid, code);
+    return NULL;
+}
+
 /**
  * Initialize QEMU environment
  */
-JNIEXPORT jboolean JNICALL
-Java_com_dockerandroid_app_qemu_QemuModule_nativeInit(
+static jboolean native_init(
     JNIEnv *env,
     jobject thiz,
     jstring data_dir
@@ -92,8 +189,7 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeInit(
 /**
  * Create a QCOW2 disk image
  */
-JNIEXPORT jboolean JNICALL
-Java_com_dockerandroid_app_qemu_QemuModule_nativeCreateDisk(
+static jboolean native_create_disk(
     JNIEnv *env,
     jobject thiz,
     jstring path,
@@ -122,13 +218,13 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeCreateDisk(
     header[1] = 'F';
     header[2] = 'I';
     header[3] = 0xFB;
-    
+
     // Version: 3
     header[4] = 0;
     header[5] = 0;
     header[6] = 0;
     header[7] = 3;
-    
+
     // Size in bytes (big endian)
     uint64_t size_bytes = (uint64_t)size_mb * 1024 * 1024;
     for (int i = 0; i < 8; i++) {
@@ -152,8 +248,7 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeCreateDisk(
 /**
  * Start QEMU process
  */
-JNIEXPORT jlong JNICALL
-Java_com_dockerandroid_app_qemu_QemuModule_nativeStart(
+static jlong native_start(
     JNIEnv *env,
     jobject thiz,
     jstring qemu_binary,
@@ -163,6 +258,7 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStart(
     jint cpu_cores,
     jstring ports
 ) {
+    jlong handle_id = -1;
     const char *binary = (*env)->GetStringUTFChars(env, qemu_binary, NULL);
     const char *iso = (*env)->GetStringUTFChars(env, iso_path, NULL);
     const char *disk = (*env)->GetStringUTFChars(env, disk_path, NULL);
@@ -177,24 +273,24 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStart(
          binary, iso, disk, ram_mb, cpu_cores);
 
     // Allocate handle
-    jlong handle_id = allocate_handle();
+    handle_id = allocate_handle();
     if (handle_id < 0) {
         LOGE("No free handle slots available");
         goto cleanup;
     }
 
     QemuHandle *handle = handles[handle_id];
-    
+
     // Fork and exec QEMU
     pid_t pid = fork();
-    
+
     if (pid < 0) {
         LOGE("Fork failed: %s", strerror(errno));
         free_handle(handle_id);
         handle_id = -1;
         goto cleanup;
     }
-    
+
     if (pid == 0) {
         // Child process - exec QEMU
         char ram_arg[32];
@@ -207,6 +303,10 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStart(
         snprintf(netdev_arg, sizeof(netdev_arg),
             "user,id=net0,%s", port_str);
 
+        char drive_arg[600];
+        snprintf(drive_arg, sizeof(drive_arg),
+            "file=%s,format=qcow2,if=virtio", disk);
+
         // Execute QEMU
         execlp(binary, binary,
             "-machine", "q35",
@@ -214,7 +314,7 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStart(
             "-smp", smp_arg,
             "-m", ram_arg,
             "-cdrom", iso,
-            "-drive", "file=%s,format=qcow2,if=virtio",
+            "-drive", drive_arg,
             "-boot", "d",
             "-netdev", netdev_arg,
             "-device", "virtio-net-pci,netdev=net0",
@@ -226,10 +326,22 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStart(
         LOGE("Exec failed: %s", strerror(errno));
         _exit(1);
     }
-    
+
     // Parent process
     handle->pid = pid;
     handle->running = 1;
+
+    if (pthread_create(&handle->watcher, NULL, exit_watcher, handle) == 0) {
+        handle->watcher_started = 1;
+    } else {
+        LOGE("Failed to start exit watcher: %s", strerror(errno));
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        free_handle(handle_id);
+        handle_id = -1;
+        goto cleanup;
+    }
+
     LOGI("QEMU started with PID: %d", pid);
 
 cleanup:
@@ -237,15 +349,14 @@ cleanup:
     if (iso) (*env)->ReleaseStringUTFChars(env, iso_path, iso);
     if (disk) (*env)->ReleaseStringUTFChars(env, disk_path, disk);
     if (port_str) (*env)->ReleaseStringUTFChars(env, ports, port_str);
-    
+
     return handle_id;
 }
 
 /**
  * Stop QEMU process
  */
-JNIEXPORT jboolean JNICALL
-Java_com_dockerandroid_app_qemu_QemuModule_nativeStop(
+static jboolean native_stop(
     JNIEnv *env,
     jobject thiz,
     jlong handle_id
@@ -256,33 +367,23 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStop(
         return JNI_FALSE;
     }
 
-    if (!handle->running) {
+    if (!handle_is_running(handle)) {
         LOGI("QEMU not running");
         return JNI_TRUE;
     }
 
     LOGI("Stopping QEMU PID: %d", handle->pid);
 
-    // Try SIGTERM first
-    if (kill(handle->pid, SIGTERM) == 0) {
-        // Wait up to 5 seconds for graceful shutdown
-        int status;
-        for (int i = 0; i < 50; i++) {
-            pid_t result = waitpid(handle->pid, &status, WNOHANG);
-            if (result == handle->pid) {
-                LOGI("QEMU exited gracefully");
-                handle->running = 0;
-                return JNI_TRUE;
-            }
-            usleep(100000); // 100ms
-        }
+    // Try SIGTERM first, then wait up to 5 seconds for graceful shutdown
+    if (kill(handle->pid, SIGTERM) == 0 && wait_for_exit(handle, 5000)) {
+        LOGI("QEMU exited gracefully");
+        return JNI_TRUE;
     }
 
     // Force kill
     LOGI("Force killing QEMU");
     kill(handle->pid, SIGKILL);
-    waitpid(handle->pid, NULL, 0);
-    handle->running = 0;
+    wait_for_exit(handle, 5000);
 
     return JNI_TRUE;
 }
@@ -291,8 +392,7 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeStop(
  * Get QEMU status
  * Returns: 0 = stopped, 1 = running, -1 = error
  */
-JNIEXPORT jint JNICALL
-Java_com_dockerandroid_app_qemu_QemuModule_nativeGetStatus(
+static jint native_get_status(
     JNIEnv *env,
     jobject thiz,
     jlong handle_id
@@ -302,32 +402,14 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeGetStatus(
         return -1;
     }
 
-    if (!handle->running) {
-        return 0;
-    }
-
-    // Check if process is still running
-    int status;
-    pid_t result = waitpid(handle->pid, &status, WNOHANG);
-    
-    if (result == 0) {
-        // Still running
-        return 1;
-    } else if (result == handle->pid) {
-        // Process exited
-        handle->running = 0;
-        return 0;
-    } else {
-        // Error
-        return -1;
-    }
+    // The exit watcher reaps the child, so this is just a flag read
+    return handle_is_running(handle) ? 1 : 0;
 }
 
 /**
  * Cleanup QEMU handle
  */
-JNIEXPORT void JNICALL
-Java_com_dockerandroid_app_qemu_QemuModule_nativeCleanup(
+static void native_cleanup(
     JNIEnv *env,
     jobject thiz,
     jlong handle_id
@@ -337,21 +419,79 @@ Java_com_dockerandroid_app_qemu_QemuModule_nativeCleanup(
         return;
     }
 
-    // Make sure QEMU is stopped
-    if (handle->running) {
-        kill(handle->pid, SIGKILL);
-        waitpid(handle->pid, NULL, 0);
-    }
+    // Make sure QEMU is stopped and reaped
+    terminate_handle(handle);
 
     free_handle(handle_id);
     LOGI("Handle %ld cleaned up", (long)handle_id);
 }
 
+/**
+ * Empty call used to measure per-call JNI overhead from Kotlin
+ */
+static jint native_noop(
+    JNIEnv *env,
+    jobject thiz
+) {
+    return 0;
+}
+
+/**
+ * Time spent in JNI_OnLoad (ID caching + registration), in nanoseconds
+ */
+static jlong native_get_load_time_nanos(
+    JNIEnv *env,
+    jobject thiz
+) {
+    return onload_nanos;
+}
+
+// Must match the external declarations in QemuModule.kt
+static const JNINativeMethod native_methods[] = {
+    { "nativeInit", "(Ljava/lang/String;)Z", (void *)native_init },
+    { "nativeCreateDisk", "(Ljava/lang/String;I)Z", (void *)native_create_disk },
+    { "nativeStart",
+      "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;IILjava/lang/String;)J",
+      (void *)native_start },
+    { "nativeStop", "(J)Z", (void *)native_stop },
+    { "nativeGetStatus", "(J)I", (void *)native_get_status },
+    { "nativeCleanup", "(J)V", (void *)native_cleanup },
+    { "nativeNoop", "()I", (void *)native_noop },
+    { "nativeGetLoadTimeNanos", "()J", (void *)native_get_load_time_nanos },
+};
+
 /**
  * JNI_OnLoad - called when library is loaded
  */
 JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void *reserved) {
-    LOGI("QEMU JNI library loaded");
+    jlong start = monotonic_nanos();
+    JNIEnv *env = NULL;
+
+    if ((*vm)->GetEnv(vm, (void **)&env, JNI_VERSION_1_6) != JNI_OK) {
+        LOGE("GetEnv failed");
+        return JNI_ERR;
+    }
+
+    if (qj_jvm_init(vm, env) != JNI_OK) {
+        LOGE("Failed to resolve cached JNI IDs");
+        return JNI_ERR;
+    }
+
+    jint count = (jint)(sizeof(native_methods) / sizeof(native_methods[0]));
+    if ((*env)->RegisterNatives(env, qj_cache.module_class, native_methods, count) != JNI_OK) {
+        qj_jvm_check_exception(env, "RegisterNatives");
+        LOGE("Failed to register native methods");
+        return JNI_ERR;
+    }
+
+    if (qj_transfer_register(env) != JNI_OK) {
+        LOGE("Failed to register transfer methods");
+        return JNI_ERR;
+    }
+
+    onload_nanos = monotonic_nanos() - start;
+    LOGI("QEMU JNI library loaded (kernels: %s, %d natives in %lld us)",
+         qj_kernels()->name, count, (long long)(onload_nanos / 1000));
     return JNI_VERSION_1_6;
 }
 
@@ -360,15 +500,19 @@ JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void *reserved) {
  */
 JNIEXPORT void JNI_OnUnload(JavaVM *vm, void *reserved) {
     LOGI("QEMU JNI library unloading");
-    
+
+    qj_transfer_shutdown();
+
     // Cleanup all handles
     for (int i = 0; i < MAX_HANDLES; i++) {
         if (handles[i]) {
-            if (handles[i]->running) {
-                kill(handles[i]->pid, SIGKILL);
-            }
-            free(handles[i]);
-            handles[i] = NULL;
+            terminate_handle(handles[i]);
+            free_handle(i);
         }
     }
+
+    JNIEnv *env = NULL;
+    if ((*vm)->GetEnv(vm, (void **)&env, JNI_VERSION_1_6) == JNI_OK) {
+        qj_jvm_shutdown(env);
+    }
 }
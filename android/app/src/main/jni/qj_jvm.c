@@ -0,0 +1,46 @@
+/**
+ * Cached JNI references
+ */
+
+#include "qj_jvm.h"
+#include "qj_log.h"
+
+#include <stddef.h>
+
+#define MODULE_CLASS "com/dockerandroid/app/qemu/QemuModule"
+
+QjJniCache qj_cache;
+
+jint qj_jvm_init(JavaVM *vm, JNIEnv *env) {
+    (void)vm;
+
+    jclass local = (*env)->FindClass(env, MODULE_CLASS);
+    if (!local) {
+        qj_jvm_check_exception(env, "FindClass " MODULE_CLASS);
+        return JNI_ERR;
+    }
+    qj_cache.module_class = (jclass)(*env)->NewGlobalRef(env, local);
+    (*env)->DeleteLocalRef(env, local);
+    if (!qj_cache.module_class) {
+        return JNI_ENOMEM;
+    }
+
+    return JNI_OK;
+}
+
+void qj_jvm_shutdown(JNIEnv *env) {
+    if (qj_cache.module_class) {
+        (*env)->DeleteGlobalRef(env, qj_cache.module_class);
+    }
+    qj_cache.module_class = NULL;
+}
+
+int qj_jvm_check_exception(JNIEnv *env, const char *where) {
+    if (!(*env)->ExceptionCheck(env)) {
+        return 0;
+    }
+    LOGE("Java exception in %s", where);
+    (*env)->ExceptionDescribe(env);
+    (*env)->ExceptionClear(env);
+    return 1;
+}
@@ -0,0 +1,36 @@
+/**
+ * Cached JNI references
+ *
+ * Holds the class references resolved once in JNI_OnLoad, so registration
+ * and later lookups never go through FindClass again.
+ */
+
+#ifndef QJ_JVM_H
+#define QJ_JVM_H
+
+#include <jni.h>
+
+// IDs resolved once at load time - valid for the lifetime of the library
+typedef struct {
+    jclass module_class;           // global ref: com.dockerandroid.app.qemu.QemuModule
+} QjJniCache;
+
+extern QjJniCache qj_cache;
+
+/**
+ * Resolve cached references. Called from JNI_OnLoad.
+ * Returns JNI_OK or a negative JNI error code.
+ */
+jint qj_jvm_init(JavaVM *vm, JNIEnv *env);
+
+/**
+ * Release global refs. Called from JNI_OnUnload.
+ */
+void qj_jvm_shutdown(JNIEnv *env);
+
+/**
+ * Clears any pending exception, logging it. Returns 1 if one was pending.
+ */
+int qj_jvm_check_exception(JNIEnv *env, const char *where);
+
+#endif // QJ_JVM_H
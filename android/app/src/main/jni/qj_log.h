@@ -0,0 +1,16 @@
+/**
+ * Logging macros shared by the JNI sources
+ */
+
+#ifndef QJ_LOG_H
+#define QJ_LOG_H
+
+#include <android/log.h>
+
+#define LOG_TAG "QemuJNI"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+#endif // QJ_LOG_H
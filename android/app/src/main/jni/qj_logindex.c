@@ -0,0 +1,1175 @@
+/**
+ * Container log index
+ */
+
+#include "qj_logindex.h"
+#include "qj_ring.h"
+#include "simd/qj_simd.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define BLOCK_BYTES (64 * 1024)
+#define BLOOM_BYTES 4096
+#define BLOOM_SHIFT 17                  // 32-bit hash -> bit in BLOOM_BYTES * 8
+#define PARTITION_NS (3600LL * 1000000000LL)
+#define MAX_LINE_BYTES (16 * 1024)
+#define RECORD_HEADER 12                // ts_ns(8) stream(1) pad(1) len(2)
+#define RESULT_LINE_BYTES 1024
+#define MAX_LIMIT 1000
+#define MAX_QUERY_BYTES 256
+#define ID_LEN 12
+#define NAME_BYTES 128
+#define BLOCK_MAGIC 0x424c4a51u         // "QJLB"
+
+/* On-disk block header, followed by the filter and the deflated records */
+typedef struct {
+    uint32_t magic;
+    uint32_t raw_bytes;
+    uint32_t packed_bytes;
+    uint32_t lines;
+    int64_t first_ns;
+    int64_t last_ns;
+    uint32_t crc;                       // CRC-32C of filter and packed records
+    uint32_t reserved;
+} BlockHeader;
+
+#define BLOCK_OVERHEAD (sizeof(BlockHeader) + BLOOM_BYTES)
+
+typedef struct {
+    uint64_t offset;                    // of the header in the segment file
+    uint32_t raw_bytes;
+    uint32_t packed_bytes;
+    uint32_t lines;
+    int64_t first_ns;
+    int64_t last_ns;
+} Block;
+
+typedef struct {
+    int64_t hour;                       // ts / PARTITION_NS
+    uint64_t bytes;
+    int64_t last_ns;
+    Block *blocks;
+    size_t count;
+    size_t cap;
+} Segment;
+
+typedef struct {
+    char id[ID_LEN + 1];
+    char name[NAME_BYTES];
+    Segment *segments;                  // ascending hour
+    size_t segment_count;
+    size_t segment_cap;
+    int64_t sealed_ns;                  // newest line on disk
+    int64_t last_ns;                    // newest line accepted
+
+    // Open block
+    unsigned char *raw;                 // BLOCK_BYTES once the first line arrives
+    uint32_t raw_bytes;
+    uint32_t lines;
+    int64_t first_ns;
+    int64_t block_last_ns;
+    int64_t hour;
+    unsigned char bloom[BLOOM_BYTES];
+
+    // Follow stream parser
+    unsigned char frame_header[8];
+    size_t header_len;
+    uint32_t frame_left;
+    int frame_stream;
+    char partial[MAX_LINE_BYTES];
+    size_t partial_len;
+    int partial_stream;
+} Container;
+
+struct QjLogIndex {
+    pthread_mutex_t lock;
+    char dir[PATH_MAX - 64];            // room for /<id>/<hour>.seg
+    uint64_t max_bytes;
+    int64_t max_age_ms;
+    uint64_t total_bytes;
+    Container **containers;
+    size_t container_count;
+    size_t container_cap;
+    unsigned char *packed;              // deflate output, compressBound(BLOCK_BYTES)
+    size_t packed_size;
+};
+
+static unsigned char fold[256];
+static pthread_once_t fold_once = PTHREAD_ONCE_INIT;
+
+static void init_fold(void) {
+    for (int i = 0; i < 256; i++) {
+        fold[i] = (unsigned char)(i >= 'A' && i <= 'Z' ? i + ('a' - 'A') : i);
+    }
+}
+
+static int64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int64_t hour_of(int64_t ts_ns) {
+    return ts_ns >= 0 ? ts_ns / PARTITION_NS : (ts_ns - PARTITION_NS + 1) / PARTITION_NS;
+}
+
+// ============== Trigram filter ==============
+
+static inline uint32_t trigram(const unsigned char *s) {
+    return (uint32_t)fold[s[0]] << 16 | (uint32_t)fold[s[1]] << 8 | fold[s[2]];
+}
+
+static inline uint32_t bloom_bit1(uint32_t t) {
+    return (t * 2654435761u) >> BLOOM_SHIFT;
+}
+
+static inline uint32_t bloom_bit2(uint32_t t) {
+    return ((t ^ 0x5bd1e995u) * 0x85ebca6bu) >> BLOOM_SHIFT;
+}
+
+static void bloom_add(unsigned char *bloom, const unsigned char *s, size_t n) {
+    for (size_t i = 0; i + 3 <= n; i++) {
+        uint32_t t = trigram(s + i);
+        uint32_t a = bloom_bit1(t), b = bloom_bit2(t);
+        bloom[a >> 3] |= (unsigned char)(1u << (a & 7));
+        bloom[b >> 3] |= (unsigned char)(1u << (b & 7));
+    }
+}
+
+static int bloom_has_all(const unsigned char *bloom, const uint32_t *trigrams, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = bloom_bit1(trigrams[i]), b = bloom_bit2(trigrams[i]);
+        if (!(bloom[a >> 3] & (1u << (a & 7))) || !(bloom[b >> 3] & (1u << (b & 7)))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Case-folded substring search; needle is already folded */
+static int contains_folded(const unsigned char *h, size_t hn, const unsigned char *needle, size_t nn) {
+    if (nn == 0) {
+        return 1;
+    }
+    for (size_t i = 0; i + nn <= hn; i++) {
+        if (fold[h[i]] != needle[0]) {
+            continue;
+        }
+        size_t k = 1;
+        while (k < nn && fold[h[i + k]] == needle[k]) {
+            k++;
+        }
+        if (k == nn) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// ============== Containers and segments ==============
+
+static int valid_id(const char *id) {
+    for (int i = 0; i < ID_LEN; i++) {
+        char c = id[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Looks a container up by (at least) its short id, creating it if asked */
+static Container *container_get(QjLogIndex *ix, const char *id, int create) {
+    if (!id || strlen(id) < ID_LEN || !valid_id(id)) {
+        return NULL;
+    }
+    for (size_t i = 0; i < ix->container_count; i++) {
+        if (memcmp(ix->containers[i]->id, id, ID_LEN) == 0) {
+            return ix->containers[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    if (ix->container_count == ix->container_cap) {
+        size_t cap = ix->container_cap ? ix->container_cap * 2 : 16;
+        Container **grown = (Container **)realloc(ix->containers, cap * sizeof(*grown));
+        if (!grown) {
+            return NULL;
+        }
+        ix->containers = grown;
+        ix->container_cap = cap;
+    }
+    Container *c = (Container *)calloc(1, sizeof(Container));
+    if (!c) {
+        return NULL;
+    }
+    memcpy(c->id, id, ID_LEN);
+    ix->containers[ix->container_count++] = c;
+    return c;
+}
+
+static Segment *segment_get(Container *c, int64_t hour) {
+    size_t at = c->segment_count;
+    for (size_t i = 0; i < c->segment_count; i++) {
+        if (c->segments[i].hour == hour) {
+            return &c->segments[i];
+        }
+        if (c->segments[i].hour > hour) {
+            at = i;
+            break;
+        }
+    }
+    if (c->segment_count == c->segment_cap) {
+        size_t cap = c->segment_cap ? c->segment_cap * 2 : 8;
+        Segment *grown = (Segment *)realloc(c->segments, cap * sizeof(*grown));
+        if (!grown) {
+            return NULL;
+        }
+        c->segments = grown;
+        c->segment_cap = cap;
+    }
+    memmove(&c->segments[at + 1], &c->segments[at], (c->segment_count - at) * sizeof(Segment));
+    memset(&c->segments[at], 0, sizeof(Segment));
+    c->segments[at].hour = hour;
+    c->segment_count++;
+    return &c->segments[at];
+}
+
+static int segment_push(Segment *s, const Block *b) {
+    if (s->count == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 64;
+        Block *grown = (Block *)realloc(s->blocks, cap * sizeof(*grown));
+        if (!grown) {
+            return -ENOMEM;
+        }
+        s->blocks = grown;
+        s->cap = cap;
+    }
+    s->blocks[s->count++] = *b;
+    s->bytes += BLOCK_OVERHEAD + b->packed_bytes;
+    if (b->last_ns > s->last_ns) {
+        s->last_ns = b->last_ns;
+    }
+    return 0;
+}
+
+static void segment_path(const QjLogIndex *ix, const Container *c, int64_t hour, char *path, size_t size) {
+    snprintf(path, size, "%s/%s/%lld.seg", ix->dir, c->id, (long long)(hour * 3600));
+}
+
+static void segment_delete(QjLogIndex *ix, Container *c, size_t i) {
+    char path[PATH_MAX];
+    segment_path(ix, c, c->segments[i].hour, path, sizeof(path));
+    unlink(path);
+    ix->total_bytes -= c->segments[i].bytes;
+    free(c->segments[i].blocks);
+    memmove(&c->segments[i], &c->segments[i + 1], (c->segment_count - i - 1) * sizeof(Segment));
+    c->segment_count--;
+    if (c->segment_count == 0 && c->lines == 0) {
+        // Nothing left; the directory comes back with the next block
+        char dir[PATH_MAX];
+        snprintf(dir, sizeof(dir), "%s/%s/name", ix->dir, c->id);
+        unlink(dir);
+        snprintf(dir, sizeof(dir), "%s/%s", ix->dir, c->id);
+        rmdir(dir);
+    }
+}
+
+static void write_name(const QjLogIndex *ix, const Container *c) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s/name", ix->dir, c->id);
+    FILE *f = fopen(path, "w");
+    if (f) {
+        fputs(c->name, f);
+        fclose(f);
+    }
+}
+
+/* Oldest segments out first: past max_age_ms, then until under max_bytes */
+static void apply_retention(QjLogIndex *ix) {
+    if (ix->max_age_ms > 0) {
+        int64_t cutoff = wall_ns() - ix->max_age_ms * 1000000LL;
+        for (size_t i = 0; i < ix->container_count; i++) {
+            Container *c = ix->containers[i];
+            while (c->segment_count > 0 && c->segments[0].last_ns < cutoff) {
+                segment_delete(ix, c, 0);
+            }
+        }
+    }
+    while (ix->max_bytes > 0 && ix->total_bytes > ix->max_bytes) {
+        Container *oldest = NULL;
+        for (size_t i = 0; i < ix->container_count; i++) {
+            Container *c = ix->containers[i];
+            if (c->segment_count > 0 && (!oldest || c->segments[0].hour < oldest->segments[0].hour)) {
+                oldest = c;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        segment_delete(ix, oldest, 0);
+    }
+}
+
+// ============== Sealing blocks ==============
+
+static int seal_block(QjLogIndex *ix, Container *c) {
+    if (c->lines == 0) {
+        return 0;
+    }
+    uLongf packed = (uLongf)ix->packed_size;
+    int rc = compress2(ix->packed, &packed, c->raw, c->raw_bytes, Z_BEST_SPEED);
+
+    BlockHeader header = {
+        .magic = BLOCK_MAGIC,
+        .raw_bytes = c->raw_bytes,
+        .packed_bytes = (uint32_t)packed,
+        .lines = c->lines,
+        .first_ns = c->first_ns,
+        .last_ns = c->block_last_ns,
+    };
+    header.crc = qj_crc32c(qj_crc32c(0, c->bloom, BLOOM_BYTES), ix->packed, packed);
+
+    // Whatever happens, the open block starts over
+    c->lines = 0;
+    c->raw_bytes = 0;
+    if (rc != Z_OK) {
+        return -ENOMEM;
+    }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", ix->dir, c->id);
+    if (mkdir(path, 0700) == 0 && c->name[0]) {
+        write_name(ix, c);
+    }
+    segment_path(ix, c, c->hour, path, sizeof(path));
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return -errno;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        rc = -errno;
+        close(fd);
+        return rc;
+    }
+    struct iovec iov[3] = {
+        { &header, sizeof(header) },
+        { c->bloom, BLOOM_BYTES },
+        { ix->packed, packed },
+    };
+    size_t total = BLOCK_OVERHEAD + packed;
+    ssize_t written = writev(fd, iov, 3);
+    if (written != (ssize_t)total) {
+        rc = written < 0 ? -errno : -ENOSPC;
+        // Don't leave a torn block for the loader to trip over
+        if (ftruncate(fd, st.st_size) != 0) {
+            rc = -errno;
+        }
+        close(fd);
+        return rc;
+    }
+    close(fd);
+
+    Segment *segment = segment_get(c, c->hour);
+    Block block = {
+        .offset = (uint64_t)st.st_size,
+        .raw_bytes = header.raw_bytes,
+        .packed_bytes = header.packed_bytes,
+        .lines = header.lines,
+        .first_ns = header.first_ns,
+        .last_ns = header.last_ns,
+    };
+    if (!segment || segment_push(segment, &block) != 0) {
+        return -ENOMEM;
+    }
+    ix->total_bytes += total;
+    if (block.last_ns > c->sealed_ns) {
+        c->sealed_ns = block.last_ns;
+    }
+    apply_retention(ix);
+    return 0;
+}
+
+static int append_line(QjLogIndex *ix, Container *c, int stream, int64_t ts_ns, const char *line, size_t len) {
+    if (len > MAX_LINE_BYTES) {
+        len = MAX_LINE_BYTES;
+    }
+    int rc = 0;
+    int64_t hour = hour_of(ts_ns);
+    if (c->lines > 0 && (hour != c->hour || c->raw_bytes + RECORD_HEADER + len > BLOCK_BYTES)) {
+        rc = seal_block(ix, c);
+    }
+    if (!c->raw && !(c->raw = (unsigned char *)malloc(BLOCK_BYTES))) {
+        return -ENOMEM;
+    }
+    if (c->lines == 0) {
+        c->hour = hour;
+        c->first_ns = ts_ns;
+        c->block_last_ns = ts_ns;
+        memset(c->bloom, 0, BLOOM_BYTES);
+    }
+
+    unsigned char *record = c->raw + c->raw_bytes;
+    uint16_t length = (uint16_t)len;
+    memcpy(record, &ts_ns, 8);
+    record[8] = (unsigned char)stream;
+    record[9] = 0;
+    memcpy(record + 10, &length, 2);
+    memcpy(record + RECORD_HEADER, line, len);
+    c->raw_bytes += (uint32_t)(RECORD_HEADER + len);
+    c->lines++;
+    bloom_add(c->bloom, (const unsigned char *)line, len);
+
+    if (ts_ns < c->first_ns) {
+        c->first_ns = ts_ns;
+    }
+    if (ts_ns > c->block_last_ns) {
+        c->block_last_ns = ts_ns;
+    }
+    if (ts_ns > c->last_ns) {
+        c->last_ns = ts_ns;
+    }
+    return rc;
+}
+
+// ============== Follow stream parsing ==============
+
+static int digits(const char *s, int n, int *out) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return 0;
+        }
+        v = v * 10 + (s[i] - '0');
+    }
+    *out = v;
+    return 1;
+}
+
+/* Days since 1970-01-01 in the proleptic Gregorian calendar */
+static int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/*
+ * "2006-01-02T15:04:05.999999999Z " as Docker prefixes lines with
+ * timestamps=1. Returns the prefix length, or 0 if there is none.
+ */
+static size_t parse_timestamp(const char *s, size_t n, int64_t *ts_ns) {
+    int y, mo, d, h, mi, sec;
+    if (n < 21 || s[4] != '-' || s[7] != '-' || s[10] != 'T' || s[13] != ':' || s[16] != ':' ||
+        !digits(s, 4, &y) || !digits(s + 5, 2, &mo) || !digits(s + 8, 2, &d) ||
+        !digits(s + 11, 2, &h) || !digits(s + 14, 2, &mi) || !digits(s + 17, 2, &sec) ||
+        mo < 1 || mo > 12 || d < 1 || d > 31) {
+        return 0;
+    }
+    size_t i = 19;
+    int64_t frac = 0;
+    int scale = 9;
+    if (s[i] == '.') {
+        i++;
+        while (i < n && s[i] >= '0' && s[i] <= '9') {
+            if (scale > 0) {
+                frac = frac * 10 + (s[i] - '0');
+                scale--;
+            }
+            i++;
+        }
+    }
+    while (scale-- > 0) {
+        frac *= 10;
+    }
+    if (i >= n || s[i] != 'Z') {
+        return 0;
+    }
+    i++;
+    int64_t secs = days_from_civil(y, mo, d) * 86400 + h * 3600 + mi * 60 + sec;
+    *ts_ns = secs * 1000000000LL + frac;
+    return i < n && s[i] == ' ' ? i + 1 : i;
+}
+
+static int ingest_line(QjLogIndex *ix, Container *c, int stream, const char *line, size_t len) {
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n')) {
+        len--;
+    }
+    int64_t ts_ns;
+    size_t prefix = parse_timestamp(line, len, &ts_ns);
+    if (prefix) {
+        // Already indexed: a resumed follower overlapping what we have
+        if (ts_ns <= c->last_ns) {
+            return 0;
+        }
+    } else {
+        ts_ns = c->last_ns > 0 ? c->last_ns : wall_ns();
+    }
+    return append_line(ix, c, stream, ts_ns, line + prefix, len - prefix);
+}
+
+/* Accumulate stream bytes into lines, flushing the partial line on a stream switch */
+static int feed_payload(QjLogIndex *ix, Container *c, int stream, const char *data, size_t len) {
+    int rc = 0;
+    if (c->partial_len > 0 && c->partial_stream != stream) {
+        rc = ingest_line(ix, c, c->partial_stream, c->partial, c->partial_len);
+        c->partial_len = 0;
+    }
+    c->partial_stream = stream;
+    while (len > 0) {
+        const char *newline = (const char *)memchr(data, '\n', len);
+        size_t take = newline ? (size_t)(newline - data) : len;
+        size_t room = MAX_LINE_BYTES - c->partial_len;
+        // Over-long lines keep their first MAX_LINE_BYTES
+        memcpy(c->partial + c->partial_len, data, take < room ? take : room);
+        c->partial_len += take < room ? take : room;
+        if (!newline) {
+            break;
+        }
+        int err = ingest_line(ix, c, stream, c->partial, c->partial_len);
+        if (err && !rc) {
+            rc = err;
+        }
+        c->partial_len = 0;
+        data += take + 1;
+        len -= take + 1;
+    }
+    return rc;
+}
+
+// ============== Loading ==============
+
+static void load_segment(QjLogIndex *ix, Container *c, const char *file) {
+    char *end;
+    long long start = strtoll(file, &end, 10);
+    if (end == file || strcmp(end, ".seg") != 0 || start % 3600 != 0) {
+        return;
+    }
+    int64_t hour = start / 3600;
+    char path[PATH_MAX];
+    segment_path(ix, c, hour, path, sizeof(path));
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    Segment *segment = NULL;
+    uint64_t offset = 0;
+    if (fstat(fd, &st) == 0) {
+        BlockHeader header;
+        while (offset + BLOCK_OVERHEAD <= (uint64_t)st.st_size &&
+               pread(fd, &header, sizeof(header), (off_t)offset) == (ssize_t)sizeof(header)) {
+            if (header.magic != BLOCK_MAGIC || header.raw_bytes > BLOCK_BYTES ||
+                header.packed_bytes > ix->packed_size ||
+                offset + BLOCK_OVERHEAD + header.packed_bytes > (uint64_t)st.st_size) {
+                break;
+            }
+            Block block = {
+                .offset = offset,
+                .raw_bytes = header.raw_bytes,
+                .packed_bytes = header.packed_bytes,
+                .lines = header.lines,
+                .first_ns = header.first_ns,
+                .last_ns = header.last_ns,
+            };
+            if ((!segment && !(segment = segment_get(c, hour))) || segment_push(segment, &block) != 0) {
+                break;
+            }
+            if (block.last_ns > c->sealed_ns) {
+                c->sealed_ns = block.last_ns;
+            }
+            offset += BLOCK_OVERHEAD + header.packed_bytes;
+        }
+        // A block torn by a crash mid-write
+        if (offset < (uint64_t)st.st_size && ftruncate(fd, (off_t)offset) != 0) {
+            offset = (uint64_t)st.st_size;
+        }
+    }
+    close(fd);
+    if (segment) {
+        ix->total_bytes += segment->bytes;
+    } else {
+        unlink(path);
+    }
+}
+
+static void load_container(QjLogIndex *ix, const char *id) {
+    Container *c = container_get(ix, id, 1);
+    if (!c) {
+        return;
+    }
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s/name", ix->dir, c->id);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        if (fgets(c->name, sizeof(c->name), f)) {
+            c->name[strcspn(c->name, "\n")] = '\0';
+        }
+        fclose(f);
+    }
+    snprintf(path, sizeof(path), "%s/%s", ix->dir, c->id);
+    DIR *d = opendir(path);
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            load_segment(ix, c, entry->d_name);
+        }
+    }
+    closedir(d);
+    c->last_ns = c->sealed_ns;
+}
+
+// ============== Public API ==============
+
+QjLogIndex *qj_logindex_open(const char *dir, uint64_t max_bytes, int64_t max_age_ms) {
+    pthread_once(&fold_once, init_fold);
+    if (strlen(dir) >= sizeof(((QjLogIndex *)0)->dir) || (mkdir(dir, 0700) != 0 && errno != EEXIST)) {
+        return NULL;
+    }
+    QjLogIndex *ix = (QjLogIndex *)calloc(1, sizeof(QjLogIndex));
+    if (!ix) {
+        return NULL;
+    }
+    snprintf(ix->dir, sizeof(ix->dir), "%s", dir);
+    ix->max_bytes = max_bytes;
+    ix->max_age_ms = max_age_ms;
+    ix->packed_size = compressBound(BLOCK_BYTES);
+    ix->packed = (unsigned char *)malloc(ix->packed_size);
+    if (!ix->packed) {
+        free(ix);
+        return NULL;
+    }
+    pthread_mutex_init(&ix->lock, NULL);
+
+    DIR *d = opendir(dir);
+    if (d) {
+        struct dirent *entry;
+        while ((entry = readdir(d)) != NULL) {
+            if (strlen(entry->d_name) == ID_LEN && valid_id(entry->d_name)) {
+                load_container(ix, entry->d_name);
+            }
+        }
+        closedir(d);
+    }
+    apply_retention(ix);
+    return ix;
+}
+
+void qj_logindex_close(QjLogIndex *ix) {
+    if (!ix) {
+        return;
+    }
+    qj_logindex_flush(ix);
+    for (size_t i = 0; i < ix->container_count; i++) {
+        Container *c = ix->containers[i];
+        for (size_t s = 0; s < c->segment_count; s++) {
+            free(c->segments[s].blocks);
+        }
+        free(c->segments);
+        free(c->raw);
+        free(c);
+    }
+    free(ix->containers);
+    free(ix->packed);
+    pthread_mutex_destroy(&ix->lock);
+    free(ix);
+}
+
+int qj_logindex_feed(QjLogIndex *ix, const char *container, int tty, const char *data, size_t len) {
+    pthread_mutex_lock(&ix->lock);
+    Container *c = container_get(ix, container, 1);
+    if (!c) {
+        pthread_mutex_unlock(&ix->lock);
+        return -EINVAL;
+    }
+    int rc = 0;
+    if (tty) {
+        rc = feed_payload(ix, c, QJ_LOG_STDOUT, data, len);
+        pthread_mutex_unlock(&ix->lock);
+        return rc;
+    }
+    while (len > 0) {
+        if (c->frame_left == 0) {
+            size_t take = 8 - c->header_len < len ? 8 - c->header_len : len;
+            memcpy(c->frame_header + c->header_len, data, take);
+            c->header_len += take;
+            data += take;
+            len -= take;
+            if (c->header_len < 8) {
+                break;
+            }
+            c->header_len = 0;
+            c->frame_stream = c->frame_header[0] == 2 ? QJ_LOG_STDERR : QJ_LOG_STDOUT;
+            c->frame_left = (uint32_t)c->frame_header[4] << 24 | (uint32_t)c->frame_header[5] << 16 |
+                            (uint32_t)c->frame_header[6] << 8 | c->frame_header[7];
+            continue;
+        }
+        size_t take = c->frame_left < len ? c->frame_left : len;
+        int err = feed_payload(ix, c, c->frame_stream, data, take);
+        if (err && !rc) {
+            rc = err;
+        }
+        c->frame_left -= (uint32_t)take;
+        data += take;
+        len -= take;
+    }
+    pthread_mutex_unlock(&ix->lock);
+    return rc;
+}
+
+int qj_logindex_append(QjLogIndex *ix, const char *container, int stream, int64_t ts_ns,
+                       const char *line, size_t len) {
+    pthread_mutex_lock(&ix->lock);
+    Container *c = container_get(ix, container, 1);
+    int rc = c ? append_line(ix, c, stream, ts_ns, line, len) : -EINVAL;
+    pthread_mutex_unlock(&ix->lock);
+    return rc;
+}
+
+int qj_logindex_set_name(QjLogIndex *ix, const char *container, const char *name) {
+    pthread_mutex_lock(&ix->lock);
+    Container *c = container_get(ix, container, 1);
+    if (!c) {
+        pthread_mutex_unlock(&ix->lock);
+        return -EINVAL;
+    }
+    // Docker reports names with a leading slash
+    const char *bare = name[0] == '/' ? name + 1 : name;
+    if (strcmp(c->name, bare) != 0) {
+        snprintf(c->name, sizeof(c->name), "%s", bare);
+        if (c->segment_count > 0) {
+            write_name(ix, c);
+        }
+    }
+    pthread_mutex_unlock(&ix->lock);
+    return 0;
+}
+
+int64_t qj_logindex_last_ns(QjLogIndex *ix, const char *container) {
+    pthread_mutex_lock(&ix->lock);
+    Container *c = container_get(ix, container, 0);
+    int64_t last = c ? c->sealed_ns : 0;
+    pthread_mutex_unlock(&ix->lock);
+    return last;
+}
+
+int qj_logindex_flush(QjLogIndex *ix) {
+    int rc = 0;
+    pthread_mutex_lock(&ix->lock);
+    for (size_t i = 0; i < ix->container_count; i++) {
+        int err = seal_block(ix, ix->containers[i]);
+        if (err && !rc) {
+            rc = err;
+        }
+    }
+    apply_retention(ix);
+    pthread_mutex_unlock(&ix->lock);
+    return rc;
+}
+
+// ============== JSON ==============
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int failed;
+} Json;
+
+static void json_reserve(Json *j, size_t extra) {
+    if (j->failed || j->len + extra < j->cap) {
+        return;
+    }
+    size_t cap = j->cap ? j->cap : 4096;
+    while (cap <= j->len + extra) {
+        cap *= 2;
+    }
+    char *grown = (char *)realloc(j->buf, cap);
+    if (!grown) {
+        j->failed = 1;
+        return;
+    }
+    j->buf = grown;
+    j->cap = cap;
+}
+
+static void json_printf(Json *j, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    va_list copy;
+    va_copy(copy, args);
+    int n = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    json_reserve(j, (size_t)n + 1);
+    if (!j->failed) {
+        vsnprintf(j->buf + j->len, j->cap - j->len, fmt, args);
+        j->len += (size_t)n;
+    }
+    va_end(args);
+}
+
+/* Length of the valid UTF-8 sequence at s and its code point, or 0 */
+static size_t utf8_decode(const unsigned char *s, size_t n, uint32_t *cp) {
+    size_t len;
+    uint32_t min;
+    if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+        len = 2, min = 0x80, *cp = s[0] & 0x1f;
+    } else if (s[0] >= 0xe0 && s[0] <= 0xef) {
+        len = 3, min = 0x800, *cp = s[0] & 0x0f;
+    } else if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+        len = 4, min = 0x10000, *cp = s[0] & 0x07;
+    } else {
+        return 0;
+    }
+    if (len > n) {
+        return 0;
+    }
+    for (size_t i = 1; i < len; i++) {
+        if ((s[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        *cp = *cp << 6 | (s[i] & 0x3f);
+    }
+    if (*cp < min || *cp > 0x10ffff || (*cp >= 0xd800 && *cp <= 0xdfff)) {
+        return 0;
+    }
+    return len;
+}
+
+/* Quoted, ASCII only: anything else as \u escapes, invalid UTF-8 as U+FFFD */
+static void json_string(Json *j, const char *str, size_t n) {
+    const unsigned char *s = (const unsigned char *)str;
+    json_reserve(j, n * 6 + 2);
+    if (j->failed) {
+        return;
+    }
+    j->buf[j->len++] = '"';
+    for (size_t i = 0; i < n;) {
+        unsigned char ch = s[i];
+        if (ch == '"' || ch == '\\') {
+            j->buf[j->len++] = '\\';
+            j->buf[j->len++] = (char)ch;
+            i++;
+        } else if (ch >= 0x20 && ch < 0x7f) {
+            j->buf[j->len++] = (char)ch;
+            i++;
+        } else if (ch < 0x80) {
+            j->len += (size_t)sprintf(j->buf + j->len, "\\u%04x", ch);
+            i++;
+        } else {
+            uint32_t cp;
+            size_t len = utf8_decode(s + i, n - i, &cp);
+            if (len == 0) {
+                cp = 0xfffd;
+                len = 1;
+            }
+            if (cp >= 0x10000) {
+                cp -= 0x10000;
+                j->len += (size_t)sprintf(j->buf + j->len, "\\u%04x\\u%04x",
+                                          0xd800 + (cp >> 10), 0xdc00 + (cp & 0x3ff));
+            } else {
+                j->len += (size_t)sprintf(j->buf + j->len, "\\u%04x", cp);
+            }
+            i += len;
+        }
+    }
+    j->buf[j->len++] = '"';
+}
+
+static char *json_finish(Json *j) {
+    json_reserve(j, 1);
+    if (j->failed) {
+        free(j->buf);
+        return NULL;
+    }
+    j->buf[j->len] = '\0';
+    return j->buf;
+}
+
+// ============== Search ==============
+
+typedef struct {
+    Container *container;
+    const Block *block;                 // NULL: the open block
+    int64_t hour;
+    int64_t last_ns;
+} Candidate;
+
+typedef struct {
+    int64_t ts_ns;
+    Container *container;
+    int stream;
+    size_t len;
+    char line[RESULT_LINE_BYTES];
+} Match;
+
+static int by_newest_block(const void *a, const void *b) {
+    int64_t x = ((const Candidate *)a)->last_ns, y = ((const Candidate *)b)->last_ns;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static int by_newest_match(const void *a, const void *b) {
+    int64_t x = ((const Match *)a)->ts_ns, y = ((const Match *)b)->ts_ns;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static int overlaps(int64_t first, int64_t last, const QjLogQuery *q) {
+    return (q->since_ns == 0 || last >= q->since_ns) && (q->until_ns == 0 || first < q->until_ns);
+}
+
+/* Read a sealed block's filter (and, with records, its inflated records) */
+static int read_block(QjLogIndex *ix, const Candidate *cand, unsigned char *bloom,
+                      unsigned char *packed, unsigned char *raw) {
+    char path[PATH_MAX];
+    segment_path(ix, cand->container, cand->hour, path, sizeof(path));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -errno;
+    }
+    const Block *b = cand->block;
+    off_t at = (off_t)(b->offset + sizeof(BlockHeader));
+    int rc = 0;
+    if (pread(fd, bloom, BLOOM_BYTES, at) != BLOOM_BYTES) {
+        rc = -EIO;
+    } else if (packed) {
+        uLongf raw_len = BLOCK_BYTES;
+        BlockHeader header;
+        if (pread(fd, &header, sizeof(header), (off_t)b->offset) != (ssize_t)sizeof(header) ||
+            pread(fd, packed, b->packed_bytes, at + BLOOM_BYTES) != (ssize_t)b->packed_bytes ||
+            qj_crc32c(qj_crc32c(0, bloom, BLOOM_BYTES), packed, b->packed_bytes) != header.crc ||
+            uncompress(raw, &raw_len, packed, b->packed_bytes) != Z_OK || raw_len != b->raw_bytes) {
+            rc = -EIO;
+        }
+    }
+    close(fd);
+    return rc;
+}
+
+char *qj_logindex_search(QjLogIndex *ix, const QjLogQuery *q) {
+    uint64_t started = qj_now_ns();
+    size_t limit = q->limit == 0 ? 100 : q->limit > MAX_LIMIT ? MAX_LIMIT : q->limit;
+
+    unsigned char needle[MAX_QUERY_BYTES];
+    size_t needle_len = q->text ? strlen(q->text) : 0;
+    if (needle_len > MAX_QUERY_BYTES) {
+        needle_len = MAX_QUERY_BYTES;
+    }
+    for (size_t i = 0; i < needle_len; i++) {
+        needle[i] = fold[(unsigned char)q->text[i]];
+    }
+    uint32_t trigrams[MAX_QUERY_BYTES];
+    size_t trigram_count = 0;
+    for (size_t i = 0; i + 3 <= needle_len; i++) {
+        trigrams[trigram_count++] = trigram(needle + i);
+    }
+    size_t prefix_len = q->container ? strlen(q->container) : 0;
+
+    Match *matches = (Match *)malloc(limit * sizeof(Match));
+    unsigned char *bloom = (unsigned char *)malloc(BLOOM_BYTES);
+    unsigned char *packed = (unsigned char *)malloc(ix->packed_size);
+    unsigned char *raw = (unsigned char *)malloc(BLOCK_BYTES);
+    Candidate *candidates = NULL;
+    size_t candidate_count = 0, candidate_cap = 0;
+    size_t match_count = 0, oldest = 0;
+    size_t block_count = 0, passed = 0, scanned = 0;
+    uint64_t lines = 0;
+    int more = 0;
+    char *result = NULL;
+    if (!matches || !bloom || !packed || !raw) {
+        goto out;
+    }
+
+    pthread_mutex_lock(&ix->lock);
+    for (size_t i = 0; i < ix->container_count; i++) {
+        Container *c = ix->containers[i];
+        if (prefix_len && strncmp(c->id, q->container, prefix_len < ID_LEN ? prefix_len : ID_LEN) != 0) {
+            continue;
+        }
+        size_t needed = candidate_count + 1;
+        for (size_t s = 0; s < c->segment_count; s++) {
+            needed += c->segments[s].count;
+        }
+        if (needed > candidate_cap) {
+            Candidate *grown = (Candidate *)realloc(candidates, needed * 2 * sizeof(Candidate));
+            if (!grown) {
+                pthread_mutex_unlock(&ix->lock);
+                goto out;
+            }
+            candidates = grown;
+            candidate_cap = needed * 2;
+        }
+        for (size_t s = 0; s < c->segment_count; s++) {
+            const Segment *segment = &c->segments[s];
+            block_count += segment->count;
+            for (size_t k = 0; k < segment->count; k++) {
+                const Block *b = &segment->blocks[k];
+                if (overlaps(b->first_ns, b->last_ns, q)) {
+                    candidates[candidate_count++] = (Candidate){ c, b, segment->hour, b->last_ns };
+                }
+            }
+        }
+        if (c->lines > 0) {
+            block_count++;
+            if (overlaps(c->first_ns, c->block_last_ns, q)) {
+                candidates[candidate_count++] = (Candidate){ c, NULL, c->hour, c->block_last_ns };
+            }
+        }
+    }
+    if (candidate_count > 1) {
+        qsort(candidates, candidate_count, sizeof(Candidate), by_newest_block);
+    }
+
+    for (size_t i = 0; i < candidate_count; i++) {
+        const Candidate *cand = &candidates[i];
+        // Nothing older can displace the newest `limit` matches
+        if (match_count == limit && cand->last_ns < matches[oldest].ts_ns) {
+            more = 1;
+            break;
+        }
+        const unsigned char *filter = cand->block ? bloom : cand->container->bloom;
+        if (cand->block && trigram_count > 0 && read_block(ix, cand, bloom, NULL, NULL) != 0) {
+            continue;
+        }
+        if (trigram_count > 0 && !bloom_has_all(filter, trigrams, trigram_count)) {
+            continue;
+        }
+        passed++;
+        const unsigned char *records = cand->container->raw;
+        size_t records_len = cand->container->raw_bytes;
+        if (cand->block) {
+            if (read_block(ix, cand, bloom, packed, raw) != 0) {
+                continue;
+            }
+            records = raw;
+            records_len = cand->block->raw_bytes;
+        }
+        scanned++;
+
+        for (size_t at = 0; at + RECORD_HEADER <= records_len;) {
+            int64_t ts_ns;
+            uint16_t len;
+            memcpy(&ts_ns, records + at, 8);
+            memcpy(&len, records + at + 10, 2);
+            int stream = records[at + 8];
+            const unsigned char *line = records + at + RECORD_HEADER;
+            at += RECORD_HEADER + len;
+            if (at > records_len) {
+                break;
+            }
+            lines++;
+            if ((q->since_ns && ts_ns < q->since_ns) || (q->until_ns && ts_ns >= q->until_ns) ||
+                (q->stream && stream != q->stream) ||
+                (match_count == limit && ts_ns <= matches[oldest].ts_ns) ||
+                !contains_folded(line, len, needle, needle_len)) {
+                continue;
+            }
+            Match *m;
+            if (match_count < limit) {
+                m = &matches[match_count++];
+            } else {
+                m = &matches[oldest];
+                more = 1;
+            }
+            size_t keep = len < RESULT_LINE_BYTES ? len : RESULT_LINE_BYTES;
+            // Don't cut a UTF-8 sequence in half
+            while (keep < len && keep > 0 && (line[keep] & 0xc0) == 0x80) {
+                keep--;
+            }
+            m->ts_ns = ts_ns;
+            m->container = cand->container;
+            m->stream = stream;
+            m->len = keep;
+            memcpy(m->line, line, keep);
+            if (match_count == limit) {
+                oldest = 0;
+                for (size_t k = 1; k < match_count; k++) {
+                    if (matches[k].ts_ns < matches[oldest].ts_ns) {
+                        oldest = k;
+                    }
+                }
+            }
+        }
+    }
+
+    qsort(matches, match_count, sizeof(Match), by_newest_match);
+    Json j = { 0 };
+    json_printf(&j, "{\"matches\":[");
+    for (size_t i = 0; i < match_count; i++) {
+        const Match *m = &matches[i];
+        json_printf(&j, "%s{\"container\":\"%s\",\"name\":", i ? "," : "", m->container->id);
+        json_string(&j, m->container->name, strlen(m->container->name));
+        json_printf(&j, ",\"ts\":%lld,\"stream\":\"%s\",\"line\":", (long long)(m->ts_ns / 1000000),
+                    m->stream == QJ_LOG_STDERR ? "stderr" : "stdout");
+        json_string(&j, m->line, m->len);
+        json_printf(&j, "}");
+    }
+    pthread_mutex_unlock(&ix->lock);
+    json_printf(&j, "],\"more\":%s,\"blocks\":%zu,\"candidates\":%zu,\"scanned\":%zu,\"lines\":%llu,\"tookUs\":%llu}",
+                more ? "true" : "false", block_count, passed, scanned, (unsigned long long)lines,
+                (unsigned long long)((qj_now_ns() - started) / 1000));
+    result = json_finish(&j);
+
+out:
+    free(candidates);
+    free(raw);
+    free(packed);
+    free(bloom);
+    free(matches);
+    return result;
+}
+
+char *qj_logindex_stats(QjLogIndex *ix) {
+    Json j = { 0 };
+    pthread_mutex_lock(&ix->lock);
+    json_printf(&j, "{\"bytes\":%llu,\"maxBytes\":%llu,\"maxAgeMs\":%lld,\"containers\":[",
+                (unsigned long long)ix->total_bytes, (unsigned long long)ix->max_bytes,
+                (long long)ix->max_age_ms);
+    for (size_t i = 0; i < ix->container_count; i++) {
+        const Container *c = ix->containers[i];
+        uint64_t bytes = 0, raw_bytes = 0, lines = c->lines;
+        size_t blocks = 0;
+        int64_t first_ns = c->lines ? c->first_ns : 0;
+        for (size_t s = 0; s < c->segment_count; s++) {
+            const Segment *segment = &c->segments[s];
+            bytes += segment->bytes;
+            blocks += segment->count;
+            for (size_t k = 0; k < segment->count; k++) {
+                raw_bytes += segment->blocks[k].raw_bytes;
+                lines += segment->blocks[k].lines;
+                if (!first_ns || segment->blocks[k].first_ns < first_ns) {
+                    first_ns = segment->blocks[k].first_ns;
+                }
+            }
+        }
+        json_printf(&j, "%s{\"id\":\"%s\",\"name\":", i ? "," : "", c->id);
+        json_string(&j, c->name, strlen(c->name));
+        json_printf(&j, ",\"bytes\":%llu,\"rawBytes\":%llu,\"blocks\":%zu,\"lines\":%llu,"
+                        "\"openLines\":%u,\"firstTs\":%lld,\"lastTs\":%lld}",
+                    (unsigned long long)bytes, (unsigned long long)raw_bytes, blocks,
+                    (unsigned long long)lines, c->lines, (long long)(first_ns / 1000000),
+                    (long long)(c->last_ns / 1000000));
+    }
+    pthread_mutex_unlock(&ix->lock);
+    json_printf(&j, "]}");
+    return json_finish(&j);
+}
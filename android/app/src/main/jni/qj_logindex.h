@@ -0,0 +1,104 @@
+/**
+ * Container log index
+ *
+ * Host-side store for container logs, fed from Docker follow streams and
+ * searched across every container at once. Per container, lines go into
+ * 64 KiB blocks that are deflated and appended to one segment file per
+ * hour of log time:
+ *
+ *   <dir>/<short id>/<hour>.seg   blocks: header, trigram filter, deflate
+ *   <dir>/<short id>/name         container name, for results
+ *
+ * Each block carries a Bloom filter of the case-folded trigrams in its
+ * lines, so a search only inflates blocks that can contain every trigram
+ * of the query, and only those overlapping its time range. Blocks are
+ * searched newest first and the search stops once the newest `limit`
+ * matches can no longer change, so common words cost no more than rare
+ * ones. Lines not yet in a sealed block are searched in memory.
+ *
+ * Retention drops whole segments, oldest first, beyond a byte budget or
+ * age. A crash loses at most the open blocks, which the follower fetches
+ * again: qj_logindex_last_ns only counts sealed lines.
+ *
+ * All functions are thread-safe. Shared by the JNI ingestion
+ * (qj_transfer.c) and the qj-logindex host tool.
+ */
+
+#ifndef QJ_LOGINDEX_H
+#define QJ_LOGINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define QJ_LOG_STDOUT 1
+#define QJ_LOG_STDERR 2
+
+typedef struct QjLogIndex QjLogIndex;
+
+typedef struct {
+    const char *text;       // case-insensitive substring; NULL or "" matches all
+    const char *container;  // short id prefix, or NULL for every container
+    int64_t since_ns;       // inclusive, 0 = unbounded
+    int64_t until_ns;       // exclusive, 0 = unbounded
+    int stream;             // QJ_LOG_STDOUT, QJ_LOG_STDERR or 0 for both
+    size_t limit;           // newest matches to return
+} QjLogQuery;
+
+/**
+ * Open (creating) the index in dir and apply retention. max_bytes and
+ * max_age_ms of 0 disable that limit. Returns NULL on failure.
+ */
+QjLogIndex *qj_logindex_open(const char *dir, uint64_t max_bytes, int64_t max_age_ms);
+
+/**
+ * Seal open blocks and free the index
+ */
+void qj_logindex_close(QjLogIndex *index);
+
+/**
+ * Feed raw bytes of GET /containers/<id>/logs?timestamps=1: 8-byte
+ * multiplexed frames, or the bare stream (stdout) for tty containers.
+ * Frames and lines may be split across calls. Lines at or before the
+ * container's newest indexed timestamp are dropped, so a follower can
+ * resume with since= and overlap. Returns 0, or -errno.
+ */
+int qj_logindex_feed(QjLogIndex *index, const char *container, int tty, const char *data, size_t len);
+
+/**
+ * Append one line (without its newline)
+ */
+int qj_logindex_append(QjLogIndex *index, const char *container, int stream, int64_t ts_ns,
+                       const char *line, size_t len);
+
+/**
+ * Remember the container's name for search results
+ */
+int qj_logindex_set_name(QjLogIndex *index, const char *container, const char *name);
+
+/**
+ * Newest timestamp in a sealed block for the container, or 0: where a
+ * follower resumes after a restart
+ */
+int64_t qj_logindex_last_ns(QjLogIndex *index, const char *container);
+
+/**
+ * Seal every open block to disk and apply retention
+ */
+int qj_logindex_flush(QjLogIndex *index);
+
+/**
+ * Run a query; returns a malloc'd JSON document (free() it) or NULL:
+ *
+ *   {"matches":[{"container","name","ts"(ms),"stream","line"}...] newest first,
+ *    "more", "blocks", "candidates", "scanned", "lines", "tookUs"}
+ *
+ * The JSON is plain ASCII; anything else in a line is \u-escaped.
+ */
+char *qj_logindex_search(QjLogIndex *index, const QjLogQuery *query);
+
+/**
+ * Usage per container and retention settings as malloc'd JSON, or NULL
+ */
+char *qj_logindex_stats(QjLogIndex *index);
+
+#endif // QJ_LOGINDEX_H
@@ -0,0 +1,72 @@
+/**
+ * /proc sampling helpers
+ */
+
+#include "qj_proc.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static ssize_t read_small_file(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+int qj_proc_sample(pid_t pid, int64_t *out) {
+    char path[64];
+    char buf[1024];
+
+    if (pid > 0) {
+        snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    } else {
+        snprintf(path, sizeof(path), "/proc/self/stat");
+    }
+    if (read_small_file(path, buf, sizeof(buf)) <= 0) {
+        return -1;
+    }
+
+    // comm may contain spaces and parens - fields resume after the last ')'
+    char *p = strrchr(buf, ')');
+    if (!p) {
+        return -1;
+    }
+    p += 2;
+
+    // Field numbers below follow proc(5); field 3 (state) is at p
+    int64_t fields[25] = {0};
+    for (int field = 3; field <= 24 && *p; field++) {
+        if (field > 3) {
+            fields[field] = strtoll(p, &p, 10);
+        } else {
+            while (*p && *p != ' ') p++;
+        }
+        while (*p == ' ') p++;
+    }
+
+    static long page_size = 0;
+    if (!page_size) {
+        page_size = sysconf(_SC_PAGESIZE);
+    }
+
+    out[QJ_SAMPLE_PID] = pid > 0 ? pid : getpid();
+    out[QJ_SAMPLE_UTIME_TICKS] = fields[14];
+    out[QJ_SAMPLE_STIME_TICKS] = fields[15];
+    out[QJ_SAMPLE_VSIZE_BYTES] = fields[23];
+    out[QJ_SAMPLE_RSS_BYTES] = fields[24] * page_size;
+    out[QJ_SAMPLE_THREADS] = fields[20];
+    out[QJ_SAMPLE_MINFLT] = fields[10];
+    out[QJ_SAMPLE_MAJFLT] = fields[12];
+    return 0;
+}
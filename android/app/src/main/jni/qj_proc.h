@@ -0,0 +1,33 @@
+/**
+ * /proc sampling helpers
+ *
+ * Samples are flat arrays of int64 so they can be copied straight into a
+ * Java long[] or a ring record without per-field marshalling.
+ */
+
+#ifndef QJ_PROC_H
+#define QJ_PROC_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+// Field indices within one process sample - keep in sync with NativeTransfer.kt
+enum {
+    QJ_SAMPLE_PID = 0,
+    QJ_SAMPLE_UTIME_TICKS,
+    QJ_SAMPLE_STIME_TICKS,
+    QJ_SAMPLE_VSIZE_BYTES,
+    QJ_SAMPLE_RSS_BYTES,
+    QJ_SAMPLE_THREADS,
+    QJ_SAMPLE_MINFLT,
+    QJ_SAMPLE_MAJFLT,
+    QJ_SAMPLE_FIELDS
+};
+
+/**
+ * Fill out[QJ_SAMPLE_FIELDS] from /proc/<pid>/stat (pid 0 = self).
+ * Returns 0 on success, -1 if the process is gone or unreadable.
+ */
+int qj_proc_sample(pid_t pid, int64_t *out);
+
+#endif // QJ_PROC_H
@@ -0,0 +1,262 @@
+/**
+ * Byte ring for bulk native -> Kotlin transfer
+ */
+
+#include "qj_ring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001u
+#endif
+
+_Static_assert(sizeof(QjRingHeader) == QJ_RING_HEADER_SIZE, "ring header layout");
+_Static_assert(offsetof(QjRingHeader, head) == 64, "ring head offset");
+_Static_assert(offsetof(QjRingHeader, tail) == 128, "ring tail offset");
+
+#define ALIGN8(x) (((x) + 7u) & ~(uint64_t)7u)
+
+uint64_t qj_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static size_t round_pow2(size_t v) {
+    size_t p = 4096;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+static QjRing *ring_wrap(void *mem, size_t map_size, int fd) {
+    QjRing *ring = (QjRing *)calloc(1, sizeof(QjRing));
+    if (!ring) {
+        return NULL;
+    }
+    ring->map_size = map_size;
+    ring->fd = fd;
+    ring->hdr = (QjRingHeader *)mem;
+    ring->data = (uint8_t *)mem + QJ_RING_HEADER_SIZE;
+    pthread_mutex_init(&ring->write_lock, NULL);
+    return ring;
+}
+
+static void ring_init_header(QjRingHeader *hdr, size_t capacity) {
+    hdr->magic = QJ_RING_MAGIC;
+    hdr->version = QJ_RING_VERSION;
+    hdr->capacity = (uint32_t)capacity;
+    hdr->header_size = QJ_RING_HEADER_SIZE;
+    atomic_init(&hdr->dropped, 0);
+    atomic_init(&hdr->head, 0);
+    atomic_init(&hdr->tail, 0);
+}
+
+QjRing *qj_ring_create(size_t min_capacity) {
+    size_t capacity = round_pow2(min_capacity);
+    if (capacity > (1u << 30)) {
+        return NULL;
+    }
+
+    size_t map_size = QJ_RING_HEADER_SIZE + capacity;
+    void *mem = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    QjRing *ring = ring_wrap(mem, map_size, -1);
+    if (!ring) {
+        munmap(mem, map_size);
+        return NULL;
+    }
+    ring_init_header(ring->hdr, capacity);
+    return ring;
+}
+
+QjRing *qj_ring_create_shared(size_t min_capacity, const char *name) {
+    size_t capacity = round_pow2(min_capacity);
+    if (capacity > (1u << 30)) {
+        return NULL;
+    }
+
+    // bionic only exposes memfd_create() from API 30; the syscall is older
+    int fd = (int)syscall(__NR_memfd_create, name, MFD_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    size_t map_size = QJ_RING_HEADER_SIZE + capacity;
+    if (ftruncate(fd, (off_t)map_size) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *mem = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    QjRing *ring = ring_wrap(mem, map_size, fd);
+    if (!ring) {
+        munmap(mem, map_size);
+        close(fd);
+        return NULL;
+    }
+    ring_init_header(ring->hdr, capacity);
+    return ring;
+}
+
+QjRing *qj_ring_attach(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < QJ_RING_HEADER_SIZE + 4096) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t map_size = (size_t)st.st_size;
+    void *mem = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    // Don't trust the other process: the header must describe this mapping
+    const QjRingHeader *hdr = (const QjRingHeader *)mem;
+    uint32_t cap = hdr->capacity;
+    if (hdr->magic != QJ_RING_MAGIC || hdr->version != QJ_RING_VERSION ||
+        hdr->header_size != QJ_RING_HEADER_SIZE || (cap & (cap - 1)) != 0 ||
+        (size_t)QJ_RING_HEADER_SIZE + cap > map_size) {
+        munmap(mem, map_size);
+        close(fd);
+        return NULL;
+    }
+
+    QjRing *ring = ring_wrap(mem, map_size, fd);
+    if (!ring) {
+        munmap(mem, map_size);
+        close(fd);
+    }
+    return ring;
+}
+
+void qj_ring_destroy(QjRing *ring) {
+    if (!ring) {
+        return;
+    }
+    munmap(ring->hdr, ring->map_size);
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    pthread_mutex_destroy(&ring->write_lock);
+    free(ring);
+}
+
+static void put_header(uint8_t *at, uint32_t length, uint16_t type,
+                       uint16_t flags, uint64_t timestamp, int with_ts) {
+    memcpy(at, &length, 4);
+    memcpy(at + 4, &type, 2);
+    memcpy(at + 6, &flags, 2);
+    if (with_ts) {
+        memcpy(at + 8, &timestamp, 8);
+    }
+}
+
+int qj_ring_write(QjRing *ring, uint16_t type, uint16_t flags,
+                  uint64_t timestamp, const void *payload, uint32_t len) {
+    QjRingHeader *hdr = ring->hdr;
+    const uint64_t cap = hdr->capacity;
+    const uint64_t size = ALIGN8((uint64_t)QJ_REC_HEADER_SIZE + len);
+
+    if (size > cap / 2) {
+        atomic_fetch_add_explicit(&hdr->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    pthread_mutex_lock(&ring->write_lock);
+
+    uint64_t head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&hdr->tail, memory_order_acquire);
+    // A shared ring's tail is written by another process; never let a bad
+    // value make the producer overwrite unconsumed data
+    if (tail > head || head - tail > cap) {
+        tail = head;
+        atomic_store_explicit(&hdr->tail, tail, memory_order_relaxed);
+    }
+    uint64_t idx = head & (cap - 1);
+    uint64_t contiguous = cap - idx;
+    uint64_t needed = contiguous < size ? contiguous + size : size;
+
+    if (cap - (head - tail) < needed) {
+        pthread_mutex_unlock(&ring->write_lock);
+        atomic_fetch_add_explicit(&hdr->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    if (contiguous < size) {
+        put_header(ring->data + idx, (uint32_t)contiguous, QJ_REC_PAD, 0, 0, 0);
+        head += contiguous;
+        idx = 0;
+    }
+
+    uint8_t *at = ring->data + idx;
+    put_header(at, QJ_REC_HEADER_SIZE + len, type, flags, timestamp, 1);
+    if (len) {
+        memcpy(at + QJ_REC_HEADER_SIZE, payload, len);
+    }
+
+    atomic_store_explicit(&hdr->head, head + size, memory_order_release);
+    pthread_mutex_unlock(&ring->write_lock);
+    return 0;
+}
+
+uint64_t qj_ring_readable(QjRing *ring) {
+    uint64_t head = atomic_load_explicit(&ring->hdr->head, memory_order_acquire);
+    uint64_t tail = atomic_load_explicit(&ring->hdr->tail, memory_order_relaxed);
+    return head - tail;
+}
+
+void qj_ring_commit(QjRing *ring, uint64_t new_tail) {
+    atomic_store_explicit(&ring->hdr->tail, new_tail, memory_order_release);
+}
+
+size_t qj_ring_drain(QjRing *ring, qj_ring_visit_fn fn, void *ctx) {
+    const uint64_t mask = ring->hdr->capacity - 1;
+    uint64_t pos = atomic_load_explicit(&ring->hdr->tail, memory_order_relaxed);
+    uint64_t end = pos + qj_ring_readable(ring);
+    size_t visited = 0;
+
+    while (pos < end) {
+        const uint8_t *at = ring->data + (pos & mask);
+        uint32_t length;
+        uint16_t type, flags;
+        memcpy(&length, at, 4);
+        memcpy(&type, at + 4, 2);
+        memcpy(&flags, at + 6, 2);
+
+        if (type == QJ_REC_PAD) {
+            pos += length;
+            continue;
+        }
+
+        uint64_t timestamp;
+        memcpy(&timestamp, at + 8, 8);
+        pos += ALIGN8(length);
+        visited++;
+
+        if (fn(ctx, type, flags, timestamp, at + QJ_REC_HEADER_SIZE,
+               length - QJ_REC_HEADER_SIZE) != 0) {
+            break;
+        }
+    }
+
+    qj_ring_commit(ring, pos);
+    return visited;
+}
@@ -0,0 +1,121 @@
+/**
+ * Byte ring for bulk native -> Kotlin transfer
+ *
+ * A single-consumer ring of variable-length records living in one
+ * contiguous region: a fixed header followed by a power-of-two data area.
+ * Kotlin maps the whole region as a direct ByteBuffer and decodes records
+ * in place; only the head/tail handshake crosses JNI (once per batch).
+ * Shared rings live in a memfd so the producer and consumer can be in
+ * different processes (the :vm host and the UI).
+ *
+ * Record layout (little-endian, every record starts 8-byte aligned):
+ *
+ *   u32 length      header + payload bytes, excluding alignment padding
+ *   u16 type        QJ_REC_*
+ *   u16 flags       type-specific
+ *   u64 timestamp   CLOCK_MONOTONIC nanoseconds
+ *   u8  payload[length - 16]
+ *
+ * A QJ_REC_PAD record (only length/type/flags valid, may be 8 bytes long)
+ * fills the gap at the end of the data area when a record would wrap.
+ */
+
+#ifndef QJ_RING_H
+#define QJ_RING_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define QJ_RING_MAGIC       0x47524A51u  // "QJRG"
+#define QJ_RING_VERSION     1
+#define QJ_RING_HEADER_SIZE 256
+#define QJ_REC_HEADER_SIZE  16
+
+// Record types - keep in sync with NativeTransfer.kt
+#define QJ_REC_PAD   0
+#define QJ_REC_LOG   1
+#define QJ_REC_STATS 2
+#define QJ_REC_BENCH 3
+
+// Shared header at offset 0 of the region. head and tail sit on their own
+// cache lines; offsets are part of the format Kotlin reads.
+typedef struct {
+    uint32_t magic;                 // 0
+    uint32_t version;               // 4
+    uint32_t capacity;              // 8   data bytes, power of two
+    uint32_t header_size;           // 12  offset of the data area
+    _Atomic uint64_t dropped;       // 16  records rejected because full
+    uint8_t pad0[40];
+    _Atomic uint64_t head;          // 64  producer position (monotonic)
+    uint8_t pad1[56];
+    _Atomic uint64_t tail;          // 128 consumer position (monotonic)
+    uint8_t pad2[QJ_RING_HEADER_SIZE - 136];
+} QjRingHeader;
+
+typedef struct {
+    QjRingHeader *hdr;
+    uint8_t *data;
+    size_t map_size;                // header + data, as mapped
+    int fd;                         // backing fd for shared rings, else -1
+    pthread_mutex_t write_lock;     // serializes native producers
+} QjRing;
+
+/**
+ * Create a ring with at least min_capacity data bytes (rounded up to a
+ * power of two). Returns NULL on failure.
+ */
+QjRing *qj_ring_create(size_t min_capacity);
+
+/**
+ * Create a ring backed by a memfd so another process can map it (see
+ * qj_ring_attach). The fd is owned by the ring. Returns NULL on failure.
+ */
+QjRing *qj_ring_create_shared(size_t min_capacity, const char *name);
+
+/**
+ * Map a shared ring from an fd received from another process. Takes
+ * ownership of fd (closed on failure too). The header is validated
+ * against the mapping size. Returns NULL on failure.
+ */
+QjRing *qj_ring_attach(int fd);
+
+/**
+ * Unmap and free a ring (closes its fd if shared)
+ */
+void qj_ring_destroy(QjRing *ring);
+
+/**
+ * Append one record. Returns 0 on success, -1 if it doesn't fit (the
+ * dropped counter is incremented) or is larger than half the ring.
+ */
+int qj_ring_write(QjRing *ring, uint16_t type, uint16_t flags,
+                  uint64_t timestamp, const void *payload, uint32_t len);
+
+/**
+ * Bytes published but not yet consumed (acquire load of head)
+ */
+uint64_t qj_ring_readable(QjRing *ring);
+
+/**
+ * Release consumed bytes up to position new_tail
+ */
+void qj_ring_commit(QjRing *ring, uint64_t new_tail);
+
+/**
+ * Walk readable records without intermediate copies. fn returns 0 to
+ * continue. Returns the number of records visited and commits them.
+ * Used by host tools; Kotlin decodes the same layout itself.
+ */
+typedef int (*qj_ring_visit_fn)(void *ctx, uint16_t type, uint16_t flags,
+                                uint64_t timestamp, const uint8_t *payload,
+                                uint32_t len);
+size_t qj_ring_drain(QjRing *ring, qj_ring_visit_fn fn, void *ctx);
+
+/**
+ * CLOCK_MONOTONIC in nanoseconds, the timebase for record timestamps
+ */
+uint64_t qj_now_ns(void);
+
+#endif // QJ_RING_H
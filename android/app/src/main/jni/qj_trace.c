@@ -0,0 +1,485 @@
+/**
+ * QEMU trace event summarizer
+ */
+
+#include "qj_trace.h"
+#include "qj_ring.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_BYTES 512
+#define MAX_EVENT_NAMES 48
+#define EVENT_NAME_MAX 48
+#define MAX_QUEUES 32
+#define MAX_BLK_DEVICES 8
+#define MAX_KVM_REASONS 64
+// Power of two; a virtio-blk queue holds at most 1024 requests
+#define PENDING_SLOTS 4096
+
+typedef struct {
+    char name[EVENT_NAME_MAX];
+    uint64_t count;
+} EventCount;
+
+typedef struct {
+    uint64_t requests;
+    uint64_t bytes;
+    uint64_t errors;
+    uint64_t max_us;
+    uint64_t hist[QJ_TRACE_HIST_SLOTS];
+} BlockStats;
+
+typedef struct {
+    uint64_t req;                   // 0 = free slot
+    uint64_t start_us;
+    int is_write;
+} Pending;
+
+typedef struct {
+    uint64_t vdev;
+    uint64_t vq;
+    int index;                      // -1 until a kick names it
+    uint64_t kicks;
+    uint64_t interrupts;
+} Queue;
+
+struct QjTrace {
+    pthread_mutex_t lock;
+    uint64_t started_ns;
+
+    char partial[LINE_MAX_BYTES];
+    size_t partial_len;
+    int partial_overflow;
+
+    uint64_t lines;
+    uint64_t unparsed;
+    EventCount events[MAX_EVENT_NAMES];
+    size_t event_count;
+    uint64_t other_events;          // past MAX_EVENT_NAMES distinct names
+
+    BlockStats reads;
+    BlockStats writes;
+    Pending pending[PENDING_SLOTS];
+    size_t inflight;
+    size_t inflight_max;
+    uint64_t blk_devices[MAX_BLK_DEVICES];
+    size_t blk_device_count;
+
+    Queue queues[MAX_QUEUES];
+    size_t queue_count;
+
+    uint64_t translations;
+    uint64_t translation_second;
+    uint64_t translations_this_second;
+    uint64_t translations_peak;
+
+    uint64_t kvm_exits[MAX_KVM_REASONS];
+};
+
+QjTrace *qj_trace_create(void) {
+    QjTrace *trace = (QjTrace *)calloc(1, sizeof(QjTrace));
+    if (!trace) {
+        return NULL;
+    }
+    pthread_mutex_init(&trace->lock, NULL);
+    trace->started_ns = qj_now_ns();
+    return trace;
+}
+
+void qj_trace_destroy(QjTrace *trace) {
+    if (!trace) {
+        return;
+    }
+    pthread_mutex_destroy(&trace->lock);
+    free(trace);
+}
+
+void qj_trace_reset(QjTrace *trace) {
+    pthread_mutex_lock(&trace->lock);
+    // Everything after the lock is plain counters
+    size_t offset = offsetof(QjTrace, started_ns);
+    memset((char *)trace + offset, 0, sizeof(QjTrace) - offset);
+    trace->started_ns = qj_now_ns();
+    pthread_mutex_unlock(&trace->lock);
+}
+
+// ============== Parsing ==============
+
+/* Value after "<key> " in an argument list, as printed by %p / %d / %zu */
+static int arg_u64(const char *args, const char *key, uint64_t *out) {
+    size_t klen = strlen(key);
+    for (const char *p = args; (p = strstr(p, key)) != NULL; p += klen) {
+        if ((p == args || p[-1] == ' ') && p[klen] == ' ') {
+            char *end;
+            *out = strtoull(p + klen + 1, &end, 0);
+            return end != p + klen + 1;
+        }
+    }
+    return 0;
+}
+
+static void count_event(QjTrace *trace, const char *name, size_t len) {
+    if (len >= EVENT_NAME_MAX) {
+        len = EVENT_NAME_MAX - 1;
+    }
+    for (size_t i = 0; i < trace->event_count; i++) {
+        if (strncmp(trace->events[i].name, name, len) == 0 && trace->events[i].name[len] == '\0') {
+            trace->events[i].count++;
+            return;
+        }
+    }
+    if (trace->event_count == MAX_EVENT_NAMES) {
+        trace->other_events++;
+        return;
+    }
+    EventCount *e = &trace->events[trace->event_count++];
+    memcpy(e->name, name, len);
+    e->name[len] = '\0';
+    e->count = 1;
+}
+
+static int hist_slot(uint64_t us) {
+    int slot = 0;
+    while (us > 1 && slot < QJ_TRACE_HIST_SLOTS - 1) {
+        us >>= 1;
+        slot++;
+    }
+    return slot;
+}
+
+static void note_blk_device(QjTrace *trace, uint64_t vdev) {
+    for (size_t i = 0; i < trace->blk_device_count; i++) {
+        if (trace->blk_devices[i] == vdev) {
+            return;
+        }
+    }
+    if (trace->blk_device_count < MAX_BLK_DEVICES) {
+        trace->blk_devices[trace->blk_device_count++] = vdev;
+    }
+}
+
+/* Linear probing with backward-shift deletion, so no tombstones build up */
+static size_t pending_home(uint64_t req) {
+    return (size_t)((req >> 4) * 0x9E3779B97F4A7C15ull >> 32) & (PENDING_SLOTS - 1);
+}
+
+static void pending_add(QjTrace *trace, uint64_t req, uint64_t now_us, int is_write) {
+    if (trace->inflight >= PENDING_SLOTS / 2) {
+        // Completions aren't arriving (event disabled mid-run); don't fill up
+        return;
+    }
+    size_t i = pending_home(req);
+    while (trace->pending[i].req && trace->pending[i].req != req) {
+        i = (i + 1) & (PENDING_SLOTS - 1);
+    }
+    if (!trace->pending[i].req) {
+        trace->inflight++;
+        if (trace->inflight > trace->inflight_max) {
+            trace->inflight_max = trace->inflight;
+        }
+    }
+    trace->pending[i] = (Pending){req, now_us, is_write};
+}
+
+static int pending_take(QjTrace *trace, uint64_t req, Pending *out) {
+    size_t i = pending_home(req);
+    while (trace->pending[i].req != req) {
+        if (!trace->pending[i].req) {
+            return 0;
+        }
+        i = (i + 1) & (PENDING_SLOTS - 1);
+    }
+    *out = trace->pending[i];
+    trace->inflight--;
+    size_t hole = i;
+    for (size_t j = (i + 1) & (PENDING_SLOTS - 1); trace->pending[j].req; j = (j + 1) & (PENDING_SLOTS - 1)) {
+        size_t home = pending_home(trace->pending[j].req);
+        // Move j into the hole unless its home lies cyclically in (hole, j]
+        if (((j - home) & (PENDING_SLOTS - 1)) >= ((j - hole) & (PENDING_SLOTS - 1))) {
+            trace->pending[hole] = trace->pending[j];
+            hole = j;
+        }
+    }
+    trace->pending[hole].req = 0;
+    return 1;
+}
+
+static Queue *find_queue(QjTrace *trace, uint64_t vdev, uint64_t vq) {
+    for (size_t i = 0; i < trace->queue_count; i++) {
+        if (trace->queues[i].vdev == vdev && trace->queues[i].vq == vq) {
+            return &trace->queues[i];
+        }
+    }
+    if (trace->queue_count == MAX_QUEUES) {
+        return NULL;
+    }
+    Queue *q = &trace->queues[trace->queue_count++];
+    *q = (Queue){vdev, vq, -1, 0, 0};
+    return q;
+}
+
+static void on_block_request(QjTrace *trace, const char *args, uint64_t now_us, int is_write) {
+    uint64_t vdev = 0, req, nsectors = 0;
+    if (!arg_u64(args, "req", &req)) {
+        trace->unparsed++;
+        return;
+    }
+    arg_u64(args, "nsectors", &nsectors);
+    if (arg_u64(args, "vdev", &vdev)) {
+        note_blk_device(trace, vdev);
+    }
+    BlockStats *stats = is_write ? &trace->writes : &trace->reads;
+    stats->requests++;
+    stats->bytes += nsectors * 512;
+    pending_add(trace, req, now_us, is_write);
+}
+
+static void on_block_complete(QjTrace *trace, const char *args, uint64_t now_us) {
+    uint64_t req, ret = 0;
+    Pending p;
+    if (!arg_u64(args, "req", &req)) {
+        trace->unparsed++;
+        return;
+    }
+    if (!pending_take(trace, req, &p)) {
+        // Issued before tracing started, or a flush
+        return;
+    }
+    BlockStats *stats = p.is_write ? &trace->writes : &trace->reads;
+    uint64_t us = now_us > p.start_us ? now_us - p.start_us : 0;
+    stats->hist[hist_slot(us)]++;
+    if (us > stats->max_us) {
+        stats->max_us = us;
+    }
+    // ret is an int printed with %d; negative is an errno
+    if (arg_u64(args, "ret", &ret) && (int64_t)ret < 0) {
+        stats->errors++;
+    }
+}
+
+static void on_translate(QjTrace *trace, uint64_t now_us) {
+    trace->translations++;
+    uint64_t second = now_us / 1000000;
+    if (second != trace->translation_second) {
+        trace->translation_second = second;
+        trace->translations_this_second = 0;
+    }
+    if (++trace->translations_this_second > trace->translations_peak) {
+        trace->translations_peak = trace->translations_this_second;
+    }
+}
+
+static void parse_line(QjTrace *trace, const char *line) {
+    trace->lines++;
+
+    // "<tid>@<sec>.<usec>:" with -msg timestamp=on; arrival time otherwise
+    uint64_t now_us = 0;
+    const char *name = line;
+    const char *at = strchr(line, '@');
+    const char *colon = at ? strchr(at, ':') : NULL;
+    if (at && colon && colon - line < 40) {
+        char *end;
+        uint64_t sec = strtoull(at + 1, &end, 10);
+        uint64_t usec = *end == '.' ? strtoull(end + 1, NULL, 10) : 0;
+        now_us = sec * 1000000 + usec;
+        name = colon + 1;
+    } else {
+        now_us = qj_now_ns() / 1000;
+    }
+
+    size_t name_len = strcspn(name, " ");
+    if (name_len == 0) {
+        trace->unparsed++;
+        return;
+    }
+    const char *args = name + name_len;
+    count_event(trace, name, name_len);
+
+#define IS(event) (name_len == sizeof(event) - 1 && strncmp(name, event, name_len) == 0)
+    if (IS("virtio_blk_handle_read")) {
+        on_block_request(trace, args, now_us, 0);
+    } else if (IS("virtio_blk_handle_write")) {
+        on_block_request(trace, args, now_us, 1);
+    } else if (IS("virtio_blk_rw_complete")) {
+        on_block_complete(trace, args, now_us);
+    } else if (IS("virtio_queue_notify")) {
+        uint64_t vdev, n, vq;
+        Queue *q;
+        if (arg_u64(args, "vdev", &vdev) && arg_u64(args, "n", &n) && arg_u64(args, "vq", &vq)
+                && (q = find_queue(trace, vdev, vq)) != NULL) {
+            q->index = (int)n;
+            q->kicks++;
+        }
+    } else if (IS("virtio_notify")) {
+        uint64_t vdev, vq;
+        Queue *q;
+        if (arg_u64(args, "vdev", &vdev) && arg_u64(args, "vq", &vq)
+                && (q = find_queue(trace, vdev, vq)) != NULL) {
+            q->interrupts++;
+        }
+    } else if (IS("translate_block")) {
+        on_translate(trace, now_us);
+    } else if (IS("kvm_run_exit")) {
+        uint64_t reason;
+        if (arg_u64(args, "reason", &reason) && reason < MAX_KVM_REASONS) {
+            trace->kvm_exits[reason]++;
+        }
+    }
+#undef IS
+}
+
+void qj_trace_feed(QjTrace *trace, const char *data, size_t len) {
+    pthread_mutex_lock(&trace->lock);
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c != '\n') {
+            if (trace->partial_len < LINE_MAX_BYTES - 1) {
+                trace->partial[trace->partial_len++] = c;
+            } else {
+                trace->partial_overflow = 1;
+            }
+            continue;
+        }
+        trace->partial[trace->partial_len] = '\0';
+        if (trace->partial_overflow) {
+            trace->lines++;
+            trace->unparsed++;
+        } else if (trace->partial_len) {
+            parse_line(trace, trace->partial);
+        }
+        trace->partial_len = 0;
+        trace->partial_overflow = 0;
+    }
+    pthread_mutex_unlock(&trace->lock);
+}
+
+// ============== Summary ==============
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+} Json;
+
+static void emit(Json *j, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void emit(Json *j, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = j->len < j->size ? j->size - j->len : 0;
+    int n = vsnprintf(room ? j->buf + j->len : NULL, room, fmt, ap);
+    va_end(ap);
+    if (n > 0) {
+        j->len += (size_t)n;
+    }
+}
+
+/* Interpolated inside the log2 bucket the rank falls in, never past the max seen */
+static uint64_t percentile_us(const uint64_t *hist, uint64_t total, double p, uint64_t max_us) {
+    if (total == 0) {
+        return 0;
+    }
+    double rank = p * (double)total;
+    uint64_t seen = 0;
+    for (int i = 0; i < QJ_TRACE_HIST_SLOTS; i++) {
+        if (hist[i] && (double)(seen + hist[i]) >= rank) {
+            double low = i == 0 ? 0 : (double)(1ull << i);
+            double high = (double)(1ull << (i + 1));
+            uint64_t us = (uint64_t)(low + (rank - (double)seen) / (double)hist[i] * (high - low));
+            return us < max_us ? us : max_us;
+        }
+        seen += hist[i];
+    }
+    return max_us;
+}
+
+static void emit_block(Json *j, const char *name, const BlockStats *s) {
+    uint64_t completed = 0;
+    int last = -1;
+    for (int i = 0; i < QJ_TRACE_HIST_SLOTS; i++) {
+        completed += s->hist[i];
+        if (s->hist[i]) {
+            last = i;
+        }
+    }
+    emit(j, "\"%s\":{\"requests\":%llu,\"completed\":%llu,\"bytes\":%llu,\"errors\":%llu,"
+            "\"p50Us\":%llu,\"p99Us\":%llu,\"maxUs\":%llu,\"histogram\":[",
+         name, (unsigned long long)s->requests, (unsigned long long)completed,
+         (unsigned long long)s->bytes, (unsigned long long)s->errors,
+         (unsigned long long)percentile_us(s->hist, completed, 0.50, s->max_us),
+         (unsigned long long)percentile_us(s->hist, completed, 0.99, s->max_us),
+         (unsigned long long)s->max_us);
+    for (int i = 0; i <= last; i++) {
+        emit(j, i ? ",%llu" : "%llu", (unsigned long long)s->hist[i]);
+    }
+    emit(j, "]}");
+}
+
+static int is_blk_device(const QjTrace *trace, uint64_t vdev) {
+    for (size_t i = 0; i < trace->blk_device_count; i++) {
+        if (trace->blk_devices[i] == vdev) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t qj_trace_summary_json(QjTrace *trace, char *buf, size_t size) {
+    Json j = {buf, size, 0};
+    pthread_mutex_lock(&trace->lock);
+
+    emit(&j, "{\"elapsedMs\":%llu,\"lines\":%llu,\"unparsed\":%llu,\"events\":{",
+         (unsigned long long)((qj_now_ns() - trace->started_ns) / 1000000),
+         (unsigned long long)trace->lines, (unsigned long long)trace->unparsed);
+    for (size_t i = 0; i < trace->event_count; i++) {
+        emit(&j, "%s\"%s\":%llu", i ? "," : "", trace->events[i].name,
+             (unsigned long long)trace->events[i].count);
+    }
+    if (trace->other_events) {
+        emit(&j, "%s\"other\":%llu", trace->event_count ? "," : "", (unsigned long long)trace->other_events);
+    }
+
+    emit(&j, "},\"block\":{");
+    emit_block(&j, "read", &trace->reads);
+    emit(&j, ",");
+    emit_block(&j, "write", &trace->writes);
+    emit(&j, ",\"inflight\":%zu,\"inflightMax\":%zu},\"virtqueues\":[", trace->inflight, trace->inflight_max);
+
+    // Devices are only known by address; number them in order of appearance
+    uint64_t vdevs[MAX_QUEUES];
+    size_t vdev_count = 0;
+    for (size_t i = 0; i < trace->queue_count; i++) {
+        const Queue *q = &trace->queues[i];
+        size_t device = 0;
+        while (device < vdev_count && vdevs[device] != q->vdev) {
+            device++;
+        }
+        if (device == vdev_count) {
+            vdevs[vdev_count++] = q->vdev;
+        }
+        emit(&j, "%s{\"device\":%zu,\"kind\":\"%s\",\"queue\":%d,\"kicks\":%llu,\"interrupts\":%llu}",
+             i ? "," : "", device, is_blk_device(trace, q->vdev) ? "blk" : "virtio", q->index,
+             (unsigned long long)q->kicks, (unsigned long long)q->interrupts);
+    }
+
+    emit(&j, "],\"tcg\":{\"translations\":%llu,\"peakPerSecond\":%llu},\"kvmExits\":{",
+         (unsigned long long)trace->translations, (unsigned long long)trace->translations_peak);
+    int first = 1;
+    for (int i = 0; i < MAX_KVM_REASONS; i++) {
+        if (trace->kvm_exits[i]) {
+            emit(&j, "%s\"%d\":%llu", first ? "" : ",", i, (unsigned long long)trace->kvm_exits[i]);
+            first = 0;
+        }
+    }
+    emit(&j, "}}");
+
+    pthread_mutex_unlock(&trace->lock);
+    if (size > 0 && j.len >= size) {
+        buf[size - 1] = '\0';
+    }
+    return j.len;
+}
@@ -0,0 +1,60 @@
+/**
+ * QEMU trace event summarizer
+ *
+ * Consumes the text QEMU's "log" trace backend writes (one event per
+ * line, "<tid>@<sec>.<usec>:<event> <args>" with -msg timestamp=on) and
+ * keeps running aggregates instead of the events themselves, so a reader
+ * can keep up with a busy guest and the summary costs the same after a
+ * minute or an hour:
+ *
+ *   every event            count per name
+ *   virtio_blk_handle_*    read/write requests and bytes; latency up to
+ *   virtio_blk_rw_complete the matching completion, log2 histogram of us
+ *   virtio_queue_notify    guest kicks per virtqueue
+ *   virtio_notify          interrupts into the guest per virtqueue
+ *   translate_block        TCG translations, total and peak per second
+ *   kvm_run_exit           exits per reason (KVM hosts only)
+ *
+ * The event list is curated in scripts/qemu/trace-events; anything else
+ * enabled there is still counted by name. Shared by the JNI trace pump
+ * (qj_transfer.c) and the qj-trace host tool.
+ */
+
+#ifndef QJ_TRACE_H
+#define QJ_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// log2 buckets of microseconds: bucket n counts [2^n, 2^(n+1)) us
+#define QJ_TRACE_HIST_SLOTS 27
+
+typedef struct QjTrace QjTrace;
+
+/**
+ * Returns NULL on allocation failure
+ */
+QjTrace *qj_trace_create(void);
+
+void qj_trace_destroy(QjTrace *trace);
+
+/**
+ * Drop every aggregate and in-flight request; the summary window starts now
+ */
+void qj_trace_reset(QjTrace *trace);
+
+/**
+ * Feed raw backend output. Lines may be split across calls; a partial
+ * line is kept until its newline arrives. Thread-safe against
+ * qj_trace_summary_json and qj_trace_reset.
+ */
+void qj_trace_feed(QjTrace *trace, const char *data, size_t len);
+
+/**
+ * Write the summary since the last reset as JSON into buf (always
+ * NUL-terminated when size > 0). Returns the length the whole document
+ * needs, like snprintf, so a caller can retry with a larger buffer.
+ */
+size_t qj_trace_summary_json(QjTrace *trace, char *buf, size_t size);
+
+#endif // QJ_TRACE_H
@@ -0,0 +1,782 @@
+/**
+ * Bulk transfer natives for NativeTransfer.kt
+ *
+ * Rings are exposed to Kotlin as direct ByteBuffers over native memory; the
+ * producers here (log pump, stats sampler, benchmark) run on native threads
+ * and never call into the JVM, so they don't need to be attached. The trace
+ * pump is the exception to "everything goes through a ring": QEMU trace
+ * events arrive far faster than Kotlin wants them, so it folds them into a
+ * QjTrace summary that Kotlin polls as JSON. The container log index
+ * (qj_logindex.h) is fed directly too, by Kotlin's log followers.
+ */
+
+#include "qj_transfer.h"
+#include "qj_jvm.h"
+#include "qj_log.h"
+#include "qj_logindex.h"
+#include "qj_proc.h"
+#include "qj_ring.h"
+#include "qj_trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRANSFER_CLASS "com/dockerandroid/app/qemu/NativeTransfer"
+
+#define MAX_RINGS 8
+#define LOG_LINE_MAX 4096
+#define LOG_POLL_MS 100
+#define TRACE_PIPE_BYTES (1 << 20)
+#define TRACE_SUMMARY_BYTES 16384
+
+static QjRing *rings[MAX_RINGS] = {NULL};
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Background producer thread with a stop flag
+typedef struct {
+    pthread_t thread;
+    int started;
+    atomic_int stop;
+    QjRing *ring;
+
+    // Log pump
+    char path[512];
+    int64_t offset;
+
+    // Stats sampler / benchmark
+    pid_t pid;
+    int interval_ms;
+    int count;
+    int payload_bytes;
+
+    // Trace pump
+    int fd;
+} Producer;
+
+static Producer log_pump;
+static Producer stats_sampler;
+static Producer bench_producer;
+static Producer trace_pump;
+static QjTrace *trace_summary;
+
+static QjRing *get_ring(jint id) {
+    QjRing *ring = NULL;
+    pthread_mutex_lock(&rings_lock);
+    if (id >= 0 && id < MAX_RINGS) {
+        ring = rings[id];
+    }
+    pthread_mutex_unlock(&rings_lock);
+    return ring;
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+}
+
+static void producer_stop(Producer *p) {
+    if (!p->started) {
+        return;
+    }
+    atomic_store(&p->stop, 1);
+    pthread_join(p->thread, NULL);
+    p->started = 0;
+}
+
+static int producer_start(Producer *p, void *(*fn)(void *)) {
+    atomic_store(&p->stop, 0);
+    if (pthread_create(&p->thread, NULL, fn, p) != 0) {
+        LOGE("Failed to start producer thread: %s", strerror(errno));
+        return 0;
+    }
+    p->started = 1;
+    return 1;
+}
+
+// ============== Log pump ==============
+
+/**
+ * Tails the QEMU serial log and publishes one LOG record per line
+ */
+static void *log_pump_main(void *arg) {
+    Producer *p = (Producer *)arg;
+    char buf[16384];
+    char line[LOG_LINE_MAX];
+    size_t line_len = 0;
+    int fd = -1;
+
+    while (!atomic_load(&p->stop)) {
+        if (fd < 0) {
+            fd = open(p->path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                sleep_ms(LOG_POLL_MS);
+                continue;
+            }
+            lseek(fd, p->offset, SEEK_SET);
+        }
+
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // Log rotated or truncated under us - start over
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size < p->offset) {
+                p->offset = 0;
+                lseek(fd, 0, SEEK_SET);
+                continue;
+            }
+            sleep_ms(LOG_POLL_MS);
+            continue;
+        }
+        p->offset += n;
+
+        uint64_t now = qj_now_ns();
+        for (ssize_t i = 0; i < n; i++) {
+            char c = buf[i];
+            if (c == '\n' || line_len == sizeof(line)) {
+                if (line_len && line[line_len - 1] == '\r') {
+                    line_len--;
+                }
+                qj_ring_write(p->ring, QJ_REC_LOG, 0, now, line, (uint32_t)line_len);
+                line_len = 0;
+                if (c == '\n') {
+                    continue;
+                }
+            }
+            line[line_len++] = c;
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    return NULL;
+}
+
+static jboolean native_log_pump_start(JNIEnv *env, jclass clazz,
+                                      jint ring_id, jstring path, jlong offset) {
+    QjRing *ring = get_ring(ring_id);
+    if (!ring) {
+        return JNI_FALSE;
+    }
+
+    producer_stop(&log_pump);
+
+    const char *file = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!file) {
+        return JNI_FALSE;
+    }
+    snprintf(log_pump.path, sizeof(log_pump.path), "%s", file);
+    (*env)->ReleaseStringUTFChars(env, path, file);
+
+    log_pump.ring = ring;
+    log_pump.offset = offset;
+    return producer_start(&log_pump, log_pump_main) ? JNI_TRUE : JNI_FALSE;
+}
+
+static jlong native_log_pump_stop(JNIEnv *env, jclass clazz) {
+    producer_stop(&log_pump);
+    return log_pump.offset;
+}
+
+// ============== Trace pump ==============
+
+/**
+ * Drains QEMU's trace FIFO into trace_summary. QEMU blocks on a full pipe,
+ * so this only parses and never waits on anything but the FIFO itself.
+ */
+static void *trace_pump_main(void *arg) {
+    Producer *p = (Producer *)arg;
+    char buf[65536];
+
+    while (!atomic_load(&p->stop)) {
+        struct pollfd pfd = { p->fd, POLLIN, 0 };
+        if (poll(&pfd, 1, LOG_POLL_MS) <= 0) {
+            continue;
+        }
+        ssize_t n = read(p->fd, buf, sizeof(buf));
+        if (n > 0) {
+            qj_trace_feed(trace_summary, buf, (size_t)n);
+        } else if (n == 0 || errno != EINTR) {
+            // No writer (QEMU gone or not started yet): POLLHUP until one opens
+            sleep_ms(LOG_POLL_MS);
+        }
+    }
+
+    close(p->fd);
+    p->fd = -1;
+    return NULL;
+}
+
+/**
+ * Open the FIFO QEMU's "log" trace backend writes to (-trace file=) and
+ * start summarizing. Must run before QEMU starts: QEMU opens the file for
+ * writing at startup, which blocks on a FIFO until a reader has it open.
+ */
+static jboolean native_trace_pump_start(JNIEnv *env, jclass clazz, jstring path) {
+    producer_stop(&trace_pump);
+
+    if (!trace_summary && !(trace_summary = qj_trace_create())) {
+        return JNI_FALSE;
+    }
+
+    const char *file = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!file) {
+        return JNI_FALSE;
+    }
+    // Non-blocking so the open doesn't wait for QEMU to become the writer
+    int fd = open(file, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Failed to open trace FIFO %s: %s", file, strerror(errno));
+        (*env)->ReleaseStringUTFChars(env, path, file);
+        return JNI_FALSE;
+    }
+    (*env)->ReleaseStringUTFChars(env, path, file);
+
+    // Room for bursts (a TB flush retranslates everything) while we parse
+    if (fcntl(fd, F_SETPIPE_SZ, TRACE_PIPE_BYTES) < 0) {
+        LOGW("Trace FIFO keeps its default size: %s", strerror(errno));
+    }
+
+    trace_pump.fd = fd;
+    if (!producer_start(&trace_pump, trace_pump_main)) {
+        close(fd);
+        trace_pump.fd = -1;
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+static void native_trace_pump_stop(JNIEnv *env, jclass clazz) {
+    producer_stop(&trace_pump);
+}
+
+static void native_trace_reset(JNIEnv *env, jclass clazz) {
+    if (trace_summary) {
+        qj_trace_reset(trace_summary);
+    }
+}
+
+/**
+ * Summary since the last reset as JSON (see qj_trace.h), or null before
+ * the pump ever started
+ */
+static jstring native_trace_summary(JNIEnv *env, jclass clazz) {
+    if (!trace_summary) {
+        return NULL;
+    }
+    size_t size = TRACE_SUMMARY_BYTES;
+    char *json = (char *)malloc(size);
+    size_t needed = json ? qj_trace_summary_json(trace_summary, json, size) : 0;
+    if (json && needed >= size) {
+        size = needed + 1024;
+        char *bigger = (char *)realloc(json, size);
+        if (bigger) {
+            json = bigger;
+            qj_trace_summary_json(trace_summary, json, size);
+        }
+    }
+    jstring result = json ? (*env)->NewStringUTF(env, json) : NULL;
+    free(json);
+    return result;
+}
+
+// ============== Container log index ==============
+
+// Feeds and searches share the index; open and close replace it
+static pthread_rwlock_t log_index_lock = PTHREAD_RWLOCK_INITIALIZER;
+static QjLogIndex *log_index;
+
+static jboolean native_log_index_open(JNIEnv *env, jclass clazz, jstring dir, jlong max_bytes,
+                                      jlong max_age_ms) {
+    const char *path = (*env)->GetStringUTFChars(env, dir, NULL);
+    if (!path) {
+        return JNI_FALSE;
+    }
+    pthread_rwlock_wrlock(&log_index_lock);
+    qj_logindex_close(log_index);
+    log_index = qj_logindex_open(path, (uint64_t)max_bytes, (int64_t)max_age_ms);
+    if (!log_index) {
+        LOGE("Failed to open log index %s: %s", path, strerror(errno));
+    }
+    jboolean opened = log_index ? JNI_TRUE : JNI_FALSE;
+    pthread_rwlock_unlock(&log_index_lock);
+    (*env)->ReleaseStringUTFChars(env, dir, path);
+    return opened;
+}
+
+static void native_log_index_close(JNIEnv *env, jclass clazz) {
+    pthread_rwlock_wrlock(&log_index_lock);
+    qj_logindex_close(log_index);
+    log_index = NULL;
+    pthread_rwlock_unlock(&log_index_lock);
+}
+
+/**
+ * Raw bytes read from GET /containers/<id>/logs?follow=1&timestamps=1
+ */
+static jboolean native_log_index_feed(JNIEnv *env, jclass clazz, jstring id, jboolean tty,
+                                      jbyteArray data, jint len) {
+    const char *container = (*env)->GetStringUTFChars(env, id, NULL);
+    if (!container) {
+        return JNI_FALSE;
+    }
+    jbyte *bytes = (*env)->GetByteArrayElements(env, data, NULL);
+    int rc = -ENOMEM;
+    if (bytes && (len < 0 || len > (*env)->GetArrayLength(env, data))) {
+        rc = -EINVAL;
+    } else if (bytes) {
+        pthread_rwlock_rdlock(&log_index_lock);
+        rc = log_index ? qj_logindex_feed(log_index, container, tty, (const char *)bytes, (size_t)len)
+                       : -EBADF;
+        pthread_rwlock_unlock(&log_index_lock);
+    }
+    if (bytes) {
+        (*env)->ReleaseByteArrayElements(env, data, bytes, JNI_ABORT);
+    }
+    if (rc != 0 && rc != -EBADF) {
+        LOGW("Log index feed for %s: %s", container, strerror(-rc));
+    }
+    (*env)->ReleaseStringUTFChars(env, id, container);
+    return rc == 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+static void native_log_index_set_name(JNIEnv *env, jclass clazz, jstring id, jstring name) {
+    const char *container = (*env)->GetStringUTFChars(env, id, NULL);
+    const char *value = container ? (*env)->GetStringUTFChars(env, name, NULL) : NULL;
+    if (value) {
+        pthread_rwlock_rdlock(&log_index_lock);
+        if (log_index) {
+            qj_logindex_set_name(log_index, container, value);
+        }
+        pthread_rwlock_unlock(&log_index_lock);
+        (*env)->ReleaseStringUTFChars(env, name, value);
+    }
+    if (container) {
+        (*env)->ReleaseStringUTFChars(env, id, container);
+    }
+}
+
+/**
+ * Newest sealed timestamp for the container in ns, 0 if none: the since=
+ * a follower resumes from
+ */
+static jlong native_log_index_last_timestamp(JNIEnv *env, jclass clazz, jstring id) {
+    const char *container = (*env)->GetStringUTFChars(env, id, NULL);
+    if (!container) {
+        return 0;
+    }
+    pthread_rwlock_rdlock(&log_index_lock);
+    int64_t last = log_index ? qj_logindex_last_ns(log_index, container) : 0;
+    pthread_rwlock_unlock(&log_index_lock);
+    (*env)->ReleaseStringUTFChars(env, id, container);
+    return (jlong)last;
+}
+
+static void native_log_index_flush(JNIEnv *env, jclass clazz) {
+    pthread_rwlock_rdlock(&log_index_lock);
+    if (log_index) {
+        int rc = qj_logindex_flush(log_index);
+        if (rc != 0) {
+            LOGW("Log index flush: %s", strerror(-rc));
+        }
+    }
+    pthread_rwlock_unlock(&log_index_lock);
+}
+
+/**
+ * Search JSON (see qj_logindex.h), or null without an index. Times are in
+ * ms, 0 for unbounded; stream is QJ_LOG_STDOUT, QJ_LOG_STDERR or 0.
+ */
+static jstring native_log_index_search(JNIEnv *env, jclass clazz, jstring text, jstring id,
+                                       jlong since_ms, jlong until_ms, jint stream, jint limit) {
+    QjLogQuery query = {
+        .since_ns = (int64_t)since_ms * 1000000,
+        .until_ns = (int64_t)until_ms * 1000000,
+        .stream = stream,
+        .limit = limit > 0 ? (size_t)limit : 0,
+    };
+    query.text = text ? (*env)->GetStringUTFChars(env, text, NULL) : NULL;
+    query.container = id ? (*env)->GetStringUTFChars(env, id, NULL) : NULL;
+
+    char *json = NULL;
+    if ((!text || query.text) && (!id || query.container)) {
+        pthread_rwlock_rdlock(&log_index_lock);
+        json = log_index ? qj_logindex_search(log_index, &query) : NULL;
+        pthread_rwlock_unlock(&log_index_lock);
+    }
+    if (query.text) {
+        (*env)->ReleaseStringUTFChars(env, text, query.text);
+    }
+    if (query.container) {
+        (*env)->ReleaseStringUTFChars(env, id, query.container);
+    }
+    // Plain ASCII, so modified UTF-8 is not a concern
+    jstring result = json ? (*env)->NewStringUTF(env, json) : NULL;
+    free(json);
+    return result;
+}
+
+static jstring native_log_index_stats(JNIEnv *env, jclass clazz) {
+    pthread_rwlock_rdlock(&log_index_lock);
+    char *json = log_index ? qj_logindex_stats(log_index) : NULL;
+    pthread_rwlock_unlock(&log_index_lock);
+    jstring result = json ? (*env)->NewStringUTF(env, json) : NULL;
+    free(json);
+    return result;
+}
+
+// ============== Stats sampler ==============
+
+/**
+ * Publishes one STATS record (QJ_SAMPLE_FIELDS int64s) per interval.
+ * flags = 1 marks the final record after the process has gone away.
+ */
+static void *stats_main(void *arg) {
+    Producer *p = (Producer *)arg;
+    int64_t sample[QJ_SAMPLE_FIELDS];
+
+    while (!atomic_load(&p->stop)) {
+        if (qj_proc_sample(p->pid, sample) != 0) {
+            memset(sample, 0, sizeof(sample));
+            sample[QJ_SAMPLE_PID] = p->pid;
+            qj_ring_write(p->ring, QJ_REC_STATS, 1, qj_now_ns(), sample, sizeof(sample));
+            break;
+        }
+        qj_ring_write(p->ring, QJ_REC_STATS, 0, qj_now_ns(), sample, sizeof(sample));
+
+        for (int waited = 0; waited < p->interval_ms && !atomic_load(&p->stop); waited += 50) {
+            sleep_ms(50);
+        }
+    }
+    return NULL;
+}
+
+static jboolean native_stats_start(JNIEnv *env, jclass clazz,
+                                   jint ring_id, jint pid, jint interval_ms) {
+    QjRing *ring = get_ring(ring_id);
+    if (!ring || pid <= 0) {
+        return JNI_FALSE;
+    }
+
+    producer_stop(&stats_sampler);
+    stats_sampler.ring = ring;
+    stats_sampler.pid = pid;
+    stats_sampler.interval_ms = interval_ms < 100 ? 100 : interval_ms;
+    return producer_start(&stats_sampler, stats_main) ? JNI_TRUE : JNI_FALSE;
+}
+
+static void native_stats_stop(JNIEnv *env, jclass clazz) {
+    producer_stop(&stats_sampler);
+}
+
+// ============== Batch sampling (critical arrays) ==============
+
+/**
+ * Sample every pid in pids into out (QJ_SAMPLE_FIELDS longs per pid).
+ * /proc is read before entering the critical region so the GC is never
+ * held off across syscalls. Entries that couldn't be read get pid -1.
+ * Returns the number of processes sampled successfully.
+ */
+static jint native_sample_processes(JNIEnv *env, jclass clazz,
+                                    jintArray pids, jlongArray out) {
+    jsize n = (*env)->GetArrayLength(env, pids);
+    if (n <= 0 || (*env)->GetArrayLength(env, out) < n * QJ_SAMPLE_FIELDS) {
+        return 0;
+    }
+
+    jint *pid_buf = (jint *)malloc(sizeof(jint) * n);
+    int64_t *samples = (int64_t *)malloc(sizeof(int64_t) * n * QJ_SAMPLE_FIELDS);
+    if (!pid_buf || !samples) {
+        free(pid_buf);
+        free(samples);
+        return 0;
+    }
+
+    (*env)->GetIntArrayRegion(env, pids, 0, n, pid_buf);
+
+    jint ok = 0;
+    for (jsize i = 0; i < n; i++) {
+        int64_t *s = samples + (size_t)i * QJ_SAMPLE_FIELDS;
+        if (qj_proc_sample(pid_buf[i], s) == 0) {
+            ok++;
+        } else {
+            memset(s, 0, sizeof(int64_t) * QJ_SAMPLE_FIELDS);
+            s[QJ_SAMPLE_PID] = -1;
+        }
+    }
+
+    jlong *dst = (jlong *)(*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (dst) {
+        memcpy(dst, samples, sizeof(int64_t) * n * QJ_SAMPLE_FIELDS);
+        (*env)->ReleasePrimitiveArrayCritical(env, out, dst, 0);
+    } else {
+        ok = 0;
+    }
+
+    free(pid_buf);
+    free(samples);
+    return ok;
+}
+
+// ============== Rings ==============
+
+static jint ring_register(QjRing *ring) {
+    pthread_mutex_lock(&rings_lock);
+    for (int i = 0; i < MAX_RINGS; i++) {
+        if (!rings[i]) {
+            rings[i] = ring;
+            pthread_mutex_unlock(&rings_lock);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&rings_lock);
+
+    qj_ring_destroy(ring);
+    LOGE("No free ring slots available");
+    return -1;
+}
+
+static jint native_ring_create(JNIEnv *env, jclass clazz, jint capacity) {
+    QjRing *ring = qj_ring_create(capacity > 0 ? (size_t)capacity : 0);
+    if (!ring) {
+        LOGE("Failed to allocate ring of %d bytes", capacity);
+        return -1;
+    }
+    return ring_register(ring);
+}
+
+static jint native_ring_create_shared(JNIEnv *env, jclass clazz, jint capacity) {
+    QjRing *ring = qj_ring_create_shared(capacity > 0 ? (size_t)capacity : 0, "qj-ring");
+    if (!ring) {
+        LOGE("Failed to create shared ring of %d bytes: %s", capacity, strerror(errno));
+        return -1;
+    }
+    return ring_register(ring);
+}
+
+/**
+ * Backing fd of a shared ring, still owned by the ring - callers that
+ * send it elsewhere must dup it (ParcelFileDescriptor.fromFd does)
+ */
+static jint native_ring_fd(JNIEnv *env, jclass clazz, jint id) {
+    QjRing *ring = get_ring(id);
+    return ring ? ring->fd : -1;
+}
+
+/**
+ * Map a ring received from another process; takes ownership of fd
+ */
+static jint native_ring_attach(JNIEnv *env, jclass clazz, jint fd) {
+    QjRing *ring = qj_ring_attach(fd);
+    if (!ring) {
+        LOGE("Rejected shared ring fd %d", fd);
+        return -1;
+    }
+    return ring_register(ring);
+}
+
+static jobject native_ring_buffer(JNIEnv *env, jclass clazz, jint id) {
+    QjRing *ring = get_ring(id);
+    if (!ring) {
+        return NULL;
+    }
+    return (*env)->NewDirectByteBuffer(env, ring->hdr, (jlong)ring->map_size);
+}
+
+/*
+ * The consumer calls below run under rings_lock so native_ring_destroy
+ * can't unmap the ring between the lookup and the access. Kotlin's own
+ * reads through the DirectByteBuffer are fenced by Ring.close().
+ */
+static jlong native_ring_readable(JNIEnv *env, jclass clazz, jint id) {
+    pthread_mutex_lock(&rings_lock);
+    QjRing *ring = (id >= 0 && id < MAX_RINGS) ? rings[id] : NULL;
+    jlong readable = ring ? (jlong)qj_ring_readable(ring) : 0;
+    pthread_mutex_unlock(&rings_lock);
+    return readable;
+}
+
+static void native_ring_commit(JNIEnv *env, jclass clazz, jint id, jlong tail) {
+    pthread_mutex_lock(&rings_lock);
+    QjRing *ring = (id >= 0 && id < MAX_RINGS) ? rings[id] : NULL;
+    if (ring) {
+        qj_ring_commit(ring, (uint64_t)tail);
+    }
+    pthread_mutex_unlock(&rings_lock);
+}
+
+static jlong native_ring_dropped(JNIEnv *env, jclass clazz, jint id) {
+    pthread_mutex_lock(&rings_lock);
+    QjRing *ring = (id >= 0 && id < MAX_RINGS) ? rings[id] : NULL;
+    jlong dropped = ring ? (jlong)atomic_load(&ring->hdr->dropped) : 0;
+    pthread_mutex_unlock(&rings_lock);
+    return dropped;
+}
+
+/**
+ * Unmaps the ring. The Kotlin Ring must not be drained afterwards:
+ * Ring.close() waits for a drain in progress and fences later ones.
+ */
+static void native_ring_destroy(JNIEnv *env, jclass clazz, jint id) {
+    pthread_mutex_lock(&rings_lock);
+    QjRing *ring = (id >= 0 && id < MAX_RINGS) ? rings[id] : NULL;
+    if (ring) {
+        rings[id] = NULL;
+    }
+    pthread_mutex_unlock(&rings_lock);
+
+    if (!ring) {
+        return;
+    }
+
+    // Producers hold a raw pointer - stop any that write to this ring
+    Producer *producers[] = { &log_pump, &stats_sampler, &bench_producer };
+    for (size_t i = 0; i < sizeof(producers) / sizeof(producers[0]); i++) {
+        if (producers[i]->started && producers[i]->ring == ring) {
+            producer_stop(producers[i]);
+        }
+    }
+    qj_ring_destroy(ring);
+}
+
+// ============== Benchmarks ==============
+
+static void *bench_main(void *arg) {
+    Producer *p = (Producer *)arg;
+    char payload[LOG_LINE_MAX];
+    memset(payload, 'x', sizeof(payload));
+
+    for (int i = 0; i < p->count && !atomic_load(&p->stop); ) {
+        memcpy(payload, &i, sizeof(i));
+        if (qj_ring_write(p->ring, QJ_REC_BENCH, 0, qj_now_ns(), payload,
+                          (uint32_t)p->payload_bytes) == 0) {
+            i++;
+        } else {
+            // Full - let the consumer catch up (don't count as a drop)
+            atomic_fetch_sub(&p->ring->hdr->dropped, 1);
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Start a native producer writing count BENCH records to the ring.
+ * Returns immediately; the caller drains and times the consumer side.
+ */
+static jboolean native_benchmark_produce(JNIEnv *env, jclass clazz,
+                                         jint ring_id, jint count, jint payload_bytes) {
+    QjRing *ring = get_ring(ring_id);
+    if (!ring || count <= 0) {
+        return JNI_FALSE;
+    }
+
+    producer_stop(&bench_producer);
+    bench_producer.ring = ring;
+    bench_producer.count = count;
+    bench_producer.payload_bytes = payload_bytes < (int)sizeof(int) ? (int)sizeof(int)
+                                 : payload_bytes > LOG_LINE_MAX ? LOG_LINE_MAX
+                                 : payload_bytes;
+    return producer_start(&bench_producer, bench_main) ? JNI_TRUE : JNI_FALSE;
+}
+
+static void native_benchmark_join(JNIEnv *env, jclass clazz) {
+    if (bench_producer.started) {
+        pthread_join(bench_producer.thread, NULL);
+        bench_producer.started = 0;
+    }
+}
+
+/**
+ * Baseline for comparison: one JNI call and one String per event
+ */
+static jstring native_benchmark_string(JNIEnv *env, jclass clazz, jint seq) {
+    char line[128];
+    snprintf(line, sizeof(line), "[%d] QEMU serial console line used as a per-event baseline", seq);
+    return (*env)->NewStringUTF(env, line);
+}
+
+// Must match the @JvmStatic external declarations in NativeTransfer.kt
+static const JNINativeMethod transfer_methods[] = {
+    { "nativeRingCreate", "(I)I", (void *)native_ring_create },
+    { "nativeRingCreateShared", "(I)I", (void *)native_ring_create_shared },
+    { "nativeRingFd", "(I)I", (void *)native_ring_fd },
+    { "nativeRingAttach", "(I)I", (void *)native_ring_attach },
+    { "nativeRingBuffer", "(I)Ljava/nio/ByteBuffer;", (void *)native_ring_buffer },
+    { "nativeRingReadable", "(I)J", (void *)native_ring_readable },
+    { "nativeRingCommit", "(IJ)V", (void *)native_ring_commit },
+    { "nativeRingDropped", "(I)J", (void *)native_ring_dropped },
+    { "nativeRingDestroy", "(I)V", (void *)native_ring_destroy },
+    { "nativeLogPumpStart", "(ILjava/lang/String;J)Z", (void *)native_log_pump_start },
+    { "nativeLogPumpStop", "()J", (void *)native_log_pump_stop },
+    { "nativeStatsStart", "(III)Z", (void *)native_stats_start },
+    { "nativeStatsStop", "()V", (void *)native_stats_stop },
+    { "nativeTracePumpStart", "(Ljava/lang/String;)Z", (void *)native_trace_pump_start },
+    { "nativeTracePumpStop", "()V", (void *)native_trace_pump_stop },
+    { "nativeTraceReset", "()V", (void *)native_trace_reset },
+    { "nativeTraceSummary", "()Ljava/lang/String;", (void *)native_trace_summary },
+    { "nativeLogIndexOpen", "(Ljava/lang/String;JJ)Z", (void *)native_log_index_open },
+    { "nativeLogIndexClose", "()V", (void *)native_log_index_close },
+    { "nativeLogIndexFeed", "(Ljava/lang/String;Z[BI)Z", (void *)native_log_index_feed },
+    { "nativeLogIndexSetName", "(Ljava/lang/String;Ljava/lang/String;)V", (void *)native_log_index_set_name },
+    { "nativeLogIndexLastTimestamp", "(Ljava/lang/String;)J", (void *)native_log_index_last_timestamp },
+    { "nativeLogIndexFlush", "()V", (void *)native_log_index_flush },
+    { "nativeLogIndexSearch", "(Ljava/lang/String;Ljava/lang/String;JJII)Ljava/lang/String;",
+      (void *)native_log_index_search },
+    { "nativeLogIndexStats", "()Ljava/lang/String;", (void *)native_log_index_stats },
+    { "nativeSampleProcesses", "([I[J)I", (void *)native_sample_processes },
+    { "nativeBenchmarkProduce", "(III)Z", (void *)native_benchmark_produce },
+    { "nativeBenchmarkJoin", "()V", (void *)native_benchmark_join },
+    { "nativeBenchmarkString", "(I)Ljava/lang/String;", (void *)native_benchmark_string },
+};
+
+jint qj_transfer_register(JNIEnv *env) {
+    jclass clazz = (*env)->FindClass(env, TRANSFER_CLASS);
+    if (!clazz) {
+        qj_jvm_check_exception(env, "FindClass " TRANSFER_CLASS);
+        return JNI_ERR;
+    }
+
+    jint count = (jint)(sizeof(transfer_methods) / sizeof(transfer_methods[0]));
+    jint rc = (*env)->RegisterNatives(env, clazz, transfer_methods, count);
+    (*env)->DeleteLocalRef(env, clazz);
+    if (rc != JNI_OK) {
+        qj_jvm_check_exception(env, "RegisterNatives " TRANSFER_CLASS);
+        return JNI_ERR;
+    }
+    return JNI_OK;
+}
+
+void qj_transfer_shutdown(void) {
+    producer_stop(&log_pump);
+    producer_stop(&stats_sampler);
+    producer_stop(&bench_producer);
+    producer_stop(&trace_pump);
+    qj_trace_destroy(trace_summary);
+    trace_summary = NULL;
+
+    pthread_rwlock_wrlock(&log_index_lock);
+    qj_logindex_close(log_index);
+    log_index = NULL;
+    pthread_rwlock_unlock(&log_index_lock);
+
+    pthread_mutex_lock(&rings_lock);
+    for (int i = 0; i < MAX_RINGS; i++) {
+        qj_ring_destroy(rings[i]);
+        rings[i] = NULL;
+    }
+    pthread_mutex_unlock(&rings_lock);
+}
@@ -0,0 +1,20 @@
+/**
+ * Bulk transfer natives (rings, log pump, stats sampler, batch sampling)
+ */
+
+#ifndef QJ_TRANSFER_H
+#define QJ_TRANSFER_H
+
+#include <jni.h>
+
+/**
+ * Register the NativeTransfer natives. Called from JNI_OnLoad.
+ */
+jint qj_transfer_register(JNIEnv *env);
+
+/**
+ * Stop producer threads and free all rings. Called from JNI_OnUnload.
+ */
+void qj_transfer_shutdown(void);
+
+#endif // QJ_TRANSFER_H
@@ -0,0 +1,56 @@
+/**
+ * Runtime-dispatched kernels for native hot paths
+ *
+ * Each kernel has a portable scalar implementation plus optional variants
+ * built with per-ABI flags (NEON/CRC on ARM, SSE4.2/AVX2 on x86_64). The
+ * best variant for the running CPU is selected once, on first use.
+ */
+
+#ifndef QJ_SIMD_H
+#define QJ_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Kernel table - one entry per hot path
+typedef struct {
+    const char *name;
+
+    // Returns 1 if all len bytes at buf are zero
+    int (*is_zero)(const void *buf, size_t len);
+
+    // CRC-32C (Castagnoli), chainable: pass the previous result as crc
+    uint32_t (*crc32c)(uint32_t crc, const void *buf, size_t len);
+} QjKernels;
+
+/**
+ * Returns the kernel table selected for this CPU (never NULL)
+ */
+const QjKernels *qj_kernels(void);
+
+/**
+ * Portable implementations, always available
+ */
+int qj_is_zero_scalar(const void *buf, size_t len);
+uint32_t qj_crc32c_scalar(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * Convenience wrappers over the dispatched table
+ */
+static inline int qj_is_zero(const void *buf, size_t len) {
+    return qj_kernels()->is_zero(buf, len);
+}
+
+static inline uint32_t qj_crc32c(uint32_t crc, const void *buf, size_t len) {
+    return qj_kernels()->crc32c(crc, buf, len);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QJ_SIMD_H
@@ -0,0 +1,26 @@
+/**
+ * AVX2 kernels (x86_64)
+ *
+ * Built with -mavx2; selected only when the CPU reports avx2.
+ */
+
+#include "simd/qj_simd_internal.h"
+
+#include <immintrin.h>
+
+int qj_is_zero_avx2(const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+
+    while (len >= 128) {
+        __m256i acc = _mm256_or_si256(
+            _mm256_or_si256(_mm256_loadu_si256((const __m256i *)p),
+                            _mm256_loadu_si256((const __m256i *)(p + 32))),
+            _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(p + 64)),
+                            _mm256_loadu_si256((const __m256i *)(p + 96))));
+        if (!_mm256_testz_si256(acc, acc)) return 0;
+        p += 128;
+        len -= 128;
+    }
+
+    return qj_is_zero_scalar(p, len);
+}
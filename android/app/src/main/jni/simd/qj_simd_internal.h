@@ -0,0 +1,28 @@
+/**
+ * Per-ABI kernel entry points
+ *
+ * Only qj_simd.c should include this. Every function declared here is
+ * compiled with ISA flags the baseline ABI does not guarantee, so it must
+ * not be called unless the dispatcher has verified CPU support.
+ */
+
+#ifndef QJ_SIMD_INTERNAL_H
+#define QJ_SIMD_INTERNAL_H
+
+#include "simd/qj_simd.h"
+
+#if defined(__aarch64__) || defined(__arm__)
+int qj_is_zero_neon(const void *buf, size_t len);
+#endif
+
+#if defined(__aarch64__)
+uint32_t qj_crc32c_armv8(uint32_t crc, const void *buf, size_t len);
+#endif
+
+#if defined(__x86_64__)
+int qj_is_zero_sse42(const void *buf, size_t len);
+uint32_t qj_crc32c_sse42(uint32_t crc, const void *buf, size_t len);
+int qj_is_zero_avx2(const void *buf, size_t len);
+#endif
+
+#endif // QJ_SIMD_INTERNAL_H
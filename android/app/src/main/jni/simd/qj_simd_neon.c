@@ -0,0 +1,53 @@
+/**
+ * NEON/ASIMD kernels (arm64-v8a, armeabi-v7a with NEON)
+ *
+ * Built with -march=armv8-a+crc on arm64 and -mfpu=neon on armv7.
+ */
+
+#include "simd/qj_simd_internal.h"
+
+#include <arm_neon.h>
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#endif
+
+int qj_is_zero_neon(const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+
+    while (len >= 64) {
+        uint8x16_t acc = vorrq_u8(
+            vorrq_u8(vld1q_u8(p), vld1q_u8(p + 16)),
+            vorrq_u8(vld1q_u8(p + 32), vld1q_u8(p + 48)));
+#if defined(__aarch64__)
+        if (vmaxvq_u8(acc)) return 0;
+#else
+        uint64x2_t wide = vreinterpretq_u64_u8(acc);
+        if (vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1)) return 0;
+#endif
+        p += 64;
+        len -= 64;
+    }
+
+    return qj_is_zero_scalar(p, len);
+}
+
+#if defined(__aarch64__)
+uint32_t qj_crc32c_armv8(uint32_t crc, const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+
+    crc = ~crc;
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = __crc32cb(crc, *p++);
+        len--;
+    }
+    while (len >= 8) {
+        crc = __crc32cd(crc, *(const uint64_t *)p);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return ~crc;
+}
+#endif
@@ -0,0 +1,45 @@
+/**
+ * SSE4.2 kernels (x86_64)
+ *
+ * Built with -msse4.2; selected only when the CPU reports sse4.2.
+ */
+
+#include "simd/qj_simd_internal.h"
+
+#include <nmmintrin.h>
+
+int qj_is_zero_sse42(const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+
+    while (len >= 64) {
+        __m128i acc = _mm_or_si128(
+            _mm_or_si128(_mm_loadu_si128((const __m128i *)p),
+                         _mm_loadu_si128((const __m128i *)(p + 16))),
+            _mm_or_si128(_mm_loadu_si128((const __m128i *)(p + 32)),
+                         _mm_loadu_si128((const __m128i *)(p + 48))));
+        if (!_mm_testz_si128(acc, acc)) return 0;
+        p += 64;
+        len -= 64;
+    }
+
+    return qj_is_zero_scalar(p, len);
+}
+
+uint32_t qj_crc32c_sse42(uint32_t crc, const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+    uint64_t c = ~crc;
+
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        c = _mm_crc32_u8((uint32_t)c, *p++);
+        len--;
+    }
+    while (len >= 8) {
+        c = _mm_crc32_u64(c, *(const uint64_t *)p);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        c = _mm_crc32_u8((uint32_t)c, *p++);
+    }
+    return ~(uint32_t)c;
+}
@@ -0,0 +1,218 @@
+/**
+ * qj-logindex: the container log index on a Linux host
+ *
+ * The same index the app keeps for the VM's containers (qj_logindex.c),
+ * for logs saved with `docker logs -t`, and a benchmark for query latency
+ * over a large synthetic index.
+ *
+ * Usage: qj-logindex [-d dir] [-m max_mb] <command>
+ *
+ *   ingest <id> [file | -]            index `docker logs -t` output
+ *   search [-c id] [-n limit] [-e] <text>
+ *                                     -e: stderr only
+ *   stats
+ *   bench <lines>                     synthesize lines, then time queries
+ */
+
+#include "qj_logindex.h"
+#include "qj_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *usage =
+    "usage: %s [-d dir] [-m max_mb] ingest <id> [file | -]\n"
+    "       %s [-d dir] search [-c id] [-n limit] [-e] <text>\n"
+    "       %s [-d dir] stats\n"
+    "       %s [-d dir] bench <lines>\n";
+
+static int ingest(QjLogIndex *index, int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        return 2;
+    }
+    const char *input = argc == 3 ? argv[2] : "-";
+    int fd = strcmp(input, "-") == 0 ? STDIN_FILENO : open(input, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "qj-logindex: %s: %s\n", input, strerror(errno));
+        return 1;
+    }
+    char buf[64 * 1024];
+    ssize_t n;
+    int rc = 0;
+    // `docker logs -t` text is the tty form: one stream, timestamped lines
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        if ((rc = qj_logindex_feed(index, argv[1], 1, buf, (size_t)n)) != 0) {
+            fprintf(stderr, "qj-logindex: %s\n", strerror(-rc));
+            break;
+        }
+    }
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return rc == 0 && n == 0 ? 0 : 1;
+}
+
+static int search(QjLogIndex *index, int argc, char **argv) {
+    QjLogQuery query = { .limit = 20 };
+    int opt;
+    optind = 1;
+    while ((opt = getopt(argc, argv, "c:n:e")) != -1) {
+        switch (opt) {
+        case 'c':
+            query.container = optarg;
+            break;
+        case 'n':
+            query.limit = (size_t)atoi(optarg);
+            break;
+        case 'e':
+            query.stream = QJ_LOG_STDERR;
+            break;
+        default:
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        return 2;
+    }
+    query.text = argv[optind];
+    char *json = qj_logindex_search(index, &query);
+    if (!json) {
+        return 1;
+    }
+    puts(json);
+    free(json);
+    return 0;
+}
+
+static const char *words[] = {
+    "GET", "POST", "request", "completed", "connection", "timeout", "user", "session",
+    "cache", "miss", "hit", "worker", "started", "listening", "upstream", "retry",
+    "database", "query", "slow", "checkpoint", "flushed", "bytes", "ms", "status",
+};
+
+/* Synthetic web/db style lines across four containers, 100 a second */
+static int bench(QjLogIndex *index, const char *dir, long lines) {
+    const char *ids[] = { "0123456789ab", "1123456789ab", "2123456789ab", "3123456789ab" };
+    const int nwords = (int)(sizeof(words) / sizeof(words[0]));
+    unsigned seed = 1;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    int64_t ts = ((int64_t)now.tv_sec - lines / 100) * 1000000000LL;
+
+    uint64_t started = qj_now_ns();
+    uint64_t raw_bytes = 0;
+    char line[256];
+    char rare[32] = "";
+    for (long i = 0; i < lines; i++) {
+        int len = snprintf(line, sizeof(line), "%ld", i);
+        for (int w = 0; w < 8; w++) {
+            seed = seed * 1103515245u + 12345u;
+            len += snprintf(line + len, sizeof(line) - (size_t)len, " %s", words[(seed >> 16) % nwords]);
+        }
+        seed = seed * 1103515245u + 12345u;
+        len += snprintf(line + len, sizeof(line) - (size_t)len, " id=%08x", seed);
+        if (i == lines / 3) {
+            snprintf(rare, sizeof(rare), "id=%08x", seed);
+        }
+        ts += 10000000;  // 100 lines a second
+        int stream = (seed >> 8) % 10 == 0 ? QJ_LOG_STDERR : QJ_LOG_STDOUT;
+        if (qj_logindex_append(index, ids[i % 4], stream, ts, line, (size_t)len) != 0) {
+            fprintf(stderr, "qj-logindex: append failed\n");
+            return 1;
+        }
+        raw_bytes += (uint64_t)len;
+    }
+    qj_logindex_flush(index);
+    double ingest_s = (double)(qj_now_ns() - started) / 1e9;
+    fprintf(stderr, "ingested %ld lines (%.1f MB) in %.2f s: %.0f lines/s\n", lines,
+            (double)raw_bytes / (1024 * 1024), ingest_s, (double)lines / ingest_s);
+
+    // Reopen so the queries below run against the on-disk index
+    qj_logindex_close(index);
+    index = qj_logindex_open(dir, 0, 0);
+    if (!index) {
+        return 1;
+    }
+    struct {
+        const char *label;
+        QjLogQuery query;
+    } queries[] = {
+        { "common word", { .text = "request", .limit = 100 } },
+        { "rare token", { .text = rare, .limit = 100 } },
+        { "absent", { .text = "no such line", .limit = 100 } },
+        { "stderr only", { .text = "timeout", .stream = QJ_LOG_STDERR, .limit = 100 } },
+        { "one container", { .text = "slow query", .container = "2123456789ab", .limit = 100 } },
+    };
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        char *json = qj_logindex_search(index, &queries[q].query);
+        if (!json) {
+            qj_logindex_close(index);
+            return 1;
+        }
+        const char *stats = strstr(json, "],\"more\"");
+        fprintf(stderr, "%-14s %s\n", queries[q].label, stats ? stats + 2 : json);
+        free(json);
+    }
+    qj_logindex_close(index);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = "logindex";
+    uint64_t max_bytes = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "+d:m:")) != -1) {
+        switch (opt) {
+        case 'd':
+            dir = optarg;
+            break;
+        case 'm':
+            max_bytes = (uint64_t)atoll(optarg) * 1024 * 1024;
+            break;
+        default:
+            fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+        return 2;
+    }
+
+    QjLogIndex *index = qj_logindex_open(dir, max_bytes, 0);
+    if (!index) {
+        fprintf(stderr, "qj-logindex: can't open %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+    const char *command = argv[optind];
+    int sub_argc = argc - optind;
+    char **sub_argv = argv + optind;
+    int rc;
+    if (strcmp(command, "ingest") == 0) {
+        rc = ingest(index, sub_argc, sub_argv);
+    } else if (strcmp(command, "search") == 0) {
+        rc = search(index, sub_argc, sub_argv);
+    } else if (strcmp(command, "stats") == 0) {
+        char *json = qj_logindex_stats(index);
+        rc = json ? 0 : 1;
+        if (json) {
+            puts(json);
+            free(json);
+        }
+    } else if (strcmp(command, "bench") == 0 && sub_argc == 2) {
+        // bench reopens, and closes, the index itself
+        return bench(index, dir, atol(sub_argv[1]));
+    } else {
+        rc = 2;
+    }
+    qj_logindex_close(index);
+    if (rc == 2) {
+        fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+    }
+    return rc;
+}
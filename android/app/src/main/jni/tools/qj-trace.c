@@ -0,0 +1,122 @@
+/**
+ * qj-trace: summarize QEMU trace events on a Linux host
+ *
+ * The same summarizer the app runs on device (qj_trace.c), for QEMU
+ * started on a benchmark host with the log trace backend. Reads until
+ * the writer closes (QEMU exits) or SIGINT, then writes the JSON summary.
+ * scripts/qemu/trace.sh sets up the FIFO and QEMU arguments.
+ *
+ * Usage: qj-trace [-i seconds] [-o summary.json] <fifo | file | ->
+ *
+ *   -i  also print the summary to stderr every N seconds
+ *   -o  write the final summary here instead of stdout
+ */
+
+#include "qj_trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stopping;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+static char *summary(QjTrace *trace) {
+    size_t size = qj_trace_summary_json(trace, NULL, 0) + 1;
+    char *json = (char *)malloc(size);
+    if (json) {
+        qj_trace_summary_json(trace, json, size);
+    }
+    return json;
+}
+
+int main(int argc, char **argv) {
+    int interval_s = 0;
+    const char *output = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_s = atoi(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-i seconds] [-o summary.json] <fifo | file | ->\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-i seconds] [-o summary.json] <fifo | file | ->\n", argv[0]);
+        return 2;
+    }
+
+    const char *input = argv[optind];
+    int fd = strcmp(input, "-") == 0 ? STDIN_FILENO : open(input, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "qj-trace: %s: %s\n", input, strerror(errno));
+        return 1;
+    }
+    QjTrace *trace = qj_trace_create();
+    if (!trace) {
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    char buf[65536];
+    time_t next_report = interval_s > 0 ? time(NULL) + interval_s : 0;
+    while (!stopping) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, 1000);
+        if (ready > 0) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n == 0) {
+                break;
+            }
+            if (n > 0) {
+                qj_trace_feed(trace, buf, (size_t)n);
+            } else if (errno != EINTR) {
+                fprintf(stderr, "qj-trace: read: %s\n", strerror(errno));
+                break;
+            }
+        }
+        if (next_report && time(NULL) >= next_report) {
+            char *json = summary(trace);
+            if (json) {
+                fprintf(stderr, "%s\n", json);
+                free(json);
+            }
+            next_report = time(NULL) + interval_s;
+        }
+    }
+
+    char *json = summary(trace);
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!json || !out) {
+        fprintf(stderr, "qj-trace: writing %s: %s\n", output ? output : "stdout", strerror(errno));
+        return 1;
+    }
+    fprintf(out, "%s\n", json);
+    if (output) {
+        fclose(out);
+    }
+    free(json);
+    qj_trace_destroy(trace);
+    return 0;
+}
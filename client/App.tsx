@@ -26,12 +26,30 @@ import RootStackNavigator from "@/navigation/RootStackNavigator";
 import { ErrorBoundary } from "@/components/ErrorBoundary";
 import { useTheme } from "@/hooks/useTheme";
 import { Colors } from "@/constants/theme";
+import { useQemuStore } from "@/store/useQemuStore";
+import { useImageQuotaStore } from "@/store/useImageQuotaStore";
+import { useContainerPoolStore } from "@/store/useContainerPoolStore";
 
 SplashScreen.preventAutoHideAsync();
 
 function AppContent() {
   const { isDark } = useTheme();
   const colors = isDark ? Colors.dark : Colors.light;
+  const vmStatus = useQemuStore((state) => state.vmStatus);
+
+  // Image quota and the warm container pool are kept in the background
+  // whatever screen is open
+  useEffect(() => {
+    if (vmStatus !== "running") return;
+    const quota = useImageQuotaStore.getState();
+    const pool = useContainerPoolStore.getState();
+    quota.start();
+    pool.start();
+    return () => {
+      quota.stop();
+      pool.stop();
+    };
+  }, [vmStatus]);
 
   return (
     <>
@@ -17,9 +17,12 @@ import { ThemedText } from "@/components/ThemedText";
 import { useTheme } from "@/hooks/useTheme";
 import { BorderRadius, Spacing, Shadows, Colors, Motion } from "@/constants/theme";
 import { Container } from "@/services/DockerAPI";
+import { ContainerUsage } from "@/services/QemuService";
 
 interface ContainerCardProps {
   container: Container;
+  // Live usage while stats are streaming
+  usage?: ContainerUsage;
   onPress?: () => void;
   onStart?: () => void;
   onStop?: () => void;
@@ -31,8 +34,17 @@ const ACTION_WIDTH = 150;
 
 const AnimatedPressable = Animated.createAnimatedComponent(Pressable);
 
+function formatBytes(bytes: number): string {
+  if (bytes === 0) return "0 B";
+  const k = 1024;
+  const sizes = ["B", "KB", "MB", "GB"];
+  const i = Math.floor(Math.log(bytes) / Math.log(k));
+  return parseFloat((bytes / Math.pow(k, i)).toFixed(1)) + " " + sizes[i];
+}
+
 export function ContainerCard({
   container,
+  usage,
   onPress,
   onStart,
   onStop,
@@ -195,6 +207,14 @@ export function ContainerCard({
                 </ThemedText>
               </View>
             ) : null}
+            {isRunning && usage ? (
+              <View style={styles.detailChip}>
+                <Feather name="activity" size={12} color={colors.accent.mauve} />
+                <ThemedText type="caption" style={[styles.chipText, { color: colors.textSecondary }]}>
+                  {usage.cpuPercent.toFixed(1)}% · {formatBytes(usage.memoryBytes)}
+                </ThemedText>
+              </View>
+            ) : null}
             <View style={styles.detailChip}>
               <Feather name="clock" size={12} color={colors.textMuted} />
               <ThemedText type="caption" style={[styles.chipText, { color: colors.textMuted }]}>
@@ -0,0 +1,85 @@
+/**
+ * Which images to evict when the image store is over quota.
+ *
+ * Only images no container refers to (running or stopped) are candidates;
+ * untagged ones go first, then the least recently used. Limits trigger at
+ * their threshold but eviction continues to a lower target, so one pull
+ * past the limit doesn't evict an image on every check.
+ */
+
+import { Container, DockerImage } from "@/services/DockerAPI";
+
+export interface QuotaLimits {
+  // docker.maxImages in qemu-config.json
+  maxImages: number;
+  // Evict when the phone has less than this free
+  minFreeBytes: number;
+}
+
+export const DEFAULT_QUOTA_LIMITS: QuotaLimits = {
+  maxImages: 20,
+  minFreeBytes: 2 * 1024 ** 3,
+};
+
+// Eviction stops at 80% of maxImages, or 1.5x minFreeBytes free
+const COUNT_TARGET = 0.8;
+const FREE_TARGET = 1.5;
+
+export interface EvictionPlan {
+  evict: DockerImage[];
+  // Estimated; layers shared with kept images are not freed
+  bytes: number;
+  reasons: string[];
+}
+
+export function isDangling(image: DockerImage): boolean {
+  return !image.RepoTags?.some((tag) => tag !== "<none>:<none>");
+}
+
+/**
+ * Bytes removing the image frees: its size less layers shared with others,
+ * when the daemon reports sharing
+ */
+export function exclusiveSize(image: DockerImage): number {
+  return image.SharedSize > 0 ? Math.max(0, image.Size - image.SharedSize) : image.Size;
+}
+
+export function planEviction(
+  images: DockerImage[],
+  containers: Container[],
+  lastUsed: Record<string, number>,
+  freeBytes: number | null,
+  limits: QuotaLimits
+): EvictionPlan {
+  const reasons: string[] = [];
+  if (images.length > limits.maxImages) {
+    reasons.push(`${images.length} images, limit ${limits.maxImages}`);
+  }
+  if (freeBytes !== null && freeBytes < limits.minFreeBytes) {
+    reasons.push(`${Math.round(freeBytes / 1024 ** 2)} MB free`);
+  }
+  if (reasons.length === 0) {
+    return { evict: [], bytes: 0, reasons };
+  }
+
+  const referenced = new Set(containers.map((c) => c.ImageID));
+  // Created is in seconds; an image never seen in use ranks by age
+  const used = (image: DockerImage) => lastUsed[image.Id] ?? image.Created * 1000;
+  const candidates = images
+    .filter((image) => !referenced.has(image.Id))
+    .sort((a, b) => Number(isDangling(b)) - Number(isDangling(a)) || used(a) - used(b));
+
+  const countTarget = Math.floor(limits.maxImages * COUNT_TARGET);
+  const bytesNeeded = freeBytes !== null && freeBytes < limits.minFreeBytes
+    ? limits.minFreeBytes * FREE_TARGET - freeBytes
+    : 0;
+
+  const evict: DockerImage[] = [];
+  let bytes = 0;
+  for (const image of candidates) {
+    if (images.length - evict.length <= countTarget && bytes >= bytesNeeded) break;
+    evict.push(image);
+    bytes += exclusiveSize(image);
+  }
+  return { evict, bytes, reasons };
+}
@@ -0,0 +1,140 @@
+/**
+ * Reading latency histograms: the guest eBPF tracer's and the block
+ * latency in the QEMU trace summary.
+ *
+ * Buckets are log2 of microseconds: bucket n counts [2^n, 2^(n+1)) us
+ * (bucket 0 also takes sub-microsecond samples). Percentiles interpolate
+ * linearly inside the bucket they fall in, so they are estimates within a
+ * factor of two, which is what a log2 histogram can tell.
+ */
+
+export function histogramCount(buckets: number[]): number {
+  return buckets.reduce((sum, n) => sum + n, 0);
+}
+
+/** The p-th percentile (0-100) in microseconds, or null with no samples */
+export function histogramPercentile(buckets: number[], p: number): number | null {
+  const total = histogramCount(buckets);
+  if (total === 0) return null;
+  const rank = (p / 100) * total;
+  let seen = 0;
+  for (let i = 0; i < buckets.length; i++) {
+    if (buckets[i] === 0) continue;
+    if (seen + buckets[i] >= rank) {
+      const low = i === 0 ? 0 : 2 ** i;
+      const high = 2 ** (i + 1);
+      return low + ((rank - seen) / buckets[i]) * (high - low);
+    }
+    seen += buckets[i];
+  }
+  return 2 ** buckets.length;
+}
+
+export function formatMicros(us: number | null): string {
+  if (us === null) return "–";
+  if (us < 1000) return `${Math.round(us)} µs`;
+  if (us < 1_000_000) return `${(us / 1000).toFixed(us < 10_000 ? 1 : 0)} ms`;
+  return `${(us / 1_000_000).toFixed(1)} s`;
+}
+
+/** Lower bound of bucket i, for axis labels */
+export function bucketLabel(i: number): string {
+  return formatMicros(i === 0 ? 0 : 2 ** i);
+}
+
+// x86_64 numbers of the syscalls containers commonly make; the rest show as
+// their number
+const SYSCALL_NAMES: Record<number, string> = {
+  0: "read",
+  1: "write",
+  2: "open",
+  3: "close",
+  4: "stat",
+  5: "fstat",
+  6: "lstat",
+  7: "poll",
+  8: "lseek",
+  9: "mmap",
+  10: "mprotect",
+  11: "munmap",
+  12: "brk",
+  13: "rt_sigaction",
+  14: "rt_sigprocmask",
+  15: "rt_sigreturn",
+  16: "ioctl",
+  17: "pread64",
+  18: "pwrite64",
+  19: "readv",
+  20: "writev",
+  21: "access",
+  22: "pipe",
+  23: "select",
+  24: "sched_yield",
+  28: "madvise",
+  32: "dup",
+  33: "dup2",
+  35: "nanosleep",
+  39: "getpid",
+  41: "socket",
+  42: "connect",
+  43: "accept",
+  44: "sendto",
+  45: "recvfrom",
+  46: "sendmsg",
+  47: "recvmsg",
+  48: "shutdown",
+  49: "bind",
+  50: "listen",
+  54: "setsockopt",
+  55: "getsockopt",
+  56: "clone",
+  57: "fork",
+  59: "execve",
+  60: "exit",
+  61: "wait4",
+  62: "kill",
+  72: "fcntl",
+  74: "fsync",
+  75: "fdatasync",
+  77: "ftruncate",
+  78: "getdents",
+  79: "getcwd",
+  82: "rename",
+  83: "mkdir",
+  87: "unlink",
+  89: "readlink",
+  96: "gettimeofday",
+  102: "getuid",
+  104: "getgid",
+  107: "geteuid",
+  110: "getppid",
+  186: "gettid",
+  202: "futex",
+  217: "getdents64",
+  228: "clock_gettime",
+  230: "clock_nanosleep",
+  231: "exit_group",
+  232: "epoll_wait",
+  233: "epoll_ctl",
+  257: "openat",
+  262: "newfstatat",
+  270: "pselect6",
+  271: "ppoll",
+  281: "epoll_pwait",
+  288: "accept4",
+  290: "eventfd2",
+  291: "epoll_create1",
+  293: "pipe2",
+  295: "preadv",
+  296: "pwritev",
+  302: "prlimit64",
+  318: "getrandom",
+  332: "statx",
+  334: "rseq",
+  435: "clone3",
+  441: "epoll_pwait2",
+};
+
+export function syscallName(nr: number): string {
+  return SYSCALL_NAMES[nr] ?? `#${nr}`;
+}
@@ -0,0 +1,85 @@
+/**
+ * Trend-based leak detection for periodic memory samples.
+ *
+ * A single spike is normal (GC timing, image decode, a container pull);
+ * a leak shows up as a steady slope. Each series is fitted with least
+ * squares over a sliding window and flagged only when the slope is both
+ * steep and consistent (high r²).
+ */
+
+export interface TrendPoint {
+  t: number; // ms since epoch
+  value: number; // kB
+}
+
+export interface Trend {
+  slopeKbPerHour: number;
+  r2: number;
+  samples: number;
+  spanMinutes: number;
+}
+
+export interface LeakThresholds {
+  minSamples: number;
+  minSpanMinutes: number;
+  minSlopeKbPerHour: number;
+  minR2: number;
+}
+
+export const DEFAULT_LEAK_THRESHOLDS: LeakThresholds = {
+  minSamples: 12,
+  minSpanMinutes: 10,
+  minSlopeKbPerHour: 8 * 1024,
+  minR2: 0.8,
+};
+
+/**
+ * Least-squares fit of value over time
+ */
+export function computeTrend(points: TrendPoint[]): Trend | null {
+  const n = points.length;
+  if (n < 2) return null;
+
+  // Center on the first sample to keep the sums well conditioned
+  const t0 = points[0].t;
+  let sumX = 0;
+  let sumY = 0;
+  for (const p of points) {
+    sumX += p.t - t0;
+    sumY += p.value;
+  }
+  const meanX = sumX / n;
+  const meanY = sumY / n;
+
+  let sxx = 0;
+  let sxy = 0;
+  let syy = 0;
+  for (const p of points) {
+    const dx = p.t - t0 - meanX;
+    const dy = p.value - meanY;
+    sxx += dx * dx;
+    sxy += dx * dy;
+    syy += dy * dy;
+  }
+  if (sxx === 0) return null;
+
+  const slopePerMs = sxy / sxx;
+  const r2 = syy === 0 ? 0 : (sxy * sxy) / (sxx * syy);
+
+  return {
+    slopeKbPerHour: slopePerMs * 3_600_000,
+    r2,
+    samples: n,
+    spanMinutes: (points[n - 1].t - t0) / 60_000,
+  };
+}
+
+export function isLeaking(trend: Trend | null, thresholds: LeakThresholds = DEFAULT_LEAK_THRESHOLDS): boolean {
+  if (!trend) return false;
+  return (
+    trend.samples >= thresholds.minSamples &&
+    trend.spanMinutes >= thresholds.minSpanMinutes &&
+    trend.slopeKbPerHour >= thresholds.minSlopeKbPerHour &&
+    trend.r2 >= thresholds.minR2
+  );
+}
@@ -0,0 +1,257 @@
+/**
+ * Lightweight JS-thread profiler.
+ *
+ * Store actions, store `set` calls, native event handlers and React renders
+ * are timed with performance.now() and recorded as spans in a fixed-size
+ * ring. A requestAnimationFrame loop measures frame intervals on the JS
+ * thread, so a hitch can be matched with the spans that ran inside it.
+ * Everything is a single branch when the profiler is disabled.
+ */
+
+import { Share } from "react-native";
+import type { StateCreator } from "zustand";
+
+export interface ProfileSpan {
+  name: string;
+  category: "store" | "action" | "event" | "render" | "handler";
+  start: number; // ms, performance.now()
+  duration: number; // ms
+  args?: Record<string, string | number>;
+}
+
+export interface LongTask {
+  name: string;
+  start: number;
+  duration: number;
+}
+
+export interface FrameHistogram {
+  bounds: number[]; // upper bound of each bucket in ms, last is Infinity
+  counts: number[];
+  frames: number;
+  droppedFrames: number;
+}
+
+export interface ProfilerSummary {
+  enabled: boolean;
+  spans: number;
+  histogram: FrameHistogram;
+  longTasks: LongTask[];
+  hotspots: { name: string; count: number; totalMs: number; maxMs: number }[];
+}
+
+const MAX_SPANS = 20_000;
+const MAX_LONG_TASKS = 100;
+const FRAME_BUDGET_MS = 1000 / 60;
+// Anything over one frame budget blocks at least one frame
+const LONG_TASK_MS = FRAME_BUDGET_MS;
+const HISTOGRAM_BOUNDS = [8, 16.7, 33.4, 50, 100, 250, Infinity];
+
+const now: () => number =
+  typeof performance !== "undefined" && typeof performance.now === "function"
+    ? () => performance.now()
+    : () => Date.now();
+
+let enabled = false;
+const spans: (ProfileSpan | undefined)[] = new Array(MAX_SPANS);
+let spanCount = 0;
+let longTasks: LongTask[] = [];
+let histogram = emptyHistogram();
+let frameHandle: number | null = null;
+let lastFrame = 0;
+// Name of the action whose synchronous body is currently running
+let currentAction: string | null = null;
+
+function emptyHistogram(): FrameHistogram {
+  return {
+    bounds: HISTOGRAM_BOUNDS,
+    counts: HISTOGRAM_BOUNDS.map(() => 0),
+    frames: 0,
+    droppedFrames: 0,
+  };
+}
+
+function onFrame() {
+  const t = now();
+  if (lastFrame > 0) {
+    const delta = t - lastFrame;
+    let bucket = 0;
+    while (delta > HISTOGRAM_BOUNDS[bucket]) bucket++;
+    histogram.counts[bucket]++;
+    histogram.frames++;
+    histogram.droppedFrames += Math.max(0, Math.round(delta / FRAME_BUDGET_MS) - 1);
+  }
+  lastFrame = t;
+  frameHandle = enabled ? requestAnimationFrame(onFrame) : null;
+}
+
+export function record(span: ProfileSpan) {
+  if (!enabled) return;
+  spans[spanCount % MAX_SPANS] = span;
+  spanCount++;
+  if (span.duration >= LONG_TASK_MS) {
+    if (longTasks.length >= MAX_LONG_TASKS) longTasks.shift();
+    longTasks.push({ name: span.name, start: span.start, duration: span.duration });
+  }
+}
+
+export function isProfilerEnabled() {
+  return enabled;
+}
+
+export function setProfilerEnabled(value: boolean) {
+  if (value === enabled) return;
+  enabled = value;
+  if (enabled && frameHandle === null) {
+    lastFrame = 0;
+    frameHandle = requestAnimationFrame(onFrame);
+  } else if (!enabled && frameHandle !== null) {
+    cancelAnimationFrame(frameHandle);
+    frameHandle = null;
+  }
+}
+
+export function resetProfiler() {
+  spans.fill(undefined);
+  spanCount = 0;
+  longTasks = [];
+  histogram = emptyHistogram();
+  lastFrame = 0;
+}
+
+/**
+ * Time fn and record it as a span. Only the synchronous part is timed: a
+ * returned Promise is not awaited, since spans measure JS thread blocking
+ */
+export function measure<T>(name: string, category: ProfileSpan["category"], fn: () => T): T {
+  if (!enabled) return fn();
+  const start = now();
+  try {
+    return fn();
+  } finally {
+    record({ name, category, start, duration: now() - start });
+  }
+}
+
+/**
+ * Wrap an event handler so its synchronous cost is attributed to name
+ */
+export function profileHandler<A extends unknown[], R>(
+  name: string,
+  fn: (...args: A) => R,
+  category: ProfileSpan["category"] = "handler"
+): (...args: A) => R {
+  return (...args: A) => measure(name, category, () => fn(...args));
+}
+
+/**
+ * Zustand middleware: times every `set` (including subscriber notification
+ * and selector work) and the synchronous part of every action.
+ *
+ *   create<State>(profileStore("qemu", (set, get) => ({ ... })))
+ */
+export function profileStore<T>(storeName: string, creator: StateCreator<T>): StateCreator<T> {
+  return (set, get, api) => {
+    const timedSet: typeof set = ((partial: any, replace?: any) => {
+      if (!enabled) return (set as any)(partial, replace);
+      const start = now();
+      (set as any)(partial, replace);
+      record({
+        name: `${storeName}.set`,
+        category: "store",
+        start,
+        duration: now() - start,
+        args: { action: currentAction ?? "async" },
+      });
+    }) as typeof set;
+
+    const state = creator(timedSet, get, api) as Record<string, unknown>;
+
+    for (const key of Object.keys(state)) {
+      const value = state[key];
+      if (typeof value !== "function") continue;
+      const name = `${storeName}.${key}`;
+      state[key] = (...args: unknown[]) => {
+        if (!enabled) return (value as Function)(...args);
+        const outer = currentAction;
+        currentAction = name;
+        const start = now();
+        try {
+          return (value as Function)(...args);
+        } finally {
+          currentAction = outer;
+          record({ name, category: "action", start, duration: now() - start });
+        }
+      };
+    }
+    return state as T;
+  };
+}
+
+/**
+ * onRender callback for <React.Profiler id="...">
+ */
+export function recordRender(id: string, phase: string, actualDuration: number, _baseDuration: number, startTime: number) {
+  record({ name: `render.${id}`, category: "render", start: startTime, duration: actualDuration, args: { phase } });
+}
+
+function orderedSpans(): ProfileSpan[] {
+  const result: ProfileSpan[] = [];
+  const first = Math.max(0, spanCount - MAX_SPANS);
+  for (let i = first; i < spanCount; i++) {
+    const span = spans[i % MAX_SPANS];
+    if (span) result.push(span);
+  }
+  return result;
+}
+
+export function getProfilerSummary(topN: number = 10): ProfilerSummary {
+  const totals = new Map<string, { count: number; totalMs: number; maxMs: number }>();
+  const all = orderedSpans();
+  for (const span of all) {
+    const entry = totals.get(span.name) ?? { count: 0, totalMs: 0, maxMs: 0 };
+    entry.count++;
+    entry.totalMs += span.duration;
+    entry.maxMs = Math.max(entry.maxMs, span.duration);
+    totals.set(span.name, entry);
+  }
+  const hotspots = [...totals.entries()]
+    .map(([name, entry]) => ({ name, ...entry }))
+    .sort((a, b) => b.totalMs - a.totalMs)
+    .slice(0, topN);
+
+  return {
+    enabled,
+    spans: all.length,
+    histogram: { ...histogram, counts: [...histogram.counts] },
+    longTasks: [...longTasks].reverse(),
+    hotspots,
+  };
+}
+
+/**
+ * Chrome trace event format - load in chrome://tracing or Perfetto
+ */
+export function exportChromeTrace(): string {
+  const traceEvents = orderedSpans().map((span) => ({
+    name: span.name,
+    cat: span.category,
+    ph: "X",
+    ts: Math.round(span.start * 1000),
+    dur: Math.max(1, Math.round(span.duration * 1000)),
+    pid: 1,
+    tid: 1,
+    args: span.args ?? {},
+  }));
+  return JSON.stringify({
+    traceEvents: [
+      { name: "thread_name", ph: "M", pid: 1, tid: 1, args: { name: "JS" } },
+      ...traceEvents,
+    ],
+    displayTimeUnit: "ms",
+  });
+}
+
+export async function shareChromeTrace() {
+  await Share.share({ title: "js-trace.json", message: exportChromeTrace() });
+}
@@ -5,6 +5,11 @@ import ContainerDetailScreen from "@/screens/ContainerDetailScreen";
 import CreateContainerScreen from "@/screens/CreateContainerScreen";
 import WebViewScreen from "@/screens/WebViewScreen";
 import TerminalScreen from "@/screens/TerminalScreen";
+import MemoryDebugScreen from "@/screens/MemoryDebugScreen";
+import ProfilerScreen from "@/screens/ProfilerScreen";
+import WatchdogScreen from "@/screens/WatchdogScreen";
+import QemuTraceScreen from "@/screens/QemuTraceScreen";
+import LogSearchScreen from "@/screens/LogSearchScreen";
 import { useScreenOptions } from "@/hooks/useScreenOptions";
 
 export type RootStackParamList = {
@@ -13,6 +18,11 @@ export type RootStackParamList = {
   CreateContainer: undefined;
   WebView: { url: string; title: string };
   Terminal: { containerId: string };
+  MemoryDebug: undefined;
+  Profiler: undefined;
+  Watchdog: undefined;
+  QemuTrace: undefined;
+  LogSearch: { containerId?: string } | undefined;
 };
 
 const Stack = createNativeStackNavigator<RootStackParamList>();
@@ -58,6 +68,41 @@ export default function RootStackNavigator() {
           presentation: "fullScreenModal",
         }}
       />
+      <Stack.Screen
+        name="MemoryDebug"
+        component={MemoryDebugScreen}
+        options={{
+          headerTitle: "Memory",
+        }}
+      />
+      <Stack.Screen
+        name="Profiler"
+        component={ProfilerScreen}
+        options={{
+          headerTitle: "JS Profiler",
+        }}
+      />
+      <Stack.Screen
+        name="Watchdog"
+        component={WatchdogScreen}
+        options={{
+          headerTitle: "VM Watchdog",
+        }}
+      />
+      <Stack.Screen
+        name="QemuTrace"
+        component={QemuTraceScreen}
+        options={{
+          headerTitle: "QEMU Trace",
+        }}
+      />
+      <Stack.Screen
+        name="LogSearch"
+        component={LogSearchScreen}
+        options={{
+          headerTitle: "Log Search",
+        }}
+      />
     </Stack.Navigator>
   );
 }
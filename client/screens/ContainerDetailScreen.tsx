@@ -12,13 +12,51 @@ import { ThemedText } from "@/components/ThemedText";
 import { LoadingSpinner } from "@/components/LoadingSpinner";
 import { useTheme } from "@/hooks/useTheme";
 import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
-import { useDockerStore } from "@/store/useDockerStore";
+import { useDockerStore, statsFor } from "@/store/useDockerStore";
+import { useCheckpointStore, CHECKPOINT_NAME, ReadinessTimes } from "@/store/useCheckpointStore";
+import { ContainerTraceEvent } from "@/services/QemuService";
+import { histogramCount, histogramPercentile, formatMicros, bucketLabel, syscallName } from "@/lib/latency";
 import { RootStackParamList } from "@/navigation/RootStackNavigator";
 
 type RouteProps = RouteProp<RootStackParamList, "ContainerDetail">;
 type NavigationProp = NativeStackNavigationProp<RootStackParamList>;
 
-type TabType = "info" | "logs" | "stats";
+type TabType = "info" | "logs" | "stats" | "trace";
+
+function formatBytes(bytes: number): string {
+  if (bytes === 0) return "0 B";
+  const k = 1024;
+  const sizes = ["B", "KB", "MB", "GB"];
+  const i = Math.floor(Math.log(bytes) / Math.log(k));
+  return parseFloat((bytes / Math.pow(k, i)).toFixed(1)) + " " + sizes[i];
+}
+
+function formatSeconds(ms: number): string {
+  return `${(ms / 1000).toFixed(1)} s`;
+}
+
+/** Restore vs cold start, both measured to readiness */
+function describeReadiness(times: ReadinessTimes): string {
+  const ready = times.probe === "health" ? "healthy" : "running";
+  if (times.restoredMs !== undefined && times.coldMs !== undefined) {
+    const speedup = times.coldMs / Math.max(times.restoredMs, 1);
+    return `${ready} in ${formatSeconds(times.restoredMs)} restored vs ${formatSeconds(times.coldMs)} cold (${speedup.toFixed(1)}x)`;
+  }
+  if (times.restoredMs !== undefined) return `${ready} in ${formatSeconds(times.restoredMs)} restored`;
+  if (times.coldMs !== undefined) return `${ready} in ${formatSeconds(times.coldMs)} cold`;
+  return "Not measured yet";
+}
+
+function describeTraceState(state: ContainerTraceEvent | null): string | null {
+  if (state?.state === "unavailable") return "The guest has no bpf-latency tracer installed";
+  if (state?.state === "off" && state.exitStatus) {
+    // bpf-latency exits 3 when /sys/kernel/btf/vmlinux is missing
+    return state.exitStatus === 3
+      ? "The guest kernel has no BTF; build it with build-kernel.sh --bpf"
+      : `The tracer stopped (exit status ${state.exitStatus}), see /var/log/cgroup-stats.log`;
+  }
+  return null;
+}
 
 export default function ContainerDetailScreen() {
   const insets = useSafeAreaInsets();
@@ -33,13 +71,47 @@ export default function ContainerDetailScreen() {
   const {
     selectedContainer,
     isLoading,
-    startContainer,
     stopContainer,
     restartContainer,
+    fetchContainers,
+    selectContainer,
+    containerStats,
+    subscribeStats,
+    containerLatency,
+    traceState,
+    subscribeTrace,
   } = useDockerStore();
+  const {
+    checkpoints,
+    timings,
+    busyId,
+    supported: checkpointSupported,
+    error: checkpointError,
+    load: loadCheckpoints,
+    fetchCheckpoints,
+    checkpoint,
+    restore,
+    start: timedStart,
+  } = useCheckpointStore();
 
   const container = selectedContainer;
 
+  useEffect(() => {
+    if (activeTab !== "stats" || container?.State !== "running") return;
+    return subscribeStats();
+  }, [activeTab, container?.State]);
+
+  useEffect(() => {
+    if (activeTab !== "trace" || container?.State !== "running") return;
+    return subscribeTrace();
+  }, [activeTab, container?.State]);
+
+  useEffect(() => {
+    if (!container) return;
+    loadCheckpoints();
+    fetchCheckpoints(container.Id);
+  }, [container?.Id]);
+
   useEffect(() => {
     navigation.setOptions({
       headerTitle: container?.Names[0]?.replace(/^\//, "") || "Container",
@@ -55,6 +127,11 @@ export default function ContainerDetailScreen() {
   }
 
   const isRunning = container.State === "running";
+  const hasCheckpoint = checkpoints[container.Id]?.includes(CHECKPOINT_NAME) ?? false;
+  const isBusy = busyId === container.Id;
+  const readiness = timings[container.Id];
+  const usage = statsFor(containerStats, container.Id);
+  const latency = statsFor(containerLatency, container.Id);
   const ports = container.Ports.filter((p) => p.PublicPort);
 
   const getStatusColor = () => {
@@ -68,11 +145,30 @@ export default function ContainerDetailScreen() {
     }
   };
 
-  const handleAction = async (action: "start" | "stop" | "restart" | "web" | "terminal") => {
+  // Checkpoint and restore change the state the action bar depends on
+  const refresh = async () => {
+    await fetchContainers();
+    const updated = useDockerStore.getState().containers.find((c) => c.Id === container.Id);
+    if (updated) selectContainer(updated);
+  };
+
+  const handleAction = async (
+    action: "start" | "stop" | "restart" | "web" | "terminal" | "checkpoint" | "restore"
+  ) => {
     Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Medium);
     switch (action) {
       case "start":
-        await startContainer(container.Id);
+        // Timed to readiness, for comparison with a restore
+        await timedStart(container.Id);
+        await refresh();
+        break;
+      case "checkpoint":
+        await checkpoint(container.Id);
+        await refresh();
+        break;
+      case "restore":
+        await restore(container.Id);
+        await refresh();
         break;
       case "stop":
         await stopContainer(container.Id);
@@ -159,6 +255,27 @@ export default function ContainerDetailScreen() {
         </View>
       ) : null}
 
+      {hasCheckpoint || readiness || checkpointError ? (
+        <View style={[styles.infoCard, { backgroundColor: theme.backgroundDefault, marginTop: Spacing.sm }, Shadows.soft]}>
+          <ThemedText type="caption" style={{ color: colors.textMuted }}>CHECKPOINT</ThemedText>
+          <ThemedText type="body" style={styles.infoValue}>
+            {hasCheckpoint
+              ? `Saved${readiness?.checkpointMs !== undefined ? ` in ${formatSeconds(readiness.checkpointMs)}` : ""}, restore to resume`
+              : "None saved"}
+          </ThemedText>
+          {readiness ? (
+            <ThemedText type="caption" style={{ color: colors.textSecondary, marginTop: 4 }}>
+              {describeReadiness(readiness)}
+            </ThemedText>
+          ) : null}
+          {checkpointError ? (
+            <ThemedText type="caption" style={{ color: colors.state.error, marginTop: 4 }}>
+              {checkpointError}
+            </ThemedText>
+          ) : null}
+        </View>
+      ) : null}
+
       {container.Mounts.length > 0 ? (
         <View style={[styles.infoCard, { backgroundColor: theme.backgroundDefault, marginTop: Spacing.sm }, Shadows.soft]}>
           <ThemedText type="caption" style={{ color: colors.textMuted, marginBottom: Spacing.sm }}>VOLUMES</ThemedText>
@@ -189,6 +306,19 @@ export default function ContainerDetailScreen() {
             : "Container is not running.\nStart the container to view logs."}
         </ThemedText>
       </View>
+      <Pressable
+        style={[styles.searchLogs, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}
+        onPress={() => {
+          Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Light);
+          navigation.navigate("LogSearch", { containerId: container.Id });
+        }}
+      >
+        <Feather name="search" size={16} color={colors.accent.mauve} />
+        <ThemedText type="small" style={{ marginLeft: Spacing.sm, flex: 1 }}>
+          Search indexed logs
+        </ThemedText>
+        <Feather name="chevron-right" size={16} color={colors.textMuted} />
+      </Pressable>
     </Animated.View>
   );
 
@@ -203,7 +333,9 @@ export default function ContainerDetailScreen() {
               </View>
               <View style={{ flex: 1 }}>
                 <ThemedText type="caption" style={{ color: colors.textMuted }}>CPU Usage</ThemedText>
-                <ThemedText type="h4" style={{ color: colors.accent.mauve }}>--</ThemedText>
+                <ThemedText type="h4" style={{ color: colors.accent.mauve }}>
+                  {usage ? `${usage.cpuPercent.toFixed(1)}%` : "--"}
+                </ThemedText>
               </View>
             </View>
             <View style={[styles.infoDivider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
@@ -213,7 +345,13 @@ export default function ContainerDetailScreen() {
               </View>
               <View style={{ flex: 1 }}>
                 <ThemedText type="caption" style={{ color: colors.textMuted }}>Memory</ThemedText>
-                <ThemedText type="h4" style={{ color: colors.accent.olive }}>--</ThemedText>
+                <ThemedText type="h4" style={{ color: colors.accent.olive }}>
+                  {usage
+                    ? usage.memoryLimit > 0
+                      ? `${formatBytes(usage.memoryBytes)} / ${formatBytes(usage.memoryLimit)}`
+                      : formatBytes(usage.memoryBytes)
+                    : "--"}
+                </ThemedText>
               </View>
             </View>
             <View style={[styles.infoDivider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
@@ -223,7 +361,9 @@ export default function ContainerDetailScreen() {
               </View>
               <View style={{ flex: 1 }}>
                 <ThemedText type="caption" style={{ color: colors.textMuted }}>Network I/O</ThemedText>
-                <ThemedText type="h4" style={{ color: colors.accent.terracotta }}>--</ThemedText>
+                <ThemedText type="h4" style={{ color: colors.accent.terracotta }}>
+                  {usage ? `${formatBytes(usage.netRx)} / ${formatBytes(usage.netTx)}` : "--"}
+                </ThemedText>
               </View>
             </View>
           </>
@@ -239,6 +379,92 @@ export default function ContainerDetailScreen() {
     </Animated.View>
   );
 
+  const renderHistogram = (label: string, buckets: number[], color: string) => {
+    const peak = Math.max(1, ...buckets);
+    const first = buckets.findIndex((n) => n > 0);
+    const shown = first < 0 ? [] : buckets.slice(first);
+    return (
+      <View style={styles.infoRow}>
+        <View style={styles.histogramHeader}>
+          <ThemedText type="caption" style={{ color: colors.textMuted }}>{label}</ThemedText>
+          <ThemedText type="caption" style={{ color }}>
+            p50 {formatMicros(histogramPercentile(buckets, 50))} · p99 {formatMicros(histogramPercentile(buckets, 99))}
+          </ThemedText>
+        </View>
+        {shown.length > 0 ? (
+          <>
+            <View style={styles.histogram}>
+              {shown.map((n, i) => (
+                <View
+                  key={i}
+                  style={[styles.histogramBar, { backgroundColor: color, height: `${Math.max(4, (n / peak) * 100)}%`, opacity: n ? 1 : 0.2 }]}
+                />
+              ))}
+            </View>
+            <View style={styles.histogramHeader}>
+              <ThemedText type="caption" style={{ color: colors.textMuted }}>{bucketLabel(first)}</ThemedText>
+              <ThemedText type="caption" style={{ color: colors.textMuted }}>
+                {histogramCount(buckets).toLocaleString()} samples
+              </ThemedText>
+              <ThemedText type="caption" style={{ color: colors.textMuted }}>{bucketLabel(buckets.length)}</ThemedText>
+            </View>
+          </>
+        ) : (
+          <ThemedText type="body" style={[styles.infoValue, { color: colors.textSecondary }]}>No samples yet</ThemedText>
+        )}
+      </View>
+    );
+  };
+
+  const renderTraceTab = () => {
+    const problem = describeTraceState(traceState);
+    const divider = <View style={[styles.infoDivider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />;
+    return (
+      <Animated.View entering={FadeInDown.duration(300)}>
+        <View style={[styles.infoCard, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          {!isRunning || problem || !latency ? (
+            <View style={styles.emptyStats}>
+              <Feather name={problem ? "alert-circle" : "crosshair"} size={32} color={problem ? colors.state.warning : colors.textMuted} />
+              <ThemedText type="body" style={{ color: colors.textSecondary, marginTop: Spacing.sm, textAlign: "center" }}>
+                {!isRunning
+                  ? "Start the container to trace its latency"
+                  : problem ?? "Attaching eBPF probes in the guest..."}
+              </ThemedText>
+            </View>
+          ) : (
+            <>
+              {renderHistogram("Runqueue latency", latency.runqueue, colors.accent.mauve)}
+              {divider}
+              {renderHistogram("Block I/O latency", latency.blockIo, colors.accent.olive)}
+              {divider}
+              <View style={styles.infoRow}>
+                <ThemedText type="caption" style={{ color: colors.textMuted }}>TCP Retransmits</ThemedText>
+                <ThemedText type="h4" style={[styles.infoValue, { color: latency.tcpRetransmits ? colors.state.warning : colors.accent.terracotta }]}>
+                  {latency.tcpRetransmits.toLocaleString()}
+                </ThemedText>
+              </View>
+              {divider}
+              <View style={styles.infoRow}>
+                <ThemedText type="caption" style={{ color: colors.textMuted }}>Syscalls</ThemedText>
+                <ThemedText type="h4" style={[styles.infoValue, { color: colors.accent.mint }]}>
+                  {latency.syscalls.toLocaleString()}
+                </ThemedText>
+                {latency.topSyscalls.map(({ nr, count }) => (
+                  <View key={nr} style={styles.histogramHeader}>
+                    <ThemedText type="caption" style={styles.codeText}>{syscallName(nr)}</ThemedText>
+                    <ThemedText type="caption" style={{ color: colors.textSecondary }}>
+                      {count.toLocaleString()} ({((count / Math.max(latency.syscalls, 1)) * 100).toFixed(1)}%)
+                    </ThemedText>
+                  </View>
+                ))}
+              </View>
+            </>
+          )}
+        </View>
+      </Animated.View>
+    );
+  };
+
   return (
     <View style={[styles.container, { backgroundColor: theme.backgroundRoot }]}>
       <ScrollView
@@ -271,11 +497,13 @@ export default function ContainerDetailScreen() {
           {renderTab("info", "Info", "info")}
           {renderTab("logs", "Logs", "file-text")}
           {renderTab("stats", "Stats", "activity")}
+          {renderTab("trace", "Trace", "crosshair")}
         </Animated.View>
 
         {activeTab === "info" && renderInfoTab()}
         {activeTab === "logs" && renderLogsTab()}
         {activeTab === "stats" && renderStatsTab()}
+        {activeTab === "trace" && renderTraceTab()}
       </ScrollView>
 
       <Animated.View
@@ -289,9 +517,19 @@ export default function ContainerDetailScreen() {
         <Pressable
           style={[styles.actionButton, { backgroundColor: isRunning ? colors.state.error : colors.state.success }]}
           onPress={() => handleAction(isRunning ? "stop" : "start")}
+          disabled={isBusy}
         >
           <Feather name={isRunning ? "square" : "play"} size={20} color="#FFF" />
         </Pressable>
+        {(isRunning && checkpointSupported !== false) || hasCheckpoint ? (
+          <Pressable
+            style={[styles.actionButton, { backgroundColor: colors.accent.mint, opacity: isBusy ? 0.5 : 1 }]}
+            onPress={() => handleAction(isRunning ? "checkpoint" : "restore")}
+            disabled={isBusy}
+          >
+            <Feather name={isRunning ? "save" : "fast-forward"} size={20} color="#FFF" />
+          </Pressable>
+        ) : null}
         <Pressable
           style={[styles.actionButton, { backgroundColor: colors.accent.mauve }]}
           onPress={() => handleAction("restart")}
@@ -407,6 +645,13 @@ const styles = StyleSheet.create({
     borderRadius: BorderRadius.md,
     minHeight: 200,
   },
+  searchLogs: {
+    flexDirection: "row",
+    alignItems: "center",
+    marginTop: Spacing.md,
+    padding: Spacing.md,
+    borderRadius: BorderRadius.lg,
+  },
   statRow: {
     flexDirection: "row",
     alignItems: "center",
@@ -424,6 +669,22 @@ const styles = StyleSheet.create({
     alignItems: "center",
     paddingVertical: Spacing.xl,
   },
+  histogramHeader: {
+    flexDirection: "row",
+    justifyContent: "space-between",
+    marginTop: 4,
+  },
+  histogram: {
+    flexDirection: "row",
+    alignItems: "flex-end",
+    height: 48,
+    gap: 2,
+    marginTop: Spacing.sm,
+  },
+  histogramBar: {
+    flex: 1,
+    borderRadius: 2,
+  },
   actionsBar: {
     position: "absolute",
     bottom: 0,
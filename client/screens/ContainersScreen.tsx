@@ -1,4 +1,4 @@
-import React, { useEffect, useCallback } from "react";
+import React, { useEffect, useCallback, Profiler } from "react";
 import { StyleSheet, RefreshControl, FlatList, View, Pressable } from "react-native";
 import { useSafeAreaInsets } from "react-native-safe-area-context";
 import { useHeaderHeight } from "@react-navigation/elements";
@@ -15,10 +15,11 @@ import { LoadingSpinner } from "@/components/LoadingSpinner";
 import { ThemedText } from "@/components/ThemedText";
 import { useTheme } from "@/hooks/useTheme";
 import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
-import { useDockerStore } from "@/store/useDockerStore";
+import { useDockerStore, statsFor } from "@/store/useDockerStore";
 import { useQemuStore } from "@/store/useQemuStore";
 import { RootStackParamList } from "@/navigation/RootStackNavigator";
 import { Container } from "@/services/DockerAPI";
+import { recordRender } from "@/lib/profiler";
 
 type NavigationProp = NativeStackNavigationProp<RootStackParamList>;
 
@@ -38,6 +39,8 @@ export default function ContainersScreen() {
     stopContainer,
     removeContainer,
     selectContainer,
+    containerStats,
+    subscribeStats,
   } = useDockerStore();
 
   const { vmStatus } = useQemuStore();
@@ -48,6 +51,12 @@ export default function ContainersScreen() {
     }
   }, [vmStatus]);
 
+  // Every card's usage comes from one guest stream
+  useEffect(() => {
+    if (vmStatus !== "running") return;
+    return subscribeStats();
+  }, [vmStatus]);
+
   const onRefresh = useCallback(async () => {
     Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Light);
     await fetchContainers();
@@ -67,6 +76,7 @@ export default function ContainersScreen() {
     <Animated.View entering={FadeInDown.duration(300).delay(index * 50)}>
       <ContainerCard
         container={item}
+        usage={statsFor(containerStats, item.Id)}
         onPress={() => handleContainerPress(item)}
         onStart={() => {
           Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Medium);
@@ -120,29 +130,32 @@ export default function ContainersScreen() {
 
   return (
     <View style={[styles.container, { backgroundColor: theme.backgroundRoot }]}>
-      <FlatList
-        style={styles.list}
-        contentContainerStyle={{
-          paddingTop: headerHeight + Spacing.sm,
-          paddingBottom: tabBarHeight + Spacing.xl + 80,
-          paddingHorizontal: Spacing.md,
-          flexGrow: 1,
-        }}
-        scrollIndicatorInsets={{ bottom: insets.bottom }}
-        data={vmStatus === "running" ? containers : []}
-        renderItem={renderItem}
-        keyExtractor={(item) => item.Id}
-        ListHeaderComponent={vmStatus === "running" && containers.length > 0 ? renderHeader : null}
-        ListEmptyComponent={renderEmpty}
-        refreshControl={
-          <RefreshControl
-            refreshing={isLoading}
-            onRefresh={onRefresh}
-            tintColor={colors.accent.mauve}
-          />
-        }
-        showsVerticalScrollIndicator={false}
-      />
+      <Profiler id="ContainersList" onRender={recordRender}>
+        <FlatList
+          style={styles.list}
+          contentContainerStyle={{
+            paddingTop: headerHeight + Spacing.sm,
+            paddingBottom: tabBarHeight + Spacing.xl + 80,
+            paddingHorizontal: Spacing.md,
+            flexGrow: 1,
+          }}
+          scrollIndicatorInsets={{ bottom: insets.bottom }}
+          data={vmStatus === "running" ? containers : []}
+          extraData={containerStats}
+          renderItem={renderItem}
+          keyExtractor={(item) => item.Id}
+          ListHeaderComponent={vmStatus === "running" && containers.length > 0 ? renderHeader : null}
+          ListEmptyComponent={renderEmpty}
+          refreshControl={
+            <RefreshControl
+              refreshing={isLoading}
+              onRefresh={onRefresh}
+              tintColor={colors.accent.mauve}
+            />
+          }
+          showsVerticalScrollIndicator={false}
+        />
+      </Profiler>
 
       {vmStatus === "running" ? (
         <Animated.View
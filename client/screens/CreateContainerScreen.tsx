@@ -12,6 +12,8 @@ import { Button } from "@/components/Button";
 import { useTheme } from "@/hooks/useTheme";
 import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
 import { useDockerStore } from "@/store/useDockerStore";
+import { useContainerPoolStore } from "@/store/useContainerPoolStore";
+import { CreateContainerConfig } from "@/services/DockerAPI";
 
 export default function CreateContainerScreen() {
   const insets = useSafeAreaInsets();
@@ -20,7 +22,10 @@ export default function CreateContainerScreen() {
   const { theme, isDark } = useTheme();
   const colors = isDark ? Colors.dark : Colors.light;
 
-  const { createContainer, isLoading } = useDockerStore();
+  const { fetchContainers } = useDockerStore();
+  const runContainer = useContainerPoolStore((state) => state.run);
+  const [isLoading, setIsLoading] = useState(false);
+  const [error, setError] = useState<string | null>(null);
 
   const [imageName, setImageName] = useState("");
   const [containerName, setContainerName] = useState("");
@@ -32,7 +37,7 @@ export default function CreateContainerScreen() {
 
     Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Medium);
 
-    const config: any = {
+    const config: CreateContainerConfig = {
       Image: imageName.trim(),
     };
 
@@ -50,10 +55,19 @@ export default function CreateContainerScreen() {
       config.Env = envVars.split("\n").filter((v) => v.trim());
     }
 
-    const containerId = await createContainer(config);
-    if (containerId) {
+    setIsLoading(true);
+    setError(null);
+    try {
+      // A warm pool container when the image has one and config allows
+      await runContainer(config, containerName.trim() || undefined);
+      await fetchContainers();
       Haptics.notificationAsync(Haptics.NotificationFeedbackType.Success);
       navigation.goBack();
+    } catch (e: any) {
+      setError(e.message || "Failed to start container");
+      Haptics.notificationAsync(Haptics.NotificationFeedbackType.Error);
+    } finally {
+      setIsLoading(false);
     }
   };
 
@@ -189,16 +203,22 @@ export default function CreateContainerScreen() {
         <View style={[styles.infoCard, { backgroundColor: colors.accent.mint + "15" }]}>
           <Feather name="info" size={18} color={colors.accent.mint} />
           <ThemedText type="caption" style={[styles.infoText, { color: colors.textSecondary }]}>
-            The container will be created but not started automatically.
+            The container starts right away. With only a name set, it is taken from the warm pool when one is ready.
           </ThemedText>
         </View>
 
+        {error ? (
+          <ThemedText type="caption" style={[styles.hint, { color: colors.state.error }]}>
+            {error}
+          </ThemedText>
+        ) : null}
+
         <Button
           onPress={handleCreate}
           disabled={!imageName.trim() || isLoading}
           style={{ marginTop: Spacing.md }}
         >
-          {isLoading ? "Creating..." : "Create Container"}
+          {isLoading ? "Starting..." : "Run Container"}
         </Button>
       </Animated.View>
     </ScrollView>
@@ -0,0 +1,279 @@
+import React, { useCallback, useEffect, useRef, useState } from "react";
+import { View, StyleSheet, ScrollView, TextInput, Pressable } from "react-native";
+import { useSafeAreaInsets } from "react-native-safe-area-context";
+import { useHeaderHeight } from "@react-navigation/elements";
+import { useRoute, RouteProp } from "@react-navigation/native";
+import { Feather } from "@expo/vector-icons";
+import * as Haptics from "expo-haptics";
+import Animated, { FadeInDown } from "react-native-reanimated";
+
+import { ThemedText } from "@/components/ThemedText";
+import { useTheme } from "@/hooks/useTheme";
+import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
+import { RootStackParamList } from "@/navigation/RootStackNavigator";
+import QemuService, { LogIndexStats, LogSearchResult } from "@/services/QemuService";
+
+const DEBOUNCE_MS = 250;
+const LIMIT = 200;
+
+type RouteProps = RouteProp<RootStackParamList, "LogSearch">;
+type Stream = "all" | "stdout" | "stderr";
+
+function formatBytes(bytes: number): string {
+  if (bytes >= 1024 * 1024 * 1024) return `${(bytes / (1024 * 1024 * 1024)).toFixed(1)} GB`;
+  if (bytes >= 1024 * 1024) return `${(bytes / (1024 * 1024)).toFixed(1)} MB`;
+  return `${(bytes / 1024).toFixed(0)} KB`;
+}
+
+function formatTime(ts: number): string {
+  const d = new Date(ts);
+  const pad = (n: number, width = 2) => String(n).padStart(width, "0");
+  return `${pad(d.getMonth() + 1)}-${pad(d.getDate())} ${pad(d.getHours())}:${pad(d.getMinutes())}:${pad(d.getSeconds())}.${pad(d.getMilliseconds(), 3)}`;
+}
+
+/**
+ * Full-text search over every container's logs, newest first, from the
+ * index the VM host keeps (qj_logindex.h). Removed containers stay
+ * searchable until retention drops their logs.
+ */
+export default function LogSearchScreen() {
+  const insets = useSafeAreaInsets();
+  const headerHeight = useHeaderHeight();
+  const route = useRoute<RouteProps>();
+  const { theme, isDark } = useTheme();
+  const colors = isDark ? Colors.dark : Colors.light;
+
+  const [query, setQuery] = useState("");
+  const [stream, setStream] = useState<Stream>("all");
+  const [container, setContainer] = useState<string | undefined>(route.params?.containerId?.slice(0, 12));
+  const [result, setResult] = useState<LogSearchResult | null>(null);
+  const [stats, setStats] = useState<LogIndexStats | null>(null);
+  const [error, setError] = useState<string | null>(null);
+  // Drops responses to queries the user has already typed past
+  const latest = useRef(0);
+
+  const search = useCallback(async () => {
+    const seq = ++latest.current;
+    try {
+      const found = await QemuService.searchContainerLogs(query, {
+        container,
+        stream: stream === "all" ? undefined : stream,
+        limit: LIMIT,
+      });
+      if (seq === latest.current) {
+        setResult(found);
+        setError(null);
+      }
+    } catch (e: any) {
+      if (seq === latest.current) setError(e.message);
+    }
+  }, [query, stream, container]);
+
+  useEffect(() => {
+    const timer = setTimeout(search, DEBOUNCE_MS);
+    return () => clearTimeout(timer);
+  }, [search]);
+
+  useEffect(() => {
+    QemuService.getLogIndexStats()
+      .then(setStats)
+      .catch(() => {});
+  }, []);
+
+  const names = new Map((stats?.containers ?? []).map((c) => [c.id, c.name]));
+  const divider = { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" };
+
+  const renderChip = (label: string, active: boolean, onPress: () => void) => (
+    <Pressable
+      key={label}
+      onPress={() => {
+        Haptics.selectionAsync();
+        onPress();
+      }}
+      style={[
+        styles.chip,
+        {
+          backgroundColor: active ? colors.accent.mauve : theme.backgroundDefault,
+          borderColor: isDark ? "rgba(255,255,255,0.1)" : "rgba(0,0,0,0.1)",
+        },
+      ]}
+    >
+      <ThemedText type="caption" style={{ color: active ? "#FFF" : colors.textSecondary }}>
+        {label}
+      </ThemedText>
+    </Pressable>
+  );
+
+  return (
+    <ScrollView
+      style={[styles.container, { backgroundColor: theme.backgroundRoot }]}
+      contentContainerStyle={{
+        paddingTop: headerHeight + Spacing.md,
+        paddingBottom: insets.bottom + Spacing.xl,
+        paddingHorizontal: Spacing.md,
+      }}
+      keyboardShouldPersistTaps="handled"
+      showsVerticalScrollIndicator={false}
+    >
+      <Animated.View entering={FadeInDown.duration(300).delay(100)}>
+        <View
+          style={[
+            styles.searchBox,
+            {
+              backgroundColor: theme.backgroundDefault,
+              borderColor: isDark ? "rgba(255,255,255,0.1)" : "rgba(0,0,0,0.1)",
+            },
+          ]}
+        >
+          <Feather name="search" size={16} color={colors.textMuted} />
+          <TextInput
+            style={[styles.input, { color: theme.text }]}
+            placeholder="Search all container logs"
+            placeholderTextColor={colors.textMuted}
+            value={query}
+            onChangeText={setQuery}
+            onSubmitEditing={search}
+            returnKeyType="search"
+            autoCapitalize="none"
+            autoCorrect={false}
+            autoFocus
+          />
+        </View>
+        <View style={styles.chips}>
+          {(["all", "stdout", "stderr"] as Stream[]).map((s) => renderChip(s, stream === s, () => setStream(s)))}
+          {container && renderChip(`${names.get(container) || container} ✕`, true, () => setContainer(undefined))}
+        </View>
+      </Animated.View>
+
+      {error && (
+        <View style={[styles.card, styles.padded, styles.notice, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <Feather name="alert-circle" size={14} color={colors.state.warning} />
+          <ThemedText type="small" style={{ color: colors.textSecondary, marginLeft: Spacing.xs, flex: 1 }}>
+            {error}
+          </ThemedText>
+        </View>
+      )}
+
+      {result && (
+        <Animated.View entering={FadeInDown.duration(300).delay(200)}>
+          <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+            {result.matches.length}
+            {result.more ? "+" : ""} MATCHES · {(result.tookUs / 1000).toFixed(1)} MS · {result.scanned} OF {result.blocks} BLOCKS READ
+          </ThemedText>
+          <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+            {result.matches.length === 0 ? (
+              <ThemedText type="small" style={[styles.padded, { color: colors.textSecondary }]}>
+                {query ? "No lines match." : "Nothing indexed yet. Logs are indexed while the VM runs."}
+              </ThemedText>
+            ) : (
+              result.matches.map((m, i) => (
+                <View key={`${m.container}:${m.ts}:${i}`}>
+                  {i > 0 && <View style={[styles.rowDivider, divider]} />}
+                  <Pressable style={styles.matchRow} onPress={() => setContainer(m.container)}>
+                    <View style={styles.matchMeta}>
+                      <ThemedText type="caption" style={{ color: colors.accent.mauve }} numberOfLines={1}>
+                        {m.name || m.container}
+                      </ThemedText>
+                      <ThemedText
+                        type="caption"
+                        style={{ color: m.stream === "stderr" ? colors.state.error : colors.textMuted }}
+                      >
+                        {formatTime(m.ts)}
+                        {m.stream === "stderr" ? " · stderr" : ""}
+                      </ThemedText>
+                    </View>
+                    <ThemedText type="small" style={styles.mono} numberOfLines={4}>
+                      {m.line}
+                    </ThemedText>
+                  </Pressable>
+                </View>
+              ))
+            )}
+          </View>
+        </Animated.View>
+      )}
+
+      {stats?.supported && (
+        <ThemedText type="caption" style={[styles.footer, { color: colors.textMuted }]}>
+          Index {formatBytes(stats.bytes ?? 0)} of {formatBytes(stats.maxBytes ?? 0)} ·{" "}
+          {(stats.containers ?? []).reduce((n, c) => n + c.lines, 0).toLocaleString()} lines from{" "}
+          {stats.containers?.length ?? 0} containers · kept{" "}
+          {Math.round((stats.maxAgeMs ?? 0) / (24 * 60 * 60 * 1000))} days
+        </ThemedText>
+      )}
+    </ScrollView>
+  );
+}
+
+const styles = StyleSheet.create({
+  container: {
+    flex: 1,
+  },
+  sectionTitle: {
+    marginTop: Spacing.lg,
+    marginBottom: Spacing.sm,
+    marginLeft: Spacing.xs,
+    fontSize: 11,
+    fontWeight: "600",
+    letterSpacing: 1,
+  },
+  card: {
+    borderRadius: BorderRadius.lg,
+    overflow: "hidden",
+  },
+  padded: {
+    padding: Spacing.md,
+  },
+  notice: {
+    flexDirection: "row",
+    alignItems: "center",
+    marginTop: Spacing.md,
+  },
+  searchBox: {
+    flexDirection: "row",
+    alignItems: "center",
+    height: 52,
+    borderRadius: BorderRadius.md,
+    paddingHorizontal: Spacing.md,
+    borderWidth: 1,
+  },
+  input: {
+    flex: 1,
+    height: "100%",
+    marginLeft: Spacing.sm,
+    fontSize: 16,
+  },
+  chips: {
+    flexDirection: "row",
+    flexWrap: "wrap",
+    gap: Spacing.xs,
+    marginTop: Spacing.sm,
+  },
+  chip: {
+    paddingHorizontal: Spacing.md,
+    paddingVertical: Spacing.xs,
+    borderRadius: BorderRadius.pill,
+    borderWidth: 1,
+  },
+  rowDivider: {
+    height: 1,
+    marginLeft: Spacing.md,
+  },
+  matchRow: {
+    paddingHorizontal: Spacing.md,
+    paddingVertical: Spacing.sm,
+  },
+  matchMeta: {
+    flexDirection: "row",
+    justifyContent: "space-between",
+    marginBottom: 2,
+  },
+  mono: {
+    fontFamily: "monospace",
+    fontSize: 12,
+  },
+  footer: {
+    marginTop: Spacing.md,
+    textAlign: "center",
+  },
+});
@@ -0,0 +1,226 @@
+import React, { useEffect } from "react";
+import { View, StyleSheet, ScrollView, Pressable } from "react-native";
+import { useSafeAreaInsets } from "react-native-safe-area-context";
+import { useHeaderHeight } from "@react-navigation/elements";
+import { Feather } from "@expo/vector-icons";
+import * as Haptics from "expo-haptics";
+import Animated, { FadeInDown } from "react-native-reanimated";
+
+import { ThemedText } from "@/components/ThemedText";
+import { useTheme } from "@/hooks/useTheme";
+import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
+import { useMemoryStore, MemorySeries } from "@/store/useMemoryStore";
+
+const SERIES_LABELS: Record<MemorySeries, string> = {
+  javaHeap: "Java heap",
+  nativeHeap: "Native heap",
+  selfPss: "App PSS",
+  jsHeap: "JS heap",
+  vmPss: "VM host PSS",
+  qemuPss: "QEMU PSS",
+};
+
+function formatKb(kb: number | null | undefined): string {
+  if (kb === null || kb === undefined) return "—";
+  if (kb >= 1024 * 1024) return `${(kb / (1024 * 1024)).toFixed(2)} GB`;
+  if (kb >= 1024) return `${(kb / 1024).toFixed(1)} MB`;
+  return `${Math.round(kb)} kB`;
+}
+
+export default function MemoryDebugScreen() {
+  const insets = useSafeAreaInsets();
+  const headerHeight = useHeaderHeight();
+  const { theme, isDark } = useTheme();
+  const colors = isDark ? Colors.dark : Colors.light;
+
+  const {
+    samples,
+    trends,
+    leaks,
+    isSampling,
+    error,
+    startSampling,
+    stopSampling,
+    sampleNow,
+    clearSamples,
+  } = useMemoryStore();
+
+  useEffect(() => {
+    if (!isSampling) {
+      sampleNow();
+    }
+  }, []);
+
+  const latest = samples[samples.length - 1];
+  const divider = { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" };
+
+  const toggleSampling = () => {
+    Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Light);
+    if (isSampling) {
+      stopSampling();
+    } else {
+      startSampling();
+    }
+  };
+
+  return (
+    <ScrollView
+      style={[styles.container, { backgroundColor: theme.backgroundRoot }]}
+      contentContainerStyle={{
+        paddingTop: headerHeight + Spacing.md,
+        paddingBottom: insets.bottom + Spacing.xl,
+        paddingHorizontal: Spacing.md,
+      }}
+      showsVerticalScrollIndicator={false}
+    >
+      {leaks.length > 0 ? (
+        <Animated.View
+          entering={FadeInDown.duration(300)}
+          style={[styles.banner, { backgroundColor: colors.state.warning + "20" }]}
+        >
+          <Feather name="alert-triangle" size={16} color={colors.state.warning} />
+          <ThemedText type="small" style={{ color: theme.text, marginLeft: Spacing.sm, flex: 1 }}>
+            Sustained growth: {leaks.map((s) => SERIES_LABELS[s]).join(", ")}
+          </ThemedText>
+        </Animated.View>
+      ) : null}
+
+      {error ? (
+        <ThemedText type="small" style={{ color: colors.state.error, marginBottom: Spacing.sm }}>
+          {error}
+        </ThemedText>
+      ) : null}
+
+      <Animated.View entering={FadeInDown.duration(300).delay(100)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          CURRENT · TREND OVER LAST HOUR
+        </ThemedText>
+        <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          {(Object.keys(SERIES_LABELS) as MemorySeries[]).map((series, index) => {
+            const trend = trends[series];
+            const leaking = leaks.includes(series);
+            return (
+              <View key={series}>
+                {index > 0 ? <View style={[styles.divider, divider]} /> : null}
+                <View style={styles.row}>
+                  <ThemedText type="body" style={{ flex: 1 }}>{SERIES_LABELS[series]}</ThemedText>
+                  <View style={{ alignItems: "flex-end" }}>
+                    <ThemedText type="body" style={{ fontWeight: "600" }}>
+                      {formatKb(latest ? latest[series] : null)}
+                    </ThemedText>
+                    <ThemedText
+                      type="caption"
+                      style={{ color: leaking ? colors.state.warning : colors.textMuted }}
+                    >
+                      {trend
+                        ? `${trend.slopeKbPerHour >= 0 ? "+" : "−"}${formatKb(Math.abs(trend.slopeKbPerHour))}/h · r² ${trend.r2.toFixed(2)}`
+                        : "not enough samples"}
+                    </ThemedText>
+                  </View>
+                </View>
+              </View>
+            );
+          })}
+        </View>
+      </Animated.View>
+
+      <Animated.View entering={FadeInDown.duration(300).delay(200)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          SAMPLING
+        </ThemedText>
+        <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <View style={styles.row}>
+            <ThemedText type="body" style={{ flex: 1 }}>Samples</ThemedText>
+            <ThemedText type="body" style={{ color: colors.textSecondary }}>
+              {samples.length}
+              {samples.length > 1
+                ? ` over ${Math.round((samples[samples.length - 1].timestamp - samples[0].timestamp) / 60000)} min`
+                : ""}
+            </ThemedText>
+          </View>
+          <View style={styles.actions}>
+            <Pressable
+              style={[styles.actionButton, { backgroundColor: colors.accent.mauve + "15" }]}
+              onPress={toggleSampling}
+            >
+              <Feather name={isSampling ? "pause" : "play"} size={16} color={colors.accent.mauve} />
+              <ThemedText type="small" style={[styles.actionLabel, { color: colors.accent.mauve }]}>
+                {isSampling ? "Stop" : "Start"}
+              </ThemedText>
+            </Pressable>
+            <Pressable
+              style={[styles.actionButton, { backgroundColor: colors.accent.olive + "15" }]}
+              onPress={() => sampleNow()}
+            >
+              <Feather name="refresh-cw" size={16} color={colors.accent.olive} />
+              <ThemedText type="small" style={[styles.actionLabel, { color: colors.accent.olive }]}>
+                Sample
+              </ThemedText>
+            </Pressable>
+            <Pressable
+              style={[styles.actionButton, { backgroundColor: colors.state.error + "15" }]}
+              onPress={clearSamples}
+            >
+              <Feather name="trash-2" size={16} color={colors.state.error} />
+              <ThemedText type="small" style={[styles.actionLabel, { color: colors.state.error }]}>
+                Clear
+              </ThemedText>
+            </Pressable>
+          </View>
+        </View>
+      </Animated.View>
+    </ScrollView>
+  );
+}
+
+const styles = StyleSheet.create({
+  container: {
+    flex: 1,
+  },
+  sectionTitle: {
+    marginTop: Spacing.lg,
+    marginBottom: Spacing.sm,
+    marginLeft: Spacing.xs,
+    fontSize: 11,
+    fontWeight: "600",
+    letterSpacing: 1,
+  },
+  card: {
+    borderRadius: BorderRadius.lg,
+    overflow: "hidden",
+  },
+  row: {
+    flexDirection: "row",
+    alignItems: "center",
+    paddingHorizontal: Spacing.md,
+    paddingVertical: Spacing.sm + 4,
+  },
+  divider: {
+    height: 1,
+    marginLeft: Spacing.md,
+  },
+  banner: {
+    flexDirection: "row",
+    alignItems: "center",
+    padding: Spacing.md,
+    borderRadius: BorderRadius.md,
+  },
+  actions: {
+    flexDirection: "row",
+    gap: Spacing.sm,
+    padding: Spacing.md,
+    paddingTop: 0,
+  },
+  actionButton: {
+    flex: 1,
+    flexDirection: "row",
+    alignItems: "center",
+    justifyContent: "center",
+    paddingVertical: Spacing.sm,
+    borderRadius: BorderRadius.md,
+  },
+  actionLabel: {
+    marginLeft: Spacing.xs,
+    fontWeight: "600",
+  },
+});
@@ -0,0 +1,222 @@
+import React, { useEffect, useState } from "react";
+import { View, StyleSheet, ScrollView, Pressable } from "react-native";
+import { useSafeAreaInsets } from "react-native-safe-area-context";
+import { useHeaderHeight } from "@react-navigation/elements";
+import { Feather } from "@expo/vector-icons";
+import * as Haptics from "expo-haptics";
+import Animated, { FadeInDown } from "react-native-reanimated";
+
+import { ThemedText } from "@/components/ThemedText";
+import { SettingsRow } from "@/components/SettingsRow";
+import { useTheme } from "@/hooks/useTheme";
+import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
+import {
+  getProfilerSummary,
+  isProfilerEnabled,
+  resetProfiler,
+  setProfilerEnabled,
+  shareChromeTrace,
+  ProfilerSummary,
+} from "@/lib/profiler";
+
+const REFRESH_MS = 1000;
+
+function bucketLabel(bounds: number[], index: number): string {
+  const lower = index === 0 ? 0 : bounds[index - 1];
+  const upper = bounds[index];
+  return upper === Infinity ? `> ${lower} ms` : `${lower}–${upper} ms`;
+}
+
+export default function ProfilerScreen() {
+  const insets = useSafeAreaInsets();
+  const headerHeight = useHeaderHeight();
+  const { theme, isDark } = useTheme();
+  const colors = isDark ? Colors.dark : Colors.light;
+
+  const [enabled, setEnabled] = useState(isProfilerEnabled());
+  const [summary, setSummary] = useState<ProfilerSummary>(() => getProfilerSummary());
+
+  useEffect(() => {
+    const timer = setInterval(() => setSummary(getProfilerSummary()), REFRESH_MS);
+    return () => clearInterval(timer);
+  }, []);
+
+  const divider = { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" };
+  const { histogram } = summary;
+  const maxCount = Math.max(1, ...histogram.counts);
+
+  const handleToggle = (value: boolean) => {
+    setProfilerEnabled(value);
+    setEnabled(value);
+    Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Light);
+  };
+
+  const handleReset = () => {
+    resetProfiler();
+    setSummary(getProfilerSummary());
+  };
+
+  return (
+    <ScrollView
+      style={[styles.container, { backgroundColor: theme.backgroundRoot }]}
+      contentContainerStyle={{
+        paddingTop: headerHeight + Spacing.md,
+        paddingBottom: insets.bottom + Spacing.xl,
+        paddingHorizontal: Spacing.md,
+      }}
+      showsVerticalScrollIndicator={false}
+    >
+      <Animated.View entering={FadeInDown.duration(300).delay(100)}>
+        <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <SettingsRow
+            icon="zap"
+            label="Record"
+            description={`${summary.spans} spans · ${histogram.frames} frames`}
+            value={enabled}
+            onToggle={handleToggle}
+          />
+          <View style={[styles.divider, divider]} />
+          <SettingsRow
+            icon="share"
+            label="Export Chrome Trace"
+            description="Open in Perfetto or chrome://tracing"
+            onPress={() => shareChromeTrace()}
+          />
+          <View style={[styles.divider, divider]} />
+          <SettingsRow icon="trash-2" label="Reset" onPress={handleReset} isDestructive />
+        </View>
+      </Animated.View>
+
+      <Animated.View entering={FadeInDown.duration(300).delay(200)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          JS FRAME TIME · {histogram.droppedFrames} DROPPED
+        </ThemedText>
+        <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          {histogram.counts.map((count, index) => (
+            <View key={index} style={styles.barRow}>
+              <ThemedText type="caption" style={[styles.barLabel, { color: colors.textSecondary }]}>
+                {bucketLabel(histogram.bounds, index)}
+              </ThemedText>
+              <View style={styles.barTrack}>
+                <View
+                  style={[
+                    styles.bar,
+                    {
+                      width: `${(count / maxCount) * 100}%`,
+                      backgroundColor: index < 2 ? colors.state.success : index < 4 ? colors.state.warning : colors.state.error,
+                    },
+                  ]}
+                />
+              </View>
+              <ThemedText type="caption" style={[styles.barCount, { color: colors.textMuted }]}>
+                {count}
+              </ThemedText>
+            </View>
+          ))}
+        </View>
+      </Animated.View>
+
+      <Animated.View entering={FadeInDown.duration(300).delay(300)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          HOTSPOTS
+        </ThemedText>
+        <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          {summary.hotspots.length === 0 ? (
+            <ThemedText type="small" style={{ color: colors.textMuted }}>No samples yet</ThemedText>
+          ) : (
+            summary.hotspots.map((spot) => (
+              <View key={spot.name} style={styles.listRow}>
+                <ThemedText type="small" style={styles.mono} numberOfLines={1}>{spot.name}</ThemedText>
+                <ThemedText type="caption" style={{ color: colors.textSecondary }}>
+                  {spot.totalMs.toFixed(1)} ms · {spot.count}× · max {spot.maxMs.toFixed(1)}
+                </ThemedText>
+              </View>
+            ))
+          )}
+        </View>
+      </Animated.View>
+
+      <Animated.View entering={FadeInDown.duration(300).delay(400)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          LONG TASKS
+        </ThemedText>
+        <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          {summary.longTasks.length === 0 ? (
+            <View style={styles.listRow}>
+              <Feather name="check" size={14} color={colors.state.success} />
+              <ThemedText type="small" style={{ color: colors.textMuted, marginLeft: Spacing.xs, flex: 1 }}>
+                Nothing over one frame
+              </ThemedText>
+            </View>
+          ) : (
+            summary.longTasks.slice(0, 20).map((task, index) => (
+              <View key={index} style={styles.listRow}>
+                <ThemedText type="small" style={styles.mono} numberOfLines={1}>{task.name}</ThemedText>
+                <ThemedText type="caption" style={{ color: colors.state.warning }}>
+                  {task.duration.toFixed(1)} ms
+                </ThemedText>
+              </View>
+            ))
+          )}
+        </View>
+      </Animated.View>
+    </ScrollView>
+  );
+}
+
+const styles = StyleSheet.create({
+  container: {
+    flex: 1,
+  },
+  sectionTitle: {
+    marginTop: Spacing.lg,
+    marginBottom: Spacing.sm,
+    marginLeft: Spacing.xs,
+    fontSize: 11,
+    fontWeight: "600",
+    letterSpacing: 1,
+  },
+  card: {
+    borderRadius: BorderRadius.lg,
+    overflow: "hidden",
+  },
+  padded: {
+    padding: Spacing.md,
+  },
+  divider: {
+    height: 1,
+    marginLeft: 60,
+  },
+  barRow: {
+    flexDirection: "row",
+    alignItems: "center",
+    marginVertical: 3,
+  },
+  barLabel: {
+    width: 80,
+  },
+  barTrack: {
+    flex: 1,
+    height: 8,
+    marginHorizontal: Spacing.sm,
+  },
+  bar: {
+    height: 8,
+    borderRadius: 4,
+  },
+  barCount: {
+    width: 48,
+    textAlign: "right",
+  },
+  listRow: {
+    flexDirection: "row",
+    alignItems: "center",
+    justifyContent: "space-between",
+    paddingVertical: Spacing.xs,
+  },
+  mono: {
+    flex: 1,
+    fontFamily: "monospace",
+    marginRight: Spacing.sm,
+  },
+});
@@ -0,0 +1,312 @@
+import React, { useCallback, useEffect, useState } from "react";
+import { View, StyleSheet, ScrollView, Share } from "react-native";
+import { useSafeAreaInsets } from "react-native-safe-area-context";
+import { useHeaderHeight } from "@react-navigation/elements";
+import { Feather } from "@expo/vector-icons";
+import * as Haptics from "expo-haptics";
+import Animated, { FadeInDown } from "react-native-reanimated";
+
+import { ThemedText } from "@/components/ThemedText";
+import { SettingsRow } from "@/components/SettingsRow";
+import { useTheme } from "@/hooks/useTheme";
+import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
+import QemuService, { QemuBlockTrace, QemuTraceSummary } from "@/services/QemuService";
+import { formatMicros, bucketLabel } from "@/lib/latency";
+
+const REFRESH_MS = 2000;
+
+function formatBytes(bytes: number): string {
+  if (bytes >= 1024 * 1024 * 1024) return `${(bytes / (1024 * 1024 * 1024)).toFixed(1)} GB`;
+  if (bytes >= 1024 * 1024) return `${(bytes / (1024 * 1024)).toFixed(1)} MB`;
+  return `${(bytes / 1024).toFixed(0)} KB`;
+}
+
+function perSecond(count: number, elapsedMs: number | undefined): string {
+  if (!elapsedMs) return "–";
+  const rate = (count * 1000) / elapsedMs;
+  return rate >= 100 ? rate.toFixed(0) : rate.toFixed(1);
+}
+
+/**
+ * QEMU's own block, virtqueue and TCG trace events. The events are only on
+ * while this screen is open; leaving it switches them off again.
+ */
+export default function QemuTraceScreen() {
+  const insets = useSafeAreaInsets();
+  const headerHeight = useHeaderHeight();
+  const { theme, isDark } = useTheme();
+  const colors = isDark ? Colors.dark : Colors.light;
+
+  const [summary, setSummary] = useState<QemuTraceSummary | null>(null);
+  const [supported, setSupported] = useState(true);
+  const [error, setError] = useState<string | null>(null);
+
+  const refresh = useCallback(async () => {
+    try {
+      setSummary(await QemuService.getQemuTraceSummary());
+    } catch (e: any) {
+      setError(e.message);
+    }
+  }, []);
+
+  const startWindow = useCallback(async () => {
+    try {
+      setSupported(await QemuService.setQemuTracing(true));
+      setError(null);
+      await refresh();
+    } catch (e: any) {
+      setError(e.message);
+    }
+  }, [refresh]);
+
+  useEffect(() => {
+    startWindow();
+    const timer = setInterval(refresh, REFRESH_MS);
+    return () => {
+      clearInterval(timer);
+      QemuService.setQemuTracing(false).catch(() => {});
+    };
+  }, [startWindow, refresh]);
+
+  const handleRestart = () => {
+    Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Light);
+    startWindow();
+  };
+
+  const handleExport = async () => {
+    const latest = await QemuService.getQemuTraceSummary();
+    await Share.share({ title: "qemu-trace.json", message: JSON.stringify(latest, null, 2) });
+  };
+
+  const divider = { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" };
+  const elapsed = summary?.elapsedMs;
+
+  const renderBlock = (label: string, block: QemuBlockTrace, color: string) => {
+    const first = block.histogram.findIndex((n) => n > 0);
+    const shown = first < 0 ? [] : block.histogram.slice(first);
+    const peak = Math.max(1, ...shown);
+    return (
+      <View style={styles.blockRow}>
+        <View style={styles.listRow}>
+          <ThemedText type="small">{label}</ThemedText>
+          <ThemedText type="caption" style={{ color }}>
+            p50 {formatMicros(block.completed ? block.p50Us : null)} · p99 {formatMicros(block.completed ? block.p99Us : null)} · max{" "}
+            {formatMicros(block.completed ? block.maxUs : null)}
+          </ThemedText>
+        </View>
+        <ThemedText type="caption" style={{ color: colors.textSecondary }}>
+          {block.requests.toLocaleString()} requests · {formatBytes(block.bytes)} · {perSecond(block.requests, elapsed)}/s
+          {block.errors ? ` · ${block.errors} errors` : ""}
+        </ThemedText>
+        {shown.length > 0 && (
+          <>
+            <View style={styles.histogram}>
+              {shown.map((n, i) => (
+                <View
+                  key={i}
+                  style={[styles.histogramBar, { backgroundColor: color, height: `${Math.max(4, (n / peak) * 100)}%`, opacity: n ? 1 : 0.2 }]}
+                />
+              ))}
+            </View>
+            <View style={styles.listRow}>
+              <ThemedText type="caption" style={{ color: colors.textMuted }}>{bucketLabel(first)}</ThemedText>
+              <ThemedText type="caption" style={{ color: colors.textMuted }}>{bucketLabel(block.histogram.length)}</ThemedText>
+            </View>
+          </>
+        )}
+      </View>
+    );
+  };
+
+  const events = Object.entries(summary?.events ?? {}).sort((a, b) => b[1] - a[1]);
+  const kvmExits = Object.entries(summary?.kvmExits ?? {}).sort((a, b) => b[1] - a[1]);
+
+  return (
+    <ScrollView
+      style={[styles.container, { backgroundColor: theme.backgroundRoot }]}
+      contentContainerStyle={{
+        paddingTop: headerHeight + Spacing.md,
+        paddingBottom: insets.bottom + Spacing.xl,
+        paddingHorizontal: Spacing.md,
+      }}
+      showsVerticalScrollIndicator={false}
+    >
+      <Animated.View entering={FadeInDown.duration(300).delay(100)}>
+        <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <SettingsRow
+            icon="refresh-cw"
+            label="Restart Window"
+            description={
+              elapsed !== undefined
+                ? `${(elapsed / 1000).toFixed(0)} s · ${(summary?.lines ?? 0).toLocaleString()} events`
+                : "Clear the summary and start counting again"
+            }
+            onPress={handleRestart}
+          />
+          <View style={[styles.divider, divider]} />
+          <SettingsRow
+            icon="share"
+            label="Export Summary"
+            description="JSON, same format as scripts/qemu/trace.sh"
+            onPress={handleExport}
+          />
+        </View>
+      </Animated.View>
+
+      {(!supported || error) && (
+        <View style={[styles.card, styles.padded, styles.notice, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <Feather name="alert-circle" size={14} color={colors.state.warning} />
+          <ThemedText type="small" style={{ color: colors.textSecondary, marginLeft: Spacing.xs, flex: 1 }}>
+            {error ?? "This QEMU build has no trace backend. Rebuild it with scripts/qemu/build-qemu.sh."}
+          </ThemedText>
+        </View>
+      )}
+
+      {summary?.block && (
+        <Animated.View entering={FadeInDown.duration(300).delay(200)}>
+          <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+            VIRTIO-BLK · {summary.block.inflight} IN FLIGHT · PEAK {summary.block.inflightMax}
+          </ThemedText>
+          <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+            {renderBlock("Read", summary.block.read, colors.state.success)}
+            {renderBlock("Write", summary.block.write, colors.state.warning)}
+          </View>
+        </Animated.View>
+      )}
+
+      {summary?.virtqueues && summary.virtqueues.length > 0 && (
+        <Animated.View entering={FadeInDown.duration(300).delay(300)}>
+          <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+            VIRTQUEUES · KICKS / INTERRUPTS PER SECOND
+          </ThemedText>
+          <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+            {summary.virtqueues.map((vq) => (
+              <View key={`${vq.device}:${vq.queue}`} style={styles.listRow}>
+                <ThemedText type="small" style={styles.mono}>
+                  {vq.kind === "blk" ? "blk" : "dev"}
+                  {vq.device} q{vq.queue}
+                </ThemedText>
+                <ThemedText type="caption" style={{ color: colors.textSecondary }}>
+                  {perSecond(vq.kicks, elapsed)} / {perSecond(vq.interrupts, elapsed)}
+                </ThemedText>
+              </View>
+            ))}
+          </View>
+        </Animated.View>
+      )}
+
+      {summary?.tcg && (
+        <Animated.View entering={FadeInDown.duration(300).delay(400)}>
+          <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+            TCG
+          </ThemedText>
+          <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+            <View style={styles.listRow}>
+              <ThemedText type="small">Translations</ThemedText>
+              <ThemedText type="caption" style={{ color: colors.textSecondary }}>
+                {summary.tcg.translations.toLocaleString()} · {perSecond(summary.tcg.translations, elapsed)}/s · peak{" "}
+                {summary.tcg.peakPerSecond.toLocaleString()}/s
+              </ThemedText>
+            </View>
+            {summary.jit?.tbFlushes !== undefined && (
+              <View style={styles.listRow}>
+                <ThemedText type="small">TB flushes</ThemedText>
+                <ThemedText type="caption" style={{ color: summary.jit.tbFlushes ? colors.state.warning : colors.textSecondary }}>
+                  {summary.jit.tbFlushes}
+                  {summary.jit.tbInvalidations !== undefined ? ` · ${summary.jit.tbInvalidations.toLocaleString()} invalidated` : ""}
+                </ThemedText>
+              </View>
+            )}
+          </View>
+        </Animated.View>
+      )}
+
+      {kvmExits.length > 0 && (
+        <Animated.View entering={FadeInDown.duration(300).delay(450)}>
+          <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+            KVM EXITS
+          </ThemedText>
+          <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+            {kvmExits.map(([reason, count]) => (
+              <View key={reason} style={styles.listRow}>
+                <ThemedText type="small" style={styles.mono}>reason {reason}</ThemedText>
+                <ThemedText type="caption" style={{ color: colors.textSecondary }}>{count.toLocaleString()}</ThemedText>
+              </View>
+            ))}
+          </View>
+        </Animated.View>
+      )}
+
+      {events.length > 0 && (
+        <Animated.View entering={FadeInDown.duration(300).delay(500)}>
+          <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+            EVENTS
+          </ThemedText>
+          <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+            {events.map(([name, count]) => (
+              <View key={name} style={styles.listRow}>
+                <ThemedText type="small" style={styles.mono} numberOfLines={1}>{name}</ThemedText>
+                <ThemedText type="caption" style={{ color: colors.textSecondary }}>{count.toLocaleString()}</ThemedText>
+              </View>
+            ))}
+          </View>
+        </Animated.View>
+      )}
+    </ScrollView>
+  );
+}
+
+const styles = StyleSheet.create({
+  container: {
+    flex: 1,
+  },
+  sectionTitle: {
+    marginTop: Spacing.lg,
+    marginBottom: Spacing.sm,
+    marginLeft: Spacing.xs,
+    fontSize: 11,
+    fontWeight: "600",
+    letterSpacing: 1,
+  },
+  card: {
+    borderRadius: BorderRadius.lg,
+    overflow: "hidden",
+  },
+  padded: {
+    padding: Spacing.md,
+  },
+  notice: {
+    flexDirection: "row",
+    alignItems: "center",
+    marginTop: Spacing.md,
+  },
+  divider: {
+    height: 1,
+    marginLeft: 60,
+  },
+  blockRow: {
+    paddingVertical: Spacing.xs,
+  },
+  histogram: {
+    flexDirection: "row",
+    alignItems: "flex-end",
+    height: 40,
+    gap: 2,
+    marginTop: Spacing.sm,
+  },
+  histogramBar: {
+    flex: 1,
+    borderRadius: 2,
+  },
+  listRow: {
+    flexDirection: "row",
+    alignItems: "center",
+    justifyContent: "space-between",
+    paddingVertical: Spacing.xs,
+  },
+  mono: {
+    flex: 1,
+    fontFamily: "monospace",
+    marginRight: Spacing.sm,
+  },
+});
@@ -1,8 +1,10 @@
-import React, { useEffect } from "react";
+import React, { useEffect, useState } from "react";
 import { View, StyleSheet, ScrollView, Pressable, Linking } from "react-native";
 import { useSafeAreaInsets } from "react-native-safe-area-context";
 import { useHeaderHeight } from "@react-navigation/elements";
 import { useBottomTabBarHeight } from "@react-navigation/bottom-tabs";
+import { useNavigation } from "@react-navigation/native";
+import { NativeStackNavigationProp } from "@react-navigation/native-stack";
 import { Feather } from "@expo/vector-icons";
 import * as Haptics from "expo-haptics";
 import Animated, { FadeInDown } from "react-native-reanimated";
@@ -14,11 +16,96 @@ import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
 import { useSettingsStore } from "@/store/useSettingsStore";
 import { useQemuStore } from "@/store/useQemuStore";
 import { useDockerStore } from "@/store/useDockerStore";
+import { useMemoryStore } from "@/store/useMemoryStore";
+import { useImageQuotaStore, cacheHitRate, QuotaStats } from "@/store/useImageQuotaStore";
+import { useContainerPoolStore, averageMs, PoolConfig } from "@/store/useContainerPoolStore";
+import { RootStackParamList } from "@/navigation/RootStackNavigator";
+import QemuService, { BootTimes, ContainerRuntime, ImagePrefetchStatus } from "@/services/QemuService";
+
+const CPU_OPTIONS = [1, 2, 3, 4];
+const RAM_OPTIONS = [1024, 2048, 3072, 4096];
+const RUNTIME_OPTIONS: ContainerRuntime[] = ["docker", "lite", "lazy"];
+const MAX_IMAGES_OPTIONS = [10, 20, 30, 50];
+const POOL_OPTIONS: Array<PoolConfig & { label: string }> = [
+  { size: 0, warmth: "created", label: "Off" },
+  { size: 1, warmth: "created", label: "1 created" },
+  { size: 2, warmth: "created", label: "2 created" },
+  { size: 1, warmth: "paused", label: "1 paused" },
+];
+
+const RUNTIME_LABELS: Record<ContainerRuntime, { value: string; description: string }> = {
+  docker: { value: "Docker", description: "dockerd on containerd" },
+  lite: { value: "Lite", description: "containerd with a Docker API shim, no dockerd" },
+  lazy: { value: "Lite + lazy pull", description: "Containers start before their images finish downloading" },
+};
+
+function nextOption<T>(options: T[], current: T): T {
+  const index = options.indexOf(current);
+  return options[(index + 1) % options.length];
+}
+
+function formatSeconds(ms: number): string {
+  return `${(ms / 1000).toFixed(1)} s`;
+}
+
+/** Evictions so far and how often a container's image was already local */
+function describeQuotaStats(stats: QuotaStats, isRunning: boolean): string {
+  const hitRate = cacheHitRate(stats);
+  if (stats.evictedImages === 0 && hitRate === null) {
+    return isRunning ? "No images evicted yet" : "Unused images are evicted while the VM runs";
+  }
+  const reclaimed = stats.reclaimedBytes >= 1024 ** 3
+    ? `${(stats.reclaimedBytes / 1024 ** 3).toFixed(1)} GB`
+    : `${Math.round(stats.reclaimedBytes / 1024 ** 2)} MB`;
+  const hits = hitRate === null ? "" : `, ${Math.round(hitRate * 100)}% cache hits`;
+  return `${stats.evictedImages} evicted, ${reclaimed} reclaimed${hits}`;
+}
+
+/** Measured start times with and without a warm pool container */
+function describePool(pooledMs: number[], coldMs: number[]): string {
+  const pooled = averageMs(pooledMs);
+  const cold = averageMs(coldMs);
+  if (pooled !== null && cold !== null) {
+    return `Starts in ${formatSeconds(pooled)} from the pool vs ${formatSeconds(cold)} cold`;
+  }
+  return "Pre-created containers for recently run images";
+}
+
+/** What the last background pre-fetch left warm in the host cache */
+function describePrefetch(status: ImagePrefetchStatus | null): string {
+  const images = status?.images;
+  if (!images || images.length === 0) {
+    return "Fetch default images while charging on Wi-Fi";
+  }
+  const warm = images.filter((image) => image.complete).length;
+  const fetched = images.reduce((sum, image) => sum + (image.fetchedBytes ?? 0), 0);
+  const parts = [`${warm}/${images.length} images warm`, `${Math.round(fetched / 1024 ** 2)} MB fetched`];
+  if (status?.stopped) parts.push("resumes next run");
+  return parts.join(", ");
+}
+
+/** Measured boot-to-Docker times for both init modes, and what appliance init saves */
+function describeBootTimes(times: BootTimes | null, enabled: boolean): string {
+  const openrc = times?.modes?.openrc;
+  const appliance = times?.modes?.appliance;
+  if (openrc && appliance) {
+    const saved = openrc.averageMs - appliance.averageMs;
+    return `Ready in ${formatSeconds(appliance.averageMs)} vs ${formatSeconds(openrc.averageMs)} with OpenRC (${formatSeconds(saved)} saved per boot)`;
+  }
+  if (enabled && times && !times.applianceInstalled) {
+    return "Takes effect once the guest setup has installed it";
+  }
+  if (openrc) {
+    return `Skip OpenRC runlevels; OpenRC boots in ${formatSeconds(openrc.averageMs)}`;
+  }
+  return "Start containerd and dockerd directly, skipping OpenRC";
+}
 
 export default function SettingsScreen() {
   const insets = useSafeAreaInsets();
   const headerHeight = useHeaderHeight();
   const tabBarHeight = useBottomTabBarHeight();
+  const navigation = useNavigation<NativeStackNavigationProp<RootStackParamList>>();
   const { theme, isDark } = useTheme();
   const colors = isDark ? Colors.dark : Colors.light;
 
@@ -31,13 +118,47 @@ export default function SettingsScreen() {
     clearCache,
   } = useSettingsStore();
 
-  const { settings: qemuSettings, updateSettings: updateQemuSettings } = useQemuStore();
+  const {
+    settings: qemuSettings,
+    updateSettings: updateQemuSettings,
+    vmStatus,
+    pendingRestart,
+    restartVM,
+  } = useQemuStore();
   const { setDockerApiUrl: updateDockerUrl } = useDockerStore();
+  const memoryLeaks = useMemoryStore((state) => state.leaks);
+  const {
+    limits: quotaLimits,
+    stats: quotaStats,
+    isRunning: quotaRunning,
+    setLimits: setQuotaLimits,
+    load: loadQuota,
+    checkNow: checkQuota,
+  } = useImageQuotaStore();
+  const {
+    config: poolConfig,
+    pooledMs,
+    coldMs,
+    load: loadPool,
+    setConfig: setPoolConfig,
+  } = useContainerPoolStore();
+  const poolOption = POOL_OPTIONS.find((o) => o.size === poolConfig.size && o.warmth === poolConfig.warmth)
+    ?? POOL_OPTIONS[0];
+  const [bootTimes, setBootTimes] = useState<BootTimes | null>(null);
+  const [prefetchStatus, setPrefetchStatus] = useState<ImagePrefetchStatus | null>(null);
 
   useEffect(() => {
     loadSettings();
+    loadQuota();
+    loadPool();
   }, []);
 
+  // A boot finishing updates the measurements
+  useEffect(() => {
+    QemuService.getBootTimes().then(setBootTimes).catch(() => setBootTimes(null));
+    QemuService.getImagePrefetchStatus().then(setPrefetchStatus).catch(() => setPrefetchStatus(null));
+  }, [vmStatus]);
+
   const handleClearCache = async () => {
     Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Medium);
     await clearCache();
@@ -75,13 +196,17 @@ export default function SettingsScreen() {
           <SettingsRow
             icon="cpu"
             label="CPU Cores"
+            description={vmStatus === "running" ? "Applied live" : undefined}
             value={`${qemuSettings.cpuCores} cores`}
+            onPress={() => updateQemuSettings({ cpuCores: nextOption(CPU_OPTIONS, qemuSettings.cpuCores) })}
           />
           <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
           <SettingsRow
             icon="database"
             label="Memory"
+            description={vmStatus === "running" ? "Applied live" : undefined}
             value={`${qemuSettings.ramMB} MB`}
+            onPress={() => updateQemuSettings({ ramMB: nextOption(RAM_OPTIONS, qemuSettings.ramMB) })}
           />
           <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
           <SettingsRow
@@ -89,6 +214,41 @@ export default function SettingsScreen() {
             label="Disk Size"
             value={`${qemuSettings.diskSizeGB} GB`}
           />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="fast-forward"
+            label="Appliance Init"
+            description={describeBootTimes(bootTimes, qemuSettings.applianceInit)}
+            value={qemuSettings.applianceInit}
+            onToggle={(applianceInit) => updateQemuSettings({ applianceInit })}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="feather"
+            label="Container Runtime"
+            description={RUNTIME_LABELS[qemuSettings.runtime].description}
+            value={RUNTIME_LABELS[qemuSettings.runtime].value}
+            onPress={() => updateQemuSettings({ runtime: nextOption(RUNTIME_OPTIONS, qemuSettings.runtime) })}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="zap"
+            label="Scratch Disk"
+            description="Fast disk for /tmp and build caches, wiped every boot; no watchdog snapshots"
+            value={qemuSettings.scratchDisk}
+            onToggle={(scratchDisk) => updateQemuSettings({ scratchDisk })}
+          />
+          {pendingRestart ? (
+            <>
+              <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+              <SettingsRow
+                icon="refresh-cw"
+                label="Restart to Apply"
+                description={pendingRestart}
+                onPress={() => restartVM()}
+              />
+            </>
+          ) : null}
         </View>
       </Animated.View>
 
@@ -117,6 +277,47 @@ export default function SettingsScreen() {
           STORAGE
         </ThemedText>
         <View style={[styles.section, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <SettingsRow
+            icon="layers"
+            label="Max Images"
+            description="Least recently used images beyond this are removed"
+            value={String(quotaLimits.maxImages)}
+            onPress={() => setQuotaLimits({ maxImages: nextOption(MAX_IMAGES_OPTIONS, quotaLimits.maxImages) })}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="archive"
+            label="Image Cleanup"
+            description={describeQuotaStats(quotaStats, quotaRunning)}
+            onPress={quotaRunning ? () => checkQuota() : undefined}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="box"
+            label="Warm Containers"
+            description={describePool(pooledMs, coldMs)}
+            value={poolOption.label}
+            onPress={() => {
+              const { size, warmth } = nextOption(POOL_OPTIONS, poolOption);
+              setPoolConfig({ size, warmth });
+            }}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="download-cloud"
+            label="Pre-fetch Images"
+            description={describePrefetch(prefetchStatus)}
+            value={qemuSettings.imagePrefetch}
+            onToggle={(imagePrefetch) => updateQemuSettings({ imagePrefetch })}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="download"
+            label="Pre-fetch Now"
+            description="Fetch default images on any network"
+            onPress={() => QemuService.prefetchImagesNow()}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
           <SettingsRow
             icon="trash-2"
             label="Clear Cache"
@@ -127,6 +328,48 @@ export default function SettingsScreen() {
         </View>
       </Animated.View>
 
+      <Animated.View entering={FadeInDown.duration(300).delay(450)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          DIAGNOSTICS
+        </ThemedText>
+        <View style={[styles.section, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          <SettingsRow
+            icon="activity"
+            label="Memory"
+            description={memoryLeaks.length > 0 ? "Sustained growth detected" : "Heap, PSS and QEMU usage over time"}
+            onPress={() => navigation.navigate("MemoryDebug")}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="zap"
+            label="JS Profiler"
+            description="Frame times, long tasks, trace export"
+            onPress={() => navigation.navigate("Profiler")}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="shield"
+            label="VM Watchdog"
+            description="Hung-guest detection, recovery and incidents"
+            onPress={() => navigation.navigate("Watchdog")}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="cpu"
+            label="QEMU Trace"
+            description="Block latency, virtqueues and TCG from QEMU's trace events"
+            onPress={() => navigation.navigate("QemuTrace")}
+          />
+          <View style={[styles.divider, { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" }]} />
+          <SettingsRow
+            icon="search"
+            label="Log Search"
+            description="Full-text search across every container's logs"
+            onPress={() => navigation.navigate("LogSearch")}
+          />
+        </View>
+      </Animated.View>
+
       <Animated.View entering={FadeInDown.duration(300).delay(500)}>
         <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
           ABOUT
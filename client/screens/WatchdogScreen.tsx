@@ -0,0 +1,268 @@
+import React, { useCallback, useEffect, useState } from "react";
+import { View, StyleSheet, ScrollView } from "react-native";
+import { useSafeAreaInsets } from "react-native-safe-area-context";
+import { useHeaderHeight } from "@react-navigation/elements";
+import { Feather } from "@expo/vector-icons";
+import * as Haptics from "expo-haptics";
+import Animated, { FadeInDown } from "react-native-reanimated";
+
+import { ThemedText } from "@/components/ThemedText";
+import { SettingsRow } from "@/components/SettingsRow";
+import { useTheme } from "@/hooks/useTheme";
+import { Spacing, Colors, BorderRadius, Shadows } from "@/constants/theme";
+import { useQemuStore } from "@/store/useQemuStore";
+import QemuService, { WatchdogAction, WatchdogConfig, WatchdogIncident } from "@/services/QemuService";
+
+const ACTIONS: { action: WatchdogAction; label: string; description: string }[] = [
+  { action: "nmi", label: "NMI", description: "Guest kernel prints backtraces or panics" },
+  { action: "dump", label: "Memory dump", description: "Compressed kdump of guest RAM" },
+  { action: "reset", label: "Reset", description: "Hard reset, guest reboots" },
+  {
+    action: "restore",
+    label: "Restore snapshot",
+    description: "Load the last healthy snapshot; container data written since is lost",
+  },
+  { action: "restart", label: "Restart QEMU", description: "Kill and relaunch the VM" },
+];
+
+// Escalation always runs in this order, whatever order the toggles were flipped in
+const ACTION_ORDER = ACTIONS.map((entry) => entry.action);
+
+function formatDuration(ms: number | null | undefined): string {
+  if (ms === null || ms === undefined) return "—";
+  if (ms >= 60_000) return `${(ms / 60_000).toFixed(1)} min`;
+  if (ms >= 1000) return `${(ms / 1000).toFixed(1)} s`;
+  return `${Math.round(ms)} ms`;
+}
+
+export default function WatchdogScreen() {
+  const insets = useSafeAreaInsets();
+  const headerHeight = useHeaderHeight();
+  const { theme, isDark } = useTheme();
+  const colors = isDark ? Colors.dark : Colors.light;
+  // QEMU can't snapshot the scratch disk's raw image, so restore is skipped
+  const scratchDisk = useQemuStore((state) => state.settings.scratchDisk);
+
+  const [config, setConfig] = useState<WatchdogConfig | null>(null);
+  const [incidents, setIncidents] = useState<WatchdogIncident[]>([]);
+  const [error, setError] = useState<string | null>(null);
+
+  const refresh = useCallback(async () => {
+    try {
+      const [nextConfig, nextIncidents] = await Promise.all([
+        QemuService.getWatchdogConfig(),
+        QemuService.getWatchdogIncidents(50),
+      ]);
+      setConfig(nextConfig);
+      setIncidents(nextIncidents);
+      setError(null);
+    } catch (e: any) {
+      setError(e.message);
+    }
+  }, []);
+
+  useEffect(() => {
+    refresh();
+    const subscription = QemuService.addEventListener<WatchdogIncident>("qemu_watchdog_incident", (incident) => {
+      setIncidents((current) => [incident, ...current]);
+    });
+    return () => subscription.remove();
+  }, [refresh]);
+
+  const update = async (changes: Partial<WatchdogConfig>) => {
+    Haptics.impactAsync(Haptics.ImpactFeedbackStyle.Light);
+    try {
+      setConfig(await QemuService.setWatchdogConfig(changes));
+    } catch (e: any) {
+      setError(e.message);
+    }
+  };
+
+  const toggleAction = (action: WatchdogAction, enabled: boolean) => {
+    if (!config) return;
+    const steps = new Set(config.escalation);
+    if (enabled) steps.add(action);
+    else steps.delete(action);
+    update({ escalation: ACTION_ORDER.filter((step) => steps.has(step)) });
+  };
+
+  const divider = { backgroundColor: isDark ? "rgba(255,255,255,0.05)" : "rgba(0,0,0,0.05)" };
+
+  return (
+    <ScrollView
+      style={[styles.container, { backgroundColor: theme.backgroundRoot }]}
+      contentContainerStyle={{
+        paddingTop: headerHeight + Spacing.md,
+        paddingBottom: insets.bottom + Spacing.xl,
+        paddingHorizontal: Spacing.md,
+      }}
+      showsVerticalScrollIndicator={false}
+    >
+      {error ? (
+        <View style={[styles.banner, { backgroundColor: colors.state.error + "20" }]}>
+          <Feather name="alert-circle" size={16} color={colors.state.error} />
+          <ThemedText type="small" style={[styles.bannerText, { color: colors.state.error }]}>
+            {error}
+          </ThemedText>
+        </View>
+      ) : null}
+
+      {config ? (
+        <>
+          <Animated.View entering={FadeInDown.duration(300).delay(100)}>
+            <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+              <SettingsRow
+                icon="shield"
+                label="Watchdog"
+                description={`QMP, heartbeat and Docker ping every ${formatDuration(config.intervalMs)}`}
+                value={config.enabled}
+                onToggle={(enabled) => update({ enabled })}
+              />
+              <View style={[styles.divider, divider]} />
+              <SettingsRow
+                icon="camera"
+                label="Healthy Snapshots"
+                description={
+                  config.snapshotIntervalMs <= 0
+                    ? "Off; restore has nothing to load"
+                    : scratchDisk
+                      ? "Unavailable while the scratch disk is on"
+                      : config.escalation.includes("restore")
+                      ? `savevm every ${formatDuration(config.snapshotIntervalMs)}; pauses the guest briefly`
+                      : "Taken only while Restore snapshot is on"
+                }
+                value={config.snapshotIntervalMs > 0}
+                onToggle={(enabled) => update({ snapshotIntervalMs: enabled ? 6 * 60 * 60 * 1000 : 0 })}
+              />
+            </View>
+          </Animated.View>
+
+          <Animated.View entering={FadeInDown.duration(300).delay(200)}>
+            <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+              ESCALATION · AFTER {config.failureThreshold} FAILED CHECKS
+            </ThemedText>
+            <View style={[styles.card, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+              {ACTIONS.map((entry, index) => (
+                <React.Fragment key={entry.action}>
+                  {index > 0 ? <View style={[styles.divider, divider]} /> : null}
+                  <SettingsRow
+                    icon="chevrons-right"
+                    label={entry.label}
+                    description={
+                      entry.action === "restore" && scratchDisk
+                        ? "Skipped while the scratch disk is on"
+                        : entry.description
+                    }
+                    value={config.escalation.includes(entry.action)}
+                    onToggle={(enabled) => toggleAction(entry.action, enabled)}
+                  />
+                </React.Fragment>
+              ))}
+            </View>
+          </Animated.View>
+        </>
+      ) : null}
+
+      <Animated.View entering={FadeInDown.duration(300).delay(300)}>
+        <ThemedText type="caption" style={[styles.sectionTitle, { color: colors.textMuted }]}>
+          INCIDENTS
+        </ThemedText>
+        <View style={[styles.card, styles.padded, { backgroundColor: theme.backgroundDefault }, Shadows.soft]}>
+          {incidents.length === 0 ? (
+            <View style={styles.listRow}>
+              <Feather name="check" size={14} color={colors.state.success} />
+              <ThemedText type="small" style={{ color: colors.textMuted, marginLeft: Spacing.xs, flex: 1 }}>
+                No hangs recorded
+              </ThemedText>
+            </View>
+          ) : (
+            incidents.map((incident) => (
+              <View key={incident.id} style={styles.incident}>
+                <View style={styles.listRow}>
+                  <ThemedText type="small" style={{ flex: 1 }}>
+                    {new Date(incident.detectedAt).toLocaleString()}
+                  </ThemedText>
+                  <ThemedText
+                    type="caption"
+                    style={{ color: incident.outcome === "recovered" ? colors.state.success : colors.state.error }}
+                  >
+                    {incident.outcome === "recovered" ? `recovered by ${incident.recoveredBy}` : incident.outcome}
+                  </ThemedText>
+                </View>
+                <ThemedText type="caption" style={{ color: colors.textSecondary }}>
+                  {incident.reasons.join(" · ")}
+                </ThemedText>
+                <ThemedText type="caption" style={[styles.mono, { color: colors.textMuted }]}>
+                  {incident.steps
+                    .map(
+                      (step) =>
+                        `${step.action}${step.skipped ? ` (skipped${step.reason ? `: ${step.reason}` : ""})` : ` ${formatDuration(step.elapsedMs)}`}`,
+                    )
+                    .join(" → ")}
+                  {"  "}total {formatDuration(incident.durationMs)}
+                </ThemedText>
+                {incident.steps
+                  .filter((step) => step.note)
+                  .map((step) => (
+                    <ThemedText key={step.at} type="caption" style={{ color: colors.state.warning }}>
+                      {step.revertedTo ? `Reverted to ${new Date(step.revertedTo).toLocaleString()}: ` : ""}
+                      {step.note}
+                    </ThemedText>
+                  ))}
+              </View>
+            ))
+          )}
+        </View>
+      </Animated.View>
+    </ScrollView>
+  );
+}
+
+const styles = StyleSheet.create({
+  container: {
+    flex: 1,
+  },
+  sectionTitle: {
+    marginTop: Spacing.lg,
+    marginBottom: Spacing.sm,
+    marginLeft: Spacing.xs,
+    fontSize: 11,
+    fontWeight: "600",
+    letterSpacing: 1,
+  },
+  card: {
+    borderRadius: BorderRadius.lg,
+    overflow: "hidden",
+  },
+  padded: {
+    padding: Spacing.md,
+  },
+  divider: {
+    height: 1,
+    marginLeft: 60,
+  },
+  banner: {
+    flexDirection: "row",
+    alignItems: "center",
+    padding: Spacing.md,
+    borderRadius: BorderRadius.md,
+    marginBottom: Spacing.md,
+  },
+  bannerText: {
+    flex: 1,
+    marginLeft: Spacing.sm,
+  },
+  listRow: {
+    flexDirection: "row",
+    alignItems: "center",
+    justifyContent: "space-between",
+    paddingVertical: Spacing.xs,
+  },
+  incident: {
+    paddingVertical: Spacing.xs,
+  },
+  mono: {
+    fontFamily: "monospace",
+    marginTop: 2,
+  },
+});
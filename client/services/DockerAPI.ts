@@ -68,6 +68,21 @@ export interface DockerImage {
   Containers: number;
 }
 
+// Volumes with this label are bind mounts on the VM's scratch disk, which
+// is wiped every boot; only the guest directory is created on demand
+export const SCRATCH_VOLUME_LABEL = "dockerandroid.scratch";
+const SCRATCH_VOLUME_ROOT = "/scratch/volumes";
+
+// Pre-created containers kept by the warm pool carry this label and a
+// name with this prefix until they are claimed and renamed
+export const POOL_LABEL = "dockerandroid.pool";
+export const POOL_NAME_PREFIX = "dockerandroid-pool-";
+
+export function isPoolContainer(container: Container): boolean {
+  return container.Labels?.[POOL_LABEL] !== undefined &&
+    container.Names?.some((name) => name.replace(/^\//, "").startsWith(POOL_NAME_PREFIX));
+}
+
 export interface Volume {
   Name: string;
   Driver: string;
@@ -123,6 +138,33 @@ export interface SystemInfo {
   ServerVersion: string;
 }
 
+export interface DockerEvent {
+  Type: string;
+  Action: string;
+  Actor: {
+    ID: string;
+    Attributes: Record<string, string>;
+  };
+  time: number;
+  timeNano: number;
+}
+
+export interface ContainerState {
+  Status: string;
+  Running: boolean;
+  Paused: boolean;
+  ExitCode: number;
+  StartedAt: string;
+  // Only for containers with a HEALTHCHECK
+  Health?: {
+    Status: "starting" | "healthy" | "unhealthy";
+  };
+}
+
+export interface Checkpoint {
+  Name: string;
+}
+
 export interface ContainerStats {
   cpu_stats: {
     cpu_usage: {
@@ -224,6 +266,26 @@ export class DockerAPI {
     }
   }
 
+  /**
+   * Events recorded between since and until (Unix seconds), as a batch
+   * rather than a stream: the daemon closes the response at until
+   */
+  async getEvents(since: number, until: number, filters?: Record<string, string[]>): Promise<DockerEvent[]> {
+    try {
+      const response = await this.axios.get("/events", {
+        params: { since, until, ...(filters && { filters: JSON.stringify(filters) }) },
+        responseType: "text",
+      });
+      const text: string = typeof response.data === "string" ? response.data : "";
+      return text
+        .split("\n")
+        .filter(Boolean)
+        .map((line) => JSON.parse(line) as DockerEvent);
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
   async listContainers(all: boolean = true): Promise<Container[]> {
     try {
       const response = await this.axios.get("/containers/json", {
@@ -254,9 +316,24 @@ export class DockerAPI {
     }
   }
 
-  async startContainer(id: string): Promise<void> {
+  async getContainerState(id: string): Promise<ContainerState> {
+    try {
+      const response = await this.axios.get(`/containers/${id}/json`);
+      return response.data.State;
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  /**
+   * Start a container, or restore it from a checkpoint taken with
+   * createCheckpoint
+   */
+  async startContainer(id: string, checkpoint?: string): Promise<void> {
     try {
-      await this.axios.post(`/containers/${id}/start`);
+      const params = checkpoint ? { checkpoint } : {};
+      // Restoring a large process tree takes a while under TCG
+      await this.axios.post(`/containers/${id}/start`, null, { params, timeout: checkpoint ? 0 : undefined });
     } catch (error) {
       const axiosError = error as AxiosError;
       if (axiosError.response?.status !== 304) {
@@ -288,6 +365,79 @@ export class DockerAPI {
     }
   }
 
+  async renameContainer(id: string, name: string): Promise<void> {
+    try {
+      await this.axios.post(`/containers/${id}/rename`, null, {
+        params: { name },
+      });
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  /**
+   * Change the resource limits and restart policy of an existing container
+   */
+  async updateContainer(
+    id: string,
+    update: Pick<NonNullable<CreateContainerConfig["HostConfig"]>, "Memory" | "NanoCpus" | "RestartPolicy">
+  ): Promise<void> {
+    try {
+      await this.axios.post(`/containers/${id}/update`, update);
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  async pauseContainer(id: string): Promise<void> {
+    try {
+      await this.axios.post(`/containers/${id}/pause`);
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  async unpauseContainer(id: string): Promise<void> {
+    try {
+      await this.axios.post(`/containers/${id}/unpause`);
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  async listCheckpoints(id: string): Promise<Checkpoint[]> {
+    try {
+      const response = await this.axios.get(`/containers/${id}/checkpoints`);
+      return response.data ?? [];
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  /**
+   * Dump the container's processes with CRIU. With exit (the default)
+   * the container stops once the checkpoint is written.
+   */
+  async createCheckpoint(id: string, name: string, exit: boolean = true): Promise<void> {
+    try {
+      await this.axios.post(
+        `/containers/${id}/checkpoints`,
+        { CheckpointID: name, Exit: exit },
+        { timeout: 0 }
+      );
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
+  async removeCheckpoint(id: string, name: string): Promise<void> {
+    try {
+      await this.axios.delete(`/containers/${id}/checkpoints/${name}`);
+    } catch (error) {
+      this.handleError(error as AxiosError);
+    }
+  }
+
   async removeContainer(id: string, force: boolean = false): Promise<void> {
     try {
       await this.axios.delete(`/containers/${id}`, {
@@ -344,43 +494,77 @@ export class DockerAPI {
     }
   }
 
-  async pullImage(imageName: string, onProgress?: (progress: number) => void): Promise<void> {
-    try {
-      const [image, tag = "latest"] = imageName.split(":");
-      const response = await this.axios.post("/images/create", null, {
-        params: { fromImage: image, tag },
-        responseType: "stream",
-      });
-
-      return new Promise((resolve, reject) => {
-        let progress = 0;
-        response.data.on("data", (chunk: Buffer) => {
-          try {
-            const lines = chunk.toString().split("\n").filter(Boolean);
-            for (const line of lines) {
-              const data = JSON.parse(line);
-              if (data.progressDetail?.current && data.progressDetail?.total) {
-                progress = (data.progressDetail.current / data.progressDetail.total) * 100;
-                onProgress?.(progress);
-              }
-              if (data.error) {
-                reject(new Error(data.error));
-              }
-            }
-          } catch {
+  /**
+   * Pull an image, reporting overall download progress (0-100) and bytes
+   * downloaded so far across all layers
+   */
+  async pullImage(imageName: string, onProgress?: (progress: number, bytes: number) => void): Promise<void> {
+    // A digest goes in the tag parameter; otherwise the tag follows the
+    // last ":" after the last "/", which keeps a registry port
+    // ("localhost:5000/app") out of it
+    const at = imageName.indexOf("@");
+    const slash = imageName.lastIndexOf("/");
+    const colon = imageName.lastIndexOf(":");
+    const split = at >= 0 ? at : colon > slash ? colon : -1;
+    const image = split >= 0 ? imageName.slice(0, split) : imageName;
+    const tag = split >= 0 ? imageName.slice(split + 1) : "latest";
+
+    const layers = new Map<string, { current: number; total: number }>();
+    let pullError = null as string | null;
+    let parsed = 0;
+
+    // The daemon streams one JSON message per line and reports failures
+    // in the stream after answering 200
+    const consume = (text: string) => {
+      const end = text.lastIndexOf("\n") + 1;
+      if (end <= parsed) return;
+      for (const line of text.slice(parsed, end).split("\n")) {
+        if (!line) continue;
+        try {
+          const data = JSON.parse(line);
+          if (data.error) pullError = data.error;
+          const layer = data.id ? layers.get(data.id) : undefined;
+          if (data.status === "Downloading" && data.progressDetail?.total) {
+            layers.set(data.id, { current: data.progressDetail.current ?? 0, total: data.progressDetail.total });
+          } else if (layer && (data.status === "Download complete" || data.status === "Pull complete")) {
+            layer.current = layer.total;
           }
-        });
+        } catch {
+        }
+      }
+      parsed = end;
 
-        response.data.on("end", () => {
-          onProgress?.(100);
-          resolve();
-        });
+      let current = 0;
+      let total = 0;
+      for (const layer of layers.values()) {
+        current += layer.current;
+        total += layer.total;
+      }
+      if (total > 0) onProgress?.((current / total) * 100, current);
+    };
 
-        response.data.on("error", reject);
+    try {
+      const response = await this.axios.post("/images/create", null, {
+        params: { fromImage: image, tag },
+        responseType: "text",
+        // A large image takes longer than the default request timeout
+        timeout: 0,
+        onDownloadProgress: (event) => {
+          const text = (event.event?.target as XMLHttpRequest | undefined)?.responseText;
+          if (text) consume(text);
+        },
       });
+      if (typeof response.data === "string") consume(response.data + "\n");
     } catch (error) {
       this.handleError(error as AxiosError);
     }
+
+    if (pullError) {
+      throw new Error(pullError);
+    }
+    let bytes = 0;
+    for (const layer of layers.values()) bytes += layer.total;
+    onProgress?.(100, bytes);
   }
 
   async removeImage(id: string, force: boolean = false): Promise<void> {
@@ -402,11 +586,15 @@ export class DockerAPI {
     }
   }
 
-  async createVolume(name: string, driver: string = "local"): Promise<Volume> {
+  async createVolume(name: string, driver: string = "local", scratch: boolean = false): Promise<Volume> {
     try {
       const response = await this.axios.post("/volumes/create", {
         Name: name,
         Driver: driver,
+        ...(scratch && {
+          Labels: { [SCRATCH_VOLUME_LABEL]: "true" },
+          DriverOpts: { type: "none", o: "bind", device: `${SCRATCH_VOLUME_ROOT}/${name}` },
+        }),
       });
       return response.data;
     } catch (error) {
@@ -0,0 +1,245 @@
+/**
+ * PullScheduler - one queue for every image pull in the app
+ *
+ * All pulls share the VM's single slirp link, so they are queued here
+ * rather than fired independently:
+ * - a reference already queued or pulling is not pulled again; the new
+ *   caller waits on the same pull and gets its progress
+ * - user pulls start before background ones, and background pulls wait
+ *   while a user pull is running
+ * - the number of concurrent pulls is tuned from measured throughput:
+ *   a level is kept only if it moves more bytes than the one below it
+ */
+
+import { DockerAPI } from "@/services/DockerAPI";
+
+export type PullPriority = "user" | "background";
+
+export type PullProgressListener = (progress: number, bytes: number) => void;
+
+export interface PullSchedulerStats {
+  active: number;
+  queued: number;
+  concurrency: number;
+  // Aggregate bytes/s over the last sample, 0 when idle
+  throughput: number;
+  // Pulls answered by joining one already in flight
+  deduplicated: number;
+}
+
+interface PullJob {
+  ref: string;
+  priority: PullPriority;
+  seq: number;
+  listeners: Set<PullProgressListener>;
+  progress: number;
+  bytes: number;
+  promise: Promise<void>;
+  resolve: () => void;
+  reject: (error: Error) => void;
+}
+
+interface LevelRate {
+  bytesPerSecond: number;
+  samples: number;
+  at: number;
+}
+
+// dockerd already downloads 3 layers of each image in parallel
+const MAX_CONCURRENCY = 3;
+const SAMPLE_MS = 5_000;
+// Samples at one level before comparing it with its neighbours
+const MIN_SAMPLES = 2;
+// A level must beat the one below by this much to be worth its extra pull
+const STEP_UP_GAIN = 1.1;
+// Measurements this old are retaken, so the link is re-explored as it changes
+const RATE_TTL_MS = 60_000;
+const EWMA_ALPHA = 0.5;
+
+/**
+ * "nginx", "library/nginx" and "docker.io/library/nginx:latest" are one
+ * image
+ */
+export function normalizeRef(ref: string): string {
+  let name = ref.trim();
+  const slash = name.lastIndexOf("/");
+  if (!name.includes("@") && name.lastIndexOf(":") <= slash) {
+    name += ":latest";
+  }
+  return name.replace(/^(docker\.io|index\.docker\.io|registry-1\.docker\.io)\//, "").replace(/^library\//, "");
+}
+
+export class PullScheduler {
+  private jobs = new Map<string, PullJob>();
+  private queue: PullJob[] = [];
+  private active = new Set<PullJob>();
+  private seq = 0;
+  private concurrency = 1;
+  private rates = new Map<number, LevelRate>();
+  private sampler: ReturnType<typeof setInterval> | null = null;
+  private sampledBytes = 0;
+  private sampledAt = 0;
+  private throughput = 0;
+  private deduplicated = 0;
+
+  constructor(private getDocker: () => DockerAPI) {}
+
+  pull(
+    imageName: string,
+    options: { priority?: PullPriority; onProgress?: PullProgressListener } = {}
+  ): Promise<void> {
+    const { priority = "user", onProgress } = options;
+    const ref = normalizeRef(imageName);
+    const existing = this.jobs.get(ref);
+    if (existing) {
+      this.deduplicated++;
+      if (onProgress) {
+        existing.listeners.add(onProgress);
+        onProgress(existing.progress, existing.bytes);
+      }
+      if (priority === "user" && existing.priority === "background") {
+        existing.priority = "user";
+        this.sortQueue();
+        this.pump();
+      }
+      return existing.promise;
+    }
+
+    let resolve!: () => void;
+    let reject!: (error: Error) => void;
+    const promise = new Promise<void>((res, rej) => {
+      resolve = res;
+      reject = rej;
+    });
+    const job: PullJob = {
+      ref,
+      priority,
+      seq: this.seq++,
+      listeners: new Set(onProgress ? [onProgress] : []),
+      progress: 0,
+      bytes: 0,
+      promise,
+      resolve,
+      reject,
+    };
+    this.jobs.set(ref, job);
+    this.queue.push(job);
+    this.sortQueue();
+    this.pump();
+    return promise;
+  }
+
+  getStats(): PullSchedulerStats {
+    return {
+      active: this.active.size,
+      queued: this.queue.length,
+      concurrency: this.concurrency,
+      throughput: this.throughput,
+      deduplicated: this.deduplicated,
+    };
+  }
+
+  private sortQueue() {
+    this.queue.sort((a, b) =>
+      Number(b.priority === "user") - Number(a.priority === "user") || a.seq - b.seq
+    );
+  }
+
+  private pump() {
+    while (this.queue.length > 0 && this.active.size < this.concurrency) {
+      const next = this.queue[0];
+      const userActive = [...this.active].some((job) => job.priority === "user");
+      if (next.priority === "background" && userActive) break;
+      this.queue.shift();
+      this.run(next);
+    }
+  }
+
+  private async run(job: PullJob) {
+    this.active.add(job);
+    this.startSampler();
+    try {
+      await this.getDocker().pullImage(job.ref, (progress, bytes) => {
+        job.progress = progress;
+        job.bytes = bytes;
+        for (const listener of job.listeners) listener(progress, bytes);
+      });
+      job.resolve();
+    } catch (error: any) {
+      job.reject(error instanceof Error ? error : new Error(String(error)));
+    } finally {
+      this.active.delete(job);
+      this.jobs.delete(job.ref);
+      // Keep the byte count consistent with the jobs still running
+      this.sampledBytes -= job.bytes;
+      if (this.active.size === 0) this.stopSampler();
+      this.pump();
+    }
+  }
+
+  private startSampler() {
+    if (this.sampler) return;
+    this.sampledBytes = this.activeBytes();
+    this.sampledAt = Date.now();
+    this.sampler = setInterval(() => this.sample(), SAMPLE_MS);
+  }
+
+  private stopSampler() {
+    if (this.sampler) {
+      clearInterval(this.sampler);
+      this.sampler = null;
+    }
+    this.throughput = 0;
+  }
+
+  private activeBytes(): number {
+    let bytes = 0;
+    for (const job of this.active) bytes += job.bytes;
+    return bytes;
+  }
+
+  private sample() {
+    const now = Date.now();
+    const bytes = this.activeBytes();
+    const seconds = (now - this.sampledAt) / 1000;
+    this.throughput = seconds > 0 ? Math.max(0, bytes - this.sampledBytes) / seconds : 0;
+    this.sampledBytes = bytes;
+    this.sampledAt = now;
+
+    // Only a saturated level says anything about that level
+    if (this.active.size < this.concurrency) return;
+    const level = this.concurrency;
+    const previous = this.rates.get(level);
+    const fresh = previous && now - previous.at < RATE_TTL_MS;
+    this.rates.set(level, {
+      bytesPerSecond: fresh ? previous.bytesPerSecond + EWMA_ALPHA * (this.throughput - previous.bytesPerSecond) : this.throughput,
+      samples: fresh ? previous.samples + 1 : 1,
+      at: now,
+    });
+    this.adapt(now);
+  }
+
+  private adapt(now: number) {
+    const level = this.concurrency;
+    const current = this.rates.get(level)!;
+    if (current.samples < MIN_SAMPLES) return;
+    const rateAt = (n: number) => {
+      const rate = this.rates.get(n);
+      return rate && now - rate.at < RATE_TTL_MS && rate.samples >= MIN_SAMPLES ? rate.bytesPerSecond : null;
+    };
+
+    const below = rateAt(level - 1);
+    if (below !== null && current.bytesPerSecond < below * STEP_UP_GAIN) {
+      // The extra pull only split the link
+      this.concurrency = level - 1;
+    } else if (level < MAX_CONCURRENCY && this.queue.length > 0) {
+      const above = rateAt(level + 1);
+      if (above === null || above >= current.bytesPerSecond * STEP_UP_GAIN) {
+        this.concurrency = level + 1;
+        this.pump();
+      }
+    }
+  }
+}
+
+export default PullScheduler;
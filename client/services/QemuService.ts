@@ -6,16 +6,42 @@
  */
 
 import { NativeModules, NativeEventEmitter, Platform } from "react-native";
+import { profileHandler } from "@/lib/profiler";
 
 // Type definitions for native module
 interface QemuNativeModule {
   initialize(): Promise<QemuInitResult>;
-  startVM(ramMb: number, cpuCores: number): Promise<QemuStartResult>;
+  startVM(
+    ramMb: number,
+    cpuCores: number,
+    applianceInit: boolean,
+    runtime: ContainerRuntime,
+    scratchDisk: boolean
+  ): Promise<QemuStartResult>;
   stopVM(): Promise<QemuStopResult>;
+  resizeVM(ramMb: number, cpuCores: number): Promise<QemuResizeResult>;
   getStatus(): Promise<QemuStatusResult>;
   getLogs(tail: number): Promise<QemuLogsResult>;
   downloadAlpineIso(): Promise<QemuDownloadResult>;
   checkRequirements(): Promise<QemuRequirementsResult>;
+  getNativeDiagnostics(iterations: number): Promise<QemuNativeDiagnostics>;
+  benchmarkTransfer(events: number, payloadBytes: number): Promise<QemuTransferBenchmark>;
+  getMemoryStats(): Promise<QemuMemoryStats>;
+  getWatchdogConfig(): Promise<WatchdogConfig>;
+  setWatchdogConfig(config: Partial<WatchdogConfig>): Promise<WatchdogConfig>;
+  getWatchdogIncidents(limit: number): Promise<{ incidents: WatchdogIncident[] }>;
+  getBootTimes(): Promise<BootTimes>;
+  getStorageStats(): Promise<StorageStats>;
+  setImagePrefetch(enabled: boolean): Promise<boolean>;
+  prefetchImagesNow(): Promise<boolean>;
+  getImagePrefetchStatus(): Promise<ImagePrefetchStatus>;
+  startContainerStats(intervalMs: number): Promise<boolean>;
+  stopContainerStats(): Promise<boolean>;
+  setContainerTracing(enabled: boolean): Promise<boolean>;
+  setQemuTracing(enabled: boolean): Promise<boolean>;
+  getQemuTraceSummary(): Promise<QemuTraceSummary>;
+  searchContainerLogs(query: string, options: LogSearchOptions): Promise<LogSearchResult>;
+  getLogIndexStats(): Promise<LogIndexStats>;
   
   // Constants exported from native
   VM_STATE_STOPPED: string;
@@ -31,6 +57,8 @@ interface QemuNativeModule {
 
 export interface QemuInitResult {
   success: boolean;
+  state: string;
+  reattached: boolean;
   qemuDir: string;
   isoPath: string;
   diskPath: string;
@@ -45,6 +73,7 @@ export interface QemuStartResult {
   dockerPort?: number;
   sshPort?: number;
   dockerReady?: boolean;
+  reattached?: boolean;
   message?: string;
 }
 
@@ -53,6 +82,14 @@ export interface QemuStopResult {
   state: string;
 }
 
+export interface QemuResizeResult {
+  success: boolean;
+  cpuCores: number;
+  ramMb: number;
+  restartRequired: boolean;
+  message?: string;
+}
+
 export interface QemuStatusResult {
   state: string;
   isRunning: boolean;
@@ -83,6 +120,140 @@ export interface QemuRequirementsResult {
   allRequirementsMet: boolean;
 }
 
+export interface QemuNativeDiagnostics {
+  loadLibraryMs: number;
+  onLoadMs: number;
+  iterations: number;
+  nsPerCall: number;
+}
+
+export interface QemuTransferBenchmark {
+  events: number;
+  ringEventsPerSec: number;
+  ringMBPerSec: number;
+  batchSamplesPerSec: number;
+  stringEventsPerSec: number;
+  stringChars: number;
+}
+
+export interface QemuMemoryStats {
+  timestamp: number;
+  javaHeapUsedKb: number;
+  javaHeapMaxKb: number;
+  nativeHeapKb: number;
+  selfRssKb: number;
+  selfPssKb: number;
+  selfSwapKb: number;
+  smapsRollup: boolean;
+  qemuPid?: number;
+  qemuRssKb?: number;
+  qemuPssKb?: number;
+  // The :vm host process (VmSupervisor, rings, log index)
+  vmPid?: number;
+  vmRssKb?: number;
+  vmPssKb?: number;
+  vmSwapKb?: number;
+}
+
+export type WatchdogAction = "nmi" | "dump" | "reset" | "restore" | "restart";
+
+export interface WatchdogConfig {
+  enabled: boolean;
+  intervalMs: number;
+  qmpLatencyMs: number;
+  heartbeatTimeoutMs: number;
+  dockerPingSlaMs: number;
+  failureThreshold: number;
+  recoveryGraceMs: number;
+  snapshotIntervalMs: number;
+  escalation: WatchdogAction[];
+}
+
+export interface WatchdogStep {
+  action: WatchdogAction;
+  at: number;
+  ok?: boolean;
+  error?: string;
+  skipped?: boolean;
+  // Why a skipped step couldn't run, e.g. no snapshot yet
+  reason?: string | null;
+  recovered?: boolean;
+  // restore: when the snapshot it went back to was taken
+  revertedTo?: number;
+  note?: string;
+  elapsedMs?: number;
+}
+
+export type BootMode = "openrc" | "appliance";
+
+// "lite": containerd with docker-shim instead of dockerd, for low-RAM devices;
+// "lazy": lite with the stargz snapshotter pulling image files on demand
+export type ContainerRuntime = "docker" | "lite" | "lazy";
+
+export interface BootModeTimes {
+  // Host-measured, QEMU launch to Docker ready
+  lastMs: number;
+  // Guest uptime when Docker became ready
+  lastGuestMs: number;
+  averageMs: number;
+  count: number;
+  at: number;
+}
+
+export interface BootTimes {
+  // The guest has /sbin/appliance-init, so appliance mode can take effect
+  applianceInstalled?: boolean;
+  // `criu check` result from the last boot; unset for guests that don't report it
+  checkpointSupported?: boolean;
+  modes?: Partial<Record<BootMode, BootModeTimes>>;
+}
+
+export interface StorageStats {
+  // Free and total bytes on the volume holding the VM's disks
+  freeBytes: number;
+  totalBytes: number;
+  // Bytes the images occupy on that volume, not their virtual size
+  osDiskBytes: number;
+  dataDiskBytes: number;
+}
+
+export interface ImagePrefetchResult {
+  image: string;
+  digest?: string;
+  blobs?: number;
+  totalBytes?: number;
+  fetchedBytes?: number;
+  // Every layer is in the host cache
+  complete?: boolean;
+  error?: string;
+}
+
+export interface ImagePrefetchStatus {
+  scheduled: boolean;
+  startedAt?: number;
+  finishedAt?: number;
+  // Cut short by charging, network or idle ending; resumes next run
+  stopped?: boolean;
+  images?: ImagePrefetchResult[];
+}
+
+export interface WatchdogIncident {
+  id: string;
+  detectedAt: number;
+  reasons: string[];
+  probe: {
+    qmpStatus: string | null;
+    qmpLatencyMs: number | null;
+    heartbeatAgeMs: number | null;
+    dockerPingMs: number | null;
+  };
+  lastHeartbeat: string | null;
+  steps: WatchdogStep[];
+  outcome: "recovered" | "unrecovered" | "vm-exited";
+  recoveredBy: WatchdogAction | null;
+  durationMs: number;
+}
+
 export interface QemuEventListener {
   remove: () => void;
 }
@@ -91,6 +262,11 @@ export type QemuEvent =
   | "qemu_state_change"
   | "qemu_log"
   | "qemu_download_progress"
+  | "qemu_stats"
+  | "qemu_watchdog_incident"
+  | "qemu_container_stats"
+  | "qemu_container_latency"
+  | "qemu_container_trace"
   | "qemu_error";
 
 export interface StateChangeEvent {
@@ -106,6 +282,152 @@ export interface DownloadProgressEvent {
   status: string;
 }
 
+export interface ProcessExitEvent {
+  handle: number;
+  status: number;
+}
+
+export interface StatsEvent {
+  cpuPercent: number;
+  rssMb: number;
+  threads: number;
+}
+
+/** One container's usage from the guest's cgroup-stats collector */
+export interface ContainerUsage {
+  // Short (12 digit) container id
+  id: string;
+  // 100 is one fully used CPU, as in `docker stats`
+  cpuPercent: number;
+  memoryBytes: number;
+  // 0 when the container has no limit
+  memoryLimit: number;
+  pids: number;
+  blockRead: number;
+  blockWrite: number;
+  netRx: number;
+  netTx: number;
+}
+
+export interface ContainerStatsEvent {
+  timestamp: number;
+  containers: ContainerUsage[];
+}
+
+/**
+ * One container's report from the guest's eBPF tracer, cumulative since
+ * tracing started. Histograms are log2 buckets of microseconds: bucket n
+ * counts [2^n, 2^(n+1)) us.
+ */
+export interface ContainerLatency {
+  timestamp: number;
+  // Short (12 digit) container id
+  id: string;
+  runqueue: number[];
+  blockIo: number[];
+  tcpRetransmits: number;
+  syscalls: number;
+  // x86_64 syscall numbers, most frequent first
+  topSyscalls: { nr: number; count: number }[];
+}
+
+export interface ContainerTraceEvent {
+  // "off" when the tracer stopped, with its exit status if it failed
+  state: "on" | "off" | "unavailable";
+  exitStatus: number | null;
+}
+
+export interface QemuBlockTrace {
+  requests: number;
+  completed: number;
+  bytes: number;
+  errors: number;
+  p50Us: number;
+  p99Us: number;
+  maxUs: number;
+  // log2 buckets of microseconds, as in ContainerLatency
+  histogram: number[];
+}
+
+/**
+ * QEMU's own trace events since tracing was switched on, summarized
+ * natively (qj_trace.h). Only supported with a log-backend QEMU build.
+ */
+export interface QemuTraceSummary {
+  supported: boolean;
+  enabled: boolean;
+  elapsedMs?: number;
+  lines?: number;
+  unparsed?: number;
+  // Count per event name
+  events?: Record<string, number>;
+  block?: {
+    read: QemuBlockTrace;
+    write: QemuBlockTrace;
+    inflight: number;
+    inflightMax: number;
+  };
+  // Guest kicks and interrupts back, per device (in order seen) and queue
+  virtqueues?: { device: number; kind: "blk" | "virtio"; queue: number; kicks: number; interrupts: number }[];
+  tcg?: { translations: number; peakPerSecond: number };
+  // From x-query-jit; absent under KVM
+  jit?: { tbFlushes?: number; tbInvalidations?: number; tlbFlushes?: number };
+  // Exit reason number to count, KVM hosts only
+  kvmExits?: Record<string, number>;
+}
+
+export interface LogSearchOptions {
+  // Short container id prefix; all containers when absent
+  container?: string;
+  // Epoch ms; since inclusive, until exclusive
+  since?: number;
+  until?: number;
+  stream?: "stdout" | "stderr";
+  limit?: number;
+}
+
+export interface LogMatch {
+  container: string;
+  name: string;
+  ts: number;
+  stream: "stdout" | "stderr";
+  line: string;
+}
+
+/**
+ * Newest matches first from the host-side log index (qj_logindex.h). The
+ * counters show how much the index narrowed the search: blocks in range,
+ * blocks whose trigram filter passed, blocks inflated and lines read.
+ */
+export interface LogSearchResult {
+  matches: LogMatch[];
+  // Older matches may exist beyond the limit
+  more: boolean;
+  blocks: number;
+  candidates: number;
+  scanned: number;
+  lines: number;
+  tookUs: number;
+}
+
+export interface LogIndexStats {
+  supported: boolean;
+  bytes?: number;
+  maxBytes?: number;
+  maxAgeMs?: number;
+  containers?: {
+    id: string;
+    name: string;
+    bytes: number;
+    rawBytes: number;
+    blocks: number;
+    lines: number;
+    openLines: number;
+    firstTs: number;
+    lastTs: number;
+  }[];
+}
+
 export interface ErrorEvent {
   message: string;
   code?: string;
@@ -130,6 +452,8 @@ class QemuMockService {
   async initialize(): Promise<QemuInitResult> {
     return {
       success: true,
+      state: this.state,
+      reattached: false,
       qemuDir: "/mock/qemu",
       isoPath: "/mock/qemu/alpine-virt.iso",
       diskPath: "/mock/qemu/alpine-disk.qcow2",
@@ -139,7 +463,13 @@ class QemuMockService {
     };
   }
 
-  async startVM(ramMb: number, cpuCores: number): Promise<QemuStartResult> {
+  async startVM(
+    ramMb: number,
+    cpuCores: number,
+    _applianceInit: boolean = false,
+    _runtime: ContainerRuntime = "docker",
+    _scratchDisk: boolean = false
+  ): Promise<QemuStartResult> {
     this.state = "starting";
     this.logs.push(`Starting VM with ${ramMb}MB RAM, ${cpuCores} CPUs`);
     
@@ -178,6 +508,16 @@ class QemuMockService {
     };
   }
 
+  async resizeVM(ramMb: number, cpuCores: number): Promise<QemuResizeResult> {
+    this.logs.push(`Resized VM to ${ramMb}MB RAM, ${cpuCores} CPUs`);
+    return {
+      success: true,
+      cpuCores,
+      ramMb,
+      restartRequired: false,
+    };
+  }
+
   async getStatus(): Promise<QemuStatusResult> {
     return {
       state: this.state,
@@ -212,6 +552,78 @@ class QemuMockService {
     };
   }
 
+  async getNativeDiagnostics(_iterations: number): Promise<QemuNativeDiagnostics> {
+    throw new Error("Native diagnostics are not available on this platform");
+  }
+
+  async benchmarkTransfer(_events: number, _payloadBytes: number): Promise<QemuTransferBenchmark> {
+    throw new Error("Native diagnostics are not available on this platform");
+  }
+
+  async getMemoryStats(): Promise<QemuMemoryStats> {
+    throw new Error("Native diagnostics are not available on this platform");
+  }
+
+  async getWatchdogConfig(): Promise<WatchdogConfig> {
+    throw new Error("The VM watchdog is not available on this platform");
+  }
+
+  async setWatchdogConfig(_config: Partial<WatchdogConfig>): Promise<WatchdogConfig> {
+    throw new Error("The VM watchdog is not available on this platform");
+  }
+
+  async getWatchdogIncidents(_limit?: number): Promise<WatchdogIncident[]> {
+    return [];
+  }
+
+  async getBootTimes(): Promise<BootTimes> {
+    return {};
+  }
+
+  async getStorageStats(): Promise<StorageStats> {
+    throw new Error("Storage stats are not available on this platform");
+  }
+
+  async setImagePrefetch(enabled: boolean): Promise<boolean> {
+    return enabled;
+  }
+
+  async prefetchImagesNow(): Promise<boolean> {
+    return false;
+  }
+
+  async getImagePrefetchStatus(): Promise<ImagePrefetchStatus> {
+    return { scheduled: false };
+  }
+
+  async startContainerStats(_intervalMs: number): Promise<boolean> {
+    return false;
+  }
+
+  async stopContainerStats(): Promise<boolean> {
+    return true;
+  }
+
+  async setContainerTracing(_enabled: boolean): Promise<boolean> {
+    return false;
+  }
+
+  async setQemuTracing(_enabled: boolean): Promise<boolean> {
+    return false;
+  }
+
+  async getQemuTraceSummary(): Promise<QemuTraceSummary> {
+    return { supported: false, enabled: false };
+  }
+
+  async searchContainerLogs(_query: string, _options: LogSearchOptions = {}): Promise<LogSearchResult> {
+    return { matches: [], more: false, blocks: 0, candidates: 0, scanned: 0, lines: 0, tookUs: 0 };
+  }
+
+  async getLogIndexStats(): Promise<LogIndexStats> {
+    return { supported: false };
+  }
+
   addEventListener(_event: QemuEvent, _callback: (data: any) => void): QemuEventListener {
     return { remove: () => {} };
   }
@@ -234,12 +646,15 @@ class QemuRealService {
 
   async startVM(
     ramMb: number = QemuNative?.DEFAULT_RAM_MB ?? 2048,
-    cpuCores: number = QemuNative?.DEFAULT_CPU_CORES ?? 2
+    cpuCores: number = QemuNative?.DEFAULT_CPU_CORES ?? 2,
+    applianceInit: boolean = false,
+    runtime: ContainerRuntime = "docker",
+    scratchDisk: boolean = false
   ): Promise<QemuStartResult> {
     if (!QemuNative) {
       throw new Error("QemuModule is not available");
     }
-    return QemuNative.startVM(ramMb, cpuCores);
+    return QemuNative.startVM(ramMb, cpuCores, applianceInit, runtime, scratchDisk);
   }
 
   async stopVM(): Promise<QemuStopResult> {
@@ -249,6 +664,13 @@ class QemuRealService {
     return QemuNative.stopVM();
   }
 
+  async resizeVM(ramMb: number, cpuCores: number): Promise<QemuResizeResult> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.resizeVM(ramMb, cpuCores);
+  }
+
   async getStatus(): Promise<QemuStatusResult> {
     if (!QemuNative) {
       throw new Error("QemuModule is not available");
@@ -277,12 +699,139 @@ class QemuRealService {
     return QemuNative.checkRequirements();
   }
 
+  async getNativeDiagnostics(iterations: number = 100000): Promise<QemuNativeDiagnostics> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getNativeDiagnostics(iterations);
+  }
+
+  async benchmarkTransfer(events: number = 100000, payloadBytes: number = 120): Promise<QemuTransferBenchmark> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.benchmarkTransfer(events, payloadBytes);
+  }
+
+  async getMemoryStats(): Promise<QemuMemoryStats> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getMemoryStats();
+  }
+
+  async getWatchdogConfig(): Promise<WatchdogConfig> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getWatchdogConfig();
+  }
+
+  async setWatchdogConfig(config: Partial<WatchdogConfig>): Promise<WatchdogConfig> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.setWatchdogConfig(config);
+  }
+
+  async getWatchdogIncidents(limit: number = 50): Promise<WatchdogIncident[]> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    const { incidents } = await QemuNative.getWatchdogIncidents(limit);
+    return incidents;
+  }
+
+  async getBootTimes(): Promise<BootTimes> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getBootTimes();
+  }
+
+  async getStorageStats(): Promise<StorageStats> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getStorageStats();
+  }
+
+  async setImagePrefetch(enabled: boolean): Promise<boolean> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.setImagePrefetch(enabled);
+  }
+
+  async prefetchImagesNow(): Promise<boolean> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.prefetchImagesNow();
+  }
+
+  async getImagePrefetchStatus(): Promise<ImagePrefetchStatus> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getImagePrefetchStatus();
+  }
+
+  async startContainerStats(intervalMs: number): Promise<boolean> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.startContainerStats(intervalMs);
+  }
+
+  async stopContainerStats(): Promise<boolean> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.stopContainerStats();
+  }
+
+  async setContainerTracing(enabled: boolean): Promise<boolean> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.setContainerTracing(enabled);
+  }
+
+  async setQemuTracing(enabled: boolean): Promise<boolean> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.setQemuTracing(enabled);
+  }
+
+  async getQemuTraceSummary(): Promise<QemuTraceSummary> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getQemuTraceSummary();
+  }
+
+  async searchContainerLogs(query: string, options: LogSearchOptions = {}): Promise<LogSearchResult> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.searchContainerLogs(query, options);
+  }
+
+  async getLogIndexStats(): Promise<LogIndexStats> {
+    if (!QemuNative) {
+      throw new Error("QemuModule is not available");
+    }
+    return QemuNative.getLogIndexStats();
+  }
+
   addEventListener<T>(event: QemuEvent, callback: (data: T) => void): QemuEventListener {
     if (!qemuEventEmitter) {
       return { remove: () => {} };
     }
     
-    const subscription = qemuEventEmitter.addListener(event, callback);
+    const subscription = qemuEventEmitter.addListener(event, profileHandler(`event.${event}`, callback, "event"));
     this.listeners.push(subscription as QemuEventListener);
     return subscription as QemuEventListener;
   }
@@ -0,0 +1,179 @@
+import { create } from "zustand";
+import AsyncStorage from "@react-native-async-storage/async-storage";
+import { DockerAPI } from "@/services/DockerAPI";
+import { useDockerStore } from "@/store/useDockerStore";
+import QemuService from "@/services/QemuService";
+
+/**
+ * "health": the container's HEALTHCHECK reported healthy.
+ * "running": it has no healthcheck, so running is the best signal there is.
+ */
+export type ReadinessProbe = "health" | "running";
+
+export interface ReadinessTimes {
+  // Start to ready without a checkpoint
+  coldMs?: number;
+  // Start from the checkpoint to ready
+  restoredMs?: number;
+  // Time to write the checkpoint
+  checkpointMs?: number;
+  probe: ReadinessProbe;
+}
+
+interface CheckpointState {
+  // Checkpoint names per container id
+  checkpoints: Record<string, string[]>;
+  timings: Record<string, ReadinessTimes>;
+  // Container whose checkpoint, restore or start is in progress
+  busyId: string | null;
+  // false once the guest reported `criu check` failing; null if unknown
+  supported: boolean | null;
+  error: string | null;
+
+  load: () => Promise<void>;
+  fetchCheckpoints: (id: string) => Promise<void>;
+  checkpoint: (id: string) => Promise<boolean>;
+  restore: (id: string) => Promise<boolean>;
+  start: (id: string) => Promise<boolean>;
+  clearError: () => void;
+}
+
+const CHECKPOINT_TIMINGS_KEY = "@checkpoint_timings";
+// One checkpoint per container, replaced each time
+export const CHECKPOINT_NAME = "warm";
+const POLL_MS = 250;
+// Databases under TCG can take minutes to come up cold
+const READY_TIMEOUT_MS = 600_000;
+
+let loaded = false;
+
+/** Poll until the container is running and, if it has a healthcheck, healthy */
+async function waitUntilReady(api: DockerAPI, id: string): Promise<ReadinessProbe> {
+  const deadline = Date.now() + READY_TIMEOUT_MS;
+  while (Date.now() < deadline) {
+    const state = await api.getContainerState(id);
+    if (!state.Running && state.Status === "exited") {
+      throw new Error(`Container exited with code ${state.ExitCode} before it was ready`);
+    }
+    if (state.Running && !state.Paused) {
+      if (!state.Health) return "running";
+      if (state.Health.Status === "healthy") return "health";
+    }
+    await new Promise((resolve) => setTimeout(resolve, POLL_MS));
+  }
+  throw new Error("Container did not become ready in time");
+}
+
+export const useCheckpointStore = create<CheckpointState>((set, get) => {
+  const docker = () => new DockerAPI(useDockerStore.getState().dockerApiUrl);
+
+  const record = async (id: string, times: Partial<ReadinessTimes>) => {
+    const timings = {
+      ...get().timings,
+      [id]: { probe: "running" as ReadinessProbe, ...get().timings[id], ...times },
+    };
+    set({ timings });
+    try {
+      await AsyncStorage.setItem(CHECKPOINT_TIMINGS_KEY, JSON.stringify(timings));
+    } catch (error) {
+      console.error("Failed to save checkpoint timings:", error);
+    }
+  };
+
+  // Starts the container, optionally from a checkpoint, and times it to ready
+  const timedStart = async (id: string, checkpoint?: string) => {
+    const api = docker();
+    const started = Date.now();
+    await api.startContainer(id, checkpoint);
+    const probe = await waitUntilReady(api, id);
+    const ms = Date.now() - started;
+    await record(id, checkpoint ? { restoredMs: ms, probe } : { coldMs: ms, probe });
+  };
+
+  return {
+    checkpoints: {},
+    timings: {},
+    busyId: null,
+    supported: null,
+    error: null,
+
+    load: async () => {
+      // Per boot: a different guest kernel may have changed the answer
+      QemuService.getBootTimes()
+        .then((times) => set({ supported: times.checkpointSupported ?? null }))
+        .catch(() => {});
+      if (loaded) return;
+      loaded = true;
+      try {
+        const saved = await AsyncStorage.getItem(CHECKPOINT_TIMINGS_KEY);
+        if (saved) set({ timings: JSON.parse(saved) });
+      } catch (error) {
+        console.error("Failed to load checkpoint timings:", error);
+      }
+    },
+
+    fetchCheckpoints: async (id: string) => {
+      try {
+        const list = await docker().listCheckpoints(id);
+        set({ checkpoints: { ...get().checkpoints, [id]: list.map((c) => c.Name) } });
+      } catch {
+        // dockerd without experimental, or no CRIU: nothing to restore
+        set({ checkpoints: { ...get().checkpoints, [id]: [] } });
+      }
+    },
+
+    checkpoint: async (id: string) => {
+      set({ busyId: id, error: null });
+      try {
+        const api = docker();
+        if (get().checkpoints[id]?.includes(CHECKPOINT_NAME)) {
+          await api.removeCheckpoint(id, CHECKPOINT_NAME);
+        }
+        const started = Date.now();
+        await api.createCheckpoint(id, CHECKPOINT_NAME);
+        await record(id, { checkpointMs: Date.now() - started });
+        await get().fetchCheckpoints(id);
+        return true;
+      } catch (error: any) {
+        set({ error: error.message || "Failed to checkpoint container" });
+        return false;
+      } finally {
+        set({ busyId: null });
+      }
+    },
+
+    restore: async (id: string) => {
+      set({ busyId: id, error: null });
+      try {
+        await timedStart(id, CHECKPOINT_NAME);
+        // The container's filesystem moves on from here; restoring the same
+        // memory image over it later could corrupt a database
+        await docker().removeCheckpoint(id, CHECKPOINT_NAME).catch(() => {});
+        await get().fetchCheckpoints(id);
+        return true;
+      } catch (error: any) {
+        set({ error: error.message || "Failed to restore container" });
+        return false;
+      } finally {
+        set({ busyId: null });
+      }
+    },
+
+    start: async (id: string) => {
+      set({ busyId: id, error: null });
+      try {
+        await timedStart(id);
+        return true;
+      } catch (error: any) {
+        set({ error: error.message || "Failed to start container" });
+        return false;
+      } finally {
+        set({ busyId: null });
+      }
+    },
+
+    clearError: () => {
+      set({ error: null });
+    },
+  };
+});
@@ -0,0 +1,270 @@
+import { create } from "zustand";
+import AsyncStorage from "@react-native-async-storage/async-storage";
+import {
+  Container,
+  CreateContainerConfig,
+  DockerAPI,
+  isPoolContainer,
+  POOL_LABEL,
+  POOL_NAME_PREFIX,
+} from "@/services/DockerAPI";
+import { normalizeRef } from "@/services/PullScheduler";
+import { useDockerStore } from "@/store/useDockerStore";
+
+/**
+ * "created": containers exist but never ran; a claim saves the create
+ * round trip. "paused": they were started and frozen; a claim is an
+ * unpause, but each one holds its memory in the guest.
+ */
+export type PoolWarmth = "created" | "paused";
+
+export interface PoolConfig {
+  // Idle containers per pooled image; 0 turns the pool off
+  size: number;
+  warmth: PoolWarmth;
+}
+
+export interface RunResult {
+  id: string;
+  pooled: boolean;
+  ms: number;
+}
+
+interface ContainerPoolState {
+  config: PoolConfig;
+  // Most recently run first; these are the images kept warm
+  images: string[];
+  // Idle pool containers per image, as of the last refill
+  idle: Record<string, number>;
+  // Recent run-to-started times, ms
+  pooledMs: number[];
+  coldMs: number[];
+  isRunning: boolean;
+  error: string | null;
+
+  load: () => Promise<void>;
+  start: (intervalMs?: number) => Promise<void>;
+  stop: () => void;
+  refill: () => Promise<void>;
+  run: (config: CreateContainerConfig, name?: string) => Promise<RunResult>;
+  setConfig: (config: Partial<PoolConfig>) => Promise<void>;
+}
+
+const CONTAINER_POOL_KEY = "@container_pool";
+const DEFAULT_INTERVAL_MS = 120_000;
+const MAX_POOLED_IMAGES = 3;
+const MAX_LATENCY_SAMPLES = 20;
+
+const DEFAULT_CONFIG: PoolConfig = { size: 1, warmth: "created" };
+
+let timer: ReturnType<typeof setInterval> | null = null;
+let loaded = false;
+let refilling = false;
+// Pool containers being claimed, so two runs never take the same one
+const claiming = new Set<string>();
+
+export function averageMs(samples: number[]): number | null {
+  return samples.length > 0 ? samples.reduce((sum, ms) => sum + ms, 0) / samples.length : null;
+}
+
+/**
+ * Whether a claimed pool container can become this container. Only the
+ * name and what `docker update` changes can be applied after creation.
+ */
+function isPoolable(config: CreateContainerConfig): boolean {
+  const { Image, HostConfig, ...rest } = config;
+  const { Memory, NanoCpus, RestartPolicy, ...hostRest } = HostConfig ?? {};
+  const isSet = (value: unknown) =>
+    value !== undefined && !(Array.isArray(value) && value.length === 0) &&
+    !(typeof value === "object" && value !== null && Object.keys(value).length === 0);
+  return Object.values(rest).every((value) => !isSet(value)) && Object.values(hostRest).every((value) => !isSet(value));
+}
+
+function slug(ref: string): string {
+  return ref.replace(/[@:].*$/, "").split("/").pop()!.replace(/[^a-zA-Z0-9_.-]/g, "-");
+}
+
+function randomSuffix(): string {
+  return Math.random().toString(16).slice(2, 8);
+}
+
+function idleFor(containers: Container[], ref: string, warmth: PoolWarmth): Container[] {
+  return containers.filter((c) =>
+    isPoolContainer(c) && c.Labels[POOL_LABEL] === ref && c.State === warmth && !claiming.has(c.Id)
+  );
+}
+
+function pushSample(samples: number[], ms: number): number[] {
+  return [...samples.slice(-(MAX_LATENCY_SAMPLES - 1)), ms];
+}
+
+async function persist(state: ContainerPoolState) {
+  try {
+    const { config, images, pooledMs, coldMs } = state;
+    await AsyncStorage.setItem(CONTAINER_POOL_KEY, JSON.stringify({ config, images, pooledMs, coldMs }));
+  } catch (error) {
+    console.error("Failed to save container pool state:", error);
+  }
+}
+
+export const useContainerPoolStore = create<ContainerPoolState>((set, get) => {
+  const docker = () => new DockerAPI(useDockerStore.getState().dockerApiUrl);
+
+  return {
+    config: DEFAULT_CONFIG,
+    images: [],
+    idle: {},
+    pooledMs: [],
+    coldMs: [],
+    isRunning: false,
+    error: null,
+
+    load: async () => {
+      if (loaded) return;
+      loaded = true;
+      try {
+        const saved = await AsyncStorage.getItem(CONTAINER_POOL_KEY);
+        if (saved) {
+          const parsed = JSON.parse(saved);
+          set({
+            config: { ...DEFAULT_CONFIG, ...parsed.config },
+            images: parsed.images ?? [],
+            pooledMs: parsed.pooledMs ?? [],
+            coldMs: parsed.coldMs ?? [],
+          });
+        }
+      } catch (error) {
+        console.error("Failed to load container pool state:", error);
+      }
+    },
+
+    start: async (intervalMs: number = DEFAULT_INTERVAL_MS) => {
+      get().stop();
+      await get().load();
+      set({ isRunning: true });
+      timer = setInterval(() => get().refill(), intervalMs);
+      get().refill();
+    },
+
+    stop: () => {
+      if (timer) {
+        clearInterval(timer);
+        timer = null;
+      }
+      set({ isRunning: false });
+    },
+
+    refill: async () => {
+      if (refilling) return;
+      refilling = true;
+      try {
+        const api = docker();
+        const { config, images } = get();
+        const [containers, localImages] = await Promise.all([api.listContainers(true), api.listImages()]);
+        const local = new Set(localImages.flatMap((image) => (image.RepoTags ?? []).map(normalizeRef)));
+        const wanted = config.size > 0 ? images : [];
+
+        // Pool containers for images no longer pooled, of the other warmth,
+        // or stopped by a VM restart are of no use
+        for (const container of containers) {
+          if (!isPoolContainer(container) || claiming.has(container.Id)) continue;
+          const ref = container.Labels[POOL_LABEL];
+          if (!wanted.includes(ref) || container.State !== config.warmth) {
+            await api.removeContainer(container.Id, true).catch(() => {});
+          }
+        }
+
+        const idle: Record<string, number> = {};
+        for (const ref of wanted) {
+          const current = idleFor(containers, ref, config.warmth);
+          for (const extra of current.slice(config.size)) {
+            await api.removeContainer(extra.Id, true).catch(() => {});
+          }
+          let count = Math.min(current.length, config.size);
+          // Never pulls: an image the quota manager evicted stays evicted
+          if (local.has(ref)) {
+            for (; count < config.size; count++) {
+              const { Id } = await api.createContainer(
+                { Image: ref, Labels: { [POOL_LABEL]: ref } },
+                `${POOL_NAME_PREFIX}${slug(ref)}-${randomSuffix()}`
+              );
+              if (config.warmth === "paused") {
+                try {
+                  await api.startContainer(Id);
+                  await api.pauseContainer(Id);
+                } catch {
+                  // An image whose command exits at once can't be kept paused
+                  await api.removeContainer(Id, true).catch(() => {});
+                  break;
+                }
+              }
+            }
+          }
+          idle[ref] = count;
+        }
+        set({ idle, error: null });
+      } catch (error: any) {
+        set({ error: error.message || "Container pool refill failed" });
+      } finally {
+        refilling = false;
+      }
+    },
+
+    run: async (config: CreateContainerConfig, name?: string) => {
+      const api = docker();
+      const ref = normalizeRef(config.Image);
+      const started = Date.now();
+      // Refilling after this run doesn't count towards its time
+      const finish = (result: RunResult) => {
+        const images = [ref, ...get().images.filter((image) => image !== ref)].slice(0, MAX_POOLED_IMAGES);
+        set((state) => ({
+          images,
+          pooledMs: result.pooled ? pushSample(state.pooledMs, result.ms) : state.pooledMs,
+          coldMs: result.pooled ? state.coldMs : pushSample(state.coldMs, result.ms),
+        }));
+        persist(get());
+        if (get().isRunning) get().refill();
+        return result;
+      };
+
+      const { size, warmth } = get().config;
+      if (size > 0 && isPoolable(config)) {
+        const containers = await api.listContainers(true).catch(() => []);
+        const candidate = idleFor(containers, ref, warmth)[0];
+        if (candidate) {
+          claiming.add(candidate.Id);
+          try {
+            await api.renameContainer(candidate.Id, name || `${slug(ref)}-${randomSuffix()}`);
+            const { Memory, NanoCpus, RestartPolicy } = config.HostConfig ?? {};
+            if (Memory || NanoCpus || RestartPolicy) {
+              await api.updateContainer(candidate.Id, { Memory, NanoCpus, RestartPolicy });
+            }
+            if (warmth === "paused") {
+              await api.unpauseContainer(candidate.Id);
+            } else {
+              await api.startContainer(candidate.Id);
+            }
+            return finish({ id: candidate.Id, pooled: true, ms: Date.now() - started });
+          } catch (error: any) {
+            // Half-claimed: neither a pool container nor the one asked for
+            console.warn(`[ContainerPool] Claim of ${candidate.Id.slice(0, 12)} failed, creating instead: ${error.message}`);
+            await api.removeContainer(candidate.Id, true).catch(() => {});
+          } finally {
+            claiming.delete(candidate.Id);
+          }
+        }
+      }
+
+      const { Id } = await api.createContainer(config, name || undefined);
+      await api.startContainer(Id);
+      return finish({ id: Id, pooled: false, ms: Date.now() - started });
+    },
+
+    setConfig: async (config: Partial<PoolConfig>) => {
+      await get().load();
+      set((state) => ({ config: { ...state.config, ...config } }));
+      await persist(get());
+      if (get().isRunning) get().refill();
+    },
+  };
+});
@@ -1,6 +1,15 @@
 import { create } from "zustand";
 import AsyncStorage from "@react-native-async-storage/async-storage";
-import { DockerAPI, Container, DockerImage, Volume, Network, SystemInfo } from "@/services/DockerAPI";
+import { DockerAPI, Container, DockerImage, Volume, Network, SystemInfo, isPoolContainer } from "@/services/DockerAPI";
+import { PullPriority, PullScheduler } from "@/services/PullScheduler";
+import QemuService, {
+  ContainerLatency,
+  ContainerStatsEvent,
+  ContainerTraceEvent,
+  ContainerUsage,
+  QemuEventListener,
+} from "@/services/QemuService";
+import { profileStore } from "@/lib/profiler";
 
 interface DockerState {
   containers: Container[];
@@ -12,6 +21,11 @@ interface DockerState {
   error: string | null;
   selectedContainer: Container | null;
   dockerApiUrl: string;
+  // Usage of every running container by short id, while subscribed
+  containerStats: Record<string, ContainerUsage>;
+  // eBPF latency reports by short id, while tracing
+  containerLatency: Record<string, ContainerLatency>;
+  traceState: ContainerTraceEvent | null;
 
   setDockerApiUrl: (url: string) => Promise<void>;
   fetchContainers: () => Promise<void>;
@@ -25,17 +39,34 @@ interface DockerState {
   restartContainer: (id: string) => Promise<void>;
   removeContainer: (id: string, force?: boolean) => Promise<void>;
   selectContainer: (container: Container | null) => void;
-  pullImage: (imageName: string, onProgress?: (progress: number) => void) => Promise<void>;
+  pullImage: (imageName: string, onProgress?: (progress: number) => void, priority?: PullPriority) => Promise<void>;
   removeImage: (id: string, force?: boolean) => Promise<void>;
   createContainer: (config: any) => Promise<string | null>;
+  subscribeStats: (intervalMs?: number) => () => void;
+  subscribeTrace: () => () => void;
   clearError: () => void;
 }
 
 const DOCKER_API_URL_KEY = "@docker_api_url";
 const DEFAULT_API_URL = "http://localhost:2375";
+const DEFAULT_STATS_INTERVAL_MS = 2000;
 
-export const useDockerStore = create<DockerState>((set, get) => {
+// One guest stream serves every screen that shows stats
+let statsSubscribers = 0;
+let statsListener: QemuEventListener | null = null;
+// Tracing rides on the stats stream and costs the guest more; only while asked
+let traceSubscribers = 0;
+let traceListeners: QemuEventListener[] = [];
+let unsubscribeTraceStats: (() => void) | null = null;
+
+export function statsFor<T>(stats: Record<string, T>, containerId: string): T | undefined {
+  return stats[containerId.slice(0, 12)];
+}
+
+export const useDockerStore = create<DockerState>(profileStore("docker", (set, get) => {
   let docker = new DockerAPI(DEFAULT_API_URL);
+  // Every pull goes through here so the same image is never fetched twice
+  const pulls = new PullScheduler(() => docker);
 
   return {
     containers: [],
@@ -47,6 +78,9 @@ export const useDockerStore = create<DockerState>((set, get) => {
     error: null,
     selectedContainer: null,
     dockerApiUrl: DEFAULT_API_URL,
+    containerStats: {},
+    containerLatency: {},
+    traceState: null,
 
     setDockerApiUrl: async (url: string) => {
       try {
@@ -61,7 +95,8 @@ export const useDockerStore = create<DockerState>((set, get) => {
     fetchContainers: async () => {
       set({ isLoading: true, error: null });
       try {
-        const containers = await docker.listContainers(true);
+        // Idle warm-pool containers aren't the user's until claimed
+        const containers = (await docker.listContainers(true)).filter((c) => !isPoolContainer(c));
         set({ containers, isLoading: false });
       } catch (error: any) {
         set({ error: error.message || "Failed to fetch containers", isLoading: false });
@@ -111,13 +146,14 @@ export const useDockerStore = create<DockerState>((set, get) => {
     fetchAll: async () => {
       set({ isLoading: true, error: null });
       try {
-        const [containers, images, volumes, networks, systemInfo] = await Promise.all([
+        const [allContainers, images, volumes, networks, systemInfo] = await Promise.all([
           docker.listContainers(true),
           docker.listImages(),
           docker.listVolumes(),
           docker.listNetworks(),
           docker.getSystemInfo(),
         ]);
+        const containers = allContainers.filter((c) => !isPoolContainer(c));
         set({ containers, images, volumes, networks, systemInfo, isLoading: false });
       } catch (error: any) {
         set({ error: error.message || "Failed to fetch Docker data", isLoading: false });
@@ -175,13 +211,18 @@ export const useDockerStore = create<DockerState>((set, get) => {
       set({ selectedContainer: container });
     },
 
-    pullImage: async (imageName: string, onProgress?: (progress: number) => void) => {
-      set({ isLoading: true, error: null });
+    pullImage: async (imageName: string, onProgress?: (progress: number) => void, priority: PullPriority = "user") => {
+      // Background pulls (prefetch) don't block the UI or report errors there
+      if (priority === "user") set({ isLoading: true, error: null });
       try {
-        await docker.pullImage(imageName, onProgress);
+        await pulls.pull(imageName, { priority, onProgress });
         await get().fetchImages();
       } catch (error: any) {
-        set({ error: error.message || "Failed to pull image", isLoading: false });
+        if (priority === "user") {
+          set({ error: error.message || "Failed to pull image", isLoading: false });
+        } else {
+          console.warn(`[Docker] Background pull of ${imageName} failed: ${error.message}`);
+        }
       }
     },
 
@@ -208,8 +249,62 @@ export const useDockerStore = create<DockerState>((set, get) => {
       }
     },
 
+    subscribeStats: (intervalMs: number = DEFAULT_STATS_INTERVAL_MS) => {
+      if (statsSubscribers++ === 0) {
+        statsListener = QemuService.addEventListener<ContainerStatsEvent>("qemu_container_stats", (event) => {
+          const containerStats: Record<string, ContainerUsage> = {};
+          for (const usage of event.containers) containerStats[usage.id] = usage;
+          set({ containerStats });
+        });
+        QemuService.startContainerStats(intervalMs).catch((error) =>
+          console.warn(`[Docker] Container stats unavailable: ${error.message}`)
+        );
+      }
+      let subscribed = true;
+      return () => {
+        if (!subscribed) return;
+        subscribed = false;
+        if (--statsSubscribers === 0) {
+          statsListener?.remove();
+          statsListener = null;
+          QemuService.stopContainerStats().catch(() => {});
+          set({ containerStats: {} });
+        }
+      };
+    },
+
+    subscribeTrace: () => {
+      if (traceSubscribers++ === 0) {
+        traceListeners = [
+          QemuService.addEventListener<ContainerLatency>("qemu_container_latency", (event) => {
+            set({ containerLatency: { ...get().containerLatency, [event.id]: event } });
+          }),
+          QemuService.addEventListener<ContainerTraceEvent>("qemu_container_trace", (event) => {
+            set({ traceState: event });
+          }),
+        ];
+        unsubscribeTraceStats = get().subscribeStats();
+        QemuService.setContainerTracing(true).catch((error) =>
+          console.warn(`[Docker] Container tracing unavailable: ${error.message}`)
+        );
+      }
+      let subscribed = true;
+      return () => {
+        if (!subscribed) return;
+        subscribed = false;
+        if (--traceSubscribers === 0) {
+          QemuService.setContainerTracing(false).catch(() => {});
+          traceListeners.forEach((listener) => listener.remove());
+          traceListeners = [];
+          unsubscribeTraceStats?.();
+          unsubscribeTraceStats = null;
+          set({ containerLatency: {}, traceState: null });
+        }
+      };
+    },
+
     clearError: () => {
       set({ error: null });
     },
   };
-});
+}));
@@ -0,0 +1,240 @@
+import { create } from "zustand";
+import AsyncStorage from "@react-native-async-storage/async-storage";
+import { DockerAPI, DockerImage, isPoolContainer } from "@/services/DockerAPI";
+import QemuService from "@/services/QemuService";
+import { useDockerStore } from "@/store/useDockerStore";
+import { DEFAULT_QUOTA_LIMITS, exclusiveSize, planEviction, QuotaLimits } from "@/lib/image-quota";
+
+export interface QuotaStats {
+  // A container created from an image that was already local
+  hits: number;
+  // An image that had to be pulled or built
+  misses: number;
+  // Misses for an image this manager had evicted
+  refetches: number;
+  evictedImages: number;
+  reclaimedBytes: number;
+}
+
+export interface EvictionRecord {
+  at: number;
+  images: string[];
+  bytes: number;
+  reasons: string[];
+}
+
+interface ImageQuotaState {
+  limits: QuotaLimits;
+  // Image ID -> ms of its last use
+  lastUsed: Record<string, number>;
+  stats: QuotaStats;
+  lastEviction: EvictionRecord | null;
+  lastCheckAt: number | null;
+  isRunning: boolean;
+  error: string | null;
+
+  load: () => Promise<void>;
+  start: (intervalMs?: number) => Promise<void>;
+  stop: () => void;
+  checkNow: () => Promise<void>;
+  setLimits: (limits: Partial<QuotaLimits>) => Promise<void>;
+  resetStats: () => Promise<void>;
+}
+
+const IMAGE_QUOTA_KEY = "@image_quota";
+const DEFAULT_INTERVAL_MS = 60_000;
+// Tags of evicted images remembered to spot refetches
+const MAX_EVICTED_REFS = 100;
+
+const EMPTY_STATS: QuotaStats = { hits: 0, misses: 0, refetches: 0, evictedImages: 0, reclaimedBytes: 0 };
+
+let timer: ReturnType<typeof setInterval> | null = null;
+let unsubscribe: (() => void) | null = null;
+let checking = false;
+let loaded = false;
+let evictedRefs: string[] = [];
+// What the previous check saw; null until the first check sets a baseline
+let seenImages: Set<string> | null = null;
+let seenContainers: Set<string> | null = null;
+// Seconds; events since this time have been applied to lastUsed
+let eventsSince = 0;
+
+export function cacheHitRate(stats: QuotaStats): number | null {
+  const total = stats.hits + stats.misses;
+  return total > 0 ? stats.hits / total : null;
+}
+
+function imageIdFor(ref: string, images: DockerImage[]): string | undefined {
+  if (ref.startsWith("sha256:")) return ref;
+  const tagged = ref.includes(":") ? ref : `${ref}:latest`;
+  return images.find((image) => image.RepoTags?.includes(tagged))?.Id;
+}
+
+async function persist(state: ImageQuotaState) {
+  try {
+    const { limits, lastUsed, stats, lastEviction } = state;
+    await AsyncStorage.setItem(IMAGE_QUOTA_KEY, JSON.stringify({ limits, lastUsed, stats, lastEviction, evictedRefs }));
+  } catch (error) {
+    console.error("Failed to save image quota state:", error);
+  }
+}
+
+export const useImageQuotaStore = create<ImageQuotaState>((set, get) => ({
+  limits: DEFAULT_QUOTA_LIMITS,
+  lastUsed: {},
+  stats: EMPTY_STATS,
+  lastEviction: null,
+  lastCheckAt: null,
+  isRunning: false,
+  error: null,
+
+  load: async () => {
+    if (loaded) return;
+    loaded = true;
+    try {
+      const saved = await AsyncStorage.getItem(IMAGE_QUOTA_KEY);
+      if (saved) {
+        const parsed = JSON.parse(saved);
+        evictedRefs = parsed.evictedRefs ?? [];
+        set({
+          limits: { ...DEFAULT_QUOTA_LIMITS, ...parsed.limits },
+          lastUsed: parsed.lastUsed ?? {},
+          stats: { ...EMPTY_STATS, ...parsed.stats },
+          lastEviction: parsed.lastEviction ?? null,
+        });
+      }
+    } catch (error) {
+      console.error("Failed to load image quota state:", error);
+    }
+  },
+
+  start: async (intervalMs: number = DEFAULT_INTERVAL_MS) => {
+    get().stop();
+    await get().load();
+
+    seenImages = null;
+    seenContainers = null;
+    eventsSince = Math.floor(Date.now() / 1000);
+    set({ isRunning: true });
+    timer = setInterval(() => get().checkNow(), intervalMs);
+    // A pull anywhere in the app is checked straight away, not at the next tick
+    unsubscribe = useDockerStore.subscribe((state, previous) => {
+      if (state.images.length > previous.images.length) get().checkNow();
+    });
+    get().checkNow();
+  },
+
+  stop: () => {
+    if (timer) {
+      clearInterval(timer);
+      timer = null;
+    }
+    unsubscribe?.();
+    unsubscribe = null;
+    set({ isRunning: false });
+  },
+
+  checkNow: async () => {
+    if (checking) return;
+    checking = true;
+    try {
+      const docker = new DockerAPI(useDockerStore.getState().dockerApiUrl);
+      const now = Date.now();
+      const [images, containers] = await Promise.all([docker.listImages(), docker.listContainers(true)]);
+      const lastUsed = { ...get().lastUsed };
+      const stats = { ...get().stats };
+
+      // dockerd replays past events; docker-shim has none, so the
+      // container references below are then the only signal
+      const until = Math.floor(now / 1000);
+      try {
+        const events = await docker.getEvents(eventsSince, until, { type: ["container", "image"] });
+        for (const event of events) {
+          const ref = event.Type === "image" ? event.Actor.ID : event.Actor.Attributes?.image;
+          const id = ref ? imageIdFor(ref, images) : undefined;
+          if (id) lastUsed[id] = Math.max(lastUsed[id] ?? 0, event.time * 1000);
+        }
+        eventsSince = until;
+      } catch {
+      }
+
+      for (const container of containers) {
+        const since = container.State === "running" ? now : container.Created * 1000;
+        lastUsed[container.ImageID] = Math.max(lastUsed[container.ImageID] ?? 0, since);
+      }
+
+      if (seenImages && seenContainers) {
+        for (const image of images) {
+          if (seenImages.has(image.Id)) continue;
+          stats.misses++;
+          if (image.RepoTags?.some((tag) => evictedRefs.includes(tag))) stats.refetches++;
+          lastUsed[image.Id] = Math.max(lastUsed[image.Id] ?? 0, now);
+        }
+        // Warm-pool containers count once claimed, not when pre-created
+        for (const container of containers) {
+          if (isPoolContainer(container) || seenContainers.has(container.Id)) continue;
+          if (seenImages.has(container.ImageID)) stats.hits++;
+        }
+      }
+
+      const storage = await QemuService.getStorageStats().catch(() => null);
+      const plan = planEviction(images, containers, lastUsed, storage?.freeBytes ?? null, get().limits);
+      let remaining = images;
+      if (plan.evict.length > 0) {
+        // Untagged layers first; dockerd reports what that freed
+        const pruned = await docker.pruneImages(true).catch(() => null);
+        let bytes = pruned?.SpaceReclaimed ?? 0;
+        const evicted: string[] = [];
+        for (const image of plan.evict) {
+          // One tag at a time: dockerd won't delete an image with several by ID
+          const tags = image.RepoTags?.filter((tag) => tag !== "<none>:<none>") ?? [];
+          try {
+            for (const ref of tags.length > 0 ? tags : [image.Id]) {
+              await docker.removeImage(ref);
+            }
+          } catch {
+            // Pruned already, or used by a container created since the listing
+            continue;
+          }
+          evicted.push(tags[0] ?? image.Id.slice(7, 19));
+          evictedRefs.push(...tags);
+          bytes += exclusiveSize(image);
+        }
+        evictedRefs = evictedRefs.slice(-MAX_EVICTED_REFS);
+        remaining = await docker.listImages();
+        stats.evictedImages += evicted.length;
+        stats.reclaimedBytes += bytes;
+        set({ lastEviction: { at: now, images: evicted, bytes, reasons: plan.reasons } });
+        useDockerStore.getState().fetchImages();
+      }
+
+      // Forget images that are gone so the map stays bounded
+      const present = new Set(remaining.map((image) => image.Id));
+      for (const id of Object.keys(lastUsed)) {
+        if (!present.has(id)) delete lastUsed[id];
+      }
+      seenImages = present;
+      seenContainers = new Set(containers.filter((c) => !isPoolContainer(c)).map((c) => c.Id));
+
+      set({ lastUsed, stats, lastCheckAt: now, error: null });
+      await persist(get());
+    } catch (error: any) {
+      set({ error: error.message || "Image quota check failed" });
+    } finally {
+      checking = false;
+    }
+  },
+
+  setLimits: async (limits: Partial<QuotaLimits>) => {
+    await get().load();
+    set((state) => ({ limits: { ...state.limits, ...limits } }));
+    await persist(get());
+    if (get().isRunning) get().checkNow();
+  },
+
+  resetStats: async () => {
+    evictedRefs = [];
+    set({ stats: EMPTY_STATS, lastEviction: null });
+    await persist(get());
+  },
+}));
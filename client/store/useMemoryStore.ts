@@ -0,0 +1,126 @@
+import { create } from "zustand";
+import QemuService, { QemuMemoryStats } from "@/services/QemuService";
+import { computeTrend, isLeaking, Trend, TrendPoint } from "@/lib/leak-detector";
+
+export type MemorySeries = "javaHeap" | "nativeHeap" | "selfPss" | "jsHeap" | "vmPss" | "qemuPss";
+
+export interface MemorySample {
+  timestamp: number;
+  javaHeap: number;
+  nativeHeap: number;
+  selfPss: number;
+  jsHeap: number | null;
+  vmPss: number | null;
+  qemuPss: number | null;
+}
+
+interface MemoryState {
+  samples: MemorySample[];
+  trends: Partial<Record<MemorySeries, Trend>>;
+  leaks: MemorySeries[];
+  latest: QemuMemoryStats | null;
+  isSampling: boolean;
+  intervalMs: number;
+  error: string | null;
+
+  startSampling: (intervalMs?: number) => void;
+  stopSampling: () => void;
+  sampleNow: () => Promise<void>;
+  clearSamples: () => void;
+}
+
+// 6 hours at the default 30s interval
+const MAX_SAMPLES = 720;
+const DEFAULT_INTERVAL_MS = 30_000;
+// Trends are fitted over the most recent hour of samples
+const TREND_WINDOW_MS = 60 * 60 * 1000;
+
+const SERIES: MemorySeries[] = ["javaHeap", "nativeHeap", "selfPss", "jsHeap", "vmPss", "qemuPss"];
+
+let timer: ReturnType<typeof setInterval> | null = null;
+
+/**
+ * Hermes heap size in kB, or null on JSC/remote debugging
+ */
+function readJsHeapKb(): number | null {
+  const hermes = (global as any).HermesInternal;
+  const stats = hermes?.getInstrumentedStats?.();
+  if (!stats || typeof stats.js_heapSize !== "number") return null;
+  return stats.js_heapSize / 1024;
+}
+
+function fitTrends(samples: MemorySample[]) {
+  const trends: Partial<Record<MemorySeries, Trend>> = {};
+  const leaks: MemorySeries[] = [];
+  const newest = samples[samples.length - 1]?.timestamp ?? 0;
+  const window = samples.filter((s) => s.timestamp >= newest - TREND_WINDOW_MS);
+
+  for (const series of SERIES) {
+    const points: TrendPoint[] = [];
+    for (const s of window) {
+      const value = s[series];
+      if (value !== null) points.push({ t: s.timestamp, value });
+    }
+    const trend = computeTrend(points);
+    if (trend) {
+      trends[series] = trend;
+      if (isLeaking(trend)) leaks.push(series);
+    }
+  }
+  return { trends, leaks };
+}
+
+export const useMemoryStore = create<MemoryState>((set, get) => ({
+  samples: [],
+  trends: {},
+  leaks: [],
+  latest: null,
+  isSampling: false,
+  intervalMs: DEFAULT_INTERVAL_MS,
+  error: null,
+
+  startSampling: (intervalMs: number = DEFAULT_INTERVAL_MS) => {
+    if (timer) clearInterval(timer);
+    set({ isSampling: true, intervalMs });
+    get().sampleNow();
+    timer = setInterval(() => get().sampleNow(), intervalMs);
+  },
+
+  stopSampling: () => {
+    if (timer) {
+      clearInterval(timer);
+      timer = null;
+    }
+    set({ isSampling: false });
+  },
+
+  sampleNow: async () => {
+    try {
+      const stats = await QemuService.getMemoryStats();
+      const sample: MemorySample = {
+        timestamp: stats.timestamp,
+        javaHeap: stats.javaHeapUsedKb,
+        nativeHeap: stats.nativeHeapKb,
+        selfPss: stats.selfPssKb,
+        jsHeap: readJsHeapKb(),
+        vmPss: stats.vmPssKb ?? null,
+        qemuPss: stats.qemuPssKb ?? null,
+      };
+      const samples = [...get().samples.slice(-(MAX_SAMPLES - 1)), sample];
+      const { trends, leaks } = fitTrends(samples);
+
+      const newLeaks = leaks.filter((series) => !get().leaks.includes(series));
+      if (newLeaks.length > 0) {
+        console.warn(`[Memory] Sustained growth detected: ${newLeaks.join(", ")}`);
+      }
+
+      set({ samples, trends, leaks, latest: stats, error: null });
+    } catch (error: any) {
+      set({ error: error.message || "Failed to read memory stats" });
+    }
+  },
+
+  clearSamples: () => {
+    set({ samples: [], trends: {}, leaks: [] });
+  },
+}));
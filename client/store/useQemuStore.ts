@@ -4,10 +4,16 @@ import QemuService, {
   QEMU_CONSTANTS, 
   QemuRequirementsResult,
   StateChangeEvent,
-  LogEvent
+  LogEvent,
+  StatsEvent,
+  ContainerRuntime
 } from "@/services/QemuService";
+import { useMemoryStore } from "@/store/useMemoryStore";
+import { profileStore } from "@/lib/profiler";
 
 type VMStatus = "stopped" | "starting" | "running" | "stopping" | "error" | "initializing";
+// Settings that can wait on a restart, each with its own pending reason
+type RestartCause = "applianceInit" | "runtime" | "scratchDisk" | "resize";
 
 interface VMStats {
   cpuUsage: number;
@@ -20,6 +26,14 @@ interface QemuSettings {
   ramMB: number;
   cpuCores: number;
   diskSizeGB: number;
+  // Boot through appliance-init instead of OpenRC runlevels
+  applianceInit: boolean;
+  // dockerd, or containerd behind docker-shim to save guest memory
+  runtime: ContainerRuntime;
+  // Blank disk per boot for /tmp, build caches and scratch volumes
+  scratchDisk: boolean;
+  // Fetch docker.defaultImages into the host cache while charging on Wi-Fi
+  imagePrefetch: boolean;
 }
 
 interface QemuPaths {
@@ -39,6 +53,10 @@ interface QemuState {
   requirements: QemuRequirementsResult | null;
   dockerAvailable: boolean;
   downloadProgress: number;
+  // Settings changes the running VM can't apply, by what changed
+  restartReasons: Partial<Record<RestartCause, string>>;
+  // The same, joined for display; null when nothing is waiting on a restart
+  pendingRestart: string | null;
 
   initialize: () => Promise<void>;
   startVM: () => Promise<void>;
@@ -57,13 +75,20 @@ interface QemuState {
 
 const QEMU_SETTINGS_KEY = "@qemu_settings";
 
+// Set once the native sampler delivers qemu_stats; simulated jitter stops then
+let hasNativeStats = false;
+
 const DEFAULT_SETTINGS: QemuSettings = {
   ramMB: QEMU_CONSTANTS.DEFAULT_RAM_MB,
   cpuCores: QEMU_CONSTANTS.DEFAULT_CPU_CORES,
   diskSizeGB: 10,
+  applianceInit: false,
+  runtime: "docker",
+  scratchDisk: false,
+  imagePrefetch: true,
 };
 
-export const useQemuStore = create<QemuState>((set, get) => ({
+export const useQemuStore = create<QemuState>(profileStore("qemu", (set, get) => ({
   vmStatus: "stopped",
   vmLogs: [],
   vmStats: null,
@@ -74,6 +99,8 @@ export const useQemuStore = create<QemuState>((set, get) => ({
   requirements: null,
   dockerAvailable: false,
   downloadProgress: 0,
+  restartReasons: {},
+  pendingRestart: null,
 
   initialize: async () => {
     const { addLog } = get();
@@ -84,7 +111,8 @@ export const useQemuStore = create<QemuState>((set, get) => ({
       // Load saved settings
       const savedSettings = await AsyncStorage.getItem(QEMU_SETTINGS_KEY);
       if (savedSettings) {
-        const settings = JSON.parse(savedSettings) as QemuSettings;
+        // Settings saved by older versions lack newer keys
+        const settings = { ...DEFAULT_SETTINGS, ...(JSON.parse(savedSettings) as Partial<QemuSettings>) };
         set({ settings });
       }
 
@@ -99,7 +127,7 @@ export const useQemuStore = create<QemuState>((set, get) => ({
             isoPath: result.isoPath,
             diskPath: result.diskPath,
           },
-          vmStatus: "stopped",
+          vmStatus: result.reattached ? "running" : "stopped",
         });
         
         addLog(`[QEMU] Initialized at ${result.qemuDir}`);
@@ -107,11 +135,31 @@ export const useQemuStore = create<QemuState>((set, get) => ({
         addLog(`[QEMU] Alpine ISO: ${result.isoExists ? "Found" : "Not found"}`);
         addLog(`[QEMU] Disk image: ${result.diskExists ? "Found" : "Not found"}`);
         
+        // WorkManager keeps the schedule; this only reconciles it with the setting
+        QemuService.setImagePrefetch(get().settings.imagePrefetch).catch((error) => {
+          addLog(`[QEMU] Image pre-fetch scheduling failed: ${error.message}`);
+        });
+
         // Check requirements
         await get().checkRequirements();
         
         // Setup event listeners
         get().setupEventListeners();
+
+        // A VM that outlived the previous JS context is adopted, not rebooted
+        if (result.reattached) {
+          addLog("[QEMU] Reattached to running VM");
+          set({
+            vmStats: {
+              cpuUsage: 0,
+              memoryUsed: 0,
+              memoryTotal: get().settings.ramMB,
+              uptime: 0,
+            },
+          });
+          useMemoryStore.getState().startSampling();
+          get().pollDockerAvailability();
+        }
       } else {
         throw new Error("QEMU initialization failed");
       }
@@ -178,10 +226,16 @@ export const useQemuStore = create<QemuState>((set, get) => ({
     addLog(`[QEMU] Starting VM with ${settings.ramMB}MB RAM, ${settings.cpuCores} CPUs...`);
 
     try {
-      const result = await QemuService.startVM(settings.ramMB, settings.cpuCores);
+      const result = await QemuService.startVM(
+        settings.ramMB,
+        settings.cpuCores,
+        settings.applianceInit,
+        settings.runtime,
+        settings.scratchDisk
+      );
       
       if (result.success) {
-        addLog("[QEMU] VM started successfully");
+        addLog(result.reattached ? "[QEMU] Reattached to running VM" : "[QEMU] VM started successfully");
         addLog(`[QEMU] Docker API: localhost:${result.dockerPort}`);
         addLog(`[QEMU] SSH: localhost:${result.sshPort}`);
         
@@ -221,7 +275,7 @@ export const useQemuStore = create<QemuState>((set, get) => ({
       
       if (result.success) {
         addLog("[QEMU] VM stopped");
-        set({ vmStatus: "stopped", vmStats: null, dockerAvailable: false });
+        set({ vmStatus: "stopped", vmStats: null, dockerAvailable: false, restartReasons: {}, pendingRestart: null });
       }
     } catch (error: any) {
       addLog(`[QEMU] Error: ${error.message}`);
@@ -246,7 +300,9 @@ export const useQemuStore = create<QemuState>((set, get) => ({
       
       // Update stats with real or simulated data
       const currentStats = get().vmStats;
-      if (currentStats) {
+      if (currentStats && hasNativeStats) {
+        set({ vmStats: { ...currentStats, uptime: currentStats.uptime + 1 } });
+      } else if (currentStats) {
         set({
           vmStats: {
             ...currentStats,
@@ -265,7 +321,7 @@ export const useQemuStore = create<QemuState>((set, get) => ({
   },
 
   updateSettings: async (newSettings: Partial<QemuSettings>) => {
-    const { settings, addLog } = get();
+    const { settings, addLog, vmStatus } = get();
     const updatedSettings = { ...settings, ...newSettings };
     
     try {
@@ -274,6 +330,57 @@ export const useQemuStore = create<QemuState>((set, get) => ({
       addLog("[QEMU] Settings updated");
     } catch (error) {
       set({ error: "Failed to save settings" });
+      return;
+    }
+
+    // Init, runtime and disks are fixed at boot
+    const setReason = (cause: RestartCause, reason: string | null) => {
+      const restartReasons = { ...get().restartReasons };
+      if (reason) restartReasons[cause] = reason;
+      else delete restartReasons[cause];
+      const reasons = Object.values(restartReasons);
+      set({ restartReasons, pendingRestart: reasons.length > 0 ? reasons.join("; ") : null });
+    };
+    if (vmStatus === "running") {
+      if (updatedSettings.applianceInit !== settings.applianceInit) {
+        setReason("applianceInit", "Restart the VM to switch the boot mode");
+      }
+      if (updatedSettings.runtime !== settings.runtime) {
+        setReason("runtime", "Restart the VM to switch the container runtime");
+      }
+      if (updatedSettings.scratchDisk !== settings.scratchDisk) {
+        setReason("scratchDisk", "Restart the VM to attach or detach the scratch disk");
+      }
+    }
+
+    if (updatedSettings.imagePrefetch !== settings.imagePrefetch) {
+      try {
+        await QemuService.setImagePrefetch(updatedSettings.imagePrefetch);
+      } catch (error: any) {
+        addLog(`[QEMU] Image pre-fetch scheduling failed: ${error.message}`);
+      }
+    }
+
+    const resized = updatedSettings.ramMB !== settings.ramMB || updatedSettings.cpuCores !== settings.cpuCores;
+    if (!resized || vmStatus !== "running") return;
+
+    // Apply to the running VM through hotplug instead of a full reboot
+    try {
+      const result = await QemuService.resizeVM(updatedSettings.ramMB, updatedSettings.cpuCores);
+      addLog(`[QEMU] Resized live to ${result.ramMb}MB RAM, ${result.cpuCores} CPUs`);
+      const currentStats = get().vmStats;
+      if (currentStats) {
+        set({ vmStats: { ...currentStats, memoryTotal: result.ramMb } });
+      }
+      if (result.restartRequired) {
+        addLog(`[QEMU] Restart required: ${result.message}`);
+        setReason("resize", result.message ?? "Restart the VM to apply the new size");
+      } else {
+        setReason("resize", null);
+      }
+    } catch (error: any) {
+      addLog(`[QEMU] Live resize failed: ${error.message}`);
+      setReason("resize", error.message);
     }
   },
 
@@ -299,6 +406,14 @@ export const useQemuStore = create<QemuState>((set, get) => ({
     QemuService.addEventListener<StateChangeEvent>("qemu_state_change", (data) => {
       addLog(`[QEMU] State changed: ${data.state}`);
       set({ vmStatus: data.state as VMStatus });
+
+      // Track memory for the whole VM session so long-run growth is visible
+      const memory = useMemoryStore.getState();
+      if (data.state === "running" && !memory.isSampling) {
+        memory.startSampling();
+      } else if (data.state === "stopped" && memory.isSampling) {
+        memory.stopSampling();
+      }
     });
     
     // Listen for logs from native module
@@ -306,6 +421,20 @@ export const useQemuStore = create<QemuState>((set, get) => ({
       addLog(data.log);
     });
     
+    // Listen for QEMU process stats sampled natively
+    QemuService.addEventListener<StatsEvent>("qemu_stats", (data) => {
+      hasNativeStats = true;
+      const currentStats = get().vmStats;
+      set({
+        vmStats: {
+          memoryTotal: currentStats?.memoryTotal ?? get().settings.ramMB,
+          uptime: currentStats?.uptime ?? 0,
+          cpuUsage: data.cpuPercent,
+          memoryUsed: Math.round(data.rssMb),
+        },
+      });
+    });
+    
     // Listen for download progress
     QemuService.addEventListener<{ progress: number; status: string }>("qemu_download_progress", (data) => {
       set({ downloadProgress: data.progress });
@@ -351,4 +480,4 @@ export const useQemuStore = create<QemuState>((set, get) => ({
     
     poll();
   },
-}));
+})));
@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+# ====================================================
+# Build appliance-init for the x86_64 guest
+# ====================================================
+# Produces a static binary and stages it in the app assets, from where
+# it is served to the guest over slirp's TFTP server (10.0.2.2) and
+# installed as /sbin/appliance-init by alpine-setup.sh.
+#
+# Usage:
+#   guest/appliance-init/build.sh [--no-install]
+#
+# CC defaults to musl-gcc (smallest binary), then x86_64-linux-musl-gcc,
+# then gcc when the build host is x86_64.
+# ====================================================
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+OUT_DIR="$REPO_ROOT/build/guest"
+ASSET_DIR="$REPO_ROOT/android/app/src/main/assets/qemu/guest"
+
+INSTALL=1
+[ "${1:-}" = "--no-install" ] && INSTALL=0
+
+if [ -z "${CC:-}" ]; then
+    for candidate in musl-gcc x86_64-linux-musl-gcc; do
+        if command -v "$candidate" > /dev/null; then
+            CC="$candidate"
+            break
+        fi
+    done
+fi
+if [ -z "${CC:-}" ]; then
+    [ "$(uname -m)" = x86_64 ] || { echo "error: set CC to an x86_64 cross compiler" >&2; exit 1; }
+    CC=gcc
+fi
+
+mkdir -p "$OUT_DIR"
+"$CC" -static -Os -Wall -Wextra -Werror -ffunction-sections -fdata-sections -Wl,--gc-sections \
+    -o "$OUT_DIR/appliance-init" "$SCRIPT_DIR/init.c"
+strip "$OUT_DIR/appliance-init" 2> /dev/null || true
+echo "==> Built $(du -h "$OUT_DIR/appliance-init" | cut -f1) $OUT_DIR/appliance-init ($CC)"
+
+if [ "$INSTALL" = 1 ]; then
+    mkdir -p "$ASSET_DIR"
+    cp "$OUT_DIR/appliance-init" "$ASSET_DIR/appliance-init"
+    echo "==> Installed into $ASSET_DIR"
+fi
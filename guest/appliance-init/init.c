@@ -0,0 +1,948 @@
+/**
+ * appliance-init: PID 1 for the docker-droid guest
+ *
+ * Replaces busybox init + OpenRC when the host boots with
+ * init=/sbin/appliance-init. Under TCG every runlevel script costs real
+ * time; this does the same work in one process:
+ *
+ *   - mounts the kernel filesystems and cgroup v2, the data disk on
+ *     /var/lib/docker and, if attached, the scratch disk
+ *   - configures lo and eth0 statically for slirp (10.0.2.15/24 via
+ *     10.0.2.2, DNS 10.0.2.3) instead of waiting for DHCP
+ *   - starts containerd, dockerd (or docker-shim), and optionally sshd,
+ *     the stargz snapshotter and cgroup-stats at once, and respawns them
+ *     with backoff if they exit
+ *   - onlines memory and vCPUs the host hotplugs for a live resize, like
+ *     hotplug.start: virtio-mem blocks as movable, so they can be
+ *     unplugged again
+ *   - reports "ready <uptime> appliance [criu|no-criu]" on the heartbeat
+ *     port once the Docker API answers, then heartbeats every 5 s like
+ *     heartbeat.start
+ *   - reaps orphans, and stops everything cleanly on poweroff/reboot
+ *
+ * If containerd, or both dockerd and docker-shim, aren't installed it
+ * hands over to /sbin/init, so a guest that hasn't been set up yet still
+ * boots through OpenRC.
+ *
+ * Kernel command line options (all optional):
+ *   appliance.sshd=1          start sshd
+ *   appliance.runtime=lite    serve the Docker API with docker-shim on
+ *                             containerd instead of dockerd
+ *   appliance.snapshotter=stargz
+ *                             lite runtime only: run the stargz snapshotter
+ *                             and pull images lazily through it
+ *   appliance.ip=A.B.C.D/N    eth0 address (default 10.0.2.15/24)
+ *   appliance.gw=A.B.C.D      default route (default 10.0.2.2)
+ *   appliance.dns=A.B.C.D     nameserver (default 10.0.2.3)
+ */
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <net/if.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/reboot.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOSTNAME "docker-android"
+#define HEARTBEAT_PORT "org.dockerandroid.heartbeat"
+#define DOCKER_SOCK "/var/run/docker.sock"
+#define CONTAINERD_SOCK "/run/containerd/containerd.sock"
+#define DOCKERD "/usr/bin/dockerd"
+#define DOCKER_SHIM "/usr/local/bin/docker-shim"
+#define STARGZ "/usr/local/bin/containerd-stargz-grpc"
+/* All-container stats for the host, from guest/cgroup-stats */
+#define CGROUP_STATS "/usr/local/bin/cgroup-stats"
+#define DOCKER_ROOT "/var/lib/docker"
+/* Virtio serial the host gives the container storage disk */
+#define DATA_DISK_SERIAL "docker-data"
+/* Formats a blank data disk; installed by alpine-setup.sh */
+#define DATA_DISK_SETUP "/usr/local/sbin/docker-data"
+#define DATA_DISK_OPTS "commit=30,discard"
+#define SCRATCH_DISK_SERIAL "scratch"
+/* Formats and mounts the scratch disk; with "watch", creates bind volume dirs */
+#define SCRATCH_DISK_SETUP "/usr/local/sbin/scratch-disk"
+/* `docker checkpoint` backend; its self-check is reported with "ready" */
+#define CRIU "/usr/sbin/criu"
+#define ENV_PATH "PATH=/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/sbin:/bin"
+
+#define HEARTBEAT_MS 5000
+#define READY_POLL_MS 100
+#define RESPAWN_MIN_MS 1000
+#define RESPAWN_MAX_MS 30000
+#define STOP_TIMEOUT_MS 10000
+/* How often hotplugged CPUs and memory blocks are looked for */
+#define HOTPLUG_POLL_MS 2000
+
+// ============== Logging ==============
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Timestamps are guest uptime, comparable with the kernel's own log */
+static void logf_(const char *fmt, ...) {
+    char buf[512];
+    int64_t t = now_ms();
+    int n = snprintf(buf, sizeof(buf), "[appliance-init %lld.%03lld] ",
+                     (long long)(t / 1000), (long long)(t % 1000));
+    va_list ap;
+    va_start(ap, fmt);
+    n += vsnprintf(buf + n, sizeof(buf) - n - 1, fmt, ap);
+    va_end(ap);
+    if (n > (int)sizeof(buf) - 2) {
+        n = sizeof(buf) - 2;
+    }
+    buf[n++] = '\n';
+    ssize_t ignored = write(STDERR_FILENO, buf, n);
+    (void)ignored;
+}
+
+// ============== Configuration ==============
+
+struct config {
+    int sshd;
+    int lite;
+    int stargz;
+    char ip[INET_ADDRSTRLEN];
+    int prefix;
+    char gateway[INET_ADDRSTRLEN];
+    char dns[INET_ADDRSTRLEN];
+};
+
+static void copy_opt(char *dst, size_t size, const char *value) {
+    snprintf(dst, size, "%s", value);
+}
+
+static void read_config(struct config *cfg) {
+    cfg->sshd = 0;
+    cfg->lite = 0;
+    cfg->stargz = 0;
+    copy_opt(cfg->ip, sizeof(cfg->ip), "10.0.2.15");
+    cfg->prefix = 24;
+    copy_opt(cfg->gateway, sizeof(cfg->gateway), "10.0.2.2");
+    copy_opt(cfg->dns, sizeof(cfg->dns), "10.0.2.3");
+
+    char cmdline[4096];
+    int fd = open("/proc/cmdline", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    ssize_t n = read(fd, cmdline, sizeof(cmdline) - 1);
+    close(fd);
+    if (n <= 0) {
+        return;
+    }
+    cmdline[n] = '\0';
+
+    char *save = NULL;
+    for (char *tok = strtok_r(cmdline, " \n", &save); tok; tok = strtok_r(NULL, " \n", &save)) {
+        if (strncmp(tok, "appliance.", 10) != 0) {
+            continue;
+        }
+        tok += 10;
+        char *value = strchr(tok, '=');
+        if (!value) {
+            continue;
+        }
+        *value++ = '\0';
+        if (strcmp(tok, "sshd") == 0) {
+            cfg->sshd = atoi(value) != 0;
+        } else if (strcmp(tok, "runtime") == 0) {
+            cfg->lite = strcmp(value, "lite") == 0;
+        } else if (strcmp(tok, "snapshotter") == 0) {
+            cfg->stargz = strcmp(value, "stargz") == 0;
+        } else if (strcmp(tok, "ip") == 0) {
+            char *slash = strchr(value, '/');
+            if (slash) {
+                *slash = '\0';
+                cfg->prefix = atoi(slash + 1);
+            }
+            copy_opt(cfg->ip, sizeof(cfg->ip), value);
+        } else if (strcmp(tok, "gw") == 0) {
+            copy_opt(cfg->gateway, sizeof(cfg->gateway), value);
+        } else if (strcmp(tok, "dns") == 0) {
+            copy_opt(cfg->dns, sizeof(cfg->dns), value);
+        }
+    }
+}
+
+// ============== Filesystems ==============
+
+static void mount_fs(const char *source, const char *target, const char *type,
+                     unsigned long flags, const char *data) {
+    mkdir(target, 0755);
+    if (mount(source, target, type, flags, data) < 0 && errno != EBUSY) {
+        logf_("mount %s on %s: %s", type, target, strerror(errno));
+    }
+}
+
+static int write_file(const char *path, const char *text) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t len = (ssize_t)strlen(text);
+    ssize_t n = write(fd, text, len);
+    close(fd);
+    return n == len ? 0 : -1;
+}
+
+static void setup_filesystems(void) {
+    const unsigned long nosuid = MS_NOSUID | MS_NODEV | MS_NOEXEC;
+
+    mount_fs("proc", "/proc", "proc", nosuid, NULL);
+    mount_fs("sysfs", "/sys", "sysfs", nosuid, NULL);
+    mount_fs("devtmpfs", "/dev", "devtmpfs", MS_NOSUID, "mode=0755");
+    mount_fs("devpts", "/dev/pts", "devpts", MS_NOSUID | MS_NOEXEC, "gid=5,mode=620,ptmxmode=000");
+    mount_fs("shm", "/dev/shm", "tmpfs", MS_NOSUID | MS_NODEV, "mode=1777");
+    mount_fs("run", "/run", "tmpfs", MS_NOSUID | MS_NODEV, "mode=0755");
+    mount_fs("tmp", "/tmp", "tmpfs", MS_NOSUID | MS_NODEV, "mode=1777");
+    mount_fs("cgroup2", "/sys/fs/cgroup", "cgroup2", nosuid, "nsdelegate");
+
+    // The live root may come up read-only
+    mount(NULL, "/", NULL, MS_REMOUNT, NULL);
+
+    // /var/run is a symlink to /run on Alpine; make sure it exists either way
+    mkdir("/var", 0755);
+    if (symlink("/run", "/var/run") < 0 && errno != EEXIST) {
+        logf_("symlink /var/run: %s", strerror(errno));
+    }
+    mkdir("/var/log", 0755);
+    mkdir("/run/containerd", 0711);
+
+    // Delegate every controller so dockerd can create its own subtree
+    if (write_file("/sys/fs/cgroup/cgroup.subtree_control", "+cpu +cpuset +io +memory +pids") < 0) {
+        logf_("cgroup subtree_control: %s", strerror(errno));
+    }
+}
+
+// ============== Data disk ==============
+
+/* /dev/vdX of the virtio disk with this serial; 0 if there is none */
+static int find_disk(const char *wanted, char *dev, size_t size) {
+    DIR *dir = opendir("/sys/block");
+    if (!dir) {
+        return 0;
+    }
+    int found = 0;
+    struct dirent *entry;
+    while (!found && (entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "vd", 2) != 0) {
+            continue;
+        }
+        char path[PATH_MAX];
+        char serial[64] = "";
+        snprintf(path, sizeof(path), "/sys/block/%s/serial", entry->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        ssize_t n = read(fd, serial, sizeof(serial) - 1);
+        close(fd);
+        if (n > 0) {
+            serial[n] = '\0';
+            serial[strcspn(serial, "\n")] = '\0';
+            if (strcmp(serial, wanted) == 0) {
+                snprintf(dev, size, "/dev/%s", entry->d_name);
+                found = 1;
+            }
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+static int run_wait(const char *path) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(path, path, (char *)NULL);
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0) {
+        return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+/*
+ * Container storage lives on its own virtio disk, so layer extraction
+ * doesn't compete with the OS disk and gets its own filesystem tuning.
+ * containerd's and the stargz snapshotter's state are bind-mounted from
+ * it too. Without the disk everything stays on the root filesystem.
+ */
+static void setup_data_disk(void) {
+    char dev[PATH_MAX];
+    if (!find_disk(DATA_DISK_SERIAL, dev, sizeof(dev))) {
+        return;
+    }
+    mkdir("/var/lib", 0755);
+    mkdir(DOCKER_ROOT, 0711);
+    if (mount(dev, DOCKER_ROOT, "ext4", MS_NOATIME, DATA_DISK_OPTS) < 0) {
+        // Blank on first boot: the script formats it and does the mounts
+        if (access(DATA_DISK_SETUP, X_OK) != 0 || run_wait(DATA_DISK_SETUP) < 0) {
+            logf_("data disk %s not usable, keeping %s on the root fs", dev, DOCKER_ROOT);
+        }
+        return;
+    }
+
+    static const char *const state_dirs[] = {"containerd", "containerd-stargz-grpc"};
+    for (size_t i = 0; i < sizeof(state_dirs) / sizeof(state_dirs[0]); i++) {
+        char source[PATH_MAX];
+        char target[PATH_MAX];
+        snprintf(source, sizeof(source), DOCKER_ROOT "/.%s", state_dirs[i]);
+        snprintf(target, sizeof(target), "/var/lib/%s", state_dirs[i]);
+        mkdir(source, 0711);
+        mkdir(target, 0711);
+        if (mount(source, target, NULL, MS_BIND, NULL) < 0) {
+            logf_("bind %s: %s", target, strerror(errno));
+        }
+    }
+    logf_("data disk %s mounted on %s", dev, DOCKER_ROOT);
+}
+
+/*
+ * The scratch disk is blank on every boot, so it always needs mkfs: that
+ * is left to the script. Returns whether it is mounted.
+ */
+static int setup_scratch_disk(void) {
+    char dev[PATH_MAX];
+    if (!find_disk(SCRATCH_DISK_SERIAL, dev, sizeof(dev))) {
+        return 0;
+    }
+    if (access(SCRATCH_DISK_SETUP, X_OK) != 0 || run_wait(SCRATCH_DISK_SETUP) < 0) {
+        logf_("scratch disk %s not usable", dev);
+        return 0;
+    }
+    logf_("scratch disk %s mounted", dev);
+    return 1;
+}
+
+// ============== Hotplug ==============
+
+/*
+ * VmHotplug resizes the guest with virtio-mem and vCPU hotplug; both
+ * arrive offline unless someone onlines them. The kernel command line
+ * has memhp_default_state=online_movable, auto_online_blocks covers a
+ * kernel that ignores it, and the main loop calls online_hotplugged()
+ * for the rest. Movable, so the host can unplug the memory again.
+ */
+static void setup_hotplug(void) {
+    static char *const modprobe_argv[] = {"/sbin/modprobe", "-q", "virtio_mem", NULL};
+    // Built in on the minimal kernel; a modular one has no udev to load it
+    if (access(modprobe_argv[0], X_OK) == 0) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execv(modprobe_argv[0], modprobe_argv);
+            _exit(127);
+        }
+        if (pid > 0) {
+            waitpid(pid, NULL, 0);
+        }
+    }
+    write_file("/sys/devices/system/memory/auto_online_blocks", "online_movable");
+}
+
+/* Bring up offline CPUs and memory blocks; "online" is a no-op for the rest */
+static void online_hotplugged(void) {
+    static const struct {
+        const char *dir, *prefix, *file, *offline, *online;
+    } kinds[] = {
+        {"/sys/devices/system/cpu", "cpu", "online", "0", "1"},
+        {"/sys/devices/system/memory", "memory", "state", "offline", "online_movable"},
+    };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        DIR *dir = opendir(kinds[k].dir);
+        if (!dir) {
+            continue;
+        }
+        size_t prefix_len = strlen(kinds[k].prefix);
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, kinds[k].prefix, prefix_len) != 0 ||
+                entry->d_name[prefix_len] < '0' || entry->d_name[prefix_len] > '9') {
+                continue;
+            }
+            char path[PATH_MAX];
+            char state[32] = "";
+            snprintf(path, sizeof(path), "%s/%s/%s", kinds[k].dir, entry->d_name, kinds[k].file);
+            // cpu0 has no "online" file on x86
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            ssize_t n = read(fd, state, sizeof(state) - 1);
+            close(fd);
+            if (n <= 0) {
+                continue;
+            }
+            state[n] = '\0';
+            state[strcspn(state, "\n")] = '\0';
+            if (strcmp(state, kinds[k].offline) == 0) {
+                if (write_file(path, kinds[k].online) == 0) {
+                    logf_("onlined %s", entry->d_name);
+                } else {
+                    logf_("online %s: %s", entry->d_name, strerror(errno));
+                }
+            }
+        }
+        closedir(dir);
+    }
+}
+
+// ============== Network ==============
+
+static int set_addr(int sock, const char *ifname, unsigned long request, const char *addr) {
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, IFNAMSIZ, "%s", ifname);
+    struct sockaddr_in *sin = (struct sockaddr_in *)&ifr.ifr_addr;
+    sin->sin_family = AF_INET;
+    if (inet_pton(AF_INET, addr, &sin->sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+    return ioctl(sock, request, &ifr);
+}
+
+static int link_up(int sock, const char *ifname) {
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, IFNAMSIZ, "%s", ifname);
+    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
+        return -1;
+    }
+    ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+    return ioctl(sock, SIOCSIFFLAGS, &ifr);
+}
+
+/* Static slirp addressing: no DHCP round trips under emulation */
+static void setup_network(const struct config *cfg) {
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        logf_("socket: %s", strerror(errno));
+        return;
+    }
+
+    if (link_up(sock, "lo") < 0) {
+        logf_("lo up: %s", strerror(errno));
+    }
+
+    char netmask[INET_ADDRSTRLEN];
+    uint32_t mask = cfg->prefix <= 0 ? 0 : htonl(0xffffffffu << (32 - (cfg->prefix > 32 ? 32 : cfg->prefix)));
+    inet_ntop(AF_INET, &mask, netmask, sizeof(netmask));
+
+    if (set_addr(sock, "eth0", SIOCSIFADDR, cfg->ip) < 0 ||
+        set_addr(sock, "eth0", SIOCSIFNETMASK, netmask) < 0 ||
+        link_up(sock, "eth0") < 0) {
+        logf_("eth0 %s/%d: %s", cfg->ip, cfg->prefix, strerror(errno));
+        close(sock);
+        return;
+    }
+
+    struct rtentry route;
+    memset(&route, 0, sizeof(route));
+    struct sockaddr_in *dst = (struct sockaddr_in *)&route.rt_dst;
+    struct sockaddr_in *gw = (struct sockaddr_in *)&route.rt_gateway;
+    struct sockaddr_in *genmask = (struct sockaddr_in *)&route.rt_genmask;
+    dst->sin_family = gw->sin_family = genmask->sin_family = AF_INET;
+    inet_pton(AF_INET, cfg->gateway, &gw->sin_addr);
+    route.rt_flags = RTF_UP | RTF_GATEWAY;
+    route.rt_dev = "eth0";
+    if (ioctl(sock, SIOCADDRT, &route) < 0 && errno != EEXIST) {
+        logf_("default route via %s: %s", cfg->gateway, strerror(errno));
+    }
+    close(sock);
+
+    char resolv[64];
+    snprintf(resolv, sizeof(resolv), "nameserver %s\n", cfg->dns);
+    write_file("/etc/resolv.conf", resolv);
+    write_file("/proc/sys/net/ipv4/ip_forward", "1");
+
+    logf_("eth0 %s/%d via %s", cfg->ip, cfg->prefix, cfg->gateway);
+}
+
+// ============== Services ==============
+
+struct service {
+    const char *name;
+    const char *log_path;
+    char *const *argv;
+    /* Run before exec, in the child; non-zero aborts the start */
+    int (*prepare)(void);
+    pid_t pid;
+    int enabled;
+    int64_t respawn_at;
+    int backoff_ms;
+};
+
+static char *const containerd_argv[] = {"/usr/bin/containerd", NULL};
+static char *const dockerd_argv[] = {
+    DOCKERD, "--containerd=" CONTAINERD_SOCK, NULL};
+/* Without daemon.json (which carries the hosts on a set-up guest) */
+static char *const dockerd_hosts_argv[] = {
+    DOCKERD, "--containerd=" CONTAINERD_SOCK,
+    "-H", "unix://" DOCKER_SOCK, "-H", "tcp://0.0.0.0:2375", NULL};
+/* Lite runtime: the Docker API shim on containerd, same sockets */
+static char *const docker_shim_argv[] = {DOCKER_SHIM, NULL};
+static char *const docker_shim_stargz_argv[] = {DOCKER_SHIM, "-snapshotter", "stargz", NULL};
+/* Lazy pulling: containerd reaches it as the "stargz" proxy plugin */
+static char *const stargz_argv[] = {STARGZ, "--log-level=info", NULL};
+static char *const sshd_argv[] = {"/usr/sbin/sshd", "-D", "-e", NULL};
+/* dockerd only: docker-shim creates bind volume directories itself */
+static char *const scratch_volumes_argv[] = {SCRATCH_DISK_SETUP, "watch", NULL};
+static char *const cgroup_stats_argv[] = {CGROUP_STATS, NULL};
+
+static int sshd_prepare(void) {
+    if (access("/etc/ssh/ssh_host_ed25519_key", F_OK) == 0) {
+        return 0;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/usr/bin/ssh-keygen", "ssh-keygen", "-A", (char *)NULL);
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0) {
+        return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+static struct service services[] = {
+    {"containerd", "/var/log/containerd.log", containerd_argv, NULL, 0, 1, 0, RESPAWN_MIN_MS},
+    {"dockerd", "/var/log/docker.log", dockerd_argv, NULL, 0, 1, 0, RESPAWN_MIN_MS},
+    {"sshd", "/var/log/sshd.log", sshd_argv, sshd_prepare, 0, 0, 0, RESPAWN_MIN_MS},
+    {"stargz", "/var/log/containerd-stargz-grpc.log", stargz_argv, NULL, 0, 0, 0, RESPAWN_MIN_MS},
+    {"scratch-volumes", "/var/log/scratch-volumes.log", scratch_volumes_argv, NULL, 0, 0, 0, RESPAWN_MIN_MS},
+    {"cgroup-stats", "/var/log/cgroup-stats.log", cgroup_stats_argv, NULL, 0, 0, 0, RESPAWN_MIN_MS},
+};
+#define SERVICE_COUNT (sizeof(services) / sizeof(services[0]))
+
+static sigset_t handled_signals;
+
+/* criu check, run alongside the services: -1 unknown, 0 failed, 1 passed */
+static pid_t criu_check_pid = -1;
+static int criu_ok = -1;
+
+static void start_service(struct service *svc) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        logf_("fork %s: %s", svc->name, strerror(errno));
+        svc->respawn_at = now_ms() + svc->backoff_ms;
+        return;
+    }
+    if (pid == 0) {
+        sigprocmask(SIG_UNBLOCK, &handled_signals, NULL);
+        setsid();
+        int fd = open(svc->log_path, O_WRONLY | O_CREAT | O_APPEND, 0640);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        int null = open("/dev/null", O_RDONLY);
+        if (null >= 0) {
+            dup2(null, STDIN_FILENO);
+            close(null);
+        }
+        if (svc->prepare && svc->prepare() != 0) {
+            _exit(126);
+        }
+        char *const envp[] = {ENV_PATH, "HOME=/root", NULL};
+        execve(svc->argv[0], svc->argv, envp);
+        _exit(127);
+    }
+    svc->pid = pid;
+    svc->respawn_at = 0;
+    logf_("started %s (pid %d)", svc->name, (int)pid);
+}
+
+static struct service *service_for(pid_t pid) {
+    for (size_t i = 0; i < SERVICE_COUNT; i++) {
+        if (services[i].pid == pid) {
+            return &services[i];
+        }
+    }
+    return NULL;
+}
+
+/* Reap everything: services get scheduled for respawn, orphans just go */
+static void reap_children(int stopping) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        if (pid == criu_check_pid) {
+            criu_ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            criu_check_pid = -1;
+            continue;
+        }
+        struct service *svc = service_for(pid);
+        if (!svc) {
+            continue;
+        }
+        svc->pid = 0;
+        if (stopping) {
+            continue;
+        }
+        if (WIFEXITED(status)) {
+            logf_("%s exited with %d, restarting in %d ms", svc->name, WEXITSTATUS(status), svc->backoff_ms);
+        } else {
+            logf_("%s killed by signal %d, restarting in %d ms", svc->name,
+                  WIFSIGNALED(status) ? WTERMSIG(status) : 0, svc->backoff_ms);
+        }
+        svc->respawn_at = now_ms() + svc->backoff_ms;
+        svc->backoff_ms = svc->backoff_ms * 2 > RESPAWN_MAX_MS ? RESPAWN_MAX_MS : svc->backoff_ms * 2;
+    }
+}
+
+// ============== Host signalling ==============
+
+/* devtmpfs has no /dev/virtio-ports symlinks without udev/mdev: match by name */
+static int open_heartbeat_port(void) {
+    DIR *dir = opendir("/sys/class/virtio-ports");
+    if (!dir) {
+        return -1;
+    }
+    int fd = -1;
+    struct dirent *entry;
+    while (fd < 0 && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[300];
+        char name[128] = {0};
+        snprintf(path, sizeof(path), "/sys/class/virtio-ports/%s/name", entry->d_name);
+        int nfd = open(path, O_RDONLY | O_CLOEXEC);
+        if (nfd < 0) {
+            continue;
+        }
+        ssize_t n = read(nfd, name, sizeof(name) - 1);
+        close(nfd);
+        if (n > 0 && strncmp(name, HEARTBEAT_PORT, strlen(HEARTBEAT_PORT)) == 0) {
+            snprintf(path, sizeof(path), "/dev/%s", entry->d_name);
+            fd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        }
+    }
+    closedir(dir);
+    return fd;
+}
+
+/* Same line format as heartbeat.start: "<uptime> <load1> <load5> <load15>" */
+static void send_heartbeat(int port, const char *prefix) {
+    char uptime[64] = {0};
+    char loadavg[64] = {0};
+    int fd = open("/proc/uptime", O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ssize_t ignored = read(fd, uptime, sizeof(uptime) - 1);
+        (void)ignored;
+        close(fd);
+    }
+    fd = open("/proc/loadavg", O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ssize_t ignored = read(fd, loadavg, sizeof(loadavg) - 1);
+        (void)ignored;
+        close(fd);
+    }
+    uptime[strcspn(uptime, " \n")] = '\0';
+
+    char line[160];
+    int n;
+    if (prefix) {
+        n = snprintf(line, sizeof(line), "%s %s appliance%s\n", prefix, uptime,
+                     criu_ok == 1 ? " criu" : criu_ok == 0 ? " no-criu" : "");
+    } else {
+        // First three loadavg fields
+        char *p = loadavg;
+        for (int spaces = 0; *p && spaces < 3; p++) {
+            if (*p == ' ' && ++spaces == 3) {
+                *p = '\0';
+            }
+        }
+        n = snprintf(line, sizeof(line), "%s %s\n", uptime, loadavg);
+    }
+    // Non-blocking: a host that isn't reading must not stall PID 1
+    ssize_t ignored = write(port, line, n);
+    (void)ignored;
+}
+
+/* GET /_ping on the Docker socket; 1 once the daemon answers 200 */
+static int docker_ready(void) {
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return 0;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", DOCKER_SOCK);
+
+    int ready = 0;
+    struct timeval timeout = {1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        static const char request[] = "GET /_ping HTTP/1.0\r\n\r\n";
+        char response[32] = {0};
+        if (write(sock, request, sizeof(request) - 1) == (ssize_t)(sizeof(request) - 1) &&
+            read(sock, response, sizeof(response) - 1) > 12) {
+            ready = strncmp(response + 9, "200", 3) == 0;
+        }
+    }
+    close(sock);
+    return ready;
+}
+
+// ============== Shutdown ==============
+
+static void stop_services(int sfd) {
+    // dockerd first: it stops containers through containerd
+    for (int phase = 0; phase < 2; phase++) {
+        for (size_t i = 0; i < SERVICE_COUNT; i++) {
+            int is_containerd = strcmp(services[i].name, "containerd") == 0;
+            if (services[i].pid > 0 && is_containerd == phase) {
+                kill(services[i].pid, SIGTERM);
+            }
+        }
+        int64_t deadline = now_ms() + STOP_TIMEOUT_MS;
+        for (;;) {
+            reap_children(1);
+            int running = 0;
+            for (size_t i = 0; i < SERVICE_COUNT; i++) {
+                int is_containerd = strcmp(services[i].name, "containerd") == 0;
+                running |= services[i].pid > 0 && is_containerd == phase;
+            }
+            int64_t left = deadline - now_ms();
+            if (!running || left <= 0) {
+                break;
+            }
+            struct pollfd pfd = {sfd, POLLIN, 0};
+            if (poll(&pfd, 1, (int)(left > 200 ? 200 : left)) > 0) {
+                struct signalfd_siginfo info;
+                ssize_t ignored = read(sfd, &info, sizeof(info));
+                (void)ignored;
+            }
+        }
+    }
+    kill(-1, SIGKILL);
+    reap_children(1);
+}
+
+static void power_off(int sfd, int restart) {
+    logf_("shutting down");
+    stop_services(sfd);
+    sync();
+    umount2("/sys/fs/cgroup", MNT_DETACH);
+    // Leaves the data disk's journal clean; harmless if it isn't mounted
+    mount(NULL, DOCKER_ROOT, NULL, MS_REMOUNT | MS_RDONLY, NULL);
+    mount(NULL, "/", NULL, MS_REMOUNT | MS_RDONLY, NULL);
+    sync();
+    reboot(restart ? RB_AUTOBOOT : RB_POWER_OFF);
+    for (;;) {
+        pause();
+    }
+}
+
+// ============== Main loop ==============
+
+int main(int argc, char **argv) {
+    (void)argc;
+
+    if (getpid() != 1) {
+        fprintf(stderr, "%s: must run as PID 1\n", argv[0]);
+        return 1;
+    }
+
+    int console = open("/dev/console", O_RDWR | O_NOCTTY);
+    if (console >= 0) {
+        dup2(console, STDIN_FILENO);
+        dup2(console, STDOUT_FILENO);
+        dup2(console, STDERR_FILENO);
+        if (console > STDERR_FILENO) {
+            close(console);
+        }
+    }
+
+    // Nothing set up yet: let OpenRC handle guests without Docker
+    if (access("/usr/bin/containerd", X_OK) != 0 ||
+        (access(DOCKERD, X_OK) != 0 && access(DOCKER_SHIM, X_OK) != 0)) {
+        logf_("containerd/dockerd not installed, handing over to /sbin/init");
+        execl("/sbin/init", "init", (char *)NULL);
+        logf_("exec /sbin/init: %s", strerror(errno));
+    }
+
+    sigemptyset(&handled_signals);
+    sigaddset(&handled_signals, SIGCHLD);
+    sigaddset(&handled_signals, SIGTERM);
+    sigaddset(&handled_signals, SIGPWR);
+    sigaddset(&handled_signals, SIGINT);
+    sigaddset(&handled_signals, SIGUSR1);
+    sigaddset(&handled_signals, SIGUSR2);
+    sigprocmask(SIG_BLOCK, &handled_signals, NULL);
+    int sfd = signalfd(-1, &handled_signals, SFD_CLOEXEC);
+
+    // Ctrl-Alt-Del becomes SIGINT instead of an immediate reboot
+    reboot(RB_DISABLE_CAD);
+
+    setup_filesystems();
+    setup_data_disk();
+    int scratch = setup_scratch_disk();
+    setup_hotplug();
+    online_hotplugged();
+    sethostname(HOSTNAME, strlen(HOSTNAME));
+    write_file("/etc/hostname", HOSTNAME "\n");
+
+    struct config cfg;
+    read_config(&cfg);
+    setup_network(&cfg);
+
+    // Either runtime answers on the same sockets; use whichever is there
+    if (cfg.lite && access(DOCKER_SHIM, X_OK) != 0) {
+        logf_("docker-shim not installed, using dockerd");
+        cfg.lite = 0;
+    } else if (!cfg.lite && access(DOCKERD, X_OK) != 0) {
+        logf_("dockerd not installed, using docker-shim");
+        cfg.lite = 1;
+    }
+    if (cfg.stargz && (!cfg.lite || access(STARGZ, X_OK) != 0)) {
+        logf_("stargz snapshotter needs the lite runtime and " STARGZ ", pulling eagerly");
+        cfg.stargz = 0;
+    }
+    if (cfg.lite) {
+        services[1].name = "docker-shim";
+        services[1].log_path = "/var/log/docker-shim.log";
+        services[1].argv = cfg.stargz ? docker_shim_stargz_argv : docker_shim_argv;
+    } else if (access("/etc/docker/daemon.json", F_OK) != 0) {
+        services[1].argv = dockerd_hosts_argv;
+    }
+    services[2].enabled = cfg.sshd && access(sshd_argv[0], X_OK) == 0;
+    services[3].enabled = cfg.stargz;
+    services[4].enabled = scratch && !cfg.lite;
+    services[5].enabled = access(CGROUP_STATS, X_OK) == 0;
+
+    // Kernels built without criu.config can't checkpoint; the app hides
+    // the action when this fails
+    if (access(CRIU, X_OK) == 0) {
+        criu_check_pid = fork();
+        if (criu_check_pid == 0) {
+            sigprocmask(SIG_UNBLOCK, &handled_signals, NULL);
+            int null = open("/dev/null", O_RDWR);
+            if (null >= 0) {
+                dup2(null, STDOUT_FILENO);
+                dup2(null, STDERR_FILENO);
+            }
+            execl(CRIU, CRIU, "check", (char *)NULL);
+            _exit(127);
+        }
+    } else {
+        criu_ok = 0;
+    }
+
+    // No ordering between them: dockerd retries the containerd socket
+    for (size_t i = 0; i < SERVICE_COUNT; i++) {
+        if (services[i].enabled) {
+            start_service(&services[i]);
+        }
+    }
+
+    int port = open_heartbeat_port();
+    int ready = 0;
+    int64_t next_beat = 0;
+    int64_t next_hotplug = now_ms() + HOTPLUG_POLL_MS;
+
+    for (;;) {
+        int64_t now = now_ms();
+
+        // A live resize from the host shows up here within one poll
+        if (now >= next_hotplug) {
+            online_hotplugged();
+            next_hotplug = now + HOTPLUG_POLL_MS;
+        }
+
+        if (!ready && docker_ready()) {
+            ready = 1;
+            logf_("docker ready");
+            if (port < 0) {
+                port = open_heartbeat_port();
+            }
+            // Done long before dockerd under normal boots; don't report half
+            if (criu_check_pid > 0) {
+                int status;
+                if (waitpid(criu_check_pid, &status, 0) == criu_check_pid) {
+                    criu_ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                }
+                criu_check_pid = -1;
+            }
+            if (port >= 0) {
+                send_heartbeat(port, "ready");
+            }
+            for (size_t i = 0; i < SERVICE_COUNT; i++) {
+                services[i].backoff_ms = RESPAWN_MIN_MS;
+            }
+        }
+        if (ready && port >= 0 && now >= next_beat) {
+            send_heartbeat(port, NULL);
+            next_beat = now + HEARTBEAT_MS;
+        }
+
+        int64_t wake = ready ? next_beat : now + READY_POLL_MS;
+        if (next_hotplug < wake) {
+            wake = next_hotplug;
+        }
+        for (size_t i = 0; i < SERVICE_COUNT; i++) {
+            if (services[i].enabled && services[i].pid == 0) {
+                if (services[i].respawn_at <= now) {
+                    start_service(&services[i]);
+                } else if (services[i].respawn_at < wake) {
+                    wake = services[i].respawn_at;
+                }
+            }
+        }
+
+        int timeout = (int)(wake > now ? wake - now : 0);
+        struct pollfd pfd = {sfd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout) <= 0) {
+            continue;
+        }
+        struct signalfd_siginfo info;
+        if (read(sfd, &info, sizeof(info)) != sizeof(info)) {
+            continue;
+        }
+        switch (info.ssi_signo) {
+        case SIGCHLD:
+            reap_children(0);
+            break;
+        // busybox init's conventions, so the guest's halt/poweroff/reboot work
+        case SIGUSR1:
+        case SIGUSR2:
+        case SIGPWR:
+            power_off(sfd, 0);
+            break;
+        case SIGTERM:
+        case SIGINT:
+            power_off(sfd, 1);
+            break;
+        }
+    }
+}
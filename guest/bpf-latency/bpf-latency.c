@@ -0,0 +1,314 @@
+/**
+ * bpf-latency: per-container latency histograms from eBPF
+ *
+ * Loads latency.bpf.c, keeps its `watched` map in step with the running
+ * containers and, every interval, writes what the probes recorded to
+ * OUTPUT for cgroup-stats to forward to the host, one line per container:
+ *
+ *   H <id> rq=<c0>,<c1>,... io=<c0>,<c1>,... retrans=<n> sys=<total> top=<nr>:<n>,...
+ *
+ *   rq, io    runqueue and block I/O latency, log2 buckets of microseconds
+ *             (bucket n counts [2^n, 2^(n+1)) us), trailing zeros dropped
+ *   retrans   TCP retransmits
+ *   sys       syscalls made, and the TOP_SYSCALLS most frequent by number
+ *
+ * Counts are cumulative since the tracer started, so a line the host
+ * missed costs nothing. cgroup-stats starts this when the host asks for
+ * tracing and stops it with SIGTERM, which detaches every probe.
+ *
+ * Needs a kernel with BTF (/sys/kernel/btf/vmlinux): the stock Alpine
+ * kernel has it; the minimal one only with build-kernel.sh --bpf.
+ *
+ * Usage: bpf-latency [-i interval_ms] [-o output]
+ */
+
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <linux/types.h>
+
+#include "latency.h"
+#include "latency.skel.h"
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+#define DEFAULT_OUTPUT "/run/bpf-latency.txt"
+#define DEFAULT_INTERVAL_MS 5000
+#define MIN_INTERVAL_MS 1000
+#define MAX_DEPTH 3
+#define ID_LEN 64
+#define SHORT_ID_LEN 12
+#define TOP_SYSCALLS 8
+
+struct container {
+    char id[SHORT_ID_LEN + 1];
+    __u64 cgroup;
+    __u64 syscalls;
+    struct {
+        __u32 nr;
+        __u64 count;
+    } top[TOP_SYSCALLS];
+};
+
+static struct container containers[MAX_CGROUPS];
+static size_t container_count;
+static volatile sig_atomic_t stopping;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+static int libbpf_log(enum libbpf_print_level level, const char *fmt, va_list args) {
+    return level == LIBBPF_DEBUG ? 0 : vfprintf(stderr, fmt, args);
+}
+
+// ============== Containers ==============
+
+/* The 64-hex-digit id in a cgroup name, or NULL; same rule as cgroup-stats */
+static const char *container_id(const char *name) {
+    size_t run = 0;
+    for (const char *p = name; *p; p++) {
+        run = isxdigit((unsigned char)*p) && !isupper((unsigned char)*p) ? run + 1 : 0;
+        if (run == ID_LEN && !isxdigit((unsigned char)p[1])) {
+            return p - ID_LEN + 1;
+        }
+    }
+    return NULL;
+}
+
+/* A cgroup's id, as bpf_get_current_cgroup_id() sees it, is its inode */
+static void scan(const char *dir, int depth) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL && container_count < MAX_CGROUPS) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[PATH_MAX];
+        if (snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= (int)sizeof(path)) {
+            continue;
+        }
+        const char *id = container_id(entry->d_name);
+        struct stat st;
+        if (id && stat(path, &st) == 0) {
+            struct container *c = &containers[container_count++];
+            memset(c, 0, sizeof(*c));
+            memcpy(c->id, id, SHORT_ID_LEN);
+            c->cgroup = st.st_ino;
+        } else if (!id && depth < MAX_DEPTH) {
+            scan(path, depth + 1);
+        }
+    }
+    closedir(d);
+}
+
+static struct container *find_container(__u64 cgroup) {
+    for (size_t i = 0; i < container_count; i++) {
+        if (containers[i].cgroup == cgroup) {
+            return &containers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Make `watched` exactly the current containers' cgroups */
+static void sync_watched(int watched_fd) {
+    __u64 key, next;
+    __u64 stale[MAX_CGROUPS];
+    size_t stale_count = 0;
+    int err = bpf_map_get_next_key(watched_fd, NULL, &next);
+    while (err == 0) {
+        key = next;
+        if (!find_container(key) && stale_count < MAX_CGROUPS) {
+            stale[stale_count++] = key;
+        }
+        err = bpf_map_get_next_key(watched_fd, &key, &next);
+    }
+    for (size_t i = 0; i < stale_count; i++) {
+        bpf_map_delete_elem(watched_fd, &stale[i]);
+    }
+    __u8 one = 1;
+    for (size_t i = 0; i < container_count; i++) {
+        bpf_map_update_elem(watched_fd, &containers[i].cgroup, &one, BPF_ANY);
+    }
+}
+
+// ============== Reading the maps ==============
+
+static __u64 sum_percpu(int fd, const void *key, __u64 *values, int cpus) {
+    if (bpf_map_lookup_elem(fd, key, values) != 0) {
+        return 0;
+    }
+    __u64 total = 0;
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        total += values[cpu];
+    }
+    return total;
+}
+
+static void add_top(struct container *c, __u32 nr, __u64 count) {
+    int slot = -1;
+    for (int i = 0; i < TOP_SYSCALLS; i++) {
+        if (slot < 0 || c->top[i].count < c->top[slot].count) {
+            slot = i;
+        }
+    }
+    if (count > c->top[slot].count) {
+        c->top[slot].nr = nr;
+        c->top[slot].count = count;
+    }
+}
+
+static void collect_syscalls(int fd, __u64 *values, int cpus) {
+    struct syscall_key key, next;
+    int err = bpf_map_get_next_key(fd, NULL, &next);
+    while (err == 0) {
+        key = next;
+        struct container *c = find_container(key.cgroup);
+        if (c) {
+            __u64 count = sum_percpu(fd, &key, values, cpus);
+            c->syscalls += count;
+            add_top(c, key.nr, count);
+        } else {
+            // A container that's gone; its entries would fill the map
+            err = bpf_map_get_next_key(fd, &key, &next);
+            bpf_map_delete_elem(fd, &key);
+            continue;
+        }
+        err = bpf_map_get_next_key(fd, &key, &next);
+    }
+}
+
+static void write_hist(FILE *out, const char *name, int fd, __u64 cgroup, __u32 kind) {
+    struct hist_key key = {.cgroup = cgroup, .kind = kind};
+    struct hist hist;
+    int last = -1;
+    if (bpf_map_lookup_elem(fd, &key, &hist) == 0) {
+        for (int i = 0; i < HIST_SLOTS; i++) {
+            if (hist.slots[i]) {
+                last = i;
+            }
+        }
+    }
+    fprintf(out, " %s=", name);
+    for (int i = 0; i <= last; i++) {
+        fprintf(out, i ? ",%llu" : "%llu", (unsigned long long)hist.slots[i]);
+    }
+}
+
+static int write_report(struct latency_bpf *skel, const char *output, __u64 *values, int cpus) {
+    int hists_fd = bpf_map__fd(skel->maps.hists);
+    int retrans_fd = bpf_map__fd(skel->maps.retransmits);
+
+    collect_syscalls(bpf_map__fd(skel->maps.syscalls), values, cpus);
+
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", output);
+    FILE *out = fopen(tmp, "w");
+    if (!out) {
+        return -errno;
+    }
+    for (size_t i = 0; i < container_count; i++) {
+        struct container *c = &containers[i];
+        fprintf(out, "H %s", c->id);
+        write_hist(out, "rq", hists_fd, c->cgroup, KIND_RUNQ);
+        write_hist(out, "io", hists_fd, c->cgroup, KIND_BLOCK_IO);
+        fprintf(out, " retrans=%llu sys=%llu top=",
+                (unsigned long long)sum_percpu(retrans_fd, &c->cgroup, values, cpus),
+                (unsigned long long)c->syscalls);
+        int first = 1;
+        for (int t = 0; t < TOP_SYSCALLS; t++) {
+            if (c->top[t].count) {
+                fprintf(out, first ? "%u:%llu" : ",%u:%llu", c->top[t].nr, (unsigned long long)c->top[t].count);
+                first = 0;
+            }
+        }
+        fputc('\n', out);
+    }
+    if (fclose(out) != 0) {
+        return -errno;
+    }
+    return rename(tmp, output) == 0 ? 0 : -errno;
+}
+
+int main(int argc, char **argv) {
+    int interval_ms = DEFAULT_INTERVAL_MS;
+    const char *output = DEFAULT_OUTPUT;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-i interval_ms] [-o output]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (interval_ms < MIN_INTERVAL_MS) {
+        interval_ms = MIN_INTERVAL_MS;
+    }
+
+    if (access("/sys/kernel/btf/vmlinux", R_OK) != 0) {
+        fprintf(stderr, "bpf-latency: kernel has no BTF (/sys/kernel/btf/vmlinux)\n");
+        return 3;
+    }
+    libbpf_set_print(libbpf_log);
+    signal(SIGTERM, on_signal);
+    signal(SIGINT, on_signal);
+
+    struct latency_bpf *skel = latency_bpf__open_and_load();
+    if (!skel) {
+        fprintf(stderr, "bpf-latency: failed to load probes: %s\n", strerror(errno));
+        return 1;
+    }
+    int err = latency_bpf__attach(skel);
+    if (err) {
+        fprintf(stderr, "bpf-latency: failed to attach probes: %s\n", strerror(-err));
+        latency_bpf__destroy(skel);
+        return 1;
+    }
+
+    int cpus = libbpf_num_possible_cpus();
+    __u64 *values = calloc(cpus > 0 ? cpus : 1, sizeof(__u64));
+    if (cpus <= 0 || !values) {
+        latency_bpf__destroy(skel);
+        return 1;
+    }
+
+    while (!stopping) {
+        container_count = 0;
+        scan(CGROUP_ROOT, 1);
+        sync_watched(bpf_map__fd(skel->maps.watched));
+        err = write_report(skel, output, values, cpus);
+        if (err) {
+            fprintf(stderr, "bpf-latency: writing %s: %s\n", output, strerror(-err));
+        }
+        struct timespec ts = {interval_ms / 1000, (long)(interval_ms % 1000) * 1000000};
+        nanosleep(&ts, NULL);
+    }
+
+    unlink(output);
+    free(values);
+    latency_bpf__destroy(skel);
+    return 0;
+}
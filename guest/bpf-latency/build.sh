@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# ====================================================
+# Build bpf-latency for the x86_64 guest
+# ====================================================
+# Compiles the probes (latency.bpf.c) to BPF, embeds them in a libbpf
+# skeleton and links the loader statically, then stages it in the app
+# assets, from where it is served to the guest over slirp's TFTP server
+# (10.0.2.2) and installed as /usr/local/bin/bpf-latency by
+# alpine-setup.sh. cgroup-stats runs it while the host asks for tracing.
+#
+# Usage:
+#   guest/bpf-latency/build.sh [--no-install]
+#
+# Requires: clang, bpftool, and static libbpf, libelf and zlib for the
+# target (Alpine: clang bpftool libbpf-dev elfutils-dev zlib-static).
+# vmlinux.h is generated from BTF (default the build host's
+# /sys/kernel/btf/vmlinux; CO-RE relocates it to the guest kernel).
+# CC defaults to musl-gcc, then x86_64-linux-musl-gcc, then gcc when the
+# build host is x86_64.
+# ====================================================
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+OUT_DIR="$REPO_ROOT/build/guest/bpf-latency"
+ASSET_DIR="$REPO_ROOT/android/app/src/main/assets/qemu/guest"
+BTF="${BTF:-/sys/kernel/btf/vmlinux}"
+
+INSTALL=1
+[ "${1:-}" = "--no-install" ] && INSTALL=0
+
+for tool in clang bpftool; do
+    command -v "$tool" > /dev/null || { echo "error: $tool not found" >&2; exit 1; }
+done
+[ -r "$BTF" ] || { echo "error: no BTF at $BTF (set BTF to a vmlinux with .BTF)" >&2; exit 1; }
+
+if [ -z "${CC:-}" ]; then
+    for candidate in musl-gcc x86_64-linux-musl-gcc; do
+        if command -v "$candidate" > /dev/null; then
+            CC="$candidate"
+            break
+        fi
+    done
+fi
+if [ -z "${CC:-}" ]; then
+    [ "$(uname -m)" = x86_64 ] || { echo "error: set CC to an x86_64 cross compiler" >&2; exit 1; }
+    CC=gcc
+fi
+
+mkdir -p "$OUT_DIR"
+bpftool btf dump file "$BTF" format c > "$OUT_DIR/vmlinux.h"
+clang -g -O2 -target bpf -D__TARGET_ARCH_x86 -I "$OUT_DIR" \
+    -c "$SCRIPT_DIR/latency.bpf.c" -o "$OUT_DIR/latency.bpf.o"
+bpftool gen skeleton "$OUT_DIR/latency.bpf.o" name latency_bpf > "$OUT_DIR/latency.skel.h"
+
+"$CC" -static -O2 -Wall -Wextra -Werror -I "$OUT_DIR" \
+    -o "$OUT_DIR/bpf-latency" "$SCRIPT_DIR/bpf-latency.c" -lbpf -lelf -lz
+strip "$OUT_DIR/bpf-latency" 2> /dev/null || true
+echo "==> Built $(du -h "$OUT_DIR/bpf-latency" | cut -f1) $OUT_DIR/bpf-latency ($CC)"
+
+if [ "$INSTALL" = 1 ]; then
+    mkdir -p "$ASSET_DIR"
+    cp "$OUT_DIR/bpf-latency" "$ASSET_DIR/bpf-latency"
+    echo "==> Installed into $ASSET_DIR"
+fi
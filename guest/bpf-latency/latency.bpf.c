@@ -0,0 +1,230 @@
+/**
+ * Per-cgroup latency probes, loaded by bpf-latency.c
+ *
+ * Only cgroups listed in `watched` (the containers, kept up to date from
+ * userspace) are recorded, so dockerd, containerd and the collectors
+ * themselves cost a map lookup per event and nothing more.
+ *
+ *   runqueue    wakeup (or preemption) to running, per task's cgroup
+ *   block I/O   request issue to completion, charged to the bio's blkcg
+ *               so writeback lands on the container that dirtied the pages
+ *   retransmits tcp_retransmit_skb, charged to the socket's cgroup
+ *   syscalls    sys_enter counts per syscall number
+ *
+ * CO-RE against the running kernel's BTF; needs 5.14+ (task __state,
+ * single-argument block_rq_issue).
+ */
+
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+
+#include "latency.h"
+
+#define TASK_RUNNING 0
+
+char LICENSE[] SEC("license") = "GPL";
+
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_CGROUPS);
+    __type(key, __u64);
+    __type(value, __u8);
+} watched SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_CGROUPS * KIND_COUNT);
+    __type(key, struct hist_key);
+    __type(value, struct hist);
+} hists SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, MAX_CGROUPS);
+    __type(key, __u64);
+    __type(value, __u64);
+} retransmits SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, MAX_SYSCALL_KEYS);
+    __type(key, struct syscall_key);
+    __type(value, __u64);
+} syscalls SEC(".maps");
+
+/* Enqueue time per pid */
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, 16384);
+    __type(key, __u32);
+    __type(value, __u64);
+} enqueued SEC(".maps");
+
+struct io_start {
+    __u64 ts;
+    __u64 cgroup;
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, 4096);
+    __type(key, struct request *);
+    __type(value, struct io_start);
+} io_starts SEC(".maps");
+
+static struct hist zero_hist;
+
+static __always_inline __u32 log2_32(__u32 v) {
+    __u32 shift, r;
+    r = (v > 0xFFFF) << 4;
+    v >>= r;
+    shift = (v > 0xFF) << 3;
+    v >>= shift;
+    r |= shift;
+    shift = (v > 0xF) << 2;
+    v >>= shift;
+    r |= shift;
+    shift = (v > 0x3) << 1;
+    v >>= shift;
+    r |= shift;
+    r |= (v >> 1);
+    return r;
+}
+
+static __always_inline __u32 log2_64(__u64 v) {
+    __u32 hi = v >> 32;
+    return hi ? log2_32(hi) + 32 : log2_32(v);
+}
+
+static __always_inline int is_watched(__u64 cgroup) {
+    return cgroup && bpf_map_lookup_elem(&watched, &cgroup) != NULL;
+}
+
+static __always_inline __u64 task_cgroup(struct task_struct *task) {
+    return BPF_CORE_READ(task, cgroups, dfl_cgrp, kn, id);
+}
+
+static __always_inline void hist_add(__u64 cgroup, __u32 kind, __u64 delta_ns) {
+    struct hist_key key = {.cgroup = cgroup, .kind = kind};
+    struct hist *hist = bpf_map_lookup_elem(&hists, &key);
+    if (!hist) {
+        bpf_map_update_elem(&hists, &key, &zero_hist, BPF_NOEXIST);
+        hist = bpf_map_lookup_elem(&hists, &key);
+        if (!hist) {
+            return;
+        }
+    }
+    __u32 slot = log2_64(delta_ns / 1000);
+    if (slot >= HIST_SLOTS) {
+        slot = HIST_SLOTS - 1;
+    }
+    __sync_fetch_and_add(&hist->slots[slot], 1);
+}
+
+// ============== Runqueue latency ==============
+
+static __always_inline int mark_enqueued(struct task_struct *task) {
+    if (!is_watched(task_cgroup(task))) {
+        return 0;
+    }
+    __u32 pid = BPF_CORE_READ(task, pid);
+    __u64 ts = bpf_ktime_get_ns();
+    bpf_map_update_elem(&enqueued, &pid, &ts, BPF_ANY);
+    return 0;
+}
+
+SEC("tp_btf/sched_wakeup")
+int BPF_PROG(sched_wakeup, struct task_struct *task) {
+    return mark_enqueued(task);
+}
+
+SEC("tp_btf/sched_wakeup_new")
+int BPF_PROG(sched_wakeup_new, struct task_struct *task) {
+    return mark_enqueued(task);
+}
+
+SEC("tp_btf/sched_switch")
+int BPF_PROG(sched_switch, bool preempt, struct task_struct *prev, struct task_struct *next) {
+    // Preempted while runnable: it waits on the runqueue again
+    if (BPF_CORE_READ(prev, __state) == TASK_RUNNING) {
+        mark_enqueued(prev);
+    }
+    __u32 pid = BPF_CORE_READ(next, pid);
+    __u64 *ts = bpf_map_lookup_elem(&enqueued, &pid);
+    if (!ts) {
+        return 0;
+    }
+    __u64 delta = bpf_ktime_get_ns() - *ts;
+    bpf_map_delete_elem(&enqueued, &pid);
+    hist_add(task_cgroup(next), KIND_RUNQ, delta);
+    return 0;
+}
+
+// ============== Block I/O latency ==============
+
+SEC("tp_btf/block_rq_issue")
+int BPF_PROG(block_rq_issue, struct request *rq) {
+    __u64 cgroup = BPF_CORE_READ(rq, bio, bi_blkg, blkcg, css.cgroup, kn, id);
+    if (!cgroup) {
+        cgroup = bpf_get_current_cgroup_id();
+    }
+    if (!is_watched(cgroup)) {
+        return 0;
+    }
+    struct io_start start = {.ts = bpf_ktime_get_ns(), .cgroup = cgroup};
+    bpf_map_update_elem(&io_starts, &rq, &start, BPF_ANY);
+    return 0;
+}
+
+SEC("tp_btf/block_rq_complete")
+int BPF_PROG(block_rq_complete, struct request *rq, int error, unsigned int nr_bytes) {
+    struct io_start *start = bpf_map_lookup_elem(&io_starts, &rq);
+    if (!start) {
+        return 0;
+    }
+    __u64 delta = bpf_ktime_get_ns() - start->ts;
+    __u64 cgroup = start->cgroup;
+    bpf_map_delete_elem(&io_starts, &rq);
+    hist_add(cgroup, KIND_BLOCK_IO, delta);
+    return 0;
+}
+
+// ============== TCP retransmits ==============
+
+SEC("tp_btf/tcp_retransmit_skb")
+int BPF_PROG(tcp_retransmit_skb, const struct sock *sk, const struct sk_buff *skb) {
+    // Retransmits fire from timers in softirq: the socket knows its cgroup
+    __u64 cgroup = BPF_CORE_READ(sk, sk_cgrp_data.cgroup, kn, id);
+    if (!is_watched(cgroup)) {
+        return 0;
+    }
+    __u64 *count = bpf_map_lookup_elem(&retransmits, &cgroup);
+    if (count) {
+        (*count)++;
+    } else {
+        __u64 one = 1;
+        bpf_map_update_elem(&retransmits, &cgroup, &one, BPF_NOEXIST);
+    }
+    return 0;
+}
+
+// ============== Syscalls ==============
+
+SEC("tp_btf/sys_enter")
+int BPF_PROG(sys_enter, struct pt_regs *regs, long id) {
+    __u64 cgroup = bpf_get_current_cgroup_id();
+    if (!is_watched(cgroup)) {
+        return 0;
+    }
+    struct syscall_key key = {.cgroup = cgroup, .nr = (__u32)id};
+    __u64 *count = bpf_map_lookup_elem(&syscalls, &key);
+    if (count) {
+        (*count)++;
+    } else {
+        __u64 one = 1;
+        bpf_map_update_elem(&syscalls, &key, &one, BPF_NOEXIST);
+    }
+    return 0;
+}
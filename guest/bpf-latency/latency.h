@@ -0,0 +1,34 @@
+/**
+ * Map layouts shared by latency.bpf.c and bpf-latency.c
+ */
+
+#ifndef BPF_LATENCY_H
+#define BPF_LATENCY_H
+
+#define KIND_RUNQ 0
+#define KIND_BLOCK_IO 1
+#define KIND_COUNT 2
+
+/* log2 buckets of microseconds: slot n counts [2^n, 2^(n+1)) us, up to ~67 s */
+#define HIST_SLOTS 27
+
+#define MAX_CGROUPS 256
+#define MAX_SYSCALL_KEYS 16384
+
+struct hist_key {
+    __u64 cgroup;
+    __u32 kind;
+    __u32 pad;
+};
+
+struct hist {
+    __u64 slots[HIST_SLOTS];
+};
+
+struct syscall_key {
+    __u64 cgroup;
+    __u32 nr;
+    __u32 pad;
+};
+
+#endif
@@ -0,0 +1,576 @@
+/**
+ * cgroup-stats: resource usage of every container, in one pass
+ *
+ * Docker's /containers/{id}/stats costs dockerd a sampling round per
+ * container and per request. This reads the cgroup v2 files directly for
+ * all containers at once and streams the numbers to the host over the
+ * org.dockerandroid.stats virtio-serial port:
+ *
+ *   cpu.stat       usage_usec
+ *   memory.current, memory.stat inactive_file, memory.max
+ *   io.stat        rbytes and wbytes summed over devices
+ *   pids.current
+ *   /proc/<pid>/net/dev of the container's first process, all
+ *                  interfaces but lo (host-network containers report the
+ *                  guest's totals)
+ *
+ * Containers are the cgroups, up to three levels below /sys/fs/cgroup,
+ * whose name holds a 64-hex-digit id: docker/<id> for dockerd,
+ * <namespace>/<id> for containerd, docker-<id>.scope with systemd.
+ *
+ * One line per frame, fields separated by spaces:
+ *
+ *   K <seq> <uptime_ms> <id>=<v0>,<v1>,...,<v8> ...
+ *   D <seq> <uptime_ms> <slot>=<d0>,<d1>,...,<d8> ...
+ *
+ * The nine values are in the order listed above, with network rx then
+ * tx after pids: cpu_usec, memory, inactive_file, memory_max (0 for no
+ * limit), io_read, io_write, pids, net_rx, net_tx. A key frame (K)
+ * carries every container with absolute values under its 12-digit short
+ * id. A delta frame (D) carries only the containers whose values changed,
+ * by their position (slot) in the last key frame, as differences from
+ * the previous frame. Zero differences are left empty and trailing empty
+ * fields dropped, so an idle container costs nothing and a busy one a few
+ * bytes. A key frame follows whenever the set of containers changes, every
+ * KEYFRAME_EVERY frames, and after a write was lost, so a reader that
+ * misses a frame (seq gap) waits for the next one.
+ *
+ * Nothing is sampled while the host isn't reading the port. The host may
+ * write "interval <ms>\n" to change the cadence (default 2 s).
+ *
+ * "trace on\n" starts bpf-latency (latency histograms from eBPF, see
+ * guest/bpf-latency) and "trace off\n" stops it, as does the host going
+ * away. Its report is forwarded as-is whenever it changes, H lines the
+ * frame decoder skips without losing sync, and its state as
+ *
+ *   T on | T off <exit status> | T unavailable
+ *
+ * Usage: cgroup-stats [-i interval_ms]
+ */
+
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STATS_PORT "org.dockerandroid.stats"
+#define CGROUP_ROOT "/sys/fs/cgroup"
+#define MAX_CONTAINERS 128
+#define MAX_DEPTH 3
+#define ID_LEN 64
+#define SHORT_ID_LEN 12
+#define NUM_VALUES 9
+#define KEYFRAME_EVERY 30
+#define DEFAULT_INTERVAL_MS 2000
+#define MIN_INTERVAL_MS 250
+#define MAX_INTERVAL_MS 60000
+#define RECONNECT_MS 2000
+#define TRACER "/usr/local/bin/bpf-latency"
+#define TRACER_OUTPUT "/run/bpf-latency.txt"
+
+struct container {
+    char id[SHORT_ID_LEN + 1];
+    char path[PATH_MAX];
+    int64_t values[NUM_VALUES];
+};
+
+struct sample {
+    struct container items[MAX_CONTAINERS];
+    size_t count;
+};
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ============== Reading cgroup files ==============
+
+/* Whole small file into buf, NUL-terminated; -1 if it can't be read */
+static ssize_t read_text(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    size_t len = 0;
+    while (len < size - 1) {
+        ssize_t n = read(fd, buf + len, size - 1 - len);
+        if (n <= 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    close(fd);
+    buf[len] = '\0';
+    return (ssize_t)len;
+}
+
+static int64_t read_number(const char *dir, const char *file) {
+    char path[PATH_MAX + 32];
+    char buf[64];
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    if (read_text(path, buf, sizeof(buf)) <= 0 || strncmp(buf, "max", 3) == 0) {
+        return 0;
+    }
+    return strtoll(buf, NULL, 10);
+}
+
+/* "key value" line of a flat-keyed file such as cpu.stat */
+static int64_t read_key(const char *dir, const char *file, const char *key) {
+    char path[PATH_MAX + 32];
+    char buf[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    if (read_text(path, buf, sizeof(buf)) <= 0) {
+        return 0;
+    }
+    size_t klen = strlen(key);
+    for (char *line = buf; line && *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+        if (strncmp(line, key, klen) == 0 && line[klen] == ' ') {
+            return strtoll(line + klen + 1, NULL, 10);
+        }
+    }
+    return 0;
+}
+
+/* io.stat: "<maj>:<min> rbytes=N wbytes=N rios=N ..." per device */
+static void read_io(const char *dir, int64_t *rbytes, int64_t *wbytes) {
+    char path[PATH_MAX + 32];
+    char buf[4096];
+    *rbytes = *wbytes = 0;
+    snprintf(path, sizeof(path), "%s/io.stat", dir);
+    if (read_text(path, buf, sizeof(buf)) <= 0) {
+        return;
+    }
+    for (char *p = buf; (p = strstr(p, " rbytes=")) != NULL; p += 8) {
+        *rbytes += strtoll(p + 8, NULL, 10);
+    }
+    for (char *p = buf; (p = strstr(p, " wbytes=")) != NULL; p += 8) {
+        *wbytes += strtoll(p + 8, NULL, 10);
+    }
+}
+
+/* Network namespace counters, through the container's first process */
+static void read_net(const char *dir, int64_t *rx, int64_t *tx) {
+    char path[PATH_MAX + 32];
+    char buf[4096];
+    *rx = *tx = 0;
+    snprintf(path, sizeof(path), "%s/cgroup.procs", dir);
+    if (read_text(path, buf, 32) <= 0) {
+        return;
+    }
+    long pid = strtol(buf, NULL, 10);
+    if (pid <= 0) {
+        return;
+    }
+    snprintf(path, sizeof(path), "/proc/%ld/net/dev", pid);
+    if (read_text(path, buf, sizeof(buf)) <= 0) {
+        return;
+    }
+    // Two header lines, then "  iface: rx_bytes packets ... tx_bytes ..."
+    char *line = strchr(buf, '\n');
+    line = line ? strchr(line + 1, '\n') : NULL;
+    while (line && *++line) {
+        char *colon = strchr(line, ':');
+        char *end = strchr(line, '\n');
+        if (!colon || (end && colon > end)) {
+            break;
+        }
+        char *name = line;
+        while (*name == ' ') {
+            name++;
+        }
+        if (strncmp(name, "lo:", 3) != 0) {
+            char *p = colon + 1;
+            // rx_bytes is field 0, tx_bytes field 8
+            for (int field = 0; field <= 8; field++) {
+                int64_t value = strtoll(p, &p, 10);
+                if (field == 0) {
+                    *rx += value;
+                } else if (field == 8) {
+                    *tx += value;
+                }
+            }
+        }
+        line = end;
+    }
+}
+
+static void read_container(struct container *c) {
+    int64_t *v = c->values;
+    v[0] = read_key(c->path, "cpu.stat", "usage_usec");
+    v[1] = read_number(c->path, "memory.current");
+    v[2] = read_key(c->path, "memory.stat", "inactive_file");
+    v[3] = read_number(c->path, "memory.max");
+    read_io(c->path, &v[4], &v[5]);
+    v[6] = read_number(c->path, "pids.current");
+    read_net(c->path, &v[7], &v[8]);
+}
+
+// ============== Finding containers ==============
+
+/* The 64-hex-digit id in a cgroup name, or NULL */
+static const char *container_id(const char *name) {
+    size_t run = 0;
+    for (const char *p = name; *p; p++) {
+        run = isxdigit((unsigned char)*p) && !isupper((unsigned char)*p) ? run + 1 : 0;
+        if (run == ID_LEN && !isxdigit((unsigned char)p[1])) {
+            return p - ID_LEN + 1;
+        }
+    }
+    return NULL;
+}
+
+static void scan(const char *dir, int depth, struct sample *out) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL && out->count < MAX_CONTAINERS) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[PATH_MAX];
+        if (snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= (int)sizeof(path)) {
+            continue;
+        }
+        const char *id = container_id(entry->d_name);
+        if (id) {
+            struct container *c = &out->items[out->count++];
+            memcpy(c->id, id, SHORT_ID_LEN);
+            c->id[SHORT_ID_LEN] = '\0';
+            memcpy(c->path, path, sizeof(path));
+            read_container(c);
+        } else if (depth < MAX_DEPTH) {
+            scan(path, depth + 1, out);
+        }
+    }
+    closedir(d);
+}
+
+// ============== Frames ==============
+
+struct line {
+    char buf[MAX_CONTAINERS * (SHORT_ID_LEN + NUM_VALUES * 21 + 2) + 64];
+    size_t len;
+};
+
+static void append(struct line *l, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void append(struct line *l, const char *fmt, ...) {
+    if (l->len >= sizeof(l->buf)) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(l->buf + l->len, sizeof(l->buf) - l->len, fmt, ap);
+    va_end(ap);
+    if (n > 0) {
+        l->len += (size_t)n;
+    }
+    if (l->len > sizeof(l->buf) - 1) {
+        l->len = sizeof(l->buf) - 1;
+    }
+}
+
+static int same_containers(const struct sample *a, const struct sample *b) {
+    if (a->count != b->count) {
+        return 0;
+    }
+    for (size_t i = 0; i < a->count; i++) {
+        if (strcmp(a->items[i].id, b->items[i].id) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void key_frame(struct line *l, uint64_t seq, int64_t t, const struct sample *cur) {
+    append(l, "K %llu %lld", (unsigned long long)seq, (long long)t);
+    for (size_t i = 0; i < cur->count; i++) {
+        const struct container *c = &cur->items[i];
+        append(l, " %s=", c->id);
+        for (int v = 0; v < NUM_VALUES; v++) {
+            append(l, v ? ",%lld" : "%lld", (long long)c->values[v]);
+        }
+    }
+    append(l, "\n");
+}
+
+static void delta_frame(struct line *l, uint64_t seq, int64_t t, const struct sample *prev, const struct sample *cur) {
+    append(l, "D %llu %lld", (unsigned long long)seq, (long long)t);
+    for (size_t i = 0; i < cur->count; i++) {
+        int64_t d[NUM_VALUES];
+        int last = -1;
+        for (int v = 0; v < NUM_VALUES; v++) {
+            d[v] = cur->items[i].values[v] - prev->items[i].values[v];
+            if (d[v] != 0) {
+                last = v;
+            }
+        }
+        if (last < 0) {
+            continue;
+        }
+        append(l, " %zu=", i);
+        for (int v = 0; v <= last; v++) {
+            if (v) {
+                append(l, ",");
+            }
+            if (d[v] != 0) {
+                append(l, "%lld", (long long)d[v]);
+            }
+        }
+    }
+    append(l, "\n");
+}
+
+// ============== Port ==============
+
+/* devtmpfs has no /dev/virtio-ports symlinks without udev/mdev: match by name */
+static int open_stats_port(void) {
+    DIR *dir = opendir("/sys/class/virtio-ports");
+    if (!dir) {
+        return -1;
+    }
+    int fd = -1;
+    struct dirent *entry;
+    while (fd < 0 && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[300];
+        char name[128];
+        snprintf(path, sizeof(path), "/sys/class/virtio-ports/%s/name", entry->d_name);
+        if (read_text(path, name, sizeof(name)) > 0 && strncmp(name, STATS_PORT, strlen(STATS_PORT)) == 0) {
+            snprintf(path, sizeof(path), "/dev/%s", entry->d_name);
+            fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        }
+    }
+    closedir(dir);
+    return fd;
+}
+
+/* One whole line or nothing a reader could mistake for one */
+static int write_line(int port, const char *buf, size_t len) {
+    ssize_t written = write(port, buf, len);
+    if (written == (ssize_t)len) {
+        return 0;
+    }
+    // The newline ends a torn line so it can't merge with the next
+    if (written > 0) {
+        ssize_t ignored = write(port, "\n", 1);
+        (void)ignored;
+    }
+    return -1;
+}
+
+/* "interval <ms>" and "trace on|off" lines from the host */
+static void read_commands(int port, int *interval_ms, int *trace) {
+    char buf[256];
+    ssize_t n = read(port, buf, sizeof(buf) - 1);
+    if (n <= 0) {
+        return;
+    }
+    buf[n] = '\0';
+    for (char *p = buf; (p = strstr(p, "interval ")) != NULL; p += 9) {
+        long ms = strtol(p + 9, NULL, 10);
+        if (ms > 0) {
+            *interval_ms = ms < MIN_INTERVAL_MS ? MIN_INTERVAL_MS : ms > MAX_INTERVAL_MS ? MAX_INTERVAL_MS : (int)ms;
+        }
+    }
+    for (char *p = buf; (p = strstr(p, "trace o")) != NULL; p += 7) {
+        if (strncmp(p + 7, "n", 1) == 0) {
+            *trace = 1;
+        } else if (strncmp(p + 7, "ff", 2) == 0) {
+            *trace = 0;
+        }
+    }
+}
+
+// ============== Tracer ==============
+
+static pid_t tracer;
+static struct timespec tracer_mtime;
+
+static void trace_status(int port, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void trace_status(int port, const char *fmt, ...) {
+    char buf[64];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (port >= 0 && n > 0 && (size_t)n < sizeof(buf)) {
+        write_line(port, buf, (size_t)n);
+    }
+}
+
+static void start_tracer(int port) {
+    if (access(TRACER, X_OK) != 0) {
+        trace_status(port, "T unavailable\n");
+        return;
+    }
+    unlink(TRACER_OUTPUT);
+    memset(&tracer_mtime, 0, sizeof(tracer_mtime));
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Probes stay attached as long as the loader lives; don't outlive us
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        execl(TRACER, "bpf-latency", "-o", TRACER_OUTPUT, (char *)NULL);
+        _exit(127);
+    }
+    if (pid < 0) {
+        trace_status(port, "T unavailable\n");
+        return;
+    }
+    tracer = pid;
+    trace_status(port, "T on\n");
+}
+
+static void stop_tracer(void) {
+    if (tracer > 0) {
+        kill(tracer, SIGTERM);
+        waitpid(tracer, NULL, 0);
+        tracer = 0;
+    }
+}
+
+/* Reports a tracer that exited on its own (no BTF, probes failed to load) */
+static int reap_tracer(int port) {
+    int status;
+    if (tracer <= 0 || waitpid(tracer, &status, WNOHANG) != tracer) {
+        return 0;
+    }
+    tracer = 0;
+    trace_status(port, "T off %d\n", WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+    return 1;
+}
+
+/* The tracer's report, whenever it has written a new one */
+static void forward_report(int port) {
+    static char report[256 * 1024];
+    struct stat st;
+    if (tracer <= 0 || stat(TRACER_OUTPUT, &st) != 0) {
+        return;
+    }
+    if (st.st_mtim.tv_sec == tracer_mtime.tv_sec && st.st_mtim.tv_nsec == tracer_mtime.tv_nsec) {
+        return;
+    }
+    ssize_t len = read_text(TRACER_OUTPUT, report, sizeof(report));
+    if (len > 0 && write_line(port, report, (size_t)len) == 0) {
+        tracer_mtime = st.st_mtim;
+    }
+}
+
+int main(int argc, char **argv) {
+    int interval_ms = DEFAULT_INTERVAL_MS;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:")) != -1) {
+        if (opt == 'i') {
+            interval_ms = atoi(optarg);
+        } else {
+            fprintf(stderr, "usage: %s [-i interval_ms]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (interval_ms < MIN_INTERVAL_MS) {
+        interval_ms = MIN_INTERVAL_MS;
+    }
+
+    static struct sample samples[2];
+    static struct line line;
+    struct sample *prev = &samples[0];
+    struct sample *cur = &samples[1];
+    uint64_t seq = 0;
+    uint64_t since_key = KEYFRAME_EVERY;
+    int port = -1;
+    int trace = 0;
+
+    for (;;) {
+        if (port < 0 && (port = open_stats_port()) < 0) {
+            usleep(RECONNECT_MS * 1000);
+            continue;
+        }
+
+        // The port reports POLLHUP until the host connects; don't sample
+        // for nobody
+        struct pollfd pfd = {port, POLLOUT, 0};
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            close(port);
+            port = -1;
+            continue;
+        }
+        if (!(pfd.revents & POLLOUT)) {
+            // Nobody to report to: the next host asks again if it wants it
+            trace = 0;
+            stop_tracer();
+            since_key = KEYFRAME_EVERY;
+            usleep(RECONNECT_MS * 1000);
+            continue;
+        }
+        int64_t started = now_ms();
+
+        cur->count = 0;
+        scan(CGROUP_ROOT, 1, cur);
+        line.len = 0;
+        if (since_key >= KEYFRAME_EVERY || !same_containers(prev, cur)) {
+            key_frame(&line, seq, started, cur);
+            since_key = 0;
+        } else {
+            delta_frame(&line, seq, started, prev, cur);
+        }
+
+        if (write_line(port, line.buf, line.len) == 0) {
+            seq++;
+            since_key++;
+            struct sample *tmp = prev;
+            prev = cur;
+            cur = tmp;
+        } else {
+            // The host went away mid-frame; start the next reader afresh
+            since_key = KEYFRAME_EVERY;
+        }
+        if (reap_tracer(port)) {
+            trace = 0;
+        }
+        forward_report(port);
+
+        // Sleep out the interval, taking cadence changes from the host
+        for (;;) {
+            int64_t left = started + interval_ms - now_ms();
+            if (left <= 0) {
+                break;
+            }
+            struct pollfd in = {port, POLLIN, 0};
+            if (poll(&in, 1, (int)left) > 0 && (in.revents & POLLIN)) {
+                read_commands(port, &interval_ms, &trace);
+                if (trace && tracer <= 0) {
+                    start_tracer(port);
+                    trace = tracer > 0;
+                } else if (!trace && tracer > 0) {
+                    stop_tracer();
+                    trace_status(port, "T off 0\n");
+                }
+            } else if (in.revents & (POLLHUP | POLLERR)) {
+                // Host closed; the poll above waits for the next one
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#!/bin/sh
+# ====================================================
+# Time to readiness: cold start vs checkpoint restore
+# ====================================================
+# Runs inside the guest against dockerd (experimental, with criu). Takes
+# an existing, warmed-up CONTAINER and times two ways of bringing it back
+# until READY_CMD succeeds inside it:
+#
+#   cold      docker stop, then docker start
+#   restore   docker checkpoint create, then docker start --checkpoint
+#
+#   guest/checkpoint/measure-restore.sh --container NAME --ready 'CMD'
+#       [--runs N] [OUT.json]
+#
+# READY_CMD runs through `docker exec NAME sh -c`, e.g. 'pg_isready -q'
+# or 'wget -q -O /dev/null http://127.0.0.1:8080/health'. OUT.json
+# defaults to /root/restore.json; a markdown table of medians goes to
+# stdout. The container is left running.
+# ====================================================
+
+set -eu
+
+RUNS=3
+CONTAINER=
+READY=
+OUT=/root/restore.json
+CHECKPOINT=measure-restore
+TIMEOUT_S=600
+
+die() { echo "error: $*" >&2; exit 1; }
+log() { echo "==> $*" >&2; }
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --runs) RUNS="$2"; shift 2 ;;
+        --container) CONTAINER="$2"; shift 2 ;;
+        --ready) READY="$2"; shift 2 ;;
+        -h|--help) sed -n '2,19p' "$0"; exit 0 ;;
+        *) OUT="$1"; shift ;;
+    esac
+done
+
+[ -n "$CONTAINER" ] || die "--container is required"
+[ -n "$READY" ] || die "--ready is required"
+command -v criu > /dev/null || die "criu is not installed"
+[ "$(docker version -f '{{.Server.Experimental}}')" = true ] \
+    || die "dockerd is not running with experimental features"
+
+# Centiseconds since boot; busybox date has no sub-second format
+now_cs() { awk '{ printf "%d", $1 * 100 }' /proc/uptime; }
+
+cleanup() {
+    docker checkpoint rm "$CONTAINER" "$CHECKPOINT" > /dev/null 2>&1 || true
+    docker start "$CONTAINER" > /dev/null 2>&1 || true
+}
+trap cleanup EXIT
+
+wait_ready() {
+    start=$1
+    until docker exec "$CONTAINER" sh -c "$READY" > /dev/null 2>&1; do
+        [ $(($(now_cs) - start)) -lt $((TIMEOUT_S * 100)) ] || die "$CONTAINER never became ready"
+        sleep 0.1
+    done
+    echo $(($(now_cs) - start))
+}
+
+# ============== Runs ==============
+
+log "Waiting for $CONTAINER to be ready before the first checkpoint"
+docker start "$CONTAINER" > /dev/null
+wait_ready "$(now_cs)" > /dev/null
+
+time_cold() {
+    docker stop "$CONTAINER" > /dev/null
+    start=$(now_cs)
+    docker start "$CONTAINER" > /dev/null
+    wait_ready "$start"
+}
+
+# Each restore uses a fresh checkpoint of the now-ready container
+time_restore() {
+    docker checkpoint rm "$CONTAINER" "$CHECKPOINT" > /dev/null 2>&1 || true
+    docker checkpoint create "$CONTAINER" "$CHECKPOINT" > /dev/null
+    start=$(now_cs)
+    docker start --checkpoint "$CHECKPOINT" "$CONTAINER" > /dev/null
+    wait_ready "$start"
+}
+
+median_ms() {
+    sort -n | awk '{ v[NR] = $1 } END { printf "%d", v[int((NR + 1) / 2)] * 10 }'
+}
+
+run_profile() {
+    i=0
+    while [ $i -lt "$RUNS" ]; do
+        "$1"
+        i=$((i + 1))
+    done | median_ms
+}
+
+log "Timing cold starts"
+COLD_MS=$(run_profile time_cold)
+log "Timing checkpoint restores"
+RESTORE_MS=$(run_profile time_restore)
+
+{
+    echo "{"
+    echo "  \"container\": \"$CONTAINER\","
+    echo "  \"ready_ms.cold\": $COLD_MS,"
+    echo "  \"ready_ms.restore\": $RESTORE_MS,"
+    echo "  \"runs\": $RUNS"
+    echo "}"
+} > "$OUT"
+log "Wrote $OUT"
+
+echo "| $CONTAINER | Time to ready (median of $RUNS) |"
+echo "|---|---:|"
+echo "| cold start | $COLD_MS ms |"
+awk -v a="$COLD_MS" -v b="$RESTORE_MS" 'BEGIN {
+    change = a > 0 ? sprintf(" (%+.0f%%)", (b - a) * 100 / a) : ""
+    printf "| checkpoint restore | %d ms%s |\n", b, change
+}'
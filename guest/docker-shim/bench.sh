@@ -0,0 +1,146 @@
+#!/bin/sh
+# ====================================================
+# dockerd vs lite runtime benchmark
+# ====================================================
+# Runs inside the guest. Measures the memory the container runtime holds
+# (PSS of dockerd, containerd, containerd-shim*, docker-proxy and
+# docker-shim, plus guest-wide used memory) and the median Docker API
+# latency of the endpoints the app polls, with one idle container
+# running. Boot once per profile and run it in each:
+#
+#   guest/docker-shim/bench.sh [--runs N] [--image IMAGE] [OUT.json]
+#   guest/docker-shim/bench.sh --compare docker.json lite.json
+#
+# OUT.json defaults to /root/bench-<profile>.json. The profile is
+# detected from the running daemon. Compare prints a markdown table and
+# works anywhere with a POSIX shell and awk.
+# ====================================================
+
+set -eu
+
+SOCK=/var/run/docker.sock
+RUNS=20
+IMAGE=alpine:latest
+OUT=
+
+die() { echo "error: $*" >&2; exit 1; }
+log() { echo "==> $*" >&2; }
+
+# Flat one-key-per-line JSON, so compare needs nothing but awk
+value() { awk -v k="\"$2\":" '$1 == k { sub(/,$/, "", $2); print $2 }' "$1"; }
+
+compare() {
+    [ -f "$1" ] && [ -f "$2" ] || die "compare needs two result files"
+    a=$(sed -n 's/^ *"profile": *"\(.*\)",*$/\1/p' "$1")
+    b=$(sed -n 's/^ *"profile": *"\(.*\)",*$/\1/p' "$2")
+    echo "| Metric | $a | $b | Change |"
+    echo "|---|---:|---:|---:|"
+    sed -n 's/^ *"\([^"]*\)": *[0-9.]*,*$/\1/p' "$1" | while read -r key; do
+        va=$(value "$1" "$key")
+        vb=$(value "$2" "$key")
+        [ -n "$vb" ] || continue
+        awk -v k="$key" -v a="$va" -v b="$vb" 'BEGIN {
+            change = a > 0 ? sprintf("%+.0f%%", (b - a) * 100 / a) : "-"
+            printf "| %s | %s | %s | %s |\n", k, a, b, change
+        }'
+    done
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --runs) RUNS="$2"; shift 2 ;;
+        --image) IMAGE="$2"; shift 2 ;;
+        --compare) shift; compare "$@"; exit 0 ;;
+        -h|--help) sed -n '2,17p' "$0"; exit 0 ;;
+        *) OUT="$1"; shift ;;
+    esac
+done
+
+command -v curl > /dev/null || die "curl is required"
+[ -S "$SOCK" ] || die "$SOCK not found: is the runtime up?"
+
+if pidof dockerd > /dev/null; then
+    PROFILE=docker
+elif pidof docker-shim > /dev/null; then
+    PROFILE=lite
+else
+    die "neither dockerd nor docker-shim is running"
+fi
+OUT="${OUT:-/root/bench-$PROFILE.json}"
+
+api() { curl -sf --unix-socket "$SOCK" "$@"; }
+
+# ============== Workload ==============
+
+log "Starting an idle $IMAGE container ($PROFILE)"
+repo="${IMAGE%:*}"
+tag="${IMAGE##*:}"
+[ "$repo" = "$IMAGE" ] && tag=latest
+api -X POST "http://d/images/create?fromImage=$repo&tag=$tag" > /dev/null
+ID=$(api -X POST -H "Content-Type: application/json" \
+    -d "{\"Image\":\"$IMAGE\",\"Cmd\":[\"sleep\",\"3600\"]}" \
+    "http://d/containers/create?name=bench-$$" | sed -n 's/.*"Id": *"\([0-9a-f]*\)".*/\1/p')
+[ -n "$ID" ] || die "container create failed"
+trap 'api -X DELETE "http://d/containers/$ID?force=1" > /dev/null || true' EXIT
+api -X POST "http://d/containers/$ID/start" > /dev/null
+# Let the runtime settle before sampling memory
+sleep 5
+
+# ============== Memory ==============
+
+pss_of() {
+    total=0
+    for pid in $(pidof "$@" 2> /dev/null); do
+        kb=$(awk '/^Pss:/ { print $2 }' "/proc/$pid/smaps_rollup" 2> /dev/null || echo 0)
+        total=$((total + ${kb:-0}))
+    done
+    echo "$total"
+}
+
+PSS_DOCKERD=$(pss_of dockerd)
+PSS_CONTAINERD=$(pss_of containerd)
+# containerd-shim-runc-v2, one per container
+PSS_SHIMS=0
+for pid in $(pgrep containerd-shim 2> /dev/null); do
+    kb=$(awk '/^Pss:/ { print $2 }' "/proc/$pid/smaps_rollup" 2> /dev/null || echo 0)
+    PSS_SHIMS=$((PSS_SHIMS + ${kb:-0}))
+done
+PSS_PROXY=$(pss_of docker-proxy)
+PSS_DOCKER_SHIM=$(pss_of docker-shim)
+PSS_TOTAL=$((PSS_DOCKERD + PSS_CONTAINERD + PSS_SHIMS + PSS_PROXY + PSS_DOCKER_SHIM))
+MEM_USED=$(awk '/^MemTotal:/ { t = $2 } /^MemAvailable:/ { a = $2 } END { print t - a }' /proc/meminfo)
+
+# ============== Latency ==============
+
+median_ms() {
+    i=0
+    while [ $i -lt "$RUNS" ]; do
+        curl -s -o /dev/null -w '%{time_total}\n' --unix-socket "$SOCK" "http://d$1"
+        i=$((i + 1))
+    done | sort -n | awk '{ v[NR] = $1 } END { printf "%.1f", v[int((NR + 1) / 2)] * 1000 }'
+}
+
+ENDPOINTS="/_ping /version /info /containers/json?all=1 /images/json /containers/$ID/json /containers/$ID/stats?stream=false"
+
+{
+    echo "{"
+    echo "  \"profile\": \"$PROFILE\","
+    echo "  \"pss_kb.dockerd\": $PSS_DOCKERD,"
+    echo "  \"pss_kb.containerd\": $PSS_CONTAINERD,"
+    echo "  \"pss_kb.containerd-shim\": $PSS_SHIMS,"
+    echo "  \"pss_kb.docker-proxy\": $PSS_PROXY,"
+    echo "  \"pss_kb.docker-shim\": $PSS_DOCKER_SHIM,"
+    echo "  \"pss_kb.total\": $PSS_TOTAL,"
+    echo "  \"guest_used_kb\": $MEM_USED,"
+    for ep in $ENDPOINTS; do
+        log "Timing $ep"
+        # Container ids differ between runs: key by the route
+        key=$(echo "$ep" | sed "s/$ID/ID/")
+        echo "  \"latency_ms.$key\": $(median_ms "$ep"),"
+    done
+    echo "  \"runs\": $RUNS"
+    echo "}"
+} > "$OUT"
+
+log "Wrote $OUT"
+cat "$OUT"
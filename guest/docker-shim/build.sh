@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# ====================================================
+# Build docker-shim for the x86_64 guest
+# ====================================================
+# Produces a static binary and stages it in the app assets, from where
+# it is served to the guest over slirp's TFTP server (10.0.2.2) and
+# installed as /usr/local/bin/docker-shim by alpine-setup.sh.
+#
+# Usage:
+#   guest/docker-shim/build.sh [--no-install]
+#
+# Needs Go 1.21 or newer; the shim has no dependencies outside the
+# standard library.
+# ====================================================
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+OUT_DIR="$REPO_ROOT/build/guest"
+ASSET_DIR="$REPO_ROOT/android/app/src/main/assets/qemu/guest"
+
+INSTALL=1
+[ "${1:-}" = "--no-install" ] && INSTALL=0
+
+command -v go > /dev/null || { echo "error: go not found" >&2; exit 1; }
+
+VERSION="$(git -C "$REPO_ROOT" describe --always --dirty 2> /dev/null || echo dev)"
+
+mkdir -p "$OUT_DIR"
+(
+    cd "$SCRIPT_DIR"
+    CGO_ENABLED=0 GOOS=linux GOARCH=amd64 go build -trimpath \
+        -ldflags "-s -w -X main.version=$VERSION" \
+        -o "$OUT_DIR/docker-shim" .
+)
+echo "==> Built $(du -h "$OUT_DIR/docker-shim" | cut -f1) $OUT_DIR/docker-shim ($VERSION)"
+
+if [ "$INSTALL" = 1 ]; then
+    mkdir -p "$ASSET_DIR"
+    cp "$OUT_DIR/docker-shim" "$ASSET_DIR/docker-shim"
+    echo "==> Installed into $ASSET_DIR"
+fi
@@ -0,0 +1,668 @@
+package main
+
+import (
+	"bufio"
+	"context"
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"io"
+	"net/http"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+)
+
+// Subset of the dockercompat inspect output the list view needs
+type containerInspect struct {
+	ID      string `json:"Id"`
+	Created string
+	Path    string
+	Args    []string
+	Name    string
+	Image   string
+	State   struct {
+		Status     string
+		Running    bool
+		Paused     bool
+		Pid        int
+		ExitCode   int
+		StartedAt  string
+		FinishedAt string
+	}
+	Config struct {
+		Image  string
+		Labels map[string]string
+		Tty    bool
+	}
+	Mounts []struct {
+		Type        string
+		Name        string
+		Source      string
+		Destination string
+		Mode        string
+		RW          bool
+	}
+	NetworkSettings struct {
+		Ports    map[string][]portBinding
+		Networks map[string]json.RawMessage
+	}
+}
+
+type portBinding struct {
+	HostIP   string `json:"HostIp"`
+	HostPort string
+}
+
+type containerPort struct {
+	IP          string `json:"IP,omitempty"`
+	PrivatePort int
+	PublicPort  int `json:"PublicPort,omitempty"`
+	Type        string
+}
+
+func (c *containerInspect) summary() map[string]any {
+	var ports []containerPort
+	for spec, bindings := range c.NetworkSettings.Ports {
+		port, proto, _ := strings.Cut(spec, "/")
+		private, _ := strconv.Atoi(port)
+		if len(bindings) == 0 {
+			ports = append(ports, containerPort{PrivatePort: private, Type: proto})
+		}
+		for _, b := range bindings {
+			public, _ := strconv.Atoi(b.HostPort)
+			ports = append(ports, containerPort{IP: b.HostIP, PrivatePort: private, PublicPort: public, Type: proto})
+		}
+	}
+	if ports == nil {
+		ports = []containerPort{}
+	}
+
+	mounts := make([]map[string]any, 0, len(c.Mounts))
+	for _, m := range c.Mounts {
+		mounts = append(mounts, map[string]any{
+			"Type": m.Type, "Name": m.Name, "Source": m.Source,
+			"Destination": m.Destination, "Mode": m.Mode, "RW": m.RW,
+		})
+	}
+
+	image := c.Config.Image
+	if image == "" {
+		image = c.Image
+	}
+	labels := c.Config.Labels
+	if labels == nil {
+		labels = map[string]string{}
+	}
+
+	return map[string]any{
+		"Id":      c.ID,
+		"Names":   []string{"/" + strings.TrimPrefix(c.Name, "/")},
+		"Image":   image,
+		"ImageID": c.Image,
+		"Command": strings.TrimSpace(c.Path + " " + strings.Join(c.Args, " ")),
+		"Created": unixTime(c.Created),
+		"State":   c.State.Status,
+		"Status":  c.statusText(),
+		"Ports":   ports,
+		"Labels":  labels,
+		"Mounts":  mounts,
+		"HostConfig": map[string]string{
+			"NetworkMode": "default",
+		},
+	}
+}
+
+// Docker's human-readable status column
+func (c *containerInspect) statusText() string {
+	since := func(ts string) string {
+		t := unixTime(ts)
+		if t == 0 {
+			return ""
+		}
+		return humanDuration(time.Since(time.Unix(t, 0)))
+	}
+	switch c.State.Status {
+	case "running":
+		return "Up " + since(c.State.StartedAt)
+	case "paused":
+		return "Up " + since(c.State.StartedAt) + " (Paused)"
+	case "exited":
+		return fmt.Sprintf("Exited (%d) %s ago", c.State.ExitCode, since(c.State.FinishedAt))
+	case "created":
+		return "Created"
+	}
+	return capitalize(c.State.Status)
+}
+
+// capitalize upper-cases the first letter of an ASCII word
+func capitalize(s string) string {
+	if s == "" {
+		return s
+	}
+	return strings.ToUpper(s[:1]) + s[1:]
+}
+
+func humanDuration(d time.Duration) string {
+	switch {
+	case d < time.Minute:
+		return fmt.Sprintf("%d seconds", int(d.Seconds()))
+	case d < time.Hour:
+		return fmt.Sprintf("%d minutes", int(d.Minutes()))
+	case d < 48*time.Hour:
+		return fmt.Sprintf("%d hours", int(d.Hours()))
+	}
+	return fmt.Sprintf("%d days", int(d.Hours()/24))
+}
+
+// ============== List / inspect ==============
+
+func (s *server) listContainers(w http.ResponseWriter, r *http.Request, _ []string) error {
+	args := []string{"ps", "-q", "--no-trunc"}
+	if boolParam(r, "all") {
+		args = append(args, "-a")
+	}
+	ids, err := s.cli.lines(r.Context(), args...)
+	if err != nil {
+		return err
+	}
+	result := []map[string]any{}
+	if len(ids) > 0 {
+		var containers []containerInspect
+		if err := s.cli.inspect(r.Context(), "container", &containers, ids...); err != nil {
+			return err
+		}
+		filters, err := filterParam(r)
+		if err != nil {
+			return err
+		}
+		for i := range containers {
+			if matchesContainerFilters(&containers[i], filters) {
+				result = append(result, containers[i].summary())
+			}
+		}
+	}
+	return writeJSON(w, http.StatusOK, result)
+}
+
+func matchesContainerFilters(c *containerInspect, filters map[string][]string) bool {
+	for key, values := range filters {
+		matched := false
+		for _, v := range values {
+			switch key {
+			case "status":
+				matched = matched || c.State.Status == v
+			case "name":
+				matched = matched || strings.Contains(strings.TrimPrefix(c.Name, "/"), strings.TrimPrefix(v, "/"))
+			case "id":
+				matched = matched || strings.HasPrefix(c.ID, v)
+			case "label":
+				k, want, hasValue := strings.Cut(v, "=")
+				got, ok := c.Config.Labels[k]
+				matched = matched || (ok && (!hasValue || got == want))
+			default:
+				// Unsupported filters don't exclude anything
+				matched = true
+			}
+		}
+		if !matched {
+			return false
+		}
+	}
+	return true
+}
+
+func (s *server) inspectContainer(w http.ResponseWriter, r *http.Request, p []string) error {
+	raw, err := s.cli.inspectOne(r.Context(), "container", p[0])
+	if err != nil {
+		return err
+	}
+	w.Header().Set("Content-Type", "application/json")
+	_, err = w.Write(raw)
+	return err
+}
+
+// ============== Create ==============
+
+type createRequest struct {
+	Image        string
+	Cmd          strSlice
+	Entrypoint   strSlice
+	Env          []string
+	Labels       map[string]string
+	Tty          bool
+	OpenStdin    bool
+	WorkingDir   string
+	User         string
+	Hostname     string
+	ExposedPorts map[string]struct{}
+	HostConfig   struct {
+		PortBindings  map[string][]portBinding
+		Binds         []string
+		Memory        int64
+		NanoCpus      int64
+		AutoRemove    bool
+		Privileged    bool
+		NetworkMode   string
+		RestartPolicy struct {
+			Name              string
+			MaximumRetryCount int
+		}
+	}
+}
+
+func (s *server) createContainer(w http.ResponseWriter, r *http.Request, _ []string) error {
+	var req createRequest
+	if err := decodeBody(r, &req); err != nil {
+		return err
+	}
+	if req.Image == "" {
+		return badRequest("config is missing Image")
+	}
+
+	args := []string{"create"}
+	if name := r.URL.Query().Get("name"); name != "" {
+		args = append(args, "--name", name)
+	}
+	for _, env := range req.Env {
+		args = append(args, "-e", env)
+	}
+	for k, v := range req.Labels {
+		args = append(args, "--label", k+"="+v)
+	}
+	if req.Tty {
+		args = append(args, "-t")
+	}
+	if req.OpenStdin {
+		args = append(args, "-i")
+	}
+	if req.WorkingDir != "" {
+		args = append(args, "-w", req.WorkingDir)
+	}
+	if req.User != "" {
+		args = append(args, "-u", req.User)
+	}
+	if req.Hostname != "" {
+		args = append(args, "-h", req.Hostname)
+	}
+
+	hc := req.HostConfig
+	for spec, bindings := range hc.PortBindings {
+		for _, b := range bindings {
+			publish := spec
+			if b.HostPort != "" {
+				publish = b.HostPort + ":" + spec
+				if b.HostIP != "" {
+					publish = b.HostIP + ":" + publish
+				}
+			}
+			args = append(args, "-p", publish)
+		}
+	}
+	for _, bind := range hc.Binds {
+		args = append(args, "-v", bind)
+	}
+	if hc.Memory > 0 {
+		args = append(args, "-m", strconv.FormatInt(hc.Memory, 10))
+	}
+	if hc.NanoCpus > 0 {
+		args = append(args, "--cpus", strconv.FormatFloat(float64(hc.NanoCpus)/1e9, 'f', -1, 64))
+	}
+	if hc.AutoRemove {
+		args = append(args, "--rm")
+	}
+	if hc.Privileged {
+		args = append(args, "--privileged")
+	}
+	if hc.NetworkMode != "" && hc.NetworkMode != "default" {
+		args = append(args, "--net", hc.NetworkMode)
+	}
+	if policy := hc.RestartPolicy.Name; policy != "" && policy != "no" {
+		if policy == "on-failure" && hc.RestartPolicy.MaximumRetryCount > 0 {
+			policy += ":" + strconv.Itoa(hc.RestartPolicy.MaximumRetryCount)
+		}
+		args = append(args, "--restart", policy)
+	}
+
+	// nerdctl takes a single entrypoint word; the rest leads the command
+	cmd := []string(req.Cmd)
+	if len(req.Entrypoint) > 0 {
+		args = append(args, "--entrypoint", req.Entrypoint[0])
+		cmd = append(append([]string{}, req.Entrypoint[1:]...), cmd...)
+	}
+	args = append(args, req.Image)
+	args = append(args, cmd...)
+
+	lines, err := s.cli.lines(r.Context(), args...)
+	if err != nil {
+		return err
+	}
+	if len(lines) == 0 {
+		return fmt.Errorf("nerdctl create returned no container id")
+	}
+	return writeJSON(w, http.StatusCreated, map[string]any{
+		"Id":       lines[len(lines)-1],
+		"Warnings": []string{},
+	})
+}
+
+// ============== Lifecycle ==============
+
+func (s *server) containerAction(w http.ResponseWriter, r *http.Request, p []string) error {
+	id, action := p[0], p[1]
+	args := []string{action}
+	if t := r.URL.Query().Get("t"); t != "" && (action == "stop" || action == "restart") {
+		args = append(args, "-t", t)
+	}
+	if sig := r.URL.Query().Get("signal"); sig != "" && action == "kill" {
+		args = append(args, "-s", sig)
+	}
+	if cp := r.URL.Query().Get("checkpoint"); cp != "" && action == "start" {
+		args = append(args, "--checkpoint", cp)
+	}
+	if _, err := s.cli.run(r.Context(), append(args, id)...); err != nil {
+		return err
+	}
+	return noContent(w)
+}
+
+func (s *server) renameContainer(w http.ResponseWriter, r *http.Request, p []string) error {
+	name := r.URL.Query().Get("name")
+	if name == "" {
+		return badRequest("name is required")
+	}
+	if _, err := s.cli.run(r.Context(), "rename", p[0], strings.TrimPrefix(name, "/")); err != nil {
+		return err
+	}
+	return noContent(w)
+}
+
+// The resource limits nerdctl update can change on an existing container
+type containerUpdate struct {
+	Memory        int64
+	NanoCpus      int64
+	RestartPolicy *struct {
+		Name              string
+		MaximumRetryCount int
+	}
+}
+
+func (s *server) updateContainer(w http.ResponseWriter, r *http.Request, p []string) error {
+	var body containerUpdate
+	if err := json.NewDecoder(r.Body).Decode(&body); err != nil {
+		return badRequest("invalid body: %v", err)
+	}
+	args := []string{"update"}
+	if body.Memory > 0 {
+		args = append(args, "--memory", strconv.FormatInt(body.Memory, 10))
+	}
+	if body.NanoCpus > 0 {
+		args = append(args, "--cpus", strconv.FormatFloat(float64(body.NanoCpus)/1e9, 'f', -1, 64))
+	}
+	if rp := body.RestartPolicy; rp != nil && rp.Name != "" {
+		policy := rp.Name
+		if rp.Name == "on-failure" && rp.MaximumRetryCount > 0 {
+			policy += ":" + strconv.Itoa(rp.MaximumRetryCount)
+		}
+		args = append(args, "--restart", policy)
+	}
+	if len(args) > 1 {
+		if _, err := s.cli.run(r.Context(), append(args, p[0])...); err != nil {
+			return err
+		}
+	}
+	return writeJSON(w, http.StatusOK, map[string][]string{"Warnings": {}})
+}
+
+// ============== Checkpoints ==============
+
+// Checkpoints need CRIU in the guest and nerdctl 2.1 or later; older
+// versions fail with an unknown command, which is passed on as is
+
+type checkpointCreate struct {
+	CheckpointID string
+	Exit         *bool
+}
+
+func (s *server) listCheckpoints(w http.ResponseWriter, r *http.Request, p []string) error {
+	lines, err := s.cli.lines(r.Context(), "checkpoint", "ls", p[0])
+	if err != nil {
+		return err
+	}
+	checkpoints := []map[string]string{}
+	for _, line := range lines {
+		// Table output: a CHECKPOINT header, then one name per line
+		if name := strings.Fields(line)[0]; name != "CHECKPOINT" {
+			checkpoints = append(checkpoints, map[string]string{"Name": name})
+		}
+	}
+	return writeJSON(w, http.StatusOK, checkpoints)
+}
+
+func (s *server) createCheckpoint(w http.ResponseWriter, r *http.Request, p []string) error {
+	var body checkpointCreate
+	if err := json.NewDecoder(r.Body).Decode(&body); err != nil {
+		return badRequest("invalid body: %v", err)
+	}
+	if body.CheckpointID == "" {
+		return badRequest("CheckpointID is required")
+	}
+	args := []string{"checkpoint", "create"}
+	// Both Docker and nerdctl stop the container unless told otherwise
+	if body.Exit != nil && !*body.Exit {
+		args = append(args, "--leave-running")
+	}
+	if _, err := s.cli.run(r.Context(), append(args, p[0], body.CheckpointID)...); err != nil {
+		return err
+	}
+	return writeJSON(w, http.StatusCreated, map[string]string{})
+}
+
+func (s *server) removeCheckpoint(w http.ResponseWriter, r *http.Request, p []string) error {
+	if _, err := s.cli.run(r.Context(), "checkpoint", "rm", p[0], p[1]); err != nil {
+		return err
+	}
+	return noContent(w)
+}
+
+func (s *server) removeContainer(w http.ResponseWriter, r *http.Request, p []string) error {
+	args := []string{"rm"}
+	if boolParam(r, "force") {
+		args = append(args, "-f")
+	}
+	if boolParam(r, "v") {
+		args = append(args, "-v")
+	}
+	if _, err := s.cli.run(r.Context(), append(args, p[0])...); err != nil {
+		return err
+	}
+	s.ttys.forget(p[0])
+	return noContent(w)
+}
+
+func (s *server) pruneContainers(w http.ResponseWriter, r *http.Request, _ []string) error {
+	deleted, err := s.pruned(r.Context(), "container", "prune", "-f")
+	if err != nil {
+		return err
+	}
+	return writeJSON(w, http.StatusOK, map[string]any{"ContainersDeleted": deleted, "SpaceReclaimed": 0})
+}
+
+// pruned runs a prune command and returns the ids it lists after its
+// "Deleted ...:" header
+func (s *server) pruned(ctx context.Context, args ...string) ([]string, error) {
+	lines, err := s.cli.lines(ctx, args...)
+	if err != nil {
+		return nil, err
+	}
+	deleted := []string{}
+	for _, line := range lines {
+		if strings.HasSuffix(line, ":") || strings.HasPrefix(line, "Total") {
+			continue
+		}
+		deleted = append(deleted, line)
+	}
+	return deleted, nil
+}
+
+// ============== Logs ==============
+
+// Docker only multiplexes stdout/stderr for containers without a TTY, so
+// the shim needs each container's Tty flag; it never changes after create
+type ttyCache struct {
+	mu   sync.Mutex
+	byID map[string]bool
+}
+
+func newTTYCache() *ttyCache { return &ttyCache{byID: map[string]bool{}} }
+
+func (c *ttyCache) get(ctx context.Context, cli *nerdctl, id string) (bool, error) {
+	c.mu.Lock()
+	tty, ok := c.byID[id]
+	c.mu.Unlock()
+	if ok {
+		return tty, nil
+	}
+	var containers []containerInspect
+	if err := cli.inspect(ctx, "container", &containers, id); err != nil {
+		return false, err
+	}
+	if len(containers) == 0 {
+		return false, apiError{http.StatusNotFound, "No such container: " + id}
+	}
+	tty = containers[0].Config.Tty
+	c.mu.Lock()
+	c.byID[id] = tty
+	c.mu.Unlock()
+	return tty, nil
+}
+
+func (c *ttyCache) forget(id string) {
+	c.mu.Lock()
+	delete(c.byID, id)
+	c.mu.Unlock()
+}
+
+// muxWriter frames output as Docker's stdcopy stream: 8-byte header with
+// the stream id and big-endian length, then the payload
+type muxWriter struct {
+	mu     sync.Mutex
+	out    io.Writer
+	stream byte
+	raw    bool
+}
+
+func (m *muxWriter) forStream(stream byte) *muxWriter {
+	return &muxWriter{out: lockedWriter{&m.mu, m.out}, stream: stream, raw: m.raw}
+}
+
+func (m *muxWriter) Write(p []byte) (int, error) {
+	if m.raw {
+		return m.out.Write(p)
+	}
+	var header [8]byte
+	header[0] = m.stream
+	binary.BigEndian.PutUint32(header[4:], uint32(len(p)))
+	if _, err := m.out.Write(append(header[:], p...)); err != nil {
+		return 0, err
+	}
+	return len(p), nil
+}
+
+type lockedWriter struct {
+	mu *sync.Mutex
+	w  io.Writer
+}
+
+func (l lockedWriter) Write(p []byte) (int, error) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	return l.w.Write(p)
+}
+
+func (s *server) containerLogs(w http.ResponseWriter, r *http.Request, p []string) error {
+	id := p[0]
+	q := r.URL.Query()
+	wantStdout, wantStderr := boolParam(r, "stdout"), boolParam(r, "stderr")
+	if !wantStdout && !wantStderr {
+		return badRequest("you must choose at least one stream")
+	}
+	tty, err := s.ttys.get(r.Context(), s.cli, id)
+	if err != nil {
+		return err
+	}
+
+	args := []string{"logs"}
+	if tail := q.Get("tail"); tail != "" && tail != "all" {
+		args = append(args, "--tail", tail)
+	}
+	if boolParam(r, "timestamps") {
+		args = append(args, "-t")
+	}
+	if since, _ := strconv.ParseInt(q.Get("since"), 10, 64); since > 0 {
+		args = append(args, "--since", time.Unix(since, 0).UTC().Format(time.RFC3339))
+	}
+	if until, _ := strconv.ParseInt(q.Get("until"), 10, 64); until > 0 {
+		args = append(args, "--until", time.Unix(until, 0).UTC().Format(time.RFC3339))
+	}
+	follow := boolParam(r, "follow")
+	if follow {
+		args = append(args, "-f")
+	}
+
+	cmd := s.cli.command(r.Context(), append(args, id)...)
+	stdout, err := cmd.StdoutPipe()
+	if err != nil {
+		return err
+	}
+	stderr, err := cmd.StderrPipe()
+	if err != nil {
+		return err
+	}
+	if err := cmd.Start(); err != nil {
+		return err
+	}
+
+	if tty {
+		w.Header().Set("Content-Type", "application/vnd.docker.raw-stream")
+	} else {
+		w.Header().Set("Content-Type", "application/vnd.docker.multiplexed-stream")
+	}
+	w.WriteHeader(http.StatusOK)
+
+	var out io.Writer = w
+	if follow {
+		out = newStreamWriter(w)
+	}
+	mux := &muxWriter{out: out, raw: tty}
+
+	var wg sync.WaitGroup
+	pump := func(src io.Reader, stream byte, wanted bool) {
+		defer wg.Done()
+		if !wanted {
+			io.Copy(io.Discard, src)
+			return
+		}
+		// Line at a time so frames never split a line
+		dst := mux.forStream(stream)
+		br := bufio.NewReader(src)
+		for {
+			line, err := br.ReadBytes('\n')
+			if len(line) > 0 {
+				if _, werr := dst.Write(line); werr != nil {
+					return
+				}
+			}
+			if err != nil {
+				return
+			}
+		}
+	}
+	wg.Add(2)
+	go pump(stdout, 1, wantStdout)
+	go pump(stderr, 2, wantStderr)
+	wg.Wait()
+	cmd.Wait()
+	return nil
+}
@@ -0,0 +1,176 @@
+package main
+
+import (
+	"bufio"
+	"context"
+	"encoding/json"
+	"net/http"
+	"strconv"
+	"strings"
+	"time"
+)
+
+// containerd publishes its own topics; these are the ones with a Docker
+// equivalent. Everything else (snapshots, content, leases) is dropped.
+var eventTopics = map[string][2]string{
+	"/containers/create":  {"container", "create"},
+	"/containers/update":  {"container", "update"},
+	"/containers/delete":  {"container", "destroy"},
+	"/tasks/start":        {"container", "start"},
+	"/tasks/exit":         {"container", "die"},
+	"/tasks/paused":       {"container", "pause"},
+	"/tasks/resumed":      {"container", "unpause"},
+	"/tasks/oom":          {"container", "oom"},
+	"/tasks/exec-added":   {"container", "exec_create"},
+	"/tasks/exec-started": {"container", "exec_start"},
+	"/images/create":      {"image", "pull"},
+	"/images/update":      {"image", "tag"},
+	"/images/delete":      {"image", "delete"},
+}
+
+// nerdctl events --format '{{json .}}'
+type containerdEvent struct {
+	Timestamp string
+	Topic     string
+	Event     string
+}
+
+type dockerEvent struct {
+	Status   string     `json:"status,omitempty"`
+	ID       string     `json:"id,omitempty"`
+	Type     string     `json:"Type"`
+	Action   string     `json:"Action"`
+	Actor    eventActor `json:"Actor"`
+	Scope    string     `json:"scope"`
+	Time     int64      `json:"time"`
+	TimeNano int64      `json:"timeNano"`
+}
+
+type eventActor struct {
+	ID         string            `json:"ID"`
+	Attributes map[string]string `json:"Attributes"`
+}
+
+func (s *server) events(w http.ResponseWriter, r *http.Request, _ []string) error {
+	filters, err := filterParam(r)
+	if err != nil {
+		return err
+	}
+	ctx := r.Context()
+	if until, _ := strconv.ParseInt(r.URL.Query().Get("until"), 10, 64); until > 0 {
+		var cancel context.CancelFunc
+		ctx, cancel = context.WithDeadline(ctx, time.Unix(until, 0))
+		defer cancel()
+	}
+
+	cmd := s.cli.command(ctx, "events", "--format", "{{json .}}")
+	stdout, err := cmd.StdoutPipe()
+	if err != nil {
+		return err
+	}
+	if err := cmd.Start(); err != nil {
+		return err
+	}
+	defer cmd.Wait()
+
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(http.StatusOK)
+	enc := json.NewEncoder(newStreamWriter(w))
+	// Docker sends the headers straight away; clients wait for them
+	if f, ok := w.(http.Flusher); ok {
+		f.Flush()
+	}
+
+	sc := bufio.NewScanner(stdout)
+	sc.Buffer(make([]byte, 64*1024), 1024*1024)
+	for sc.Scan() {
+		var ce containerdEvent
+		if json.Unmarshal(sc.Bytes(), &ce) != nil {
+			continue
+		}
+		ev, ok := translateEvent(&ce)
+		if !ok || !matchesEventFilters(&ev, filters) {
+			continue
+		}
+		if enc.Encode(ev) != nil {
+			return nil
+		}
+	}
+	return nil
+}
+
+func translateEvent(ce *containerdEvent) (dockerEvent, bool) {
+	mapped, ok := eventTopics[ce.Topic]
+	if !ok {
+		return dockerEvent{}, false
+	}
+	var payload struct {
+		ID          string `json:"id"`
+		ContainerID string `json:"container_id"`
+		Name        string `json:"name"`
+		Image       string `json:"image"`
+		ExitStatus  int    `json:"exit_status"`
+	}
+	json.Unmarshal([]byte(ce.Event), &payload)
+
+	when, err := time.Parse(time.RFC3339Nano, ce.Timestamp)
+	if err != nil {
+		when, err = time.Parse("2006-01-02 15:04:05.999999999 -0700 MST", ce.Timestamp)
+	}
+	if err != nil {
+		when = time.Now()
+	}
+
+	ev := dockerEvent{
+		Type:     mapped[0],
+		Action:   mapped[1],
+		Scope:    "local",
+		Time:     when.Unix(),
+		TimeNano: when.UnixNano(),
+		Actor:    eventActor{Attributes: map[string]string{}},
+	}
+	if ev.Type == "container" {
+		ev.Actor.ID = payload.ContainerID
+		if ev.Actor.ID == "" {
+			ev.Actor.ID = payload.ID
+		}
+		if payload.Image != "" {
+			ev.Actor.Attributes["image"] = payload.Image
+		}
+		if ev.Action == "die" {
+			ev.Actor.Attributes["exitCode"] = strconv.Itoa(payload.ExitStatus)
+		}
+		// Pre-1.22 fields that older clients still read
+		ev.Status = ev.Action
+		ev.ID = ev.Actor.ID
+	} else {
+		ev.Actor.ID = payload.Name
+		ev.Actor.Attributes["name"] = payload.Name
+	}
+	return ev, ev.Actor.ID != ""
+}
+
+func matchesEventFilters(ev *dockerEvent, filters map[string][]string) bool {
+	match := func(key, value string) bool {
+		values, ok := filters[key]
+		if !ok {
+			return true
+		}
+		for _, v := range values {
+			if v == value || (key == "container" && strings.HasPrefix(value, v)) {
+				return true
+			}
+		}
+		return false
+	}
+	if !match("type", ev.Type) || !match("event", ev.Action) {
+		return false
+	}
+	if ev.Type == "container" && !match("container", ev.Actor.ID) {
+		return false
+	}
+	if ev.Type == "image" && !match("image", ev.Actor.ID) {
+		return false
+	}
+	return true
+}
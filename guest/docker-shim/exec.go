@@ -0,0 +1,336 @@
+package main
+
+import (
+	"context"
+	"crypto/rand"
+	"encoding/hex"
+	"errors"
+	"io"
+	"net/http"
+	"os"
+	"os/exec"
+	"strconv"
+	"sync"
+	"syscall"
+	"time"
+)
+
+// Finished exec instances are kept this long for inspectExec
+const execRetention = 5 * time.Minute
+
+type execConfig struct {
+	AttachStdin  bool
+	AttachStdout bool
+	AttachStderr bool
+	Tty          bool
+	Cmd          strSlice
+	Env          []string
+	WorkingDir   string
+	User         string
+	Privileged   bool
+}
+
+type execInstance struct {
+	id          string
+	containerID string
+	config      execConfig
+
+	mu       sync.Mutex
+	cmd      *exec.Cmd
+	pty      *os.File
+	relayed  chan struct{}
+	running  bool
+	exitCode int
+	pid      int
+	endedAt  time.Time
+}
+
+type execStore struct {
+	mu   sync.Mutex
+	byID map[string]*execInstance
+}
+
+func newExecStore() *execStore { return &execStore{byID: map[string]*execInstance{}} }
+
+func (s *execStore) add(e *execInstance) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	for id, old := range s.byID {
+		old.mu.Lock()
+		expired := !old.endedAt.IsZero() && time.Since(old.endedAt) > execRetention
+		old.mu.Unlock()
+		if expired {
+			delete(s.byID, id)
+		}
+	}
+	s.byID[e.id] = e
+}
+
+func (s *execStore) get(id string) (*execInstance, error) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if e, ok := s.byID[id]; ok {
+		return e, nil
+	}
+	return nil, apiError{http.StatusNotFound, "No such exec instance: " + id}
+}
+
+func newID() string {
+	b := make([]byte, 32)
+	rand.Read(b)
+	return hex.EncodeToString(b)
+}
+
+func (s *server) createExec(w http.ResponseWriter, r *http.Request, p []string) error {
+	var config execConfig
+	if err := decodeBody(r, &config); err != nil {
+		return err
+	}
+	if len(config.Cmd) == 0 {
+		return badRequest("No exec command specified")
+	}
+	// Fail early like Docker does when the container is gone
+	var containers []containerInspect
+	if err := s.cli.inspect(r.Context(), "container", &containers, p[0]); err != nil {
+		return err
+	}
+	if len(containers) == 0 {
+		return apiError{http.StatusNotFound, "No such container: " + p[0]}
+	}
+	if !containers[0].State.Running {
+		return apiError{http.StatusConflict, "Container " + p[0] + " is not running"}
+	}
+
+	e := &execInstance{id: newID(), containerID: containers[0].ID, config: config}
+	s.execs.add(e)
+	return writeJSON(w, http.StatusCreated, map[string]string{"Id": e.id})
+}
+
+func (s *server) startExec(w http.ResponseWriter, r *http.Request, p []string) error {
+	e, err := s.execs.get(p[0])
+	if err != nil {
+		return err
+	}
+	var body struct {
+		Detach bool
+		Tty    bool
+	}
+	if err := decodeBody(r, &body); err != nil {
+		return err
+	}
+
+	e.mu.Lock()
+	if e.cmd != nil {
+		e.mu.Unlock()
+		return apiError{http.StatusConflict, "Exec " + e.id + " has already been started"}
+	}
+	c := e.config
+	args := []string{"exec"}
+	if c.AttachStdin && !body.Detach {
+		args = append(args, "-i")
+	}
+	if c.Tty {
+		args = append(args, "-t")
+	}
+	if c.WorkingDir != "" {
+		args = append(args, "-w", c.WorkingDir)
+	}
+	if c.User != "" {
+		args = append(args, "-u", c.User)
+	}
+	if c.Privileged {
+		args = append(args, "--privileged")
+	}
+	for _, env := range c.Env {
+		args = append(args, "-e", env)
+	}
+	args = append(append(args, e.containerID), c.Cmd...)
+	// The exec outlives the request when detached or hijacked
+	e.cmd = s.cli.command(context.Background(), args...)
+	e.mu.Unlock()
+
+	if body.Detach {
+		if err := e.start(nil, nil, nil); err != nil {
+			return err
+		}
+		go e.wait()
+		return writeJSON(w, http.StatusOK, struct{}{})
+	}
+
+	hj, ok := w.(http.Hijacker)
+	if !ok {
+		return errors.New("connection does not support hijacking")
+	}
+	conn, bufrw, err := hj.Hijack()
+	if err != nil {
+		return err
+	}
+	defer conn.Close()
+
+	// Same handshake as dockerd: 101 when the client asked to upgrade,
+	// otherwise 200 and the raw stream on the same connection
+	if r.Header.Get("Upgrade") != "" {
+		bufrw.WriteString("HTTP/1.1 101 UPGRADED\r\nConnection: Upgrade\r\nUpgrade: tcp\r\n")
+	} else {
+		bufrw.WriteString("HTTP/1.1 200 OK\r\n")
+	}
+	if c.Tty {
+		bufrw.WriteString("Content-Type: application/vnd.docker.raw-stream\r\n\r\n")
+	} else {
+		bufrw.WriteString("Content-Type: application/vnd.docker.multiplexed-stream\r\n\r\n")
+	}
+	if err := bufrw.Flush(); err != nil {
+		return nil
+	}
+
+	mux := &muxWriter{out: conn, raw: c.Tty}
+	var stdout, stderr io.Writer = io.Discard, io.Discard
+	if c.AttachStdout {
+		stdout = mux.forStream(1)
+	}
+	if c.AttachStderr {
+		stderr = mux.forStream(2)
+	}
+	var stdin io.Reader
+	if c.AttachStdin {
+		// Anything buffered past the request headers belongs to stdin
+		stdin = bufrw.Reader
+	}
+	if err := e.start(stdin, stdout, stderr); err != nil {
+		mux.forStream(2).Write([]byte(err.Error() + "\n"))
+		return nil
+	}
+	e.wait()
+	if e.relayed != nil {
+		select {
+		case <-e.relayed:
+		case <-time.After(time.Second):
+		}
+	}
+	return nil
+}
+
+// start launches the nerdctl exec, through a pty when the exec has a TTY
+func (e *execInstance) start(stdin io.Reader, stdout, stderr io.Writer) error {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	cmd := e.cmd
+
+	if e.config.Tty && (stdin != nil || stdout != nil) {
+		master, slave, err := openPTY()
+		if err != nil {
+			return err
+		}
+		cmd.Stdin, cmd.Stdout, cmd.Stderr = slave, slave, slave
+		cmd.SysProcAttr = &syscall.SysProcAttr{Setsid: true, Setctty: true}
+		if err := cmd.Start(); err != nil {
+			master.Close()
+			slave.Close()
+			return err
+		}
+		slave.Close()
+		e.pty = master
+		if stdin != nil {
+			go io.Copy(master, stdin)
+		}
+		if stdout != nil {
+			// Reads fail with EIO once the last slave fd closes; that is EOF
+			e.relayed = make(chan struct{})
+			go func() {
+				io.Copy(stdout, master)
+				close(e.relayed)
+			}()
+		}
+	} else {
+		if stdin != nil {
+			pipe, err := cmd.StdinPipe()
+			if err != nil {
+				return err
+			}
+			go func() {
+				io.Copy(pipe, stdin)
+				pipe.Close()
+			}()
+		}
+		cmd.Stdout, cmd.Stderr = stdout, stderr
+		if err := cmd.Start(); err != nil {
+			return err
+		}
+	}
+	e.running = true
+	e.pid = cmd.Process.Pid
+	return nil
+}
+
+func (e *execInstance) wait() {
+	err := e.cmd.Wait()
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	e.running = false
+	e.endedAt = time.Now()
+	e.exitCode = 0
+	var exitErr *exec.ExitError
+	if errors.As(err, &exitErr) {
+		e.exitCode = exitErr.ExitCode()
+	} else if err != nil {
+		e.exitCode = 126
+	}
+	if e.pty != nil {
+		// Let the relay drain what the process wrote last
+		time.AfterFunc(100*time.Millisecond, func() { e.pty.Close() })
+	}
+}
+
+func (s *server) resizeExec(w http.ResponseWriter, r *http.Request, p []string) error {
+	e, err := s.execs.get(p[0])
+	if err != nil {
+		return err
+	}
+	h, errH := strconv.ParseUint(r.URL.Query().Get("h"), 10, 16)
+	wd, errW := strconv.ParseUint(r.URL.Query().Get("w"), 10, 16)
+	if errH != nil || errW != nil {
+		return badRequest("h and w must be terminal dimensions")
+	}
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	if e.pty == nil {
+		return apiError{http.StatusConflict, "Exec " + e.id + " has no running TTY"}
+	}
+	// nerdctl picks up SIGWINCH on its terminal and resizes the exec
+	if err := setWinsize(e.pty, uint16(h), uint16(wd)); err != nil {
+		return err
+	}
+	w.WriteHeader(http.StatusOK)
+	return nil
+}
+
+func (s *server) inspectExec(w http.ResponseWriter, r *http.Request, p []string) error {
+	e, err := s.execs.get(p[0])
+	if err != nil {
+		return err
+	}
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	c := e.config
+	args := []string{}
+	if len(c.Cmd) > 1 {
+		args = c.Cmd[1:]
+	}
+	return writeJSON(w, http.StatusOK, map[string]any{
+		"ID":          e.id,
+		"Running":     e.running,
+		"ExitCode":    e.exitCode,
+		"ContainerID": e.containerID,
+		"Pid":         e.pid,
+		"OpenStdin":   c.AttachStdin,
+		"OpenStdout":  c.AttachStdout,
+		"OpenStderr":  c.AttachStderr,
+		"ProcessConfig": map[string]any{
+			"tty":        c.Tty,
+			"entrypoint": c.Cmd[0],
+			"arguments":  args,
+			"privileged": c.Privileged,
+			"user":       c.User,
+		},
+	})
+}
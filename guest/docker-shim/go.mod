@@ -0,0 +1,3 @@
+module dockerandroid/docker-shim
+
+go 1.21
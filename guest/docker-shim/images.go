@@ -0,0 +1,255 @@
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"io"
+	"net/http"
+	"regexp"
+	"strconv"
+	"strings"
+)
+
+type imageInspect struct {
+	ID          string `json:"Id"`
+	RepoTags    []string
+	RepoDigests []string
+	Parent      string
+	Created     string
+	Size        int64
+	VirtualSize int64
+	Config      struct {
+		Labels map[string]string
+	}
+}
+
+func (i *imageInspect) summary() map[string]any {
+	labels := i.Config.Labels
+	if labels == nil {
+		labels = map[string]string{}
+	}
+	tags := i.RepoTags
+	if tags == nil {
+		tags = []string{}
+	}
+	digests := i.RepoDigests
+	if digests == nil {
+		digests = []string{}
+	}
+	virtual := i.VirtualSize
+	if virtual == 0 {
+		virtual = i.Size
+	}
+	return map[string]any{
+		"Id":          i.ID,
+		"ParentId":    i.Parent,
+		"RepoTags":    tags,
+		"RepoDigests": digests,
+		"Created":     unixTime(i.Created),
+		"Size":        i.Size,
+		"VirtualSize": virtual,
+		"SharedSize":  -1,
+		"Labels":      labels,
+		"Containers":  -1,
+	}
+}
+
+func (s *server) listImages(w http.ResponseWriter, r *http.Request, _ []string) error {
+	refs, err := s.cli.lines(r.Context(), "images", "--format", "{{.Repository}}:{{.Tag}}")
+	if err != nil {
+		return err
+	}
+	// Untagged images list as <none>:<none> and can't be inspected by name
+	named := refs[:0]
+	seen := map[string]bool{}
+	for _, ref := range refs {
+		if !strings.Contains(ref, "<none>") && !seen[ref] {
+			seen[ref] = true
+			named = append(named, ref)
+		}
+	}
+
+	result := []map[string]any{}
+	if len(named) > 0 {
+		var images []imageInspect
+		if err := s.cli.inspect(r.Context(), "image", &images, named...); err != nil {
+			return err
+		}
+		// nerdctl returns one entry per reference: merge those of one image
+		byID := map[string]int{}
+		for i := range images {
+			if j, ok := byID[images[i].ID]; ok {
+				tags := append(result[j]["RepoTags"].([]string), images[i].RepoTags...)
+				result[j]["RepoTags"] = tags
+				continue
+			}
+			byID[images[i].ID] = len(result)
+			result = append(result, images[i].summary())
+		}
+	}
+	return writeJSON(w, http.StatusOK, result)
+}
+
+func (s *server) inspectImage(w http.ResponseWriter, r *http.Request, p []string) error {
+	raw, err := s.cli.inspectOne(r.Context(), "image", p[0])
+	if err != nil {
+		return err
+	}
+	w.Header().Set("Content-Type", "application/json")
+	_, err = w.Write(raw)
+	return err
+}
+
+// nerdctl's non-interactive progress lines look like
+// "layer-sha256:1a2b...: downloading |+++    | 1.2 MiB/3.4 MiB"
+var (
+	progressLine = regexp.MustCompile(`^(\S+):\s+(\w+)\s*(?:\|[^|]*\|)?\s*(?:([0-9.]+\s*[KMGT]?i?B)/([0-9.]+\s*[KMGT]?i?B))?`)
+	sizeUnits    = map[string]float64{"B": 1, "KiB": 1 << 10, "MiB": 1 << 20, "GiB": 1 << 30, "TiB": 1 << 40,
+		"KB": 1e3, "MB": 1e6, "GB": 1e9, "TB": 1e12}
+)
+
+func parseSize(s string) int64 {
+	s = strings.ReplaceAll(s, " ", "")
+	i := strings.IndexFunc(s, func(r rune) bool { return (r < '0' || r > '9') && r != '.' })
+	if i <= 0 {
+		return 0
+	}
+	n, err := strconv.ParseFloat(s[:i], 64)
+	if err != nil {
+		return 0
+	}
+	return int64(n * sizeUnits[s[i:]])
+}
+
+type pullMessage struct {
+	Status         string          `json:"status,omitempty"`
+	ID             string          `json:"id,omitempty"`
+	ProgressDetail *progressDetail `json:"progressDetail,omitempty"`
+	Error          string          `json:"error,omitempty"`
+	ErrorDetail    *errorDetail    `json:"errorDetail,omitempty"`
+}
+
+type progressDetail struct {
+	Current int64 `json:"current"`
+	Total   int64 `json:"total"`
+}
+
+type errorDetail struct {
+	Message string `json:"message"`
+}
+
+func (s *server) pullImage(w http.ResponseWriter, r *http.Request, _ []string) error {
+	q := r.URL.Query()
+	ref := q.Get("fromImage")
+	if ref == "" {
+		return badRequest("fromImage is required")
+	}
+	if tag := q.Get("tag"); tag != "" {
+		if strings.HasPrefix(tag, "sha256:") {
+			ref += "@" + tag
+		} else {
+			ref += ":" + tag
+		}
+	}
+
+	cmd := s.cli.command(r.Context(), "pull", ref)
+	// Progress goes to stderr; the final digest line to stdout
+	pr, pw := io.Pipe()
+	cmd.Stdout = pw
+	cmd.Stderr = pw
+	if err := cmd.Start(); err != nil {
+		return err
+	}
+	done := make(chan error, 1)
+	go func() {
+		err := cmd.Wait()
+		pw.Close()
+		done <- err
+	}()
+
+	// Docker answers 200 before the pull and reports failure in the stream
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(http.StatusOK)
+	enc := json.NewEncoder(newStreamWriter(w))
+	enc.Encode(pullMessage{Status: "Pulling from " + ref})
+
+	var lastErr string
+	sc := bufio.NewScanner(pr)
+	last := map[string]string{}
+	for sc.Scan() {
+		line := strings.TrimSpace(sc.Text())
+		if line == "" {
+			continue
+		}
+		m := progressLine.FindStringSubmatch(line)
+		if m == nil || strings.HasPrefix(line, "elapsed") {
+			if strings.Contains(strings.ToLower(line), "level=fatal") || strings.Contains(strings.ToLower(line), "error") {
+				lastErr = line
+			}
+			continue
+		}
+		id, status := m[1], m[2]
+		msg := pullMessage{ID: shortLayerID(id), Status: capitalize(status)}
+		if m[3] != "" {
+			msg.ProgressDetail = &progressDetail{Current: parseSize(m[3]), Total: parseSize(m[4])}
+		} else if last[id] == status {
+			// Non-interactive output repeats every layer each tick
+			continue
+		}
+		last[id] = status
+		enc.Encode(msg)
+	}
+
+	if err := <-done; err != nil {
+		message := (&cliError{stderr: lastErr, err: err}).Error()
+		enc.Encode(pullMessage{Error: message, ErrorDetail: &errorDetail{message}})
+		return nil
+	}
+	enc.Encode(pullMessage{Status: "Status: Downloaded newer image for " + ref})
+	return nil
+}
+
+// shortLayerID turns "layer-sha256:1a2b3c..." into Docker's 12-digit id
+func shortLayerID(id string) string {
+	if _, digest, ok := strings.Cut(id, "sha256:"); ok && len(digest) >= 12 {
+		return digest[:12]
+	}
+	return id
+}
+
+func (s *server) removeImage(w http.ResponseWriter, r *http.Request, p []string) error {
+	args := []string{"rmi"}
+	if boolParam(r, "force") {
+		args = append(args, "-f")
+	}
+	if _, err := s.cli.run(r.Context(), append(args, p[0])...); err != nil {
+		return err
+	}
+	return writeJSON(w, http.StatusOK, []map[string]string{{"Untagged": p[0]}})
+}
+
+func (s *server) pruneImages(w http.ResponseWriter, r *http.Request, _ []string) error {
+	filters, err := filterParam(r)
+	if err != nil {
+		return err
+	}
+	args := []string{"image", "prune", "-f"}
+	// Docker prunes only dangling images unless dangling=false; the app
+	// passes it as a plain query parameter
+	dangling := filters["dangling"]
+	if q := r.URL.Query().Get("dangling"); q != "" {
+		dangling = []string{q}
+	}
+	if len(dangling) > 0 && (dangling[0] == "false" || dangling[0] == "0") {
+		args = append(args, "-a")
+	}
+	deleted, err := s.pruned(r.Context(), args...)
+	if err != nil {
+		return err
+	}
+	images := []map[string]string{}
+	for _, ref := range deleted {
+		images = append(images, map[string]string{"Deleted": ref})
+	}
+	return writeJSON(w, http.StatusOK, map[string]any{"ImagesDeleted": images, "SpaceReclaimed": 0})
+}
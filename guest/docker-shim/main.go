@@ -0,0 +1,94 @@
+// Command docker-shim serves the subset of the Docker Engine API used by
+// the app's DockerAPI client on top of containerd, for the "lite" runtime
+// profile on low-RAM devices.
+//
+// dockerd, its containerd client and one docker-proxy per published port
+// take a large share of a 512 MB-1 GB guest. In the lite profile only
+// containerd runs permanently; this shim translates API calls into nerdctl
+// invocations (a short-lived CLI, so nothing stays resident) and reads
+// container stats straight from cgroup v2. Port publishing goes through
+// the CNI portmap plugin, so there are no proxy processes either. With
+// -snapshotter stargz, images are pulled lazily: containers start once the
+// files they touch have been fetched, and the rest streams in behind them.
+//
+// Covered: /_ping, /version, /info, containers (list, inspect, create,
+// start, stop, restart, kill, remove, logs, stats, prune), images (list,
+// inspect, pull, remove, prune), exec (create, start with or without
+// hijacking, resize, inspect), volumes, networks, /events and
+// /system/prune. Anything else answers 501 in Docker's error format.
+package main
+
+import (
+	"context"
+	"errors"
+	"flag"
+	"log"
+	"net"
+	"net/http"
+	"os"
+	"os/signal"
+	"syscall"
+	"time"
+)
+
+// Version reported by /version and /info, set at build time with -ldflags
+var version = "dev"
+
+func main() {
+	unixPath := flag.String("unix", "/var/run/docker.sock", "Unix socket to serve on (empty to disable)")
+	tcpAddr := flag.String("tcp", "0.0.0.0:2375", "TCP address to serve on (empty to disable)")
+	nerdctlBin := flag.String("nerdctl", "nerdctl", "nerdctl binary")
+	namespace := flag.String("namespace", "default", "containerd namespace")
+	snapshotter := flag.String("snapshotter", "", "containerd snapshotter (empty for nerdctl's default, overlayfs)")
+	flag.Parse()
+
+	log.SetFlags(log.LstdFlags | log.Lmicroseconds)
+
+	srv := newServer(&nerdctl{bin: *nerdctlBin, namespace: *namespace, snapshotter: *snapshotter})
+	httpServer := &http.Server{
+		Handler:           srv,
+		ReadHeaderTimeout: 10 * time.Second,
+	}
+
+	var listeners []net.Listener
+	if *unixPath != "" {
+		// A stale socket from a previous run blocks bind
+		os.Remove(*unixPath)
+		l, err := net.Listen("unix", *unixPath)
+		if err != nil {
+			log.Fatalf("listen %s: %v", *unixPath, err)
+		}
+		os.Chmod(*unixPath, 0660)
+		listeners = append(listeners, l)
+	}
+	if *tcpAddr != "" {
+		l, err := net.Listen("tcp", *tcpAddr)
+		if err != nil {
+			log.Fatalf("listen %s: %v", *tcpAddr, err)
+		}
+		listeners = append(listeners, l)
+	}
+	if len(listeners) == 0 {
+		log.Fatal("nothing to listen on")
+	}
+
+	for _, l := range listeners {
+		go func(l net.Listener) {
+			log.Printf("serving Docker API on %s", l.Addr())
+			if err := httpServer.Serve(l); err != nil && !errors.Is(err, http.ErrServerClosed) {
+				log.Fatalf("serve %s: %v", l.Addr(), err)
+			}
+		}(l)
+	}
+
+	stop := make(chan os.Signal, 1)
+	signal.Notify(stop, syscall.SIGINT, syscall.SIGTERM)
+	<-stop
+
+	ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+	defer cancel()
+	httpServer.Shutdown(ctx)
+	if *unixPath != "" {
+		os.Remove(*unixPath)
+	}
+}
@@ -0,0 +1,103 @@
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"context"
+	"encoding/json"
+	"fmt"
+	"os/exec"
+	"strings"
+)
+
+// nerdctl runs the containerd CLI. Every call is a fresh process, so the
+// shim holds no containerd client state between requests.
+type nerdctl struct {
+	bin         string
+	namespace   string
+	snapshotter string
+}
+
+type cliError struct {
+	args   []string
+	stderr string
+	err    error
+}
+
+func (e *cliError) Error() string {
+	msg := strings.TrimSpace(e.stderr)
+	if msg == "" {
+		msg = e.err.Error()
+	}
+	// nerdctl logs through logrus: keep the message, drop the decoration
+	if i := strings.LastIndex(msg, "msg=\""); i >= 0 {
+		msg = strings.TrimSuffix(msg[i+5:], "\"")
+	}
+	return msg
+}
+
+func (n *nerdctl) command(ctx context.Context, args ...string) *exec.Cmd {
+	full := []string{"--namespace", n.namespace}
+	if n.snapshotter != "" {
+		full = append(full, "--snapshotter", n.snapshotter)
+	}
+	full = append(full, args...)
+	return exec.CommandContext(ctx, n.bin, full...)
+}
+
+// run returns stdout, or the stderr text as the error
+func (n *nerdctl) run(ctx context.Context, args ...string) ([]byte, error) {
+	cmd := n.command(ctx, args...)
+	var stdout, stderr bytes.Buffer
+	cmd.Stdout = &stdout
+	cmd.Stderr = &stderr
+	if err := cmd.Run(); err != nil {
+		return nil, &cliError{args, stderr.String(), err}
+	}
+	return stdout.Bytes(), nil
+}
+
+// lines runs a command and returns its non-empty output lines
+func (n *nerdctl) lines(ctx context.Context, args ...string) ([]string, error) {
+	out, err := n.run(ctx, args...)
+	if err != nil {
+		return nil, err
+	}
+	var result []string
+	sc := bufio.NewScanner(bytes.NewReader(out))
+	for sc.Scan() {
+		if line := strings.TrimSpace(sc.Text()); line != "" {
+			result = append(result, line)
+		}
+	}
+	return result, nil
+}
+
+// inspect decodes `nerdctl <kind> inspect --mode=dockercompat` output,
+// which is already in Docker's shape
+func (n *nerdctl) inspect(ctx context.Context, kind string, v any, names ...string) error {
+	args := []string{kind, "inspect"}
+	if kind != "volume" {
+		args = append(args, "--mode=dockercompat")
+	}
+	out, err := n.run(ctx, append(args, names...)...)
+	if err != nil {
+		return err
+	}
+	if err := json.Unmarshal(out, v); err != nil {
+		return fmt.Errorf("decode %s inspect: %w", kind, err)
+	}
+	return nil
+}
+
+// inspectOne returns the raw Docker-shaped object for a single name
+func (n *nerdctl) inspectOne(ctx context.Context, kind, name string) (json.RawMessage, error) {
+	var items []json.RawMessage
+	if err := n.inspect(ctx, kind, &items, name); err != nil {
+		return nil, err
+	}
+	if len(items) == 0 {
+		return nil, apiError{404, fmt.Sprintf("No such %s: %s", kind, name)}
+	}
+	return items[0], nil
+}
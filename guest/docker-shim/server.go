@@ -0,0 +1,260 @@
+package main
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"log"
+	"net/http"
+	"regexp"
+	"strconv"
+	"strings"
+	"time"
+)
+
+// API version advertised; the client sends unversioned paths anyway
+const apiVersion = "1.43"
+
+type handlerFunc func(w http.ResponseWriter, r *http.Request, params []string) error
+
+type route struct {
+	method  string
+	pattern *regexp.Regexp
+	handler handlerFunc
+}
+
+type server struct {
+	cli    *nerdctl
+	routes []route
+	execs  *execStore
+	ttys   *ttyCache
+}
+
+var versionPrefix = regexp.MustCompile(`^/v[0-9]+\.[0-9]+`)
+
+func newServer(cli *nerdctl) *server {
+	s := &server{cli: cli, execs: newExecStore(), ttys: newTTYCache()}
+
+	// Names may contain slashes (images) so they are matched greedily
+	// where the API allows it
+	s.handle("GET", `/_ping`, s.ping)
+	s.handle("HEAD", `/_ping`, s.ping)
+	s.handle("GET", `/version`, s.version)
+	s.handle("GET", `/info`, s.info)
+	s.handle("GET", `/events`, s.events)
+	s.handle("POST", `/system/prune`, s.systemPrune)
+
+	s.handle("GET", `/containers/json`, s.listContainers)
+	s.handle("POST", `/containers/create`, s.createContainer)
+	s.handle("POST", `/containers/prune`, s.pruneContainers)
+	s.handle("GET", `/containers/([^/]+)/json`, s.inspectContainer)
+	s.handle("POST", `/containers/([^/]+)/(start|stop|restart|kill|pause|unpause)`, s.containerAction)
+	s.handle("POST", `/containers/([^/]+)/rename`, s.renameContainer)
+	s.handle("POST", `/containers/([^/]+)/update`, s.updateContainer)
+	s.handle("GET", `/containers/([^/]+)/checkpoints`, s.listCheckpoints)
+	s.handle("POST", `/containers/([^/]+)/checkpoints`, s.createCheckpoint)
+	s.handle("DELETE", `/containers/([^/]+)/checkpoints/([^/]+)`, s.removeCheckpoint)
+	s.handle("DELETE", `/containers/([^/]+)`, s.removeContainer)
+	s.handle("GET", `/containers/([^/]+)/logs`, s.containerLogs)
+	s.handle("GET", `/containers/([^/]+)/stats`, s.containerStats)
+	s.handle("POST", `/containers/([^/]+)/exec`, s.createExec)
+
+	s.handle("POST", `/exec/([^/]+)/start`, s.startExec)
+	s.handle("POST", `/exec/([^/]+)/resize`, s.resizeExec)
+	s.handle("GET", `/exec/([^/]+)/json`, s.inspectExec)
+
+	s.handle("GET", `/images/json`, s.listImages)
+	s.handle("POST", `/images/create`, s.pullImage)
+	s.handle("POST", `/images/prune`, s.pruneImages)
+	s.handle("GET", `/images/(.+)/json`, s.inspectImage)
+	s.handle("DELETE", `/images/(.+)`, s.removeImage)
+
+	s.handle("GET", `/volumes`, s.listVolumes)
+	s.handle("POST", `/volumes/create`, s.createVolume)
+	s.handle("POST", `/volumes/prune`, s.pruneVolumes)
+	s.handle("DELETE", `/volumes/([^/]+)`, s.removeVolume)
+
+	s.handle("GET", `/networks`, s.listNetworks)
+	s.handle("POST", `/networks/create`, s.createNetwork)
+	s.handle("DELETE", `/networks/([^/]+)`, s.removeNetwork)
+
+	return s
+}
+
+func (s *server) handle(method, pattern string, h handlerFunc) {
+	s.routes = append(s.routes, route{method, regexp.MustCompile("^" + pattern + "$"), h})
+}
+
+func (s *server) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	start := time.Now()
+	path := versionPrefix.ReplaceAllString(r.URL.Path, "")
+
+	w.Header().Set("Api-Version", apiVersion)
+	w.Header().Set("Server", "docker-shim/"+version)
+
+	pathMatched := false
+	for _, rt := range s.routes {
+		m := rt.pattern.FindStringSubmatch(path)
+		if m == nil {
+			continue
+		}
+		pathMatched = true
+		if rt.method != r.Method {
+			continue
+		}
+		if err := rt.handler(w, r, m[1:]); err != nil {
+			writeError(w, err)
+			log.Printf("%s %s: %v (%s)", r.Method, path, err, time.Since(start))
+		}
+		return
+	}
+	if pathMatched {
+		writeError(w, apiError{http.StatusMethodNotAllowed, "method not allowed"})
+		return
+	}
+	writeError(w, apiError{http.StatusNotImplemented, fmt.Sprintf("%s %s is not supported by the lite runtime", r.Method, path)})
+}
+
+// ============== Responses ==============
+
+type apiError struct {
+	status  int
+	message string
+}
+
+func (e apiError) Error() string { return e.message }
+
+func badRequest(format string, args ...any) error {
+	return apiError{http.StatusBadRequest, fmt.Sprintf(format, args...)}
+}
+
+// Map nerdctl failures onto the status codes Docker would use
+func statusFor(err error) int {
+	var ae apiError
+	if errors.As(err, &ae) {
+		return ae.status
+	}
+	msg := strings.ToLower(err.Error())
+	switch {
+	case strings.Contains(msg, "no such"), strings.Contains(msg, "not found"):
+		return http.StatusNotFound
+	case strings.Contains(msg, "already exists"), strings.Contains(msg, "in use"),
+		strings.Contains(msg, "is running"), strings.Contains(msg, "conflict"):
+		return http.StatusConflict
+	case strings.Contains(msg, "not running"), strings.Contains(msg, "already stopped"):
+		return http.StatusNotModified
+	}
+	return http.StatusInternalServerError
+}
+
+func writeError(w http.ResponseWriter, err error) {
+	status := statusFor(err)
+	if status == http.StatusNotModified {
+		w.WriteHeader(status)
+		return
+	}
+	writeJSON(w, status, map[string]string{"message": err.Error()})
+}
+
+func writeJSON(w http.ResponseWriter, status int, v any) error {
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(status)
+	return json.NewEncoder(w).Encode(v)
+}
+
+func noContent(w http.ResponseWriter) error {
+	w.WriteHeader(http.StatusNoContent)
+	return nil
+}
+
+// ============== Request helpers ==============
+
+// Docker accepts 1/true/True for booleans
+func boolParam(r *http.Request, name string) bool {
+	v, err := strconv.ParseBool(r.URL.Query().Get(name))
+	return err == nil && v
+}
+
+func decodeBody(r *http.Request, v any) error {
+	if r.Body == nil || r.ContentLength == 0 {
+		return nil
+	}
+	if err := json.NewDecoder(r.Body).Decode(v); err != nil {
+		return badRequest("invalid request body: %v", err)
+	}
+	return nil
+}
+
+// filters={"key":["v1","v2"]} or the legacy {"key":{"v1":true}}
+func filterParam(r *http.Request) (map[string][]string, error) {
+	raw := r.URL.Query().Get("filters")
+	result := map[string][]string{}
+	if raw == "" {
+		return result, nil
+	}
+	var lists map[string][]string
+	if err := json.Unmarshal([]byte(raw), &lists); err == nil {
+		return lists, nil
+	}
+	var sets map[string]map[string]bool
+	if err := json.Unmarshal([]byte(raw), &sets); err != nil {
+		return nil, badRequest("invalid filters: %v", err)
+	}
+	for key, set := range sets {
+		for value, on := range set {
+			if on {
+				result[key] = append(result[key], value)
+			}
+		}
+	}
+	return result, nil
+}
+
+// strSlice accepts both "cmd" and ["cmd", "arg"], like Docker's strslice
+type strSlice []string
+
+func (s *strSlice) UnmarshalJSON(b []byte) error {
+	if string(b) == "null" {
+		*s = nil
+		return nil
+	}
+	var one string
+	if err := json.Unmarshal(b, &one); err == nil {
+		*s = []string{one}
+		return nil
+	}
+	var many []string
+	if err := json.Unmarshal(b, &many); err != nil {
+		return err
+	}
+	*s = many
+	return nil
+}
+
+func unixTime(s string) int64 {
+	for _, layout := range []string{time.RFC3339Nano, "2006-01-02 15:04:05 -0700 MST", "2006-01-02 15:04:05.999999999 -0700 MST"} {
+		if t, err := time.Parse(layout, s); err == nil {
+			return t.Unix()
+		}
+	}
+	return 0
+}
+
+// streamWriter flushes every write so clients see progress immediately
+type streamWriter struct {
+	w http.ResponseWriter
+	f http.Flusher
+}
+
+func newStreamWriter(w http.ResponseWriter) *streamWriter {
+	f, _ := w.(http.Flusher)
+	return &streamWriter{w, f}
+}
+
+func (s *streamWriter) Write(p []byte) (int, error) {
+	n, err := s.w.Write(p)
+	if s.f != nil {
+		s.f.Flush()
+	}
+	return n, err
+}
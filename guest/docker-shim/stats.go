@@ -0,0 +1,264 @@
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"fmt"
+	"net/http"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strconv"
+	"strings"
+	"time"
+)
+
+// Stats come straight from cgroup v2 and /proc rather than through
+// nerdctl, which would cost a process (and a containerd round trip) per
+// sample; the app polls every container every few seconds.
+
+const cgroupRoot = "/sys/fs/cgroup"
+
+// Linux USER_HZ; /proc/stat counts in these
+const clockTicks = 100
+
+type cpuUsage struct {
+	TotalUsage        uint64   `json:"total_usage"`
+	PercpuUsage       []uint64 `json:"percpu_usage,omitempty"`
+	UsageInKernelmode uint64   `json:"usage_in_kernelmode"`
+	UsageInUsermode   uint64   `json:"usage_in_usermode"`
+}
+
+type cpuStats struct {
+	CPUUsage       cpuUsage `json:"cpu_usage"`
+	SystemCPUUsage uint64   `json:"system_cpu_usage"`
+	OnlineCPUs     int      `json:"online_cpus"`
+}
+
+type memoryStats struct {
+	Usage    uint64            `json:"usage"`
+	MaxUsage uint64            `json:"max_usage,omitempty"`
+	Limit    uint64            `json:"limit"`
+	Stats    map[string]uint64 `json:"stats,omitempty"`
+}
+
+type netStats struct {
+	RxBytes   uint64 `json:"rx_bytes"`
+	RxPackets uint64 `json:"rx_packets"`
+	RxErrors  uint64 `json:"rx_errors"`
+	RxDropped uint64 `json:"rx_dropped"`
+	TxBytes   uint64 `json:"tx_bytes"`
+	TxPackets uint64 `json:"tx_packets"`
+	TxErrors  uint64 `json:"tx_errors"`
+	TxDropped uint64 `json:"tx_dropped"`
+}
+
+type containerStats struct {
+	Read        string              `json:"read"`
+	PreRead     string              `json:"preread"`
+	ID          string              `json:"id"`
+	Name        string              `json:"name"`
+	CPUStats    cpuStats            `json:"cpu_stats"`
+	PreCPUStats cpuStats            `json:"precpu_stats"`
+	MemoryStats memoryStats         `json:"memory_stats"`
+	PidsStats   map[string]uint64   `json:"pids_stats"`
+	Networks    map[string]netStats `json:"networks,omitempty"`
+}
+
+type sample struct {
+	at  time.Time
+	cpu cpuStats
+}
+
+func (s *server) containerStats(w http.ResponseWriter, r *http.Request, p []string) error {
+	var containers []containerInspect
+	if err := s.cli.inspect(r.Context(), "container", &containers, p[0]); err != nil {
+		return err
+	}
+	if len(containers) == 0 {
+		return apiError{http.StatusNotFound, "No such container: " + p[0]}
+	}
+	c := containers[0]
+	stream := r.URL.Query().Get("stream") == "" || boolParam(r, "stream")
+
+	// A stopped container has no cgroup: Docker answers with zeroes
+	cgroup := ""
+	if c.State.Running && c.State.Pid > 0 {
+		var err error
+		if cgroup, err = cgroupPath(c.State.Pid); err != nil {
+			return err
+		}
+	}
+
+	// Docker primes precpu with a sample one second earlier unless the
+	// client opts out; the app's CPU percentage needs the delta
+	prev := sample{at: time.Now(), cpu: readCPU(cgroup)}
+	if !boolParam(r, "one-shot") {
+		select {
+		case <-time.After(time.Second):
+		case <-r.Context().Done():
+			return nil
+		}
+	}
+
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(http.StatusOK)
+	out := newStreamWriter(w)
+	enc := json.NewEncoder(out)
+	for {
+		cur := sample{at: time.Now(), cpu: readCPU(cgroup)}
+		stats := containerStats{
+			Read:        cur.at.UTC().Format(time.RFC3339Nano),
+			PreRead:     prev.at.UTC().Format(time.RFC3339Nano),
+			ID:          c.ID,
+			Name:        "/" + strings.TrimPrefix(c.Name, "/"),
+			CPUStats:    cur.cpu,
+			PreCPUStats: prev.cpu,
+			MemoryStats: readMemory(cgroup),
+			PidsStats:   map[string]uint64{"current": 0},
+		}
+		if cgroup != "" {
+			stats.PidsStats["current"] = readUint(filepath.Join(cgroup, "pids.current"))
+			stats.Networks = readNetDev(c.State.Pid)
+		}
+		if err := enc.Encode(stats); err != nil || !stream {
+			return nil
+		}
+		prev = cur
+		select {
+		case <-time.After(time.Second):
+		case <-r.Context().Done():
+			return nil
+		}
+	}
+}
+
+// cgroupPath resolves the unified-hierarchy cgroup directory of a process
+func cgroupPath(pid int) (string, error) {
+	data, err := os.ReadFile(fmt.Sprintf("/proc/%d/cgroup", pid))
+	if err != nil {
+		return "", err
+	}
+	for _, line := range strings.Split(string(data), "\n") {
+		if rest, ok := strings.CutPrefix(line, "0::"); ok {
+			return filepath.Join(cgroupRoot, rest), nil
+		}
+	}
+	return "", fmt.Errorf("process %d is not in a cgroup v2 hierarchy", pid)
+}
+
+func readCPU(cgroup string) cpuStats {
+	stats := cpuStats{SystemCPUUsage: systemCPUUsage(), OnlineCPUs: runtime.NumCPU()}
+	if cgroup == "" {
+		return stats
+	}
+	kv := readKeyValues(filepath.Join(cgroup, "cpu.stat"))
+	// cgroup v2 reports microseconds, the Docker API nanoseconds
+	stats.CPUUsage.TotalUsage = kv["usage_usec"] * 1000
+	stats.CPUUsage.UsageInUsermode = kv["user_usec"] * 1000
+	stats.CPUUsage.UsageInKernelmode = kv["system_usec"] * 1000
+	return stats
+}
+
+func readMemory(cgroup string) memoryStats {
+	stats := memoryStats{Limit: hostMemory()}
+	if cgroup == "" {
+		return stats
+	}
+	stats.Usage = readUint(filepath.Join(cgroup, "memory.current"))
+	stats.MaxUsage = readUint(filepath.Join(cgroup, "memory.peak"))
+	if max := readUint(filepath.Join(cgroup, "memory.max")); max > 0 && max < stats.Limit {
+		stats.Limit = max
+	}
+	stats.Stats = readKeyValues(filepath.Join(cgroup, "memory.stat"))
+	return stats
+}
+
+// systemCPUUsage is host CPU time in nanoseconds, the denominator of
+// Docker's CPU percentage
+func systemCPUUsage() uint64 {
+	f, err := os.Open("/proc/stat")
+	if err != nil {
+		return 0
+	}
+	defer f.Close()
+	sc := bufio.NewScanner(f)
+	if !sc.Scan() {
+		return 0
+	}
+	fields := strings.Fields(sc.Text())
+	if len(fields) == 0 || fields[0] != "cpu" {
+		return 0
+	}
+	var ticks uint64
+	// user nice system idle iowait irq softirq steal
+	for i := 1; i < len(fields) && i <= 8; i++ {
+		v, _ := strconv.ParseUint(fields[i], 10, 64)
+		ticks += v
+	}
+	return ticks * (1e9 / clockTicks)
+}
+
+func hostMemory() uint64 {
+	kv := readKeyValues("/proc/meminfo")
+	return kv["MemTotal:"] * 1024
+}
+
+// readNetDev reads the counters of the container's network namespace
+func readNetDev(pid int) map[string]netStats {
+	f, err := os.Open(fmt.Sprintf("/proc/%d/net/dev", pid))
+	if err != nil {
+		return nil
+	}
+	defer f.Close()
+	result := map[string]netStats{}
+	sc := bufio.NewScanner(f)
+	for sc.Scan() {
+		name, rest, ok := strings.Cut(sc.Text(), ":")
+		name = strings.TrimSpace(name)
+		if !ok || name == "lo" {
+			continue
+		}
+		f := strings.Fields(rest)
+		if len(f) < 16 {
+			continue
+		}
+		n := func(i int) uint64 { v, _ := strconv.ParseUint(f[i], 10, 64); return v }
+		result[name] = netStats{
+			RxBytes: n(0), RxPackets: n(1), RxErrors: n(2), RxDropped: n(3),
+			TxBytes: n(8), TxPackets: n(9), TxErrors: n(10), TxDropped: n(11),
+		}
+	}
+	return result
+}
+
+// readKeyValues parses "key value" lines (cpu.stat, memory.stat, meminfo)
+func readKeyValues(path string) map[string]uint64 {
+	result := map[string]uint64{}
+	f, err := os.Open(path)
+	if err != nil {
+		return result
+	}
+	defer f.Close()
+	sc := bufio.NewScanner(f)
+	for sc.Scan() {
+		fields := strings.Fields(sc.Text())
+		if len(fields) < 2 {
+			continue
+		}
+		if v, err := strconv.ParseUint(fields[1], 10, 64); err == nil {
+			result[fields[0]] = v
+		}
+	}
+	return result
+}
+
+// readUint reads a single-value cgroup file; "max" and errors read as 0
+func readUint(path string) uint64 {
+	data, err := os.ReadFile(path)
+	if err != nil {
+		return 0
+	}
+	v, _ := strconv.ParseUint(strings.TrimSpace(string(data)), 10, 64)
+	return v
+}
@@ -0,0 +1,406 @@
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"net/http"
+	"os"
+	"runtime"
+	"strings"
+	"syscall"
+	"time"
+)
+
+// ============== System ==============
+
+func (s *server) ping(w http.ResponseWriter, r *http.Request, _ []string) error {
+	w.Header().Set("Content-Type", "text/plain; charset=utf-8")
+	w.Header().Set("Cache-Control", "no-cache, no-store, must-revalidate")
+	w.WriteHeader(http.StatusOK)
+	if r.Method != http.MethodHead {
+		w.Write([]byte("OK"))
+	}
+	return nil
+}
+
+func kernelRelease() string {
+	var u syscall.Utsname
+	if syscall.Uname(&u) != nil {
+		return ""
+	}
+	b := make([]byte, 0, len(u.Release))
+	for _, c := range u.Release {
+		if c == 0 {
+			break
+		}
+		b = append(b, byte(c))
+	}
+	return string(b)
+}
+
+func (s *server) version(w http.ResponseWriter, r *http.Request, _ []string) error {
+	return writeJSON(w, http.StatusOK, map[string]any{
+		"Version":       version,
+		"ApiVersion":    apiVersion,
+		"MinAPIVersion": "1.24",
+		"Os":            runtime.GOOS,
+		"Arch":          runtime.GOARCH,
+		"KernelVersion": kernelRelease(),
+		"GoVersion":     runtime.Version(),
+		"Components": []map[string]string{
+			{"Name": "docker-shim", "Version": version},
+		},
+	})
+}
+
+// osName reads PRETTY_NAME from os-release
+func osName() string {
+	f, err := os.Open("/etc/os-release")
+	if err != nil {
+		return "Linux"
+	}
+	defer f.Close()
+	sc := bufio.NewScanner(f)
+	for sc.Scan() {
+		if v, ok := strings.CutPrefix(sc.Text(), "PRETTY_NAME="); ok {
+			return strings.Trim(v, `"`)
+		}
+	}
+	return "Linux"
+}
+
+func (s *server) info(w http.ResponseWriter, r *http.Request, _ []string) error {
+	ctx := r.Context()
+	states, err := s.cli.lines(ctx, "ps", "-a", "--format", "{{.Status}}")
+	if err != nil {
+		return err
+	}
+	var running, paused, stopped int
+	for _, st := range states {
+		switch {
+		case strings.HasPrefix(st, "Up") && strings.Contains(st, "Paused"):
+			paused++
+		case strings.HasPrefix(st, "Up"):
+			running++
+		default:
+			stopped++
+		}
+	}
+	images, err := s.cli.lines(ctx, "images", "-q")
+	if err != nil {
+		return err
+	}
+	unique := map[string]bool{}
+	for _, id := range images {
+		unique[id] = true
+	}
+	hostname, _ := os.Hostname()
+	driver := "overlayfs"
+	if s.cli.snapshotter != "" {
+		driver = s.cli.snapshotter
+	}
+
+	return writeJSON(w, http.StatusOK, map[string]any{
+		"ID":                hostname,
+		"Containers":        len(states),
+		"ContainersRunning": running,
+		"ContainersPaused":  paused,
+		"ContainersStopped": stopped,
+		"Images":            len(unique),
+		"Driver":            driver,
+		"MemTotal":          hostMemory(),
+		"Name":              hostname,
+		"NCPU":              runtime.NumCPU(),
+		"OperatingSystem":   osName(),
+		"OSType":            runtime.GOOS,
+		"Architecture":      kernelArch(),
+		"KernelVersion":     kernelRelease(),
+		"DockerRootDir":     "/var/lib/containerd",
+		"ServerVersion":     version,
+		"CgroupVersion":     "2",
+		"CgroupDriver":      "cgroupfs",
+		"SystemTime":        time.Now().Format(time.RFC3339Nano),
+	})
+}
+
+func kernelArch() string {
+	switch runtime.GOARCH {
+	case "amd64":
+		return "x86_64"
+	case "arm64":
+		return "aarch64"
+	}
+	return runtime.GOARCH
+}
+
+func (s *server) systemPrune(w http.ResponseWriter, r *http.Request, _ []string) error {
+	args := []string{"system", "prune", "-f"}
+	if boolParam(r, "all") {
+		args = append(args, "-a")
+	}
+	if boolParam(r, "volumes") {
+		args = append(args, "--volumes")
+	}
+	if _, err := s.cli.run(r.Context(), args...); err != nil {
+		return err
+	}
+	// nerdctl doesn't report reclaimed space
+	return writeJSON(w, http.StatusOK, map[string]any{"SpaceReclaimed": 0})
+}
+
+// ============== Volumes ==============
+
+// nerdctl volume inspect (native mode)
+type volumeInspect struct {
+	Name       string
+	Mountpoint string
+	Labels     map[string]string
+	Size       int64
+}
+
+func (v *volumeInspect) docker() map[string]any {
+	labels := v.Labels
+	if labels == nil {
+		labels = map[string]string{}
+	}
+	created := ""
+	if fi, err := os.Lstat(v.Mountpoint); err == nil {
+		created = fi.ModTime().UTC().Format(time.RFC3339)
+	}
+	options := map[string]string{}
+	if device, err := os.Readlink(v.Mountpoint); err == nil {
+		options = map[string]string{"type": "none", "o": "bind", "device": device}
+	}
+	return map[string]any{
+		"Name":       v.Name,
+		"Driver":     "local",
+		"Mountpoint": v.Mountpoint,
+		"CreatedAt":  created,
+		"Labels":     labels,
+		"Scope":      "local",
+		"Options":    options,
+	}
+}
+
+// bindVolume points a volume's data directory at device, the way the
+// local driver's type=none,o=bind options do under dockerd. nerdctl has
+// no driver options, but bind-mounts the data directory into containers,
+// and the mount follows the symlink.
+func bindVolume(mountpoint, device string) error {
+	if err := os.MkdirAll(device, 0755); err != nil {
+		return err
+	}
+	if err := os.Remove(mountpoint); err != nil {
+		return err
+	}
+	return os.Symlink(device, mountpoint)
+}
+
+func (s *server) listVolumes(w http.ResponseWriter, r *http.Request, _ []string) error {
+	names, err := s.cli.lines(r.Context(), "volume", "ls", "-q")
+	if err != nil {
+		return err
+	}
+	volumes := []map[string]any{}
+	if len(names) > 0 {
+		var inspected []volumeInspect
+		if err := s.cli.inspect(r.Context(), "volume", &inspected, names...); err != nil {
+			return err
+		}
+		for i := range inspected {
+			volumes = append(volumes, inspected[i].docker())
+		}
+	}
+	return writeJSON(w, http.StatusOK, map[string]any{"Volumes": volumes, "Warnings": []string{}})
+}
+
+func (s *server) createVolume(w http.ResponseWriter, r *http.Request, _ []string) error {
+	var req struct {
+		Name       string
+		Driver     string
+		Labels     map[string]string
+		DriverOpts map[string]string
+	}
+	if err := decodeBody(r, &req); err != nil {
+		return err
+	}
+	if req.Driver != "" && req.Driver != "local" {
+		return badRequest("volume driver %q is not supported by the lite runtime", req.Driver)
+	}
+	device := ""
+	if len(req.DriverOpts) > 0 {
+		device = req.DriverOpts["device"]
+		if req.DriverOpts["type"] != "none" || req.DriverOpts["o"] != "bind" || !strings.HasPrefix(device, "/") {
+			return badRequest("the lite runtime only supports bind volumes (type=none, o=bind, absolute device)")
+		}
+	}
+	if req.Name == "" {
+		req.Name = newID()
+	}
+	args := []string{"volume", "create"}
+	for k, v := range req.Labels {
+		args = append(args, "--label", k+"="+v)
+	}
+	if _, err := s.cli.run(r.Context(), append(args, req.Name)...); err != nil {
+		return err
+	}
+	var inspected []volumeInspect
+	if err := s.cli.inspect(r.Context(), "volume", &inspected, req.Name); err != nil {
+		return err
+	}
+	if len(inspected) == 0 {
+		return apiError{http.StatusNotFound, "No such volume: " + req.Name}
+	}
+	if device != "" {
+		if err := bindVolume(inspected[0].Mountpoint, device); err != nil {
+			return err
+		}
+	}
+	return writeJSON(w, http.StatusCreated, inspected[0].docker())
+}
+
+func (s *server) removeVolume(w http.ResponseWriter, r *http.Request, p []string) error {
+	args := []string{"volume", "rm"}
+	if boolParam(r, "force") {
+		args = append(args, "-f")
+	}
+	if _, err := s.cli.run(r.Context(), append(args, p[0])...); err != nil {
+		return err
+	}
+	return noContent(w)
+}
+
+func (s *server) pruneVolumes(w http.ResponseWriter, r *http.Request, _ []string) error {
+	deleted, err := s.pruned(r.Context(), "volume", "prune", "-f")
+	if err != nil {
+		return err
+	}
+	return writeJSON(w, http.StatusOK, map[string]any{"VolumesDeleted": deleted, "SpaceReclaimed": 0})
+}
+
+// ============== Networks ==============
+
+type networkInspect struct {
+	Name   string
+	ID     string `json:"Id"`
+	Driver string
+	IPAM   struct {
+		Config []struct {
+			Subnet  string
+			Gateway string
+		}
+	}
+	Labels map[string]string
+}
+
+func (n *networkInspect) docker() map[string]any {
+	labels := n.Labels
+	if labels == nil {
+		labels = map[string]string{}
+	}
+	config := []map[string]string{}
+	for _, c := range n.IPAM.Config {
+		config = append(config, map[string]string{"Subnet": c.Subnet, "Gateway": c.Gateway})
+	}
+	driver := n.Driver
+	if driver == "" {
+		driver = "bridge"
+	}
+	id := n.ID
+	if id == "" {
+		id = n.Name
+	}
+	return map[string]any{
+		"Id":         id,
+		"Name":       n.Name,
+		"Created":    "",
+		"Scope":      "local",
+		"Driver":     driver,
+		"EnableIPv6": false,
+		"IPAM":       map[string]any{"Driver": "default", "Config": config},
+		"Internal":   false,
+		"Attachable": false,
+		"Ingress":    false,
+		"Options":    map[string]string{},
+		"Labels":     labels,
+	}
+}
+
+func (s *server) listNetworks(w http.ResponseWriter, r *http.Request, _ []string) error {
+	names, err := s.cli.lines(r.Context(), "network", "ls", "-q")
+	if err != nil {
+		return err
+	}
+	// ls -q prints ids; networks without one (host, none) list by name
+	lsNames, err := s.cli.lines(r.Context(), "network", "ls", "--format", "{{.Name}}")
+	if err == nil && len(lsNames) >= len(names) {
+		names = lsNames
+	}
+	networks := []map[string]any{}
+	if len(names) > 0 {
+		var inspected []networkInspect
+		if err := s.cli.inspect(r.Context(), "network", &inspected, names...); err != nil {
+			return err
+		}
+		for i := range inspected {
+			networks = append(networks, inspected[i].docker())
+		}
+	}
+	return writeJSON(w, http.StatusOK, networks)
+}
+
+func (s *server) createNetwork(w http.ResponseWriter, r *http.Request, _ []string) error {
+	var req struct {
+		Name   string
+		Driver string
+		Labels map[string]string
+		IPAM   struct {
+			Config []struct {
+				Subnet  string
+				Gateway string
+			}
+		}
+	}
+	if err := decodeBody(r, &req); err != nil {
+		return err
+	}
+	if req.Name == "" {
+		return badRequest("network name is required")
+	}
+	args := []string{"network", "create"}
+	if req.Driver != "" {
+		args = append(args, "--driver", req.Driver)
+	}
+	for k, v := range req.Labels {
+		args = append(args, "--label", k+"="+v)
+	}
+	for _, c := range req.IPAM.Config {
+		if c.Subnet != "" {
+			args = append(args, "--subnet", c.Subnet)
+		}
+		if c.Gateway != "" {
+			args = append(args, "--gateway", c.Gateway)
+		}
+	}
+	if _, err := s.cli.run(r.Context(), append(args, req.Name)...); err != nil {
+		return err
+	}
+	raw, err := s.cli.inspectOne(r.Context(), "network", req.Name)
+	if err != nil {
+		return err
+	}
+	var created networkInspect
+	json.Unmarshal(raw, &created)
+	id := created.ID
+	if id == "" {
+		id = req.Name
+	}
+	return writeJSON(w, http.StatusCreated, map[string]string{"Id": id, "Warning": ""})
+}
+
+func (s *server) removeNetwork(w http.ResponseWriter, r *http.Request, p []string) error {
+	if _, err := s.cli.run(r.Context(), "network", "rm", p[0]); err != nil {
+		return err
+	}
+	return noContent(w)
+}
@@ -0,0 +1,131 @@
+#!/bin/sh
+# ====================================================
+# Scratch disk vs data disk vs OS disk I/O throughput
+# ====================================================
+# Runs inside the guest, booted with the scratch disk enabled. Measures,
+# in a directory on each disk:
+#
+#   seq_write   MB/s, SIZE MB of random data then fsync
+#   seq_read    MB/s, same file with the page cache dropped
+#   extract     files/s, untarring FILES small files then sync, the
+#               pattern of image layer extraction
+#   fsync       ops/s, 4 KiB writes each followed by fsync
+#
+#   guest/scratch/measure-io.sh [--size MB] [--files N] [OUT.json]
+#
+# Random data keeps the host's detect-zeroes from skipping the writes.
+# OUT.json defaults to /root/io.json; a markdown table goes to stdout.
+# ====================================================
+
+set -eu
+
+SIZE=64
+FILES=2000
+FSYNCS=200
+OUT=/root/io.json
+SRC=/dev/shm/io-src
+TAR=/dev/shm/io-files.tar
+
+die() { echo "error: $*" >&2; exit 1; }
+log() { echo "==> $*" >&2; }
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --size) SIZE="$2"; shift 2 ;;
+        --files) FILES="$2"; shift 2 ;;
+        -h|--help) sed -n '2,19p' "$0"; exit 0 ;;
+        *) OUT="$1"; shift ;;
+    esac
+done
+
+mountpoint -q /scratch || die "/scratch is not mounted: enable the scratch disk and reboot"
+[ "$(id -u)" = 0 ] || die "needs root to drop the page cache"
+
+# Centiseconds since boot; busybox date has no sub-second format
+now_cs() { awk '{ printf "%d", $1 * 100 }' /proc/uptime; }
+# rate COUNT START: COUNT per second since START
+rate() { awk -v n="$1" -v t=$(($(now_cs) - $2)) 'BEGIN { printf "%.1f", t > 0 ? n * 100 / t : 0 }'; }
+
+cleanup() { rm -rf "$SRC" "$TAR" /scratch/io-test /var/lib/docker/io-test /root/io-test; }
+trap cleanup EXIT
+
+log "Preparing $SIZE MB of random data and $FILES small files in RAM"
+head -c $((SIZE * 1024 * 1024)) /dev/urandom > "$SRC"
+mkdir -p /dev/shm/io-files
+i=0
+while [ $i -lt "$FILES" ]; do
+    head -c 4096 "$SRC" > /dev/shm/io-files/f$i
+    i=$((i + 1))
+done
+tar -cf "$TAR" -C /dev/shm io-files
+rm -rf /dev/shm/io-files
+
+# measure DIR: prints "seq_write seq_read extract fsync"
+measure() {
+    dir=$1/io-test
+    rm -rf "$dir"
+    mkdir -p "$dir"
+
+    start=$(now_cs)
+    dd if="$SRC" of="$dir/big" bs=1M conv=fsync 2> /dev/null
+    write=$(rate "$SIZE" "$start")
+
+    sync
+    echo 3 > /proc/sys/vm/drop_caches
+    start=$(now_cs)
+    dd if="$dir/big" of=/dev/null bs=1M 2> /dev/null
+    read=$(rate "$SIZE" "$start")
+
+    start=$(now_cs)
+    tar -xf "$TAR" -C "$dir"
+    sync
+    extract=$(rate "$FILES" "$start")
+
+    start=$(now_cs)
+    i=0
+    while [ $i -lt "$FSYNCS" ]; do
+        dd if="$SRC" of="$dir/sync" bs=4k count=1 conv=fsync,notrunc 2> /dev/null
+        i=$((i + 1))
+    done
+    fsync=$(rate "$FSYNCS" "$start")
+
+    rm -rf "$dir"
+    echo "$write $read $extract $fsync"
+}
+
+log "Measuring scratch disk"
+set -- $(measure /scratch)
+S_WRITE=$1 S_READ=$2 S_EXTRACT=$3 S_FSYNC=$4
+log "Measuring data disk"
+set -- $(measure /var/lib/docker)
+D_WRITE=$1 D_READ=$2 D_EXTRACT=$3 D_FSYNC=$4
+log "Measuring OS disk"
+set -- $(measure /root)
+O_WRITE=$1 O_READ=$2 O_EXTRACT=$3 O_FSYNC=$4
+
+{
+    echo "{"
+    echo "  \"seq_write_mbs.scratch\": $S_WRITE,"
+    echo "  \"seq_write_mbs.data\": $D_WRITE,"
+    echo "  \"seq_write_mbs.os\": $O_WRITE,"
+    echo "  \"seq_read_mbs.scratch\": $S_READ,"
+    echo "  \"seq_read_mbs.data\": $D_READ,"
+    echo "  \"seq_read_mbs.os\": $O_READ,"
+    echo "  \"extract_files_s.scratch\": $S_EXTRACT,"
+    echo "  \"extract_files_s.data\": $D_EXTRACT,"
+    echo "  \"extract_files_s.os\": $O_EXTRACT,"
+    echo "  \"fsync_ops_s.scratch\": $S_FSYNC,"
+    echo "  \"fsync_ops_s.data\": $D_FSYNC,"
+    echo "  \"fsync_ops_s.os\": $O_FSYNC,"
+    echo "  \"size_mb\": $SIZE,"
+    echo "  \"files\": $FILES"
+    echo "}"
+} > "$OUT"
+log "Wrote $OUT"
+
+echo "| Metric | scratch (unsafe, raw) | data (qcow2) | OS (qcow2) |"
+echo "|---|---:|---:|---:|"
+echo "| Sequential write, MB/s | $S_WRITE | $D_WRITE | $O_WRITE |"
+echo "| Sequential read, MB/s | $S_READ | $D_READ | $O_READ |"
+echo "| Small-file extract, files/s | $S_EXTRACT | $D_EXTRACT | $O_EXTRACT |"
+echo "| 4 KiB write + fsync, ops/s | $S_FSYNC | $D_FSYNC | $O_FSYNC |"
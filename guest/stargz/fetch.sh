@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+# ====================================================
+# Stage the stargz snapshotter for the x86_64 guest
+# ====================================================
+# Downloads the containerd-stargz-grpc release binary and stages it in the
+# app assets, from where it is served to the guest over slirp's TFTP
+# server (10.0.2.2) and installed as /usr/local/bin/containerd-stargz-grpc
+# by alpine-setup.sh. The "lazy" runtime (lite + appliance.snapshotter=
+# stargz) runs it as containerd's "stargz" proxy snapshotter.
+#
+# Usage:
+#   guest/stargz/fetch.sh [--no-install]
+#
+# The release tarball is downloaded once into build/stargz. Its SHA-256
+# sum is written to build/stargz/sources.sha256; copy that file next to
+# this script to pin it, after which a mismatch aborts.
+# ====================================================
+
+set -euo pipefail
+
+STARGZ_VERSION=0.15.1
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+WORK_DIR="$REPO_ROOT/build/stargz"
+SRC_DIR="$WORK_DIR/src"
+OUT_DIR="$REPO_ROOT/build/guest"
+ASSET_DIR="$REPO_ROOT/android/app/src/main/assets/qemu/guest"
+
+INSTALL=1
+[ "${1:-}" = "--no-install" ] && INSTALL=0
+
+die() {
+    echo "error: $*" >&2
+    exit 1
+}
+
+log() {
+    echo "==> $*"
+}
+
+fetch() {
+    local url="$1" file="$SRC_DIR/$(basename "$1")"
+    if [ ! -f "$file" ]; then
+        log "Downloading $(basename "$url")"
+        curl -fL --retry 3 -o "$file.part" "$url"
+        mv "$file.part" "$file"
+    fi
+    (cd "$SRC_DIR" && sha256sum "$(basename "$file")") > "$WORK_DIR/sources.sha256"
+}
+
+command -v curl > /dev/null || die "curl not found"
+mkdir -p "$SRC_DIR" "$OUT_DIR"
+
+TARBALL="stargz-snapshotter-v$STARGZ_VERSION-linux-amd64.tar.gz"
+fetch "https://github.com/containerd/stargz-snapshotter/releases/download/v$STARGZ_VERSION/$TARBALL"
+
+if [ -f "$SCRIPT_DIR/sources.sha256" ]; then
+    log "Verifying pinned checksum"
+    (cd "$SRC_DIR" && sha256sum --check --ignore-missing "$SCRIPT_DIR/sources.sha256") \
+        || die "checksum mismatch"
+fi
+
+# The tarball also carries ctr-remote, which the guest doesn't need:
+# nerdctl converts images to eStargz itself
+tar -C "$OUT_DIR" -xzf "$SRC_DIR/$TARBALL" containerd-stargz-grpc
+log "Extracted $(du -h "$OUT_DIR/containerd-stargz-grpc" | cut -f1) $OUT_DIR/containerd-stargz-grpc (v$STARGZ_VERSION)"
+
+if [ "$INSTALL" = 1 ]; then
+    mkdir -p "$ASSET_DIR"
+    cp "$OUT_DIR/containerd-stargz-grpc" "$ASSET_DIR/containerd-stargz-grpc"
+    log "Installed into $ASSET_DIR"
+fi
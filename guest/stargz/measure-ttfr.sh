@@ -0,0 +1,135 @@
+#!/bin/sh
+# ====================================================
+# Time to first response: full pull vs lazy pull
+# ====================================================
+# Runs inside the guest, booted with the "lazy" runtime so containerd has
+# the stargz snapshotter. Starts a registry:2 stand-in on 127.0.0.1:5000,
+# pushes IMAGE to it twice (as is, and converted to eStargz), then times
+# `nerdctl run` from an empty image store until the container answers its
+# first HTTP request:
+#
+#   overlayfs  plain image, every layer downloaded and unpacked first
+#   stargz     eStargz image, files fetched as the container reads them
+#
+#   guest/stargz/measure-ttfr.sh [--runs N] [--image IMAGE] [--port P] [OUT.json]
+#
+# IMAGE must serve HTTP on PORT (default nginx:alpine on 80). OUT.json
+# defaults to /root/ttfr.json; a markdown table of medians goes to stdout.
+# ====================================================
+
+set -eu
+
+RUNS=5
+IMAGE=nginx:alpine
+PORT=80
+OUT=/root/ttfr.json
+REGISTRY=127.0.0.1:5000
+HOST_PORT=18080
+TIMEOUT_S=300
+
+die() { echo "error: $*" >&2; exit 1; }
+log() { echo "==> $*" >&2; }
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --runs) RUNS="$2"; shift 2 ;;
+        --image) IMAGE="$2"; shift 2 ;;
+        --port) PORT="$2"; shift 2 ;;
+        -h|--help) sed -n '2,18p' "$0"; exit 0 ;;
+        *) OUT="$1"; shift ;;
+    esac
+done
+
+command -v nerdctl > /dev/null || die "nerdctl is required (lite runtime)"
+command -v curl > /dev/null || die "curl is required"
+[ -S /run/containerd-stargz-grpc/containerd-stargz-grpc.sock ] \
+    || die "stargz snapshotter not running: boot with the lazy runtime"
+
+# Centiseconds since boot; busybox date has no sub-second format
+now_cs() { awk '{ printf "%d", $1 * 100 }' /proc/uptime; }
+
+cleanup() {
+    nerdctl rm -f ttfr-run > /dev/null 2>&1 || true
+    nerdctl rm -f ttfr-registry > /dev/null 2>&1 || true
+}
+trap cleanup EXIT
+
+# ============== Registry stand-in ==============
+
+# Plain HTTP, and not through the host's registry cache, which can't
+# reach the guest's loopback
+mkdir -p "/etc/containerd/certs.d/$REGISTRY"
+cat > "/etc/containerd/certs.d/$REGISTRY/hosts.toml" << HOSTS
+server = "http://$REGISTRY"
+
+[host."http://$REGISTRY"]
+  capabilities = ["pull", "resolve", "push"]
+HOSTS
+
+log "Starting registry stand-in on $REGISTRY"
+cleanup
+nerdctl run -d --name ttfr-registry --net host registry:2 > /dev/null
+i=0
+until curl -sf "http://$REGISTRY/v2/" > /dev/null; do
+    i=$((i + 1))
+    [ $i -lt 100 ] || die "registry did not come up"
+    sleep 0.1
+done
+
+log "Pushing $IMAGE as-is and as eStargz"
+nerdctl pull -q "$IMAGE" > /dev/null
+nerdctl tag "$IMAGE" "$REGISTRY/ttfr:plain"
+nerdctl image convert --estargz --oci "$IMAGE" "$REGISTRY/ttfr:esgz" > /dev/null
+nerdctl push -q --insecure-registry "$REGISTRY/ttfr:plain" > /dev/null
+nerdctl push -q --insecure-registry "$REGISTRY/ttfr:esgz" > /dev/null
+
+# ============== Runs ==============
+
+# time_run SNAPSHOTTER REF: centiseconds from `run` to the first response
+time_run() {
+    nerdctl rm -f ttfr-run > /dev/null 2>&1 || true
+    nerdctl --snapshotter "$1" rmi -f "$2" > /dev/null 2>&1 || true
+    start=$(now_cs)
+    nerdctl --snapshotter "$1" run -d --name ttfr-run --insecure-registry \
+        -p "$HOST_PORT:$PORT" "$2" > /dev/null
+    until curl -s -o /dev/null "http://127.0.0.1:$HOST_PORT/"; do
+        [ $(($(now_cs) - start)) -lt $((TIMEOUT_S * 100)) ] || die "$2 never answered"
+        sleep 0.05
+    done
+    echo $(($(now_cs) - start))
+}
+
+median_ms() {
+    sort -n | awk '{ v[NR] = $1 } END { printf "%d", v[int((NR + 1) / 2)] * 10 }'
+}
+
+run_profile() {
+    i=0
+    while [ $i -lt "$RUNS" ]; do
+        time_run "$1" "$2"
+        i=$((i + 1))
+    done | median_ms
+}
+
+log "Timing full pulls (overlayfs)"
+FULL_MS=$(run_profile overlayfs "$REGISTRY/ttfr:plain")
+log "Timing lazy pulls (stargz)"
+LAZY_MS=$(run_profile stargz "$REGISTRY/ttfr:esgz")
+
+{
+    echo "{"
+    echo "  \"image\": \"$IMAGE\","
+    echo "  \"ttfr_ms.overlayfs\": $FULL_MS,"
+    echo "  \"ttfr_ms.stargz\": $LAZY_MS,"
+    echo "  \"runs\": $RUNS"
+    echo "}"
+} > "$OUT"
+log "Wrote $OUT"
+
+echo "| $IMAGE | Time to first response (median of $RUNS) |"
+echo "|---|---:|"
+echo "| overlayfs, full pull | $FULL_MS ms |"
+awk -v a="$FULL_MS" -v b="$LAZY_MS" 'BEGIN {
+    change = a > 0 ? sprintf(" (%+.0f%%)", (b - a) * 100 / a) : ""
+    printf "| stargz, lazy pull | %d ms%s |\n", b, change
+}'
@@ -0,0 +1,159 @@
+#!/usr/bin/env bash
+# ====================================================
+# Minimal guest kernel build for docker-droid
+# ====================================================
+# Builds an x86_64 bzImage from tinyconfig plus docker-droid.config and
+# installs it where the launch builder picks it up for direct boot:
+#
+#   android/app/src/main/assets/qemu/vmlinuz
+#   android/app/src/main/assets/qemu/initramfs   (Alpine's, from the ISO)
+#
+# When both are present VmSupervisor boots with -kernel/-initrd/-append
+# instead of going through the ISO's bootloader and stock kernel.
+#
+# Usage:
+#   scripts/kernel/build-kernel.sh [options]
+#
+#   --version X.Y.Z   Linux version (default: 6.6.63, LTS)
+#   --iso PATH        Alpine virt ISO to take the initramfs from
+#                     (default: android/app/src/main/assets/qemu/alpine-virt.iso)
+#   --jobs N          (default: nproc)
+#   --bpf             Also merge bpf.config (BTF and tracepoints for
+#                     guest/bpf-latency; needs pahole)
+#   --no-criu         Leave out criu.config; `docker checkpoint` then
+#                     fails and the app hides it
+#   --no-install      Leave the result in build/kernel only
+#
+# Requires: gcc, make, flex, bison, bc, libelf headers, lz4, curl, and
+# bsdtar or xorriso to read the ISO. On a non-x86_64 host set
+# CROSS_COMPILE (e.g. x86_64-linux-gnu-).
+# ====================================================
+
+set -euo pipefail
+
+KERNEL_VERSION=6.6.63
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+WORK_DIR="$REPO_ROOT/build/kernel"
+ASSET_DIR="$REPO_ROOT/android/app/src/main/assets/qemu"
+
+ISO="$ASSET_DIR/alpine-virt.iso"
+JOBS="$(nproc 2>/dev/null || echo 4)"
+INSTALL=1
+BPF=0
+CRIU=1
+
+die() {
+    echo "error: $*" >&2
+    exit 1
+}
+
+log() {
+    echo "==> $*"
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --version) KERNEL_VERSION="$2"; shift 2 ;;
+        --iso) ISO="$2"; shift 2 ;;
+        --jobs) JOBS="$2"; shift 2 ;;
+        --no-install) INSTALL=0; shift ;;
+        --bpf) BPF=1; shift ;;
+        --no-criu) CRIU=0; shift ;;
+        -h|--help) sed -n '2,30p' "$0"; exit 0 ;;
+        *) die "unknown option $1" ;;
+    esac
+done
+
+SRC="$WORK_DIR/linux-$KERNEL_VERSION"
+OUT="$WORK_DIR/out-$KERNEL_VERSION"
+mkdir -p "$WORK_DIR" "$OUT"
+
+# ============== Source ==============
+
+TARBALL="$WORK_DIR/linux-$KERNEL_VERSION.tar.xz"
+if [ ! -f "$TARBALL" ]; then
+    log "Downloading Linux $KERNEL_VERSION"
+    curl -fL --retry 3 -o "$TARBALL.part" \
+        "https://cdn.kernel.org/pub/linux/kernel/v${KERNEL_VERSION%%.*}.x/linux-$KERNEL_VERSION.tar.xz"
+    mv "$TARBALL.part" "$TARBALL"
+fi
+[ -d "$SRC" ] || tar -C "$WORK_DIR" -xf "$TARBALL"
+
+# ============== Config ==============
+
+KMAKE=(make -C "$SRC" O="$OUT" ARCH=x86_64 ${CROSS_COMPILE:+CROSS_COMPILE="$CROSS_COMPILE"})
+
+FRAGMENTS=("$SCRIPT_DIR/docker-droid.config")
+[ "$CRIU" = 1 ] && FRAGMENTS+=("$SCRIPT_DIR/criu.config")
+[ "$BPF" = 1 ] && FRAGMENTS+=("$SCRIPT_DIR/bpf.config")
+
+log "Configuring (tinyconfig + ${FRAGMENTS[*]##*/})"
+"${KMAKE[@]}" tinyconfig > /dev/null
+"$SRC/scripts/kconfig/merge_config.sh" -m -O "$OUT" "$OUT/.config" "${FRAGMENTS[@]}" > "$OUT/merge.log"
+"${KMAKE[@]}" olddefconfig > /dev/null
+
+# merge_config only warns; an option dropped for an unmet dependency
+# would otherwise surface as a guest that can't find its disk or run dockerd
+missing=0
+while IFS= read -r line; do
+    case "$line" in
+        CONFIG_*=*)
+            if ! grep -qx "$line" "$OUT/.config"; then
+                echo "  not applied: $line (have: $(grep "^${line%%=*}=" "$OUT/.config" || echo unset))" >&2
+                missing=1
+            fi
+            ;;
+        "# CONFIG_"*" is not set")
+            option="${line#\# }"
+            option="${option%% *}"
+            if grep -q "^$option=" "$OUT/.config"; then
+                echo "  not disabled: $option" >&2
+                missing=1
+            fi
+            ;;
+    esac
+done < <(cat "${FRAGMENTS[@]}")
+[ "$missing" = 0 ] || die "config fragment did not apply cleanly, see above and $OUT/merge.log"
+
+# ============== Build ==============
+
+log "Building bzImage"
+"${KMAKE[@]}" -j "$JOBS" bzImage > "$OUT/build.log" 2>&1 \
+    || { tail -40 "$OUT/build.log"; die "kernel build failed, see $OUT/build.log"; }
+
+BZIMAGE="$OUT/arch/x86/boot/bzImage"
+cp "$BZIMAGE" "$WORK_DIR/vmlinuz"
+log "Built $(du -h "$BZIMAGE" | cut -f1) bzImage"
+
+# ============== initramfs ==============
+
+# Alpine's initramfs finds the ISO, mounts it and brings up the live
+# system; with every driver built in its modprobe calls are no-ops
+iso_extract() {
+    local path="$1" dest="$2"
+    if command -v bsdtar > /dev/null; then
+        bsdtar -xOf "$ISO" "${path#/}" > "$dest"
+    elif command -v xorriso > /dev/null; then
+        xorriso -osirrox on -indev "$ISO" -extract "$path" "$dest" > /dev/null 2>&1
+    else
+        die "need bsdtar or xorriso to read $ISO"
+    fi
+}
+
+if [ -f "$ISO" ]; then
+    iso_extract /boot/initramfs-virt "$WORK_DIR/initramfs"
+    # Stock kernel, for measure-boot.sh
+    iso_extract /boot/vmlinuz-virt "$WORK_DIR/vmlinuz-stock"
+else
+    echo "warning: $ISO not found, no initramfs extracted" >&2
+fi
+
+if [ "$INSTALL" = 1 ]; then
+    [ -f "$WORK_DIR/initramfs" ] || die "refusing to install a kernel without its initramfs"
+    mkdir -p "$ASSET_DIR"
+    cp "$WORK_DIR/vmlinuz" "$ASSET_DIR/vmlinuz"
+    cp "$WORK_DIR/initramfs" "$ASSET_DIR/initramfs"
+    log "Installed into $ASSET_DIR"
+fi
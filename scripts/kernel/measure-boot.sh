@@ -0,0 +1,109 @@
+#!/usr/bin/env bash
+# ====================================================
+# Guest boot-to-init time: minimal vs stock kernel
+# ====================================================
+# Boots the Alpine ISO under TCG with the kernel from build-kernel.sh and
+# with the ISO's stock vmlinuz-virt, both with the same initramfs, and
+# times QEMU launch until Alpine's init prints its banner on the serial
+# console, i.e. the kernel handed over to userspace.
+#
+# Usage:
+#   scripts/kernel/measure-boot.sh [--runs N] [--qemu PATH] [--smp N] [--mem MB]
+#
+# Uses build/kernel/{vmlinuz,vmlinuz-stock,initramfs} and the ISO in the
+# app assets. The minimal kernel gets VmSupervisor.GUEST_KERNEL_CMDLINE,
+# the stock kernel Alpine's own boot options.
+# ====================================================
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+WORK_DIR="$REPO_ROOT/build/kernel"
+ISO="$REPO_ROOT/android/app/src/main/assets/qemu/alpine-virt.iso"
+SUPERVISOR="$REPO_ROOT/android/app/src/main/java/com/dockerandroid/app/qemu/VmSupervisor.kt"
+
+RUNS=5
+QEMU=qemu-system-x86_64
+SMP=2
+MEM=1024
+MARKER="Alpine Init"
+TIMEOUT=300
+
+# What isolinux on the alpine-virt ISO passes
+STOCK_APPEND="modules=loop,squashfs,sd-mod,usb-storage quiet console=ttyS0"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --runs) RUNS="$2"; shift 2 ;;
+        --qemu) QEMU="$2"; shift 2 ;;
+        --smp) SMP="$2"; shift 2 ;;
+        --mem) MEM="$2"; shift 2 ;;
+        -h|--help) sed -n '2,16p' "$0"; exit 0 ;;
+        *) echo "error: unknown option $1" >&2; exit 1 ;;
+    esac
+done
+
+# Single source of truth for the production command line
+APPEND="$(sed -n 's/.*GUEST_KERNEL_CMDLINE = "\(.*\)".*/\1/p' "$SUPERVISOR")"
+[ -n "$APPEND" ] || { echo "error: GUEST_KERNEL_CMDLINE not found in $SUPERVISOR" >&2; exit 1; }
+
+for file in "$WORK_DIR/vmlinuz" "$WORK_DIR/vmlinuz-stock" "$WORK_DIR/initramfs" "$ISO"; do
+    [ -f "$file" ] || { echo "error: $file missing, run build-kernel.sh first" >&2; exit 1; }
+done
+
+TMP="$(mktemp -d)"
+trap 'rm -rf "$TMP"' EXIT
+
+# Prints milliseconds from launch to the init banner
+boot_once() {
+    local kernel="$1" append="$2" fifo="$TMP/serial" start line elapsed="" qpid
+    rm -f "$fifo"
+    mkfifo "$fifo"
+
+    start=$(date +%s%N)
+    "$QEMU" -machine q35 -cpu max -accel tcg -smp "$SMP" -m "$MEM" \
+        -nodefaults -display none -no-reboot \
+        -kernel "$kernel" -initrd "$WORK_DIR/initramfs" -append "$append" \
+        -cdrom "$ISO" -serial stdio < /dev/null > "$fifo" 2> /dev/null &
+    qpid=$!
+
+    while IFS= read -r -t "$TIMEOUT" line; do
+        if [[ "$line" == *"$MARKER"* ]]; then
+            elapsed=$(( ($(date +%s%N) - start) / 1000000 ))
+            break
+        fi
+    done < "$fifo"
+
+    kill "$qpid" 2> /dev/null || true
+    wait "$qpid" 2> /dev/null || true
+    [ -n "$elapsed" ] || { echo "error: no \"$MARKER\" within ${TIMEOUT}s ($kernel)" >&2; return 1; }
+    echo "$elapsed"
+}
+
+# Median of RUNS boots
+measure() {
+    local kernel="$1" append="$2" i times=()
+    for ((i = 0; i < RUNS; i++)); do
+        times+=("$(boot_once "$kernel" "$append")")
+    done
+    printf '%s\n' "${times[@]}" | sort -n | sed -n "$(( (RUNS + 1) / 2 ))p"
+}
+
+echo "Measuring stock kernel ($RUNS runs)..." >&2
+stock_ms=$(measure "$WORK_DIR/vmlinuz-stock" "$STOCK_APPEND")
+echo "Measuring minimal kernel ($RUNS runs)..." >&2
+slim_ms=$(measure "$WORK_DIR/vmlinuz" "$APPEND")
+
+size() {
+    awk -v v="$(stat -c %s "$1")" 'BEGIN { printf "%.1f MiB", v / 1048576 }'
+}
+
+echo "### Guest boot to init under TCG ($("$QEMU" --version | head -1), ${SMP} vCPU, ${MEM} MB, median of $RUNS)"
+echo
+echo "| | stock vmlinuz-virt | minimal | change |"
+echo "|---|---|---|---|"
+echo "| Boot to init | ${stock_ms} ms | ${slim_ms} ms | $(awk -v a="$slim_ms" -v b="$stock_ms" 'BEGIN { printf "%+.0f%%", (a - b) * 100 / b }') |"
+echo "| Kernel image | $(size "$WORK_DIR/vmlinuz-stock") | $(size "$WORK_DIR/vmlinuz") | |"
+echo
+echo "Minimal kernel command line: \`$APPEND\`"
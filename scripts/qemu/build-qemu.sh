@@ -0,0 +1,321 @@
+#!/usr/bin/env bash
+# ====================================================
+# Slim QEMU build for docker-droid
+# ====================================================
+# Cross-builds qemu-system-x86_64 for Android with only the machines and
+# devices the app launches (see devices/*.mak), LTO, and no GUI, audio,
+# USB or tools. The result is installed where findQemuBinary() looks:
+#
+#   android/app/src/main/jniLibs/<abi>/libqemu-system-x86_64.so
+#   android/app/src/main/assets/qemu/firmware/   (BIOS blobs, passed with -L)
+#   android/app/src/main/assets/qemu/trace-events (with the log trace backend)
+#
+# The log backend costs one predicted branch per trace point while its
+# events are off; the app switches the ones in trace-events on over QMP
+# and summarizes them natively (see trace.sh for the host equivalent).
+#
+# The "full" variant builds the same target with QEMU's defaults into
+# build/qemu only, as the baseline for report.sh.
+#
+# Usage:
+#   scripts/qemu/build-qemu.sh [options]
+#
+#   --abi arm64-v8a|x86_64|host   Android ABI, or the Linux build host (default: arm64-v8a)
+#   --variant slim|full           (default: slim)
+#   --targets x86_64[,aarch64]    Guest architectures (default: x86_64)
+#   --api N                       Android API level (default: 28, glib needs iconv)
+#   --with-tools                  Also build qemu-img
+#   --trace-backends LIST         QEMU trace backends (default: log, nop for none)
+#   --jobs N                      (default: nproc)
+#   --no-install                  Don't copy into the Android tree
+#
+# Requires: ANDROID_NDK_HOME (r26+) for Android ABIs, meson >= 1.1,
+# ninja, pkg-config, python3, curl, tar, xz. Host builds use the system
+# glib/libslirp development packages instead of building them.
+#
+# Sources are downloaded once into build/qemu/src. Their SHA-256 sums are
+# written to build/qemu/sources.sha256; copy that file next to this
+# script to pin them, after which mismatches abort the build.
+# ====================================================
+
+set -euo pipefail
+
+QEMU_VERSION=9.1.2
+GLIB_VERSION=2.82.4
+SLIRP_VERSION=4.8.0
+PIXMAN_VERSION=0.44.2
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+WORK_DIR="$REPO_ROOT/build/qemu"
+SRC_DIR="$WORK_DIR/src"
+
+ABI=arm64-v8a
+VARIANT=slim
+TARGETS=x86_64
+API=28
+WITH_TOOLS=0
+TRACE_BACKENDS=log
+JOBS="$(nproc 2>/dev/null || echo 4)"
+INSTALL=1
+
+# Firmware the q35/microvm machines load; everything else in pc-bios is unused
+FIRMWARE_BLOBS="bios-256k.bin bios-microvm.bin linuxboot_dma.bin"
+
+die() {
+    echo "error: $*" >&2
+    exit 1
+}
+
+log() {
+    echo "==> $*"
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --abi) ABI="$2"; shift 2 ;;
+        --variant) VARIANT="$2"; shift 2 ;;
+        --targets) TARGETS="$2"; shift 2 ;;
+        --api) API="$2"; shift 2 ;;
+        --with-tools) WITH_TOOLS=1; shift ;;
+        --trace-backends) TRACE_BACKENDS="$2"; shift 2 ;;
+        --jobs) JOBS="$2"; shift 2 ;;
+        --no-install) INSTALL=0; shift ;;
+        -h|--help) sed -n '2,39p' "$0"; exit 0 ;;
+        *) die "unknown option $1" ;;
+    esac
+done
+
+case "$VARIANT" in
+    slim|full) ;;
+    *) die "--variant must be slim or full" ;;
+esac
+
+case "$ABI" in
+    arm64-v8a) TRIPLE=aarch64-linux-android; CPU_FAMILY=aarch64; CPU=armv8-a ;;
+    x86_64) TRIPLE=x86_64-linux-android; CPU_FAMILY=x86_64; CPU=x86_64 ;;
+    host) TRIPLE= ;;
+    *) die "--abi must be arm64-v8a, x86_64 or host" ;;
+esac
+
+TARGET_LIST=""
+for arch in ${TARGETS//,/ }; do
+    [ -f "$SCRIPT_DIR/devices/$arch-slim.mak" ] || die "no device config for guest architecture $arch"
+    TARGET_LIST="${TARGET_LIST:+$TARGET_LIST,}$arch-softmmu"
+done
+
+BUILD_DIR="$WORK_DIR/$ABI-$VARIANT"
+PREFIX="$BUILD_DIR/prefix"
+DEPS_PREFIX="$WORK_DIR/$ABI-deps"
+mkdir -p "$SRC_DIR" "$BUILD_DIR" "$PREFIX"
+
+# ============== Sources ==============
+
+fetch() {
+    local url="$1" file="$SRC_DIR/$(basename "$1")"
+    if [ ! -f "$file" ]; then
+        log "Downloading $(basename "$url")"
+        curl -fL --retry 3 -o "$file.part" "$url"
+        mv "$file.part" "$file"
+    fi
+    (cd "$SRC_DIR" && sha256sum "$(basename "$file")") >> "$WORK_DIR/sources.sha256.new"
+}
+
+unpack() {
+    local archive="$SRC_DIR/$1" dir="$SRC_DIR/$2"
+    if [ ! -d "$dir" ]; then
+        tar -C "$SRC_DIR" -xf "$archive"
+    fi
+    echo "$dir"
+}
+
+rm -f "$WORK_DIR/sources.sha256.new"
+fetch "https://download.qemu.org/qemu-$QEMU_VERSION.tar.xz"
+if [ "$ABI" != host ]; then
+    fetch "https://download.gnome.org/sources/glib/${GLIB_VERSION%.*}/glib-$GLIB_VERSION.tar.xz"
+    fetch "https://gitlab.freedesktop.org/slirp/libslirp/-/archive/v$SLIRP_VERSION/libslirp-v$SLIRP_VERSION.tar.gz"
+    if [ "$VARIANT" = full ]; then
+        fetch "https://www.x.org/releases/individual/lib/pixman-$PIXMAN_VERSION.tar.xz"
+    fi
+fi
+sort -u "$WORK_DIR/sources.sha256.new" > "$WORK_DIR/sources.sha256"
+rm -f "$WORK_DIR/sources.sha256.new"
+
+if [ -f "$SCRIPT_DIR/sources.sha256" ]; then
+    log "Verifying pinned source checksums"
+    (cd "$SRC_DIR" && sha256sum --check --ignore-missing "$SCRIPT_DIR/sources.sha256") \
+        || die "source checksum mismatch"
+fi
+
+QEMU_SRC="$(unpack "qemu-$QEMU_VERSION.tar.xz" "qemu-$QEMU_VERSION")"
+
+# Local fixes for bionic, applied once per unpacked tree
+if compgen -G "$SCRIPT_DIR/patches/*.patch" > /dev/null && [ ! -f "$QEMU_SRC/.docker-droid-patched" ]; then
+    for patch in "$SCRIPT_DIR"/patches/*.patch; do
+        log "Applying $(basename "$patch")"
+        patch -d "$QEMU_SRC" -p1 < "$patch"
+    done
+    touch "$QEMU_SRC/.docker-droid-patched"
+fi
+
+# Device configs are selected by name from configs/devices/<arch>-softmmu/
+for arch in ${TARGETS//,/ }; do
+    cp "$SCRIPT_DIR/devices/$arch-slim.mak" "$QEMU_SRC/configs/devices/$arch-softmmu/docker-droid.mak"
+done
+
+# ============== Toolchain ==============
+
+if [ "$ABI" != host ]; then
+    [ -n "${ANDROID_NDK_HOME:-}" ] || die "ANDROID_NDK_HOME is not set"
+    NDK_BIN="$(echo "$ANDROID_NDK_HOME"/toolchains/llvm/prebuilt/*/bin)"
+    [ -x "$NDK_BIN/$TRIPLE$API-clang" ] || die "no $TRIPLE$API-clang in $NDK_BIN"
+
+    export CC="$NDK_BIN/$TRIPLE$API-clang"
+    export CXX="$NDK_BIN/$TRIPLE$API-clang++"
+    export AR="$NDK_BIN/llvm-ar"
+    export NM="$NDK_BIN/llvm-nm"
+    export RANLIB="$NDK_BIN/llvm-ranlib"
+    export STRIP="$NDK_BIN/llvm-strip"
+    export PKG_CONFIG_LIBDIR="$DEPS_PREFIX/lib/pkgconfig"
+    unset PKG_CONFIG_PATH
+
+    CROSS_FILE="$WORK_DIR/$ABI-cross.ini"
+    sed -e "s|@NDK_BIN@|$NDK_BIN|" \
+        -e "s|@TRIPLE@|$TRIPLE|" \
+        -e "s|@API@|$API|" \
+        -e "s|@PREFIX@|$DEPS_PREFIX|" \
+        -e "s|@CPU_FAMILY@|$CPU_FAMILY|" \
+        -e "s|@CPU@|$CPU|" \
+        "$SCRIPT_DIR/cross/android.ini.in" > "$CROSS_FILE"
+else
+    STRIP="${STRIP:-strip}"
+fi
+
+# ============== Dependencies (Android only) ==============
+
+# Static so the final binary only needs bionic, libz and liblog
+meson_dep() {
+    local name="$1" src="$2"
+    shift 2
+    if [ -f "$DEPS_PREFIX/.built-$name" ]; then
+        return
+    fi
+    log "Building $name for $ABI"
+    meson setup --reconfigure "$WORK_DIR/$ABI-deps-build/$name" "$src" \
+        --cross-file "$CROSS_FILE" \
+        --prefix "$DEPS_PREFIX" \
+        --libdir lib \
+        --buildtype release \
+        --default-library static \
+        --wrap-mode default \
+        "$@"
+    ninja -C "$WORK_DIR/$ABI-deps-build/$name" -j "$JOBS" install
+    touch "$DEPS_PREFIX/.built-$name"
+}
+
+if [ "$ABI" != host ]; then
+    mkdir -p "$DEPS_PREFIX"
+    meson_dep glib "$(unpack "glib-$GLIB_VERSION.tar.xz" "glib-$GLIB_VERSION")" \
+        -Dtests=false -Dintrospection=disabled -Dnls=disabled -Dlibmount=disabled \
+        -Dselinux=disabled -Dxattr=false -Dlibelf=disabled -Dman-pages=disabled \
+        -Ddocumentation=false -Dsysprof=disabled -Dglib_debug=disabled
+    meson_dep libslirp "$(unpack "libslirp-v$SLIRP_VERSION.tar.gz" "libslirp-v$SLIRP_VERSION")"
+    if [ "$VARIANT" = full ]; then
+        meson_dep pixman "$(unpack "pixman-$PIXMAN_VERSION.tar.xz" "pixman-$PIXMAN_VERSION")" \
+            -Dtests=disabled -Ddemos=disabled -Dgtk=disabled -Dlibpng=disabled
+    fi
+fi
+
+# ============== QEMU ==============
+
+CONFIGURE_ARGS=(
+    --prefix="$PREFIX"
+    --target-list="$TARGET_LIST"
+    --disable-user
+    --enable-system
+    --disable-docs
+    --disable-werror
+    --disable-guest-agent
+    --disable-install-blobs
+    --enable-trace-backends="$TRACE_BACKENDS"
+)
+
+if [ "$VARIANT" = slim ]; then
+    # Only what the launch builder uses: TCG, slirp user networking,
+    # qcow2/raw images, virtio. No GUI, audio, USB, VNC, spice, smartcard,
+    # block network protocols or crypto backends.
+    CONFIGURE_ARGS+=(
+        --without-default-features
+        --without-default-devices
+        --enable-tcg
+        --enable-slirp
+        --enable-lto
+        --disable-debug-info
+        --audio-drv-list=
+    )
+    for arch in ${TARGETS//,/ }; do
+        CONFIGURE_ARGS+=(--with-devices-$arch=docker-droid)
+    done
+    if [ "$WITH_TOOLS" = 1 ]; then
+        CONFIGURE_ARGS+=(--enable-tools)
+    else
+        CONFIGURE_ARGS+=(--disable-tools)
+    fi
+fi
+
+if [ "$ABI" != host ]; then
+    CONFIGURE_ARGS+=(
+        --cross-prefix=
+        --cc="$CC"
+        --cxx="$CXX"
+        --host-cc=cc
+        --extra-cflags="-I$DEPS_PREFIX/include -ffunction-sections -fdata-sections"
+        # 16 KB pages are required on newer Android devices
+        --extra-ldflags="-L$DEPS_PREFIX/lib -Wl,--gc-sections -Wl,-z,max-page-size=16384 -llog"
+    )
+fi
+
+log "Configuring QEMU $QEMU_VERSION ($ABI, $VARIANT)"
+(
+    cd "$BUILD_DIR"
+    "$QEMU_SRC/configure" "${CONFIGURE_ARGS[@]}" > configure.log 2>&1 \
+        || { tail -40 configure.log; exit 1; }
+)
+
+log "Building"
+make -C "$BUILD_DIR" -j "$JOBS" > "$BUILD_DIR/build.log" 2>&1 \
+    || { tail -40 "$BUILD_DIR/build.log"; die "QEMU build failed, see $BUILD_DIR/build.log"; }
+make -C "$BUILD_DIR" install > /dev/null
+
+# Blobs aren't installed (--disable-install-blobs); stage the ones we boot with
+mkdir -p "$PREFIX/share/qemu"
+for blob in $FIRMWARE_BLOBS; do
+    cp "$QEMU_SRC/pc-bios/$blob" "$PREFIX/share/qemu/"
+done
+
+# Keep an unstripped copy for symbolizing tombstones
+BINARY="$PREFIX/bin/qemu-system-x86_64"
+cp "$BINARY" "$BUILD_DIR/qemu-system-x86_64.unstripped"
+"$STRIP" --strip-unneeded "$BINARY"
+
+log "Built $(du -h "$BINARY" | cut -f1) $BINARY"
+
+if [ "$INSTALL" = 1 ] && [ "$ABI" != host ] && [ "$VARIANT" = slim ]; then
+    JNI_DIR="$REPO_ROOT/android/app/src/main/jniLibs/$ABI"
+    ASSET_DIR="$REPO_ROOT/android/app/src/main/assets/qemu/firmware"
+    mkdir -p "$JNI_DIR" "$ASSET_DIR"
+    # Packaged as a "library" so the installer extracts it executable
+    cp "$BINARY" "$JNI_DIR/libqemu-system-x86_64.so"
+    if [ "$WITH_TOOLS" = 1 ]; then
+        cp "$PREFIX/bin/qemu-img" "$JNI_DIR/libqemu-img.so"
+    fi
+    for blob in $FIRMWARE_BLOBS; do
+        cp "$PREFIX/share/qemu/$blob" "$ASSET_DIR/"
+    done
+    # Tells the app this binary accepts -trace file=
+    case ",$TRACE_BACKENDS," in
+        *,log,*) cp "$SCRIPT_DIR/trace-events" "$ASSET_DIR/../trace-events" ;;
+        *) rm -f "$ASSET_DIR/../trace-events" ;;
+    esac
+    log "Installed into $JNI_DIR and $ASSET_DIR"
+fi
@@ -0,0 +1,17 @@
+# Device set for an optional aarch64 guest on the `virt` machine, used
+# with --without-default-devices. Only built with --targets ...,aarch64.
+
+# Machines
+CONFIG_ARM_VIRT=y
+
+# virtio transports
+CONFIG_VIRTIO_PCI=y
+CONFIG_VIRTIO_MMIO=y
+
+# virtio devices
+CONFIG_VIRTIO_BLK=y
+CONFIG_VIRTIO_NET=y
+CONFIG_VIRTIO_SERIAL=y
+CONFIG_VIRTIO_RNG=y
+CONFIG_VIRTIO_BALLOON=y
+CONFIG_VIRTIO_MEM=y
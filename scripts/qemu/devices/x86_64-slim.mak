@@ -0,0 +1,30 @@
+# Device set for the docker-droid x86_64 guest, used with
+# --without-default-devices. Everything not listed here (and not
+# selected by these machines' Kconfig) is left out of the binary.
+#
+# Keep in sync with VmSupervisor.buildQemuArgs: a device used on the
+# command line but missing here fails at launch with
+# "'<name>' is not a valid device model name".
+
+# Machines
+CONFIG_Q35=y
+CONFIG_MICROVM=y
+
+# Console and panic reporting
+CONFIG_SERIAL_ISA=y
+CONFIG_PVPANIC_ISA=y
+
+# virtio transports
+CONFIG_VIRTIO_PCI=y
+CONFIG_VIRTIO_MMIO=y
+
+# virtio devices
+CONFIG_VIRTIO_BLK=y
+CONFIG_VIRTIO_NET=y
+CONFIG_VIRTIO_SERIAL=y
+CONFIG_VIRTIO_RNG=y
+CONFIG_VIRTIO_BALLOON=y
+CONFIG_VIRTIO_MEM=y
+
+# Install media (-cdrom) on the q35 AHCI controller
+CONFIG_AHCI_ICH9=y
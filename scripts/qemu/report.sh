@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+# ====================================================
+# Slim vs full QEMU comparison
+# ====================================================
+# Compares two build-qemu.sh outputs on stripped binary size, number of
+# devices compiled in, startup time (launch until -daemonize returns with
+# the machine initialised and paused) and resident memory at that point.
+#
+# Usage:
+#   scripts/qemu/report.sh [--adb] [--runs N] [--machine q35|microvm] [SLIM_DIR FULL_DIR]
+#
+#   --adb        Push both binaries to /data/local/tmp and measure on the
+#                connected device (arm64-v8a or x86_64 builds)
+#   SLIM_DIR     Defaults to build/qemu/host-slim, or arm64-v8a-slim with --adb
+#   FULL_DIR     Defaults to build/qemu/host-full, or arm64-v8a-full with --adb
+#
+# Prints a markdown table and writes build/qemu/report.json.
+# ====================================================
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+WORK_DIR="$REPO_ROOT/build/qemu"
+REMOTE_DIR=/data/local/tmp/qemu-report
+
+USE_ADB=0
+RUNS=5
+MACHINE=q35
+DIRS=()
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --adb) USE_ADB=1; shift ;;
+        --runs) RUNS="$2"; shift 2 ;;
+        --machine) MACHINE="$2"; shift 2 ;;
+        -h|--help) sed -n '2,18p' "$0"; exit 0 ;;
+        *) DIRS+=("$1"); shift ;;
+    esac
+done
+
+if [ ${#DIRS[@]} -eq 0 ]; then
+    abi=host
+    [ "$USE_ADB" = 1 ] && abi=arm64-v8a
+    DIRS=("$WORK_DIR/$abi-slim" "$WORK_DIR/$abi-full")
+fi
+[ ${#DIRS[@]} -eq 2 ] || { echo "error: expected SLIM_DIR and FULL_DIR" >&2; exit 1; }
+
+# Runs on the device's toybox sh as well as locally: POSIX only.
+# Prints "<avg startup ms> <VmRSS kB> <VmHWM kB>" for the last run.
+MEASURE='
+bin=$1; fw=$2; runs=$3; machine=$4; tmp=$5
+total=0; i=0
+while [ $i -lt $runs ]; do
+    rm -f $tmp/qemu.pid
+    start=$(date +%s%N)
+    $bin -L $fw -machine $machine -m 512 -display none -nodefaults -S \
+        -daemonize -pidfile $tmp/qemu.pid >/dev/null 2>&1 || { echo "launch failed" >&2; exit 1; }
+    end=$(date +%s%N)
+    pid=$(cat $tmp/qemu.pid)
+    rss=$(grep VmRSS /proc/$pid/status | tr -s " " | cut -d" " -f2)
+    hwm=$(grep VmHWM /proc/$pid/status | tr -s " " | cut -d" " -f2)
+    kill -9 $pid
+    total=$((total + (end - start) / 1000000))
+    i=$((i + 1))
+done
+echo "$((total / runs)) $rss $hwm"
+'
+
+measure() {
+    local name="$1" dir="$2"
+    local bin="$dir/prefix/bin/qemu-system-x86_64" fw="$dir/prefix/share/qemu"
+    [ -x "$bin" ] || { echo "error: $bin not found, run build-qemu.sh first" >&2; exit 1; }
+
+    local size devices
+    size=$(stat -c %s "$bin")
+
+    if [ "$USE_ADB" = 1 ]; then
+        local remote="$REMOTE_DIR/$name"
+        adb shell "rm -rf $remote && mkdir -p $remote/firmware" > /dev/null
+        adb push "$bin" "$remote/qemu" > /dev/null
+        adb push "$fw/." "$remote/firmware/" > /dev/null
+        adb shell "chmod 755 $remote/qemu"
+        devices=$(adb shell "$remote/qemu -L $remote/firmware -device help" | grep -c '^name ')
+        # shellcheck disable=SC2086
+        read -r startup rss hwm <<< "$(adb shell "sh -c '$(printf %s "$MEASURE" | sed "s/'/'\\\\''/g")' measure \
+            $remote/qemu $remote/firmware $RUNS $MACHINE $remote" | tr -d '\r')"
+    else
+        local tmp
+        tmp=$(mktemp -d)
+        devices=$("$bin" -L "$fw" -device help | grep -c '^name ')
+        read -r startup rss hwm <<< "$(sh -c "$MEASURE" measure "$bin" "$fw" "$RUNS" "$MACHINE" "$tmp")"
+        rm -rf "$tmp"
+    fi
+
+    printf '%s %s %s %s %s %s\n' "$name" "$size" "$devices" "$startup" "$rss" "$hwm"
+}
+
+read -r _ slim_size slim_devices slim_startup slim_rss slim_hwm <<< "$(measure slim "${DIRS[0]}")"
+read -r _ full_size full_devices full_startup full_rss full_hwm <<< "$(measure full "${DIRS[1]}")"
+
+pct() {
+    awk -v a="$1" -v b="$2" 'BEGIN { if (b == 0) print "—"; else printf "%+.0f%%", (a - b) * 100 / b }'
+}
+
+mib() {
+    awk -v v="$1" -v d="$2" 'BEGIN { printf "%.1f MiB", v / d }'
+}
+
+where=host
+[ "$USE_ADB" = 1 ] && where="$(adb shell getprop ro.product.model | tr -d '\r')"
+
+echo "### QEMU slim vs full ($MACHINE, $where, $RUNS runs)"
+echo
+echo "| | slim | full | change |"
+echo "|---|---|---|---|"
+echo "| Binary size (stripped) | $(mib "$slim_size" 1048576) | $(mib "$full_size" 1048576) | $(pct "$slim_size" "$full_size") |"
+echo "| Devices compiled in | $slim_devices | $full_devices | $(pct "$slim_devices" "$full_devices") |"
+echo "| Startup to paused VM | ${slim_startup} ms | ${full_startup} ms | $(pct "$slim_startup" "$full_startup") |"
+echo "| RSS after startup | $(mib "$slim_rss" 1024) | $(mib "$full_rss" 1024) | $(pct "$slim_rss" "$full_rss") |"
+echo "| Peak RSS | $(mib "$slim_hwm" 1024) | $(mib "$full_hwm" 1024) | $(pct "$slim_hwm" "$full_hwm") |"
+
+mkdir -p "$WORK_DIR"
+cat > "$WORK_DIR/report.json" << EOF
+{
+  "machine": "$MACHINE",
+  "runs": $RUNS,
+  "device": "$where",
+  "slim": { "sizeBytes": $slim_size, "devices": $slim_devices, "startupMs": $slim_startup, "rssKb": $slim_rss, "peakRssKb": $slim_hwm },
+  "full": { "sizeBytes": $full_size, "devices": $full_devices, "startupMs": $full_startup, "rssKb": $full_rss, "peakRssKb": $full_hwm }
+}
+EOF
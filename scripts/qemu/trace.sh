@@ -0,0 +1,74 @@
+#!/usr/bin/env bash
+# ====================================================
+# QEMU trace summary on a Linux host
+# ====================================================
+# Runs a QEMU command line with the events in trace-events enabled and
+# summarizes them with qj-trace, the host build of the summarizer the app
+# uses (android/app/src/main/jni/qj_trace.c): virtio-blk latency
+# histograms, virtqueue kicks and interrupts, TCG translations and KVM
+# exits. QEMU must be built with the log trace backend (build-qemu.sh
+# --abi host does this by default) and run in the foreground.
+#
+# Usage:
+#   scripts/qemu/trace.sh [-i seconds] [-o summary.json] -- QEMU_COMMAND...
+#
+#   -i   Print the running summary to stderr every N seconds
+#   -o   Write the final summary here (default: build/qemu/trace-summary.json)
+#
+# TB flushes have no trace event: ask the monitor with `info jit`.
+# ====================================================
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+WORK_DIR="$REPO_ROOT/build/qemu"
+JNI_DIR="$REPO_ROOT/android/app/src/main/jni"
+TOOL_DIR="$WORK_DIR/qj-trace"
+
+INTERVAL=0
+OUTPUT="$WORK_DIR/trace-summary.json"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -i) INTERVAL="$2"; shift 2 ;;
+        -o) OUTPUT="$2"; shift 2 ;;
+        --) shift; break ;;
+        -h|--help) sed -n '2,19p' "$0"; exit 0 ;;
+        *) break ;;
+    esac
+done
+[ $# -gt 0 ] || { echo "error: no QEMU command given" >&2; exit 1; }
+
+for arg in "$@"; do
+    [ "$arg" != -daemonize ] || { echo "error: run QEMU in the foreground (no -daemonize)" >&2; exit 1; }
+done
+
+echo "==> Building qj-trace"
+cmake -S "$JNI_DIR" -B "$TOOL_DIR" > /dev/null
+cmake --build "$TOOL_DIR" --target qj-trace > /dev/null
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+fifo="$tmp/trace.fifo"
+mkfifo "$fifo"
+mkdir -p "$(dirname "$OUTPUT")"
+
+# Blocks opening the FIFO until QEMU does, then reads until QEMU exits
+interval_args=()
+[ "$INTERVAL" -gt 0 ] && interval_args=(-i "$INTERVAL")
+"$TOOL_DIR/qj-trace" "${interval_args[@]}" -o "$OUTPUT" "$fifo" &
+reader=$!
+
+status=0
+"$@" -msg timestamp=on -trace "events=$SCRIPT_DIR/trace-events,file=$fifo" || status=$?
+
+# QEMU that never got as far as opening the trace file leaves the reader waiting
+sleep 1
+kill "$reader" 2> /dev/null || true
+if wait "$reader" && [ -s "$OUTPUT" ]; then
+    echo "==> Summary written to $OUTPUT"
+else
+    echo "error: no trace summary; was QEMU built with --trace-backends log?" >&2
+fi
+exit "$status"